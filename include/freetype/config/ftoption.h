@@ -387,6 +387,22 @@ FT_BEGIN_HEADER
 #define FT_RENDER_POOL_SIZE  16384L
 
 
+  /**************************************************************************
+   *
+   * The maximum size in bytes to which the smooth and monochrome
+   * rasterizers may grow their render pools on the heap.  If an outline
+   * needs more memory than `FT_RENDER_POOL_SIZE`, a larger pool is
+   * allocated for the current call (doubling its size each time, up to
+   * this limit), so that complex glyphs at large sizes get rendered
+   * without splitting them into many bands.  Values not larger than
+   * `FT_RENDER_POOL_SIZE` disable the heap pool.
+   *
+   * This value can be changed at runtime with the 'max-pool-size' property
+   * of the 'smooth' and 'raster1' modules.
+   */
+#define FT_RENDER_POOL_MAX_SIZE  1048576L
+
+
   /**************************************************************************
    *
    * FT_MAX_MODULES
@@ -717,6 +733,45 @@ FT_BEGIN_HEADER
 #endif
 
 
+  /**************************************************************************
+   *
+   * Option `TT_CONFIG_OPTION_PREP_CACHE_SIZE` is the number of results of
+   * the cvt program (`prep`) a TrueType face keeps, together with the
+   * definitions made by the font program (`fpgm`), which is then run only
+   * once per face instead of once per size object.  A size object that is
+   * set to a pixel size and rendering mode seen recently gets its control
+   * value table, storage area, and twilight zone from this cache instead of
+   * running `prep` again.  Each entry takes about as much memory as these
+   * tables.  Set this to zero to switch off the cache of `prep` results.
+   *
+   * Like `TT_CONFIG_OPTION_MAX_RUNNABLE_OPCODES`, it can be set on the
+   * compiler's command line.
+   */
+#ifndef TT_CONFIG_OPTION_PREP_CACHE_SIZE
+#define TT_CONFIG_OPTION_PREP_CACHE_SIZE  16
+#endif
+
+
+  /**************************************************************************
+   *
+   * Define `TT_CONFIG_OPTION_BYTECODE_PROFILE` to make the bytecode
+   * interpreter collect statistics while it runs: the number of times each
+   * opcode gets executed together with an estimate of the time it takes,
+   * the number of instructions executed by the font, cvt, and glyph
+   * programs, the depth of nested function calls, and the glyphs with the
+   * most expensive glyph programs.  The numbers are kept per face and can
+   * be retrieved with the `bytecode-profile` property of the TrueType
+   * driver.
+   *
+   * This slows down the interpreter considerably and is thus meant for
+   * analyzing fonts only; don't define it for production builds.
+   *
+   * This option requires `TT_CONFIG_OPTION_BYTECODE_INTERPRETER` to be
+   * defined.
+   */
+/* #define TT_CONFIG_OPTION_BYTECODE_PROFILE */
+
+
   /*************************************************************************/
   /*************************************************************************/
   /****                                                                 ****/
@@ -945,6 +1000,14 @@ FT_BEGIN_HEADER
 #endif
 
 
+  /*
+   * The profiler is part of the bytecode interpreter.  Don't change this.
+   */
+#ifndef TT_USE_BYTECODE_INTERPRETER
+#undef TT_CONFIG_OPTION_BYTECODE_PROFILE
+#endif
+
+
   /*
    * Check CFF darkening parameters.  The checks are the same as in function
    * `cff_property_set` in file `cffdrivr.c`.
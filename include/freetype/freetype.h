@@ -3237,6 +3237,18 @@ FT_BEGIN_HEADER
    *     bitmaps that are 3~times the height of the original glyph outline in
    *     pixels and use the @FT_PIXEL_MODE_LCD_V mode.
    *
+   *   FT_RENDER_MODE_SDF ::
+   *     This mode produces 8-bit signed distance fields (SDF), using the
+   *     @FT_PIXEL_MODE_GRAY mode.  Each pixel holds the distance of its
+   *     center to the nearest outline edge, mapped to the range 0 to~255:
+   *     128 is on the edge, larger values are inside, smaller values
+   *     outside.  Distances beyond the `spread` property of the `sdf`
+   *     module (8~pixels by default) are clamped; the bitmap gets a margin
+   *     of that size on all sides.  Unlike the other modes, this one can
+   *     also be applied to bitmap glyphs (by the `bsdf` module), e.g., to
+   *     embedded bitmaps or to outlines already rendered with another
+   *     mode.
+   *
    * @note:
    *   Should you define `FT_CONFIG_OPTION_SUBPIXEL_RENDERING` in your
    *   `ftoption.h`, which enables patented ClearType-style rendering, the
@@ -3258,6 +3270,7 @@ FT_BEGIN_HEADER
     FT_RENDER_MODE_MONO,
     FT_RENDER_MODE_LCD,
     FT_RENDER_MODE_LCD_V,
+    FT_RENDER_MODE_SDF,
 
     FT_RENDER_MODE_MAX
 
@@ -111,6 +111,28 @@ FT_BEGIN_HEADER
    *   FTC_Manager_LookupFace
    *   FTC_Manager_LookupSize
    *   FTC_Manager_RemoveFaceID
+   *   FTC_Manager_SetLimits
+   *   FTC_Manager_Trim
+   *   FTC_Manager_SetFaceQuota
+   *
+   *   FTC_Lock_NewFunc
+   *   FTC_Lock_DoneFunc
+   *   FTC_Lock_Func
+   *   FTC_LockerRec
+   *   FTC_Manager_NewConcurrent
+   *   FTC_Manager_AcquireSize
+   *   FTC_Manager_ReleaseSize
+   *
+   *   FTC_STATS_LOAD_TIME_BINS
+   *   FTC_Clock_Func
+   *   FTC_Evict_Func
+   *   FTC_StatsHooksRec
+   *   FTC_CacheStatsRec
+   *   FTC_ManagerStatsRec
+   *   FTC_Manager_GetCacheStats
+   *   FTC_Manager_GetStats
+   *   FTC_Manager_ResetStats
+   *   FTC_Manager_SetStatsHooks
    *
    *   FTC_Node
    *   FTC_Node_Unref
@@ -118,14 +140,31 @@ FT_BEGIN_HEADER
    *   FTC_ImageCache
    *   FTC_ImageCache_New
    *   FTC_ImageCache_Lookup
+   *   FTC_ImageCache_LookupBatch
    *
    *   FTC_SBit
    *   FTC_SBitCache
    *   FTC_SBitCache_New
    *   FTC_SBitCache_Lookup
+   *   FTC_SBitCache_LookupBatch
+   *   FTC_SBitCache_SetStore
+   *
+   *   FTC_PhaseCache
+   *   FTC_PhaseCache_New
+   *   FTC_PhaseCache_Lookup
+   *
+   *   FTC_AtlasGlyphRec
+   *   FTC_AtlasGlyph
+   *   FTC_AtlasRectRec
+   *   FTC_AtlasRect
+   *   FTC_AtlasCache
+   *   FTC_AtlasCache_New
+   *   FTC_AtlasCache_Lookup
+   *   FTC_AtlasCache_GetPage
    *
    *   FTC_CMapCache
    *   FTC_CMapCache_New
+   *   FTC_CMapCache_NewFlat
    *   FTC_CMapCache_Lookup
    *
    *************************************************************************/
@@ -321,6 +360,199 @@ FT_BEGIN_HEADER
                    FTC_Manager        *amanager );
 
 
+  /**************************************************************************
+   *
+   * @functype:
+   *   FTC_Lock_NewFunc
+   *
+   * @description:
+   *   A function, provided by client applications, that creates a mutual
+   *   exclusion lock (e.g., a `pthread_mutex_t`).  See @FTC_LockerRec.
+   *
+   * @input:
+   *   data ::
+   *     The `data` field of the @FTC_LockerRec structure.
+   *
+   * @return:
+   *   A handle to the new lock.  NULL in case of failure.
+   */
+  typedef FT_Pointer
+  (*FTC_Lock_NewFunc)( FT_Pointer  data );
+
+
+  /**************************************************************************
+   *
+   * @functype:
+   *   FTC_Lock_DoneFunc
+   *
+   * @description:
+   *   A function, provided by client applications, that destroys a lock
+   *   created by an @FTC_Lock_NewFunc callback.
+   *
+   * @input:
+   *   data ::
+   *     The `data` field of the @FTC_LockerRec structure.
+   *
+   *   lock ::
+   *     The lock to destroy.  It is not held.
+   */
+  typedef void
+  (*FTC_Lock_DoneFunc)( FT_Pointer  data,
+                        FT_Pointer  lock );
+
+
+  /**************************************************************************
+   *
+   * @functype:
+   *   FTC_Lock_Func
+   *
+   * @description:
+   *   A function, provided by client applications, that acquires or
+   *   releases a lock created by an @FTC_Lock_NewFunc callback.
+   *
+   * @input:
+   *   lock ::
+   *     The lock.
+   *
+   * @note:
+   *   The cache never acquires a lock it already holds, so locks need not
+   *   be recursive.
+   */
+  typedef void
+  (*FTC_Lock_Func)( FT_Pointer  lock );
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FTC_LockerRec
+   *
+   * @description:
+   *   A structure that gives a concurrent cache manager access to the
+   *   client's locking primitives.  See @FTC_Manager_NewConcurrent.
+   *
+   * @fields:
+   *   lock_new ::
+   *     Create a lock.
+   *
+   *   lock_done ::
+   *     Destroy a lock.
+   *
+   *   lock ::
+   *     Acquire a lock, waiting until it is available.
+   *
+   *   unlock ::
+   *     Release a lock.
+   *
+   *   data ::
+   *     User data passed to `lock_new` and `lock_done`.
+   */
+  typedef struct  FTC_LockerRec_
+  {
+    FTC_Lock_NewFunc   lock_new;
+    FTC_Lock_DoneFunc  lock_done;
+    FTC_Lock_Func      lock;
+    FTC_Lock_Func      unlock;
+    FT_Pointer         data;
+
+  } FTC_LockerRec;
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_Manager_NewConcurrent
+   *
+   * @description:
+   *   Create a new cache manager that can be used by several threads at the
+   *   same time.
+   *
+   *   The cached nodes are distributed over `num_shards` independent
+   *   shards according to their hash value, each one protected by a lock of
+   *   its own, so that threads looking up different glyphs rarely wait for
+   *   each other.  A cache hit only locks one shard.
+   *
+   *   The `max_bytes` limit applies to the whole manager: if a new node
+   *   makes the cache exceed it, the least recently used nodes of the
+   *   shards that hold more than their share of `max_bytes` get flushed.
+   *
+   *   @FT_Face objects can't be used by several threads at the same time.
+   *   The manager thus keeps a pool of face objects, possibly with several
+   *   instances for the same face ID; a glyph gets loaded with an instance
+   *   that no other thread uses at the moment.
+   *
+   * @input:
+   *   library ::
+   *     The parent FreeType library handle to use.
+   *
+   *   max_faces ::
+   *     Maximum number of unused @FT_Face objects kept in the pool.  Use~0
+   *     for defaults.
+   *
+   *   max_sizes ::
+   *     Maximum number of @FT_Size objects kept for each face object.
+   *     Use~0 for defaults.
+   *
+   *   max_bytes ::
+   *     Maximum number of bytes to use for cached data nodes.  Use~0 for
+   *     defaults.
+   *
+   *   requester ::
+   *     An application-provided callback used to translate face IDs into
+   *     real @FT_Face objects.  It must return a new face object each time
+   *     it is called.
+   *
+   *   req_data ::
+   *     A generic pointer that is passed to the requester each time it is
+   *     called (see @FTC_Face_Requester).
+   *
+   *   num_shards ::
+   *     The number of shards.  Use~0 for defaults.  A few times the number
+   *     of threads is a good choice.
+   *
+   *   locker ::
+   *     The client's locking primitives.  The structure gets copied.
+   *
+   * @output:
+   *   amanager ::
+   *     A handle to a new manager object.  0~in case of failure.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   Create all caches (e.g., with @FTC_ImageCache_New) before using the
+   *   manager from several threads.  @FTC_Manager_Reset and
+   *   @FTC_Manager_RemoveFaceID may be called at any time, but
+   *   @FTC_Manager_Done only if no other thread uses the manager.
+   *
+   *   Only use the `library` handle in other threads as documented for
+   *   @FT_Library; the manager calls the requester and @FT_Done_Face while
+   *   holding a lock of its own.  This lock serializes only the opening
+   *   and closing of faces; lookups in other shards go on meanwhile.
+   *
+   *   A node returned by a lookup function without the `anode` argument can
+   *   be flushed by another thread at any time.  Always use `anode` and
+   *   release the node with @FTC_Node_Unref when done.
+   *
+   *   @FTC_Manager_LookupFace and @FTC_Manager_LookupSize are not available
+   *   with concurrent managers; use @FTC_Manager_AcquireSize instead.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_Manager_NewConcurrent( FT_Library            library,
+                             FT_UInt               max_faces,
+                             FT_UInt               max_sizes,
+                             FT_ULong              max_bytes,
+                             FTC_Face_Requester    requester,
+                             FT_Pointer            req_data,
+                             FT_UInt               num_shards,
+                             const FTC_LockerRec*  locker,
+                             FTC_Manager          *amanager );
+
+
   /**************************************************************************
    *
    * @function:
@@ -507,6 +739,68 @@ FT_BEGIN_HEADER
                           FT_Size     *asize );
 
 
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_Manager_AcquireSize
+   *
+   * @description:
+   *   Retrieve an @FT_Size object that corresponds to a given
+   *   @FTC_ScalerRec pointer, for exclusive use by the caller until it
+   *   calls @FTC_Manager_ReleaseSize.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the cache manager.
+   *
+   *   scaler ::
+   *     A scaler handle.
+   *
+   * @output:
+   *   asize ::
+   *     A handle to the size object.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   With a concurrent manager (see @FTC_Manager_NewConcurrent), the size
+   *   and its parent face `size->face` are taken from the manager's pool
+   *   of face objects; no other thread uses them until they are released.
+   *   Otherwise, this function is the same as @FTC_Manager_LookupSize.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_Manager_AcquireSize( FTC_Manager  manager,
+                           FTC_Scaler   scaler,
+                           FT_Size     *asize );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_Manager_ReleaseSize
+   *
+   * @description:
+   *   Give back a size object retrieved with @FTC_Manager_AcquireSize.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the cache manager.
+   *
+   *   size ::
+   *     The size object.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( void )
+  FTC_Manager_ReleaseSize( FTC_Manager  manager,
+                           FT_Size      size );
+
+
   /**************************************************************************
    *
    * @function:
@@ -563,139 +857,659 @@ FT_BEGIN_HEADER
 
   /**************************************************************************
    *
-   * @type:
-   *   FTC_CMapCache
+   * @function:
+   *   FTC_Manager_SetLimits
    *
    * @description:
-   *   An opaque handle used to model a charmap cache.  This cache is to hold
-   *   character codes -> glyph indices mappings.
+   *   Change the limits of a cache manager that were given to
+   *   @FTC_Manager_New or @FTC_Manager_NewConcurrent.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the cache manager.
+   *
+   *   max_faces ::
+   *     Maximum number of opened @FT_Face objects.  0~leaves the limit
+   *     unchanged.
+   *
+   *   max_sizes ::
+   *     Maximum number of opened @FT_Size objects.  0~leaves the limit
+   *     unchanged.
+   *
+   *   max_bytes ::
+   *     Maximum number of bytes to use for cached data nodes.  0~leaves
+   *     the limit unchanged.
    *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   Lowering a limit immediately closes the least recently used faces
+   *   and sizes and flushes old cache nodes, except for nodes still
+   *   referenced by the client.  With a concurrent manager, faces and
+   *   sizes that are in use are closed when they are given back.
+   *
+   * @since:
+   *   2.10
    */
-  typedef struct FTC_CMapCacheRec_*  FTC_CMapCache;
+  FT_EXPORT( FT_Error )
+  FTC_Manager_SetLimits( FTC_Manager  manager,
+                         FT_UInt      max_faces,
+                         FT_UInt      max_sizes,
+                         FT_ULong     max_bytes );
 
 
   /**************************************************************************
    *
    * @function:
-   *   FTC_CMapCache_New
+   *   FTC_Manager_Trim
    *
    * @description:
-   *   Create a new charmap cache.
+   *   Flush old cache nodes until the cached data uses at most a given
+   *   number of bytes, and give unused memory back to the system.  The
+   *   manager's limit doesn't change.
    *
    * @input:
    *   manager ::
    *     A handle to the cache manager.
    *
-   * @output:
-   *   acache ::
-   *     A new cache handle.  NULL in case of error.
-   *
-   * @return:
-   *   FreeType error code.  0~means success.
+   *   max_bytes ::
+   *     The target size of the cached data.  Use~0 to flush all nodes
+   *     that are not referenced by the client.
    *
    * @note:
-   *   Like all other caches, this one will be destroyed with the cache
-   *   manager.
+   *   This function is meant to be called when the system is short of
+   *   memory.  With a concurrent manager, each shard is trimmed to its
+   *   part of `max_bytes`.
    *
+   * @since:
+   *   2.10
    */
-  FT_EXPORT( FT_Error )
-  FTC_CMapCache_New( FTC_Manager     manager,
-                     FTC_CMapCache  *acache );
+  FT_EXPORT( void )
+  FTC_Manager_Trim( FTC_Manager  manager,
+                    FT_ULong     max_bytes );
 
 
   /**************************************************************************
    *
    * @function:
-   *   FTC_CMapCache_Lookup
+   *   FTC_Manager_SetFaceQuota
    *
    * @description:
-   *   Translate a character code into a glyph index, using the charmap
-   *   cache.
+   *   Limit the number of bytes that the cached data of a single face can
+   *   use, so that lookups in a large font don't flush the data of all
+   *   other fonts.
    *
    * @input:
-   *   cache ::
-   *     A charmap cache handle.
+   *   manager ::
+   *     A handle to the cache manager.
    *
-   *   face_id ::
-   *     The source face ID.
+   *   max_bytes ::
+   *     The quota of each face.  0~removes the quotas, which is the
+   *     default.
    *
-   *   cmap_index ::
-   *     The index of the charmap in the source face.  Any negative value
-   *     means to use the cache @FT_Face's default charmap.
+   * @return:
+   *   FreeType error code.  0~means success.
    *
-   *   char_code ::
-   *     The character code (in the corresponding charmap).
+   * @note:
+   *   When a new node makes a face exceed its quota, the oldest nodes of
+   *   that face are flushed.  The manager's overall limit still applies.
+   *   Faces are identified by their @FTC_FaceID.
    *
-   * @return:
-   *    Glyph index.  0~means 'no glyph'.
+   *   With a concurrent manager, each shard applies its part of the
+   *   quota.
    *
+   * @since:
+   *   2.10
    */
-  FT_EXPORT( FT_UInt )
-  FTC_CMapCache_Lookup( FTC_CMapCache  cache,
-                        FTC_FaceID     face_id,
-                        FT_Int         cmap_index,
-                        FT_UInt32      char_code );
-
-
-  /*************************************************************************/
-  /*************************************************************************/
-  /*************************************************************************/
-  /*****                                                               *****/
-  /*****                       IMAGE CACHE OBJECT                      *****/
-  /*****                                                               *****/
-  /*************************************************************************/
-  /*************************************************************************/
-  /*************************************************************************/
+  FT_EXPORT( FT_Error )
+  FTC_Manager_SetFaceQuota( FTC_Manager  manager,
+                            FT_ULong     max_bytes );
 
 
   /**************************************************************************
    *
-   * @struct:
-   *   FTC_ImageTypeRec
+   * @macro:
+   *   FTC_STATS_LOAD_TIME_BINS
    *
    * @description:
-   *   A structure used to model the type of images in a glyph cache.
+   *   The number of bins in the load time histograms of
+   *   @FTC_CacheStatsRec and @FTC_ManagerStatsRec.  Bin~0 counts loads
+   *   that took 0~ticks, bin~n (for n~>~0) loads that took at least
+   *   2^(n-1) and less than 2^n ticks.  The last bin also counts all
+   *   slower loads.
+   *
+   * @since:
+   *   2.10
+   */
+#define FTC_STATS_LOAD_TIME_BINS  32
+
+
+  /**************************************************************************
    *
-   * @fields:
-   *   face_id ::
-   *     The face ID.
+   * @functype:
+   *   FTC_Clock_Func
    *
-   *   width ::
-   *     The width in pixels.
+   * @description:
+   *   A function, provided by client applications, that returns the
+   *   current time in arbitrary ticks (e.g., nanoseconds from a monotonic
+   *   clock).  The value may wrap around.  See @FTC_StatsHooksRec.
    *
-   *   height ::
-   *     The height in pixels.
+   * @input:
+   *   data ::
+   *     The `data` field of the @FTC_StatsHooksRec structure.
    *
-   *   flags ::
-   *     The load flags, as in @FT_Load_Glyph.
+   * @return:
+   *   The current time.
    *
+   * @since:
+   *   2.10
    */
-  typedef struct  FTC_ImageTypeRec_
-  {
-    FTC_FaceID  face_id;
-    FT_UInt     width;
-    FT_UInt     height;
-    FT_Int32    flags;
-
-  } FTC_ImageTypeRec;
+  typedef FT_ULong
+  (*FTC_Clock_Func)( FT_Pointer  data );
 
 
   /**************************************************************************
    *
-   * @type:
-   *   FTC_ImageType
+   * @functype:
+   *   FTC_Evict_Func
    *
    * @description:
-   *   A handle to an @FTC_ImageTypeRec structure.
+   *   A function, provided by client applications, that is called whenever
+   *   the cache manager destroys an old node to make room for new data.
+   *   See @FTC_StatsHooksRec.
+   *
+   * @input:
+   *   cache ::
+   *     The handle of the cache the node belongs to, as returned by
+   *     @FTC_ImageCache_New, @FTC_SBitCache_New, etc.
+   *
+   *   weight ::
+   *     The number of bytes the node used.
+   *
+   *   data ::
+   *     The `data` field of the @FTC_StatsHooksRec structure.
    *
+   * @note:
+   *   The function is called from within cache lookups, possibly with
+   *   locks of a concurrent manager held.  It must not call any cache
+   *   function.
+   *
+   * @since:
+   *   2.10
    */
-  typedef struct FTC_ImageTypeRec_*  FTC_ImageType;
+  typedef void
+  (*FTC_Evict_Func)( FT_Pointer  cache,
+                     FT_Offset   weight,
+                     FT_Pointer  data );
 
 
-  /* */
-
-
-#define FTC_IMAGE_TYPE_COMPARE( d1, d2 )      \
+  /**************************************************************************
+   *
+   * @struct:
+   *   FTC_StatsHooksRec
+   *
+   * @description:
+   *   A structure to install client callbacks for cache statistics.  See
+   *   @FTC_Manager_SetStatsHooks.
+   *
+   * @fields:
+   *   clock ::
+   *     If set, the time of each load after a cache miss is measured and
+   *     recorded in the load time histograms.  Can be NULL.
+   *
+   *   evict ::
+   *     Called for each node destroyed by the manager to respect its
+   *     memory limit, after an out-of-memory error, or by
+   *     @FTC_Manager_Reset.  Can be NULL.
+   *
+   *   data ::
+   *     User data passed to `clock` and `evict`.
+   *
+   *   count_lookups ::
+   *     If true, all lookups are counted, which is needed for the
+   *     `lookups` and `hits` fields of @FTC_CacheStatsRec.  This adds a
+   *     write to the cache for each hit; otherwise, only misses are
+   *     counted.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct  FTC_StatsHooksRec_
+  {
+    FTC_Clock_Func  clock;
+    FTC_Evict_Func  evict;
+    FT_Pointer      data;
+    FT_Bool         count_lookups;
+
+  } FTC_StatsHooksRec;
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FTC_CacheStatsRec
+   *
+   * @description:
+   *   A structure to hold the statistics of a single cache.  See
+   *   @FTC_Manager_GetCacheStats.
+   *
+   * @fields:
+   *   lookups ::
+   *     The number of lookups.  Batch lookups count each glyph.  Lookups
+   *     are only counted while the `count_lookups` field of the
+   *     @FTC_StatsHooksRec structure is set.
+   *
+   *   hits ::
+   *     The number of counted lookups that found the data in the cache.
+   *
+   *   misses ::
+   *     The number of loads because of lookups that didn't find the data.
+   *     This includes glyphs loaded into existing nodes of the small
+   *     bitmap and phase caches.
+   *
+   *   evictions ::
+   *     The number of nodes destroyed by the manager to make room for new
+   *     data or by @FTC_Manager_Reset.  Nodes removed by
+   *     @FTC_Manager_RemoveFaceID are not counted.
+   *
+   *   load_times ::
+   *     A histogram of the load times of misses, in ticks of the clock
+   *     set with @FTC_Manager_SetStatsHooks; see
+   *     @FTC_STATS_LOAD_TIME_BINS.  Misses are only recorded here while a
+   *     clock is set.
+   *
+   *   num_nodes ::
+   *     The current number of nodes.
+   *
+   *   weight ::
+   *     The current number of bytes used by the nodes and, for atlas
+   *     caches, by the allocated pages.
+   *
+   *   num_families ::
+   *     The current number of families, i.e., of distinct face, size, and
+   *     load flag combinations used in lookups.  For a concurrent manager,
+   *     each shard has its own families.  Always~0 for charmap caches.
+   *
+   *   num_buckets ::
+   *     The current number of hash table buckets.  The average load
+   *     factor is `num_nodes / num_buckets`.
+   *
+   *   max_bucket_nodes ::
+   *     The number of nodes in the most crowded bucket.
+   *
+   * @note:
+   *   The counters `lookups`, `hits`, `misses`, `evictions`, and
+   *   `load_times` are cumulative and can be reset with
+   *   @FTC_Manager_ResetStats.  The other fields are computed when the
+   *   statistics are retrieved.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct  FTC_CacheStatsRec_
+  {
+    FT_ULong   lookups;
+    FT_ULong   hits;
+    FT_ULong   misses;
+    FT_ULong   evictions;
+    FT_ULong   load_times[FTC_STATS_LOAD_TIME_BINS];
+
+    FT_ULong   num_nodes;
+    FT_Offset  weight;
+    FT_ULong   num_families;
+    FT_ULong   num_buckets;
+    FT_ULong   max_bucket_nodes;
+
+  } FTC_CacheStatsRec;
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FTC_ManagerStatsRec
+   *
+   * @description:
+   *   A structure to hold the statistics of a cache manager.  See
+   *   @FTC_Manager_GetStats.
+   *
+   * @fields:
+   *   caches ::
+   *     The sum of the statistics of all caches of the manager.  Its
+   *     `max_bucket_nodes` field is the maximum over all caches.
+   *
+   *   num_caches ::
+   *     The number of caches.
+   *
+   *   max_bytes ::
+   *     The manager's memory limit.
+   *
+   *   slab_bytes ::
+   *     The number of bytes allocated by the manager for storing small
+   *     nodes and bitmaps.  The weight of the nodes counts the part of
+   *     it that is in use.
+   *
+   *   num_faces ::
+   *     The current number of @FT_Face objects opened by the manager.
+   *
+   *   num_sizes ::
+   *     The current number of @FT_Size objects created by the manager.
+   *     With @FTC_Manager_NewConcurrent, the size objects of a face being
+   *     used by a lookup are counted as of the end of its previous use.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct  FTC_ManagerStatsRec_
+  {
+    FTC_CacheStatsRec  caches;
+    FT_UInt            num_caches;
+
+    FT_Offset          max_bytes;
+    FT_Offset          slab_bytes;
+
+    FT_UInt            num_faces;
+    FT_UInt            num_sizes;
+
+  } FTC_ManagerStatsRec;
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_Manager_GetCacheStats
+   *
+   * @description:
+   *   Retrieve the statistics of a cache.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the cache manager.
+   *
+   *   cache ::
+   *     The handle of a cache created for `manager`, e.g., an
+   *     @FTC_SBitCache handle.
+   *
+   * @output:
+   *   astats ::
+   *     The statistics.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   Keeping the statistics costs a few counter increments per lookup;
+   *   walking the hash table to compute the fields `num_nodes` to
+   *   `max_bucket_nodes` takes time proportional to the number of nodes.
+   *
+   *   With a concurrent manager, this function can be called from any
+   *   thread; the values of all shards are added.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_Manager_GetCacheStats( FTC_Manager         manager,
+                             FT_Pointer          cache,
+                             FTC_CacheStatsRec  *astats );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_Manager_GetStats
+   *
+   * @description:
+   *   Retrieve the statistics of a cache manager and all its caches.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the cache manager.
+   *
+   * @output:
+   *   astats ::
+   *     The statistics.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_Manager_GetStats( FTC_Manager           manager,
+                        FTC_ManagerStatsRec  *astats );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_Manager_ResetStats
+   *
+   * @description:
+   *   Reset the cumulative statistics counters of all caches of a manager
+   *   to zero.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the cache manager.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( void )
+  FTC_Manager_ResetStats( FTC_Manager  manager );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_Manager_SetStatsHooks
+   *
+   * @description:
+   *   Install or remove the client callbacks for cache statistics.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the cache manager.
+   *
+   *   hooks ::
+   *     The callbacks; they are copied.  NULL removes all callbacks.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   The callbacks of a concurrent manager are called from the threads
+   *   that do lookups, so they must be thread-safe.
+   *
+   *   Lookups are not counted by default, so that cache hits don't write
+   *   to the cache (see the `count_lookups` field of
+   *   @FTC_StatsHooksRec).
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_Manager_SetStatsHooks( FTC_Manager               manager,
+                             const FTC_StatsHooksRec*  hooks );
+
+
+  /**************************************************************************
+   *
+   * @type:
+   *   FTC_CMapCache
+   *
+   * @description:
+   *   An opaque handle used to model a charmap cache.  This cache is to hold
+   *   character codes -> glyph indices mappings.
+   *
+   */
+  typedef struct FTC_CMapCacheRec_*  FTC_CMapCache;
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_CMapCache_New
+   *
+   * @description:
+   *   Create a new charmap cache.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the cache manager.
+   *
+   * @output:
+   *   acache ::
+   *     A new cache handle.  NULL in case of error.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   Like all other caches, this one will be destroyed with the cache
+   *   manager.
+   *
+   */
+  FT_EXPORT( FT_Error )
+  FTC_CMapCache_New( FTC_Manager     manager,
+                     FTC_CMapCache  *acache );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_CMapCache_NewFlat
+   *
+   * @description:
+   *   Create a new charmap cache that keeps a flat table of glyph indices
+   *   for each face and charmap.  It is used with @FTC_CMapCache_Lookup,
+   *   like caches created with @FTC_CMapCache_New.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the cache manager.
+   *
+   * @output:
+   *   acache ::
+   *     A new cache handle.  NULL in case of error.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   A table maps blocks of 256~character codes to glyph indices; blocks
+   *   are allocated when a character code in them is first looked up.
+   *   Consecutive lookups with the same face ID and charmap index then
+   *   cost two array accesses.  This is faster than @FTC_CMapCache_New
+   *   for text in a few fonts, but uses more memory if many fonts are
+   *   used for a few characters each.
+   *
+   *   Character codes larger than 0x10FFFF are looked up in the face each
+   *   time.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_CMapCache_NewFlat( FTC_Manager     manager,
+                         FTC_CMapCache  *acache );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_CMapCache_Lookup
+   *
+   * @description:
+   *   Translate a character code into a glyph index, using the charmap
+   *   cache.
+   *
+   * @input:
+   *   cache ::
+   *     A charmap cache handle.
+   *
+   *   face_id ::
+   *     The source face ID.
+   *
+   *   cmap_index ::
+   *     The index of the charmap in the source face.  Any negative value
+   *     means to use the cache @FT_Face's default charmap.
+   *
+   *   char_code ::
+   *     The character code (in the corresponding charmap).
+   *
+   * @return:
+   *    Glyph index.  0~means 'no glyph'.
+   *
+   */
+  FT_EXPORT( FT_UInt )
+  FTC_CMapCache_Lookup( FTC_CMapCache  cache,
+                        FTC_FaceID     face_id,
+                        FT_Int         cmap_index,
+                        FT_UInt32      char_code );
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                       IMAGE CACHE OBJECT                      *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FTC_ImageTypeRec
+   *
+   * @description:
+   *   A structure used to model the type of images in a glyph cache.
+   *
+   * @fields:
+   *   face_id ::
+   *     The face ID.
+   *
+   *   width ::
+   *     The width in pixels.
+   *
+   *   height ::
+   *     The height in pixels.
+   *
+   *   flags ::
+   *     The load flags, as in @FT_Load_Glyph.
+   *
+   */
+  typedef struct  FTC_ImageTypeRec_
+  {
+    FTC_FaceID  face_id;
+    FT_UInt     width;
+    FT_UInt     height;
+    FT_Int32    flags;
+
+  } FTC_ImageTypeRec;
+
+
+  /**************************************************************************
+   *
+   * @type:
+   *   FTC_ImageType
+   *
+   * @description:
+   *   A handle to an @FTC_ImageTypeRec structure.
+   *
+   */
+  typedef struct FTC_ImageTypeRec_*  FTC_ImageType;
+
+
+  /* */
+
+
+#define FTC_IMAGE_TYPE_COMPARE( d1, d2 )      \
           ( (d1)->face_id == (d2)->face_id && \
             (d1)->width   == (d2)->width   && \
             (d1)->flags   == (d2)->flags   )
@@ -704,61 +1518,682 @@ FT_BEGIN_HEADER
   /**************************************************************************
    *
    * @type:
-   *   FTC_ImageCache
+   *   FTC_ImageCache
+   *
+   * @description:
+   *   A handle to a glyph image cache object.  They are designed to hold
+   *   many distinct glyph images while not exceeding a certain memory
+   *   threshold.
+   */
+  typedef struct FTC_ImageCacheRec_*  FTC_ImageCache;
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_ImageCache_New
+   *
+   * @description:
+   *   Create a new glyph image cache.
+   *
+   * @input:
+   *   manager ::
+   *     The parent manager for the image cache.
+   *
+   * @output:
+   *   acache ::
+   *     A handle to the new glyph image cache object.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   */
+  FT_EXPORT( FT_Error )
+  FTC_ImageCache_New( FTC_Manager      manager,
+                      FTC_ImageCache  *acache );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_ImageCache_Lookup
+   *
+   * @description:
+   *   Retrieve a given glyph image from a glyph image cache.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the source glyph image cache.
+   *
+   *   type ::
+   *     A pointer to a glyph image type descriptor.
+   *
+   *   gindex ::
+   *     The glyph index to retrieve.
+   *
+   * @output:
+   *   aglyph ::
+   *     The corresponding @FT_Glyph object.  0~in case of failure.
+   *
+   *   anode ::
+   *     Used to return the address of the corresponding cache node after
+   *     incrementing its reference count (see note below).
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   The returned glyph is owned and managed by the glyph image cache.
+   *   Never try to transform or discard it manually!  You can however create
+   *   a copy with @FT_Glyph_Copy and modify the new one.
+   *
+   *   If `anode` is _not_ NULL, it receives the address of the cache node
+   *   containing the glyph image, after increasing its reference count.
+   *   This ensures that the node (as well as the @FT_Glyph) will always be
+   *   kept in the cache until you call @FTC_Node_Unref to 'release' it.
+   *
+   *   If `anode` is NULL, the cache node is left unchanged, which means that
+   *   the @FT_Glyph could be flushed out of the cache on the next call to
+   *   one of the caching sub-system APIs.  Don't assume that it is
+   *   persistent!
+   */
+  FT_EXPORT( FT_Error )
+  FTC_ImageCache_Lookup( FTC_ImageCache  cache,
+                         FTC_ImageType   type,
+                         FT_UInt         gindex,
+                         FT_Glyph       *aglyph,
+                         FTC_Node       *anode );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_ImageCache_LookupScaler
+   *
+   * @description:
+   *   A variant of @FTC_ImageCache_Lookup that uses an @FTC_ScalerRec to
+   *   specify the face ID and its size.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the source glyph image cache.
+   *
+   *   scaler ::
+   *     A pointer to a scaler descriptor.
+   *
+   *   load_flags ::
+   *     The corresponding load flags.
+   *
+   *   gindex ::
+   *     The glyph index to retrieve.
+   *
+   * @output:
+   *   aglyph ::
+   *     The corresponding @FT_Glyph object.  0~in case of failure.
+   *
+   *   anode ::
+   *     Used to return the address of the corresponding cache node after
+   *     incrementing its reference count (see note below).
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   The returned glyph is owned and managed by the glyph image cache.
+   *   Never try to transform or discard it manually!  You can however create
+   *   a copy with @FT_Glyph_Copy and modify the new one.
+   *
+   *   If `anode` is _not_ NULL, it receives the address of the cache node
+   *   containing the glyph image, after increasing its reference count.
+   *   This ensures that the node (as well as the @FT_Glyph) will always be
+   *   kept in the cache until you call @FTC_Node_Unref to 'release' it.
+   *
+   *   If `anode` is NULL, the cache node is left unchanged, which means that
+   *   the @FT_Glyph could be flushed out of the cache on the next call to
+   *   one of the caching sub-system APIs.  Don't assume that it is
+   *   persistent!
+   *
+   *   Calls to @FT_Set_Char_Size and friends have no effect on cached
+   *   glyphs; you should always use the FreeType cache API instead.
+   */
+  FT_EXPORT( FT_Error )
+  FTC_ImageCache_LookupScaler( FTC_ImageCache  cache,
+                               FTC_Scaler      scaler,
+                               FT_ULong        load_flags,
+                               FT_UInt         gindex,
+                               FT_Glyph       *aglyph,
+                               FTC_Node       *anode );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_ImageCache_LookupBatch
+   *
+   * @description:
+   *   Retrieve a run of glyph images with the same size and load flags,
+   *   for example, the output of a text shaper.  This is faster than
+   *   calling @FTC_ImageCache_LookupScaler for each glyph.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the source glyph image cache.
+   *
+   *   scaler ::
+   *     A pointer to a scaler descriptor.
+   *
+   *   load_flags ::
+   *     The corresponding load flags.
+   *
+   *   gindices ::
+   *     An array of `count` glyph indices.
+   *
+   *   count ::
+   *     The number of glyphs; at most 32767.
+   *
+   * @output:
+   *   aglyphs ::
+   *     An array of `count` elements that receives the corresponding
+   *     @FT_Glyph objects.  An element is set to~0 if its glyph cannot be
+   *     loaded.
+   *
+   *   anodes ::
+   *     If not NULL, an array of `count` elements that receives the
+   *     addresses of the corresponding cache nodes after incrementing their
+   *     reference counts.  Elements of glyphs that cannot be loaded are set
+   *     to~0.
+   *
+   * @return:
+   *   FreeType error code of the first glyph that cannot be loaded.
+   *   0~means success.  The other glyphs are retrieved in any case.
+   *
+   * @note:
+   *   The notes of @FTC_ImageCache_LookupScaler apply to all glyphs.
+   *   However, glyphs of the run are not flushed while the function runs,
+   *   so all returned glyphs are valid at least until the next call to the
+   *   caching sub-system, even if `anodes` is NULL.
+   *
+   *   The glyph family of `scaler` and `load_flags` is searched only once,
+   *   and the hash buckets of the glyphs are prefetched before the nodes
+   *   are looked up.
+   *
+   *   With a cache of a concurrent cache manager (see
+   *   @FTC_Manager_NewConcurrent), `anodes` must not be NULL; the glyphs
+   *   are then looked up one by one.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_ImageCache_LookupBatch( FTC_ImageCache  cache,
+                              FTC_Scaler      scaler,
+                              FT_ULong        load_flags,
+                              const FT_UInt*  gindices,
+                              FT_UInt         count,
+                              FT_Glyph       *aglyphs,
+                              FTC_Node       *anodes );
+
+
+  /**************************************************************************
+   *
+   * @type:
+   *   FTC_SBit
+   *
+   * @description:
+   *   A handle to a small bitmap descriptor.  See the @FTC_SBitRec structure
+   *   for details.
+   */
+  typedef struct FTC_SBitRec_*  FTC_SBit;
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FTC_SBitRec
+   *
+   * @description:
+   *   A very compact structure used to describe a small glyph bitmap.
+   *
+   * @fields:
+   *   width ::
+   *     The bitmap width in pixels.
+   *
+   *   height ::
+   *     The bitmap height in pixels.
+   *
+   *   left ::
+   *     The horizontal distance from the pen position to the left bitmap
+   *     border (a.k.a. 'left side bearing', or 'lsb').
+   *
+   *   top ::
+   *     The vertical distance from the pen position (on the baseline) to the
+   *     upper bitmap border (a.k.a. 'top side bearing').  The distance is
+   *     positive for upwards y~coordinates.
+   *
+   *   format ::
+   *     The format of the glyph bitmap (monochrome or gray).
+   *
+   *   max_grays ::
+   *     Maximum gray level value (in the range 1 to~255).
+   *
+   *   pitch ::
+   *     The number of bytes per bitmap line.  May be positive or negative.
+   *
+   *   xadvance ::
+   *     The horizontal advance width in pixels.
+   *
+   *   yadvance ::
+   *     The vertical advance height in pixels.
+   *
+   *   buffer ::
+   *     A pointer to the bitmap pixels.
+   */
+  typedef struct  FTC_SBitRec_
+  {
+    FT_Byte   width;
+    FT_Byte   height;
+    FT_Char   left;
+    FT_Char   top;
+
+    FT_Byte   format;
+    FT_Byte   max_grays;
+    FT_Short  pitch;
+    FT_Char   xadvance;
+    FT_Char   yadvance;
+
+    FT_Byte*  buffer;
+
+  } FTC_SBitRec;
+
+
+  /**************************************************************************
+   *
+   * @type:
+   *   FTC_SBitCache
+   *
+   * @description:
+   *   A handle to a small bitmap cache.  These are special cache objects
+   *   used to store small glyph bitmaps (and anti-aliased pixmaps) in a much
+   *   more efficient way than the traditional glyph image cache implemented
+   *   by @FTC_ImageCache.
+   */
+  typedef struct FTC_SBitCacheRec_*  FTC_SBitCache;
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_SBitCache_New
+   *
+   * @description:
+   *   Create a new cache to store small glyph bitmaps.
+   *
+   * @input:
+   *   manager ::
+   *     A handle to the source cache manager.
+   *
+   * @output:
+   *   acache ::
+   *     A handle to the new sbit cache.  NULL in case of error.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   */
+  FT_EXPORT( FT_Error )
+  FTC_SBitCache_New( FTC_Manager     manager,
+                     FTC_SBitCache  *acache );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_SBitCache_Lookup
+   *
+   * @description:
+   *   Look up a given small glyph bitmap in a given sbit cache and 'lock' it
+   *   to prevent its flushing from the cache until needed.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the source sbit cache.
+   *
+   *   type ::
+   *     A pointer to the glyph image type descriptor.
+   *
+   *   gindex ::
+   *     The glyph index.
+   *
+   * @output:
+   *   sbit ::
+   *     A handle to a small bitmap descriptor.
+   *
+   *   anode ::
+   *     Used to return the address of the corresponding cache node after
+   *     incrementing its reference count (see note below).
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   The small bitmap descriptor and its bit buffer are owned by the cache
+   *   and should never be freed by the application.  They might as well
+   *   disappear from memory on the next cache lookup, so don't treat them as
+   *   persistent data.
+   *
+   *   The descriptor's `buffer` field is set to~0 to indicate a missing
+   *   glyph bitmap.
+   *
+   *   If `anode` is _not_ NULL, it receives the address of the cache node
+   *   containing the bitmap, after increasing its reference count.  This
+   *   ensures that the node (as well as the image) will always be kept in
+   *   the cache until you call @FTC_Node_Unref to 'release' it.
+   *
+   *   If `anode` is NULL, the cache node is left unchanged, which means that
+   *   the bitmap could be flushed out of the cache on the next call to one
+   *   of the caching sub-system APIs.  Don't assume that it is persistent!
+   */
+  FT_EXPORT( FT_Error )
+  FTC_SBitCache_Lookup( FTC_SBitCache    cache,
+                        FTC_ImageType    type,
+                        FT_UInt          gindex,
+                        FTC_SBit        *sbit,
+                        FTC_Node        *anode );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_SBitCache_LookupScaler
+   *
+   * @description:
+   *   A variant of @FTC_SBitCache_Lookup that uses an @FTC_ScalerRec to
+   *   specify the face ID and its size.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the source sbit cache.
+   *
+   *   scaler ::
+   *     A pointer to the scaler descriptor.
+   *
+   *   load_flags ::
+   *     The corresponding load flags.
+   *
+   *   gindex ::
+   *     The glyph index.
+   *
+   * @output:
+   *   sbit ::
+   *     A handle to a small bitmap descriptor.
+   *
+   *   anode ::
+   *     Used to return the address of the corresponding cache node after
+   *     incrementing its reference count (see note below).
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   The small bitmap descriptor and its bit buffer are owned by the cache
+   *   and should never be freed by the application.  They might as well
+   *   disappear from memory on the next cache lookup, so don't treat them as
+   *   persistent data.
+   *
+   *   The descriptor's `buffer` field is set to~0 to indicate a missing
+   *   glyph bitmap.
+   *
+   *   If `anode` is _not_ NULL, it receives the address of the cache node
+   *   containing the bitmap, after increasing its reference count.  This
+   *   ensures that the node (as well as the image) will always be kept in
+   *   the cache until you call @FTC_Node_Unref to 'release' it.
+   *
+   *   If `anode` is NULL, the cache node is left unchanged, which means that
+   *   the bitmap could be flushed out of the cache on the next call to one
+   *   of the caching sub-system APIs.  Don't assume that it is persistent!
+   */
+  FT_EXPORT( FT_Error )
+  FTC_SBitCache_LookupScaler( FTC_SBitCache  cache,
+                              FTC_Scaler     scaler,
+                              FT_ULong       load_flags,
+                              FT_UInt        gindex,
+                              FTC_SBit      *sbit,
+                              FTC_Node      *anode );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_SBitCache_LookupBatch
+   *
+   * @description:
+   *   Retrieve the small bitmaps of a run of glyphs with the same size and
+   *   load flags, for example, the output of a text shaper.  This is faster
+   *   than calling @FTC_SBitCache_LookupScaler for each glyph.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the source sbit cache.
+   *
+   *   scaler ::
+   *     A pointer to the scaler descriptor.
+   *
+   *   load_flags ::
+   *     The corresponding load flags.
+   *
+   *   gindices ::
+   *     An array of `count` glyph indices.
+   *
+   *   count ::
+   *     The number of glyphs; at most 32767.
+   *
+   * @output:
+   *   sbits ::
+   *     An array of `count` elements that receives handles to the small
+   *     bitmap descriptors.  An element is set to~0 if its glyph cannot be
+   *     loaded.
+   *
+   *   anodes ::
+   *     If not NULL, an array of `count` elements that receives the
+   *     addresses of the corresponding cache nodes after incrementing their
+   *     reference counts.  Elements of glyphs that cannot be loaded are set
+   *     to~0.  Since a node holds the bitmaps of several glyphs, the same
+   *     node can appear more than once; each element must be released.
+   *
+   * @return:
+   *   FreeType error code of the first glyph that cannot be loaded.
+   *   0~means success.  The other glyphs are retrieved in any case.
+   *
+   * @note:
+   *   The notes of @FTC_SBitCache_LookupScaler apply to all glyphs.
+   *   However, bitmaps of the run are not flushed while the function runs,
+   *   so all returned descriptors are valid at least until the next call to
+   *   the caching sub-system, even if `anodes` is NULL.
+   *
+   *   With a cache of a concurrent cache manager (see
+   *   @FTC_Manager_NewConcurrent), `anodes` must not be NULL; the glyphs
+   *   are then looked up one by one.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_SBitCache_LookupBatch( FTC_SBitCache   cache,
+                             FTC_Scaler      scaler,
+                             FT_ULong        load_flags,
+                             const FT_UInt*  gindices,
+                             FT_UInt         count,
+                             FTC_SBit       *sbits,
+                             FTC_Node       *anodes );
+
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FTC_SBitCache_SetStore
+   *
+   * @description:
+   *   Attach a persistent store to a small bitmap cache.  The store is a
+   *   block of client memory, normally a memory-mapped file, that keeps
+   *   rendered bitmaps across program runs.
+   *
+   *   When a glyph isn't in the cache, its bitmap is looked up in the store
+   *   first; it is only loaded and rendered if this fails, and then added
+   *   to the store.  Bitmaps in the store are used in place and don't count
+   *   towards the `max_bytes` limit of the cache manager.
+   *
+   * @input:
+   *   cache ::
+   *     A handle to the sbit cache.
+   *
+   *   base ::
+   *     The address of the store, aligned on 4~bytes at least.
+   *
+   *   size ::
+   *     The size of the store in bytes; at least 4096.  Only the first
+   *     2GByte are used.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   Bitmaps are identified by a fingerprint of the font file data, the
+   *   face index, the size, the load flags, and the glyph index.  The store
+   *   is cleared if it was created by a different FreeType version or with
+   *   different hinting or LCD filter settings of the library, or if `base`
+   *   doesn't hold a store of `size` bytes.  It is never cleared
+   *   otherwise; once it is full, new bitmaps are only added to the cache.
+   *
+   *   The fingerprint of a face is computed by reading its entire font
+   *   file once each time the cache manager opens the face.  Variation
+   *   fonts must not change their coordinates after being created by the
+   *   face requester.
+   *
+   *   The memory must stay valid until the cache manager is destroyed.  A
+   *   cache can have only one store, and a store must not be used by
+   *   several caches or processes at the same time.  This function must
+   *   not be called while other threads use the cache.
+   *
+   *   A typical POSIX implementation is as follows.
+   *
+   *   ```
+   *     int    fd   = open( "glyphs.cache", O_RDWR | O_CREAT, 0644 );
+   *     void*  base;
+   *
+   *
+   *     ftruncate( fd, size );
+   *     base = mmap( NULL, size, PROT_READ | PROT_WRITE,
+   *                  MAP_SHARED, fd, 0 );
+   *
+   *     error = FTC_SBitCache_SetStore( cache, base, size );
+   *   ```
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FTC_SBitCache_SetStore( FTC_SBitCache  cache,
+                          FT_Pointer     base,
+                          FT_ULong       size );
+
+  /**************************************************************************
+   *
+   * @type:
+   *   FTC_PhaseCache
    *
    * @description:
-   *   A handle to a glyph image cache object.  They are designed to hold
-   *   many distinct glyph images while not exceeding a certain memory
-   *   threshold.
+   *   A handle to a subpixel phase cache.  This is a small bitmap cache for
+   *   glyphs positioned at fractional pixel offsets: each glyph is rendered
+   *   at a fixed number of subpixel offsets of its origin (`phases`),
+   *   sharing a single glyph load for all of them.
+   *
+   * @since:
+   *   2.10
    */
-  typedef struct FTC_ImageCacheRec_*  FTC_ImageCache;
+  typedef struct FTC_PhaseCacheRec_*  FTC_PhaseCache;
 
 
   /**************************************************************************
    *
    * @function:
-   *   FTC_ImageCache_New
+   *   FTC_PhaseCache_New
    *
    * @description:
-   *   Create a new glyph image cache.
+   *   Create a new cache to store small glyph bitmaps rendered at subpixel
+   *   offsets.
    *
    * @input:
    *   manager ::
-   *     The parent manager for the image cache.
+   *     A handle to the source cache manager.
+   *
+   *   x_phases ::
+   *     The number of horizontal phases, i.e., the number of distinct
+   *     fractional x~offsets a glyph is rendered at.  Use~1 for no
+   *     horizontal subpixel positioning.
+   *
+   *   y_phases ::
+   *     The number of vertical phases.
    *
    * @output:
    *   acache ::
-   *     A handle to the new glyph image cache object.
+   *     A handle to the new phase cache.  NULL in case of error.
    *
    * @return:
    *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   Both `x_phases` and `y_phases` must be at least~1, and their product
+   *   must not exceed~16.  Typical values are 4 and~1.
+   *
+   *   The bitmaps count against the `max_bytes` limit of `manager` like
+   *   the contents of all other caches.
+   *
+   * @since:
+   *   2.10
    */
   FT_EXPORT( FT_Error )
-  FTC_ImageCache_New( FTC_Manager      manager,
-                      FTC_ImageCache  *acache );
+  FTC_PhaseCache_New( FTC_Manager      manager,
+                      FT_UInt          x_phases,
+                      FT_UInt          y_phases,
+                      FTC_PhaseCache  *acache );
 
 
   /**************************************************************************
    *
    * @function:
-   *   FTC_ImageCache_Lookup
+   *   FTC_PhaseCache_Lookup
    *
    * @description:
-   *   Retrieve a given glyph image from a glyph image cache.
+   *   Look up a given small glyph bitmap, rendered at a subpixel offset, in
+   *   a given phase cache and lock it to prevent its flushing from the
+   *   cache until needed.
    *
    * @input:
    *   cache ::
-   *     A handle to the source glyph image cache.
+   *     A handle to the source phase cache.
    *
-   *   type ::
-   *     A pointer to a glyph image type descriptor.
+   *   scaler ::
+   *     A pointer to the scaler descriptor.
+   *
+   *   load_flags ::
+   *     The corresponding load flags.  @FT_LOAD_RENDER is ignored; the
+   *     render mode is taken from the @FT_LOAD_TARGET_XXX value.
    *
    *   gindex ::
-   *     The glyph index to retrieve.
+   *     The glyph index.
+   *
+   *   x_offset ::
+   *     The horizontal pen position in 26.6 format.  Only its fractional
+   *     part is used; it is rounded down to a multiple of 1/`x_phases`
+   *     pixel.
+   *
+   *   y_offset ::
+   *     The vertical pen position in 26.6 format, with y~values increasing
+   *     upwards.  Only its fractional part is used.
    *
    * @output:
-   *   aglyph ::
-   *     The corresponding @FT_Glyph object.  0~in case of failure.
+   *   sbit ::
+   *     A handle to a small bitmap descriptor.  Its `left` and `top` fields
+   *     are relative to the integer pen position, that is, to
+   *     `FT_FLOOR(x_offset)` and `FT_FLOOR(y_offset)`.
    *
    *   anode ::
    *     Used to return the address of the corresponding cache node after
@@ -768,220 +2203,268 @@ FT_BEGIN_HEADER
    *   FreeType error code.  0~means success.
    *
    * @note:
-   *   The returned glyph is owned and managed by the glyph image cache.
-   *   Never try to transform or discard it manually!  You can however create
-   *   a copy with @FT_Glyph_Copy and modify the new one.
+   *   The small bitmap descriptor and its bit buffer are owned by the cache
+   *   and should never be freed by the application.  They might as well
+   *   disappear from memory on the next cache lookup, so don't treat them
+   *   as persistent data.
    *
-   *   If `anode` is _not_ NULL, it receives the address of the cache node
-   *   containing the glyph image, after increasing its reference count.
-   *   This ensures that the node (as well as the @FT_Glyph) will always be
-   *   kept in the cache until you call @FTC_Node_Unref to 'release' it.
+   *   The descriptor's `buffer` field is set to~0 to indicate a missing
+   *   glyph bitmap.
    *
-   *   If `anode` is NULL, the cache node is left unchanged, which means that
-   *   the @FT_Glyph could be flushed out of the cache on the next call to
-   *   one of the caching sub-system APIs.  Don't assume that it is
-   *   persistent!
+   *   All phases of a glyph are stored in the same cache node, and the
+   *   glyph is loaded only once.  Its outline is kept in the node until
+   *   all phases have been rendered.  Bitmap-only glyphs can't be shifted;
+   *   the same bitmap is returned for all phases.
+   *
+   *   If `anode` is _not_ set to NULL, the cache node containing the
+   *   bitmap is locked and must be released with @FTC_Node_Unref.
+   *
+   * @since:
+   *   2.10
    */
   FT_EXPORT( FT_Error )
-  FTC_ImageCache_Lookup( FTC_ImageCache  cache,
-                         FTC_ImageType   type,
+  FTC_PhaseCache_Lookup( FTC_PhaseCache  cache,
+                         FTC_Scaler      scaler,
+                         FT_ULong        load_flags,
                          FT_UInt         gindex,
-                         FT_Glyph       *aglyph,
+                         FT_Pos          x_offset,
+                         FT_Pos          y_offset,
+                         FTC_SBit       *sbit,
                          FTC_Node       *anode );
 
-
   /**************************************************************************
    *
-   * @function:
-   *   FTC_ImageCache_LookupScaler
+   * @struct:
+   *   FTC_AtlasGlyphRec
    *
    * @description:
-   *   A variant of @FTC_ImageCache_Lookup that uses an @FTC_ScalerRec to
-   *   specify the face ID and its size.
-   *
-   * @input:
-   *   cache ::
-   *     A handle to the source glyph image cache.
+   *   A structure describing the position of a glyph bitmap in an atlas
+   *   page of an @FTC_AtlasCache.
    *
-   *   scaler ::
-   *     A pointer to a scaler descriptor.
+   * @fields:
+   *   page ::
+   *     The index of the page.
    *
-   *   load_flags ::
-   *     The corresponding load flags.
+   *   x ::
+   *     The horizontal position of the bitmap's left edge in the page, in
+   *     pixels.
    *
-   *   gindex ::
-   *     The glyph index to retrieve.
+   *   y ::
+   *     The vertical position of the bitmap's top edge in the page, in
+   *     pixels, counted from the top.
    *
-   * @output:
-   *   aglyph ::
-   *     The corresponding @FT_Glyph object.  0~in case of failure.
+   *   width ::
+   *     The bitmap width in pixels.  Zero for empty glyphs (like the space
+   *     glyph) and for glyphs that don't fit into a page.
    *
-   *   anode ::
-   *     Used to return the address of the corresponding cache node after
-   *     incrementing its reference count (see note below).
+   *   height ::
+   *     The bitmap height in pixels.
    *
-   * @return:
-   *   FreeType error code.  0~means success.
+   *   left ::
+   *     The horizontal distance from the pen position to the left bitmap
+   *     border (a.k.a. `left side bearing', or `lsb').
    *
-   * @note:
-   *   The returned glyph is owned and managed by the glyph image cache.
-   *   Never try to transform or discard it manually!  You can however create
-   *   a copy with @FT_Glyph_Copy and modify the new one.
+   *   top ::
+   *     The vertical distance from the pen position (on the baseline) to
+   *     the upper bitmap border (a.k.a. `top side bearing').  The distance
+   *     is positive for upwards y~coordinates.
    *
-   *   If `anode` is _not_ NULL, it receives the address of the cache node
-   *   containing the glyph image, after increasing its reference count.
-   *   This ensures that the node (as well as the @FT_Glyph) will always be
-   *   kept in the cache until you call @FTC_Node_Unref to 'release' it.
+   *   xadvance ::
+   *     The horizontal advance width in pixels.
    *
-   *   If `anode` is NULL, the cache node is left unchanged, which means that
-   *   the @FT_Glyph could be flushed out of the cache on the next call to
-   *   one of the caching sub-system APIs.  Don't assume that it is
-   *   persistent!
+   *   yadvance ::
+   *     The vertical advance height in pixels.
    *
-   *   Calls to @FT_Set_Char_Size and friends have no effect on cached
-   *   glyphs; you should always use the FreeType cache API instead.
+   * @since:
+   *   2.10
    */
-  FT_EXPORT( FT_Error )
-  FTC_ImageCache_LookupScaler( FTC_ImageCache  cache,
-                               FTC_Scaler      scaler,
-                               FT_ULong        load_flags,
-                               FT_UInt         gindex,
-                               FT_Glyph       *aglyph,
-                               FTC_Node       *anode );
+  typedef struct  FTC_AtlasGlyphRec_
+  {
+    FT_UInt    page;
+    FT_UShort  x;
+    FT_UShort  y;
+    FT_UShort  width;
+    FT_UShort  height;
+
+    FT_Short   left;
+    FT_Short   top;
+    FT_Short   xadvance;
+    FT_Short   yadvance;
+
+  } FTC_AtlasGlyphRec;
 
 
   /**************************************************************************
    *
    * @type:
-   *   FTC_SBit
+   *   FTC_AtlasGlyph
    *
    * @description:
-   *   A handle to a small bitmap descriptor.  See the @FTC_SBitRec structure
-   *   for details.
+   *   A handle to an @FTC_AtlasGlyphRec structure.
+   *
+   * @since:
+   *   2.10
    */
-  typedef struct FTC_SBitRec_*  FTC_SBit;
+  typedef struct FTC_AtlasGlyphRec_*  FTC_AtlasGlyph;
 
 
   /**************************************************************************
    *
    * @struct:
-   *   FTC_SBitRec
+   *   FTC_AtlasRectRec
    *
    * @description:
-   *   A very compact structure used to describe a small glyph bitmap.
+   *   A rectangle in an atlas page, in pixels, counted from the top left
+   *   corner of the page.
    *
    * @fields:
-   *   width ::
-   *     The bitmap width in pixels.
-   *
-   *   height ::
-   *     The bitmap height in pixels.
-   *
-   *   left ::
-   *     The horizontal distance from the pen position to the left bitmap
-   *     border (a.k.a. 'left side bearing', or 'lsb').
-   *
-   *   top ::
-   *     The vertical distance from the pen position (on the baseline) to the
-   *     upper bitmap border (a.k.a. 'top side bearing').  The distance is
-   *     positive for upwards y~coordinates.
-   *
-   *   format ::
-   *     The format of the glyph bitmap (monochrome or gray).
-   *
-   *   max_grays ::
-   *     Maximum gray level value (in the range 1 to~255).
+   *   x ::
+   *     The left edge.
    *
-   *   pitch ::
-   *     The number of bytes per bitmap line.  May be positive or negative.
+   *   y ::
+   *     The top edge.
    *
-   *   xadvance ::
-   *     The horizontal advance width in pixels.
+   *   width ::
+   *     The width.  Zero for an empty rectangle.
    *
-   *   yadvance ::
-   *     The vertical advance height in pixels.
+   *   height ::
+   *     The height.
    *
-   *   buffer ::
-   *     A pointer to the bitmap pixels.
+   * @since:
+   *   2.10
    */
-  typedef struct  FTC_SBitRec_
+  typedef struct  FTC_AtlasRectRec_
   {
-    FT_Byte   width;
-    FT_Byte   height;
-    FT_Char   left;
-    FT_Char   top;
+    FT_UInt  x;
+    FT_UInt  y;
+    FT_UInt  width;
+    FT_UInt  height;
 
-    FT_Byte   format;
-    FT_Byte   max_grays;
-    FT_Short  pitch;
-    FT_Char   xadvance;
-    FT_Char   yadvance;
+  } FTC_AtlasRectRec;
 
-    FT_Byte*  buffer;
 
-  } FTC_SBitRec;
+  /**************************************************************************
+   *
+   * @type:
+   *   FTC_AtlasRect
+   *
+   * @description:
+   *   A handle to an @FTC_AtlasRectRec structure.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct FTC_AtlasRectRec_*  FTC_AtlasRect;
 
 
   /**************************************************************************
    *
    * @type:
-   *   FTC_SBitCache
+   *   FTC_AtlasCache
    *
    * @description:
-   *   A handle to a small bitmap cache.  These are special cache objects
-   *   used to store small glyph bitmaps (and anti-aliased pixmaps) in a much
-   *   more efficient way than the traditional glyph image cache implemented
-   *   by @FTC_ImageCache.
+   *   A handle to a glyph atlas cache.  Instead of storing each glyph
+   *   bitmap in a buffer of its own, this cache packs them into a fixed
+   *   number of large pages, which can be uploaded to textures.  Clients
+   *   learn which parts of a page have changed with
+   *   @FTC_AtlasCache_GetPage.
+   *
+   * @since:
+   *   2.10
    */
-  typedef struct FTC_SBitCacheRec_*  FTC_SBitCache;
+  typedef struct FTC_AtlasCacheRec_*  FTC_AtlasCache;
 
 
   /**************************************************************************
    *
    * @function:
-   *   FTC_SBitCache_New
+   *   FTC_AtlasCache_New
    *
    * @description:
-   *   Create a new cache to store small glyph bitmaps.
+   *   Create a new glyph atlas cache.
    *
    * @input:
    *   manager ::
    *     A handle to the source cache manager.
    *
+   *   pixel_mode ::
+   *     The format of the pages, either @FT_PIXEL_MODE_GRAY (one byte per
+   *     pixel) or @FT_PIXEL_MODE_LCD (three bytes per pixel, in the order
+   *     the LCD filter produces them).
+   *
+   *   page_width ::
+   *     The width of a page in pixels, at most 16384.
+   *
+   *   page_height ::
+   *     The height of a page in pixels, at most 16384.
+   *
+   *   max_pages ::
+   *     The maximum number of pages.  Pages are allocated when needed.
+   *
    * @output:
    *   acache ::
-   *     A handle to the new sbit cache.  NULL in case of error.
+   *     A handle to the new atlas cache.  NULL in case of error.
    *
    * @return:
    *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   The glyphs in a page are packed with a skyline algorithm, leaving
+   *   one empty pixel to the right of and below each glyph.  The space of
+   *   single glyphs flushed by the cache manager is not reused; instead, a
+   *   page is freed as soon as all its glyphs are flushed.  If a new glyph
+   *   doesn't fit into any page and all pages are in use, the unlocked
+   *   glyphs of the least recently used pages are evicted until it fits.
+   *
+   *   The whole memory of the allocated pages counts against the
+   *   `max_bytes` limit of `manager`, which should therefore be a good deal
+   *   larger than a page.
+   *
+   *   This cache can't be used with a concurrent cache manager (see
+   *   @FTC_Manager_NewConcurrent).
+   *
+   * @since:
+   *   2.10
    */
   FT_EXPORT( FT_Error )
-  FTC_SBitCache_New( FTC_Manager     manager,
-                     FTC_SBitCache  *acache );
+  FTC_AtlasCache_New( FTC_Manager      manager,
+                      FT_Pixel_Mode    pixel_mode,
+                      FT_UInt          page_width,
+                      FT_UInt          page_height,
+                      FT_UInt          max_pages,
+                      FTC_AtlasCache  *acache );
 
 
   /**************************************************************************
    *
    * @function:
-   *   FTC_SBitCache_Lookup
+   *   FTC_AtlasCache_Lookup
    *
    * @description:
-   *   Look up a given small glyph bitmap in a given sbit cache and 'lock' it
-   *   to prevent its flushing from the cache until needed.
+   *   Look up a given glyph in an atlas cache, rendering it into a page if
+   *   necessary, and lock it to prevent its flushing from the cache until
+   *   needed.
    *
    * @input:
    *   cache ::
-   *     A handle to the source sbit cache.
+   *     A handle to the source atlas cache.
    *
-   *   type ::
-   *     A pointer to the glyph image type descriptor.
+   *   scaler ::
+   *     A pointer to the scaler descriptor.
+   *
+   *   load_flags ::
+   *     The corresponding load flags.  The glyph is always rendered.  With
+   *     @FT_PIXEL_MODE_LCD pages, @FT_LOAD_TARGET_LCD is used; with
+   *     @FT_PIXEL_MODE_GRAY pages, LCD target modes are replaced with
+   *     @FT_LOAD_TARGET_NORMAL and monochrome bitmaps are stored with
+   *     values 0 and~255.
    *
    *   gindex ::
    *     The glyph index.
    *
    * @output:
-   *   sbit ::
-   *     A handle to a small bitmap descriptor.
+   *   aglyph ::
+   *     A handle to the glyph's position in the atlas.
    *
    *   anode ::
    *     Used to return the address of the corresponding cache node after
@@ -991,89 +2474,75 @@ FT_BEGIN_HEADER
    *   FreeType error code.  0~means success.
    *
    * @note:
-   *   The small bitmap descriptor and its bit buffer are owned by the cache
-   *   and should never be freed by the application.  They might as well
-   *   disappear from memory on the next cache lookup, so don't treat them as
-   *   persistent data.
+   *   The position descriptor is owned by the cache.  Like the pixels in
+   *   the page, it is only valid until the next cache lookup, unless
+   *   `anode` is not NULL.  In that case, the glyph is locked in its page
+   *   until the node is released with @FTC_Node_Unref.
    *
-   *   The descriptor's `buffer` field is set to~0 to indicate a missing
-   *   glyph bitmap.
-   *
-   *   If `anode` is _not_ NULL, it receives the address of the cache node
-   *   containing the bitmap, after increasing its reference count.  This
-   *   ensures that the node (as well as the image) will always be kept in
-   *   the cache until you call @FTC_Node_Unref to 'release' it.
+   *   If the glyph doesn't fit into any page because all pages are filled
+   *   with locked glyphs, the error is `FT_Err_Raster_Overflow`.
    *
-   *   If `anode` is NULL, the cache node is left unchanged, which means that
-   *   the bitmap could be flushed out of the cache on the next call to one
-   *   of the caching sub-system APIs.  Don't assume that it is persistent!
+   * @since:
+   *   2.10
    */
   FT_EXPORT( FT_Error )
-  FTC_SBitCache_Lookup( FTC_SBitCache    cache,
-                        FTC_ImageType    type,
-                        FT_UInt          gindex,
-                        FTC_SBit        *sbit,
-                        FTC_Node        *anode );
+  FTC_AtlasCache_Lookup( FTC_AtlasCache   cache,
+                         FTC_Scaler       scaler,
+                         FT_ULong         load_flags,
+                         FT_UInt          gindex,
+                         FTC_AtlasGlyph  *aglyph,
+                         FTC_Node        *anode );
 
 
   /**************************************************************************
    *
    * @function:
-   *   FTC_SBitCache_LookupScaler
+   *   FTC_AtlasCache_GetPage
    *
    * @description:
-   *   A variant of @FTC_SBitCache_Lookup that uses an @FTC_ScalerRec to
-   *   specify the face ID and its size.
+   *   Retrieve the pixels of an atlas page, together with the rectangle
+   *   that has changed since the last call for this page.
    *
    * @input:
    *   cache ::
-   *     A handle to the source sbit cache.
-   *
-   *   scaler ::
-   *     A pointer to the scaler descriptor.
-   *
-   *   load_flags ::
-   *     The corresponding load flags.
+   *     A handle to the source atlas cache.
    *
-   *   gindex ::
-   *     The glyph index.
+   *   page_index ::
+   *     The index of the page, smaller than the `max_pages` value given to
+   *     @FTC_AtlasCache_New.
    *
    * @output:
-   *   sbit ::
-   *     A handle to a small bitmap descriptor.
+   *   abitmap ::
+   *     A bitmap descriptor for the page.  Its buffer is owned by the
+   *     cache.  If the page hasn't been used yet, or if it has been freed
+   *     because all its glyphs were flushed, the buffer is NULL and the
+   *     dimensions are zero.
    *
-   *   anode ::
-   *     Used to return the address of the corresponding cache node after
-   *     incrementing its reference count (see note below).
+   *   adirty ::
+   *     If not NULL, the bounding box of all glyphs written into the page
+   *     since the last call, including their padding.  Its width is zero
+   *     if nothing has changed.
    *
    * @return:
    *   FreeType error code.  0~means success.
    *
    * @note:
-   *   The small bitmap descriptor and its bit buffer are owned by the cache
-   *   and should never be freed by the application.  They might as well
-   *   disappear from memory on the next cache lookup, so don't treat them as
-   *   persistent data.
+   *   Uploading only the dirty rectangle of each page after a run of
+   *   lookups keeps a texture copy of the atlas up to date.  The dirty
+   *   rectangle is reset by this function, so the caller should upload it
+   *   before the next lookup.
    *
-   *   The descriptor's `buffer` field is set to~0 to indicate a missing
-   *   glyph bitmap.
-   *
-   *   If `anode` is _not_ NULL, it receives the address of the cache node
-   *   containing the bitmap, after increasing its reference count.  This
-   *   ensures that the node (as well as the image) will always be kept in
-   *   the cache until you call @FTC_Node_Unref to 'release' it.
+   *   For @FT_PIXEL_MODE_LCD pages, the bitmap width is given in bytes,
+   *   that is, three times the page width.
    *
-   *   If `anode` is NULL, the cache node is left unchanged, which means that
-   *   the bitmap could be flushed out of the cache on the next call to one
-   *   of the caching sub-system APIs.  Don't assume that it is persistent!
+   * @since:
+   *   2.10
    */
   FT_EXPORT( FT_Error )
-  FTC_SBitCache_LookupScaler( FTC_SBitCache  cache,
-                              FTC_Scaler     scaler,
-                              FT_ULong       load_flags,
-                              FT_UInt        gindex,
-                              FTC_SBit      *sbit,
-                              FTC_Node      *anode );
+  FTC_AtlasCache_GetPage( FTC_AtlasCache  cache,
+                          FT_UInt         page_index,
+                          FT_Bitmap      *abitmap,
+                          FTC_AtlasRect   adirty );
 
   /* */
 
@@ -218,8 +218,9 @@ FT_BEGIN_HEADER
    *
    *   The TrueType driver's module name is 'truetype'.
    *
-   *   A single property @interpreter-version is available, as documented in
-   *   the @properties section.
+   *   Available properties are @interpreter-version, @glyph-cache-size,
+   *   @bytecode-profile, @hinting-cost-limit, and @hinting-cost, as
+   *   documented in the @properties section.
    *
    *   We start with a list of definitions, kindly provided by Greg
    *   Hitchcock.
@@ -807,6 +808,364 @@ FT_BEGIN_HEADER
    */
 
 
+  /**************************************************************************
+   *
+   * @property:
+   *   glyph-cache-size
+   *
+   * @description:
+   *   The TrueType driver can keep the hinted outlines and metrics of
+   *   recently loaded glyphs, so that loading a glyph again with the same
+   *   size, rendering mode, and instance doesn't run the bytecode
+   *   interpreter.  This property sets the memory (in bytes, as an
+   *   @FT_ULong) that each face may use for this; the least recently used
+   *   glyphs get discarded first.  The default is zero, which switches the
+   *   cache off.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   This property can be set via the `FREETYPE_PROPERTIES` environment
+   *   variable.
+   *
+   *   The glyph programs of some fonts leave values in the control value
+   *   table or the storage area that influence how later glyphs get
+   *   hinted.  Since cached glyphs don't run their glyph programs, such
+   *   fonts may get hinted differently with the cache.
+   *
+   * @example:
+   *   ```
+   *     FT_Library  library;
+   *     FT_ULong    glyph_cache_size = 1024 * 1024;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     FT_Property_Set( library, "truetype",
+   *                               "glyph-cache-size", &glyph_cache_size );
+   *   ```
+   *
+   * @since:
+   *   2.10
+   */
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   bytecode-profile
+   *
+   * @description:
+   *   If FreeType has been compiled with configuration option
+   *   `TT_CONFIG_OPTION_BYTECODE_PROFILE`, the bytecode interpreter counts
+   *   the instructions it executes for each face.  Use @FT_Property_Get
+   *   with this property to retrieve the numbers collected for a face
+   *   (see @FT_Prop_BytecodeProfile), and @FT_Property_Set to reset them.
+   *   In both cases, the `face` field of the structure must be set; the
+   *   other fields are ignored by @FT_Property_Set.
+   *
+   *   Without the configuration option, the property returns the error
+   *   `Unimplemented_Feature`.
+   *
+   * @note:
+   *   The time estimates are given in the units of a processor cycle
+   *   counter if one is available (currently on x86 platforms with GCC
+   *   compatible compilers); otherwise, they are zero.  Reading the counter
+   *   for every instruction adds a considerable overhead, so the estimates
+   *   are only good for comparing opcodes and glyphs with each other.
+   *
+   * @example:
+   *   ```
+   *     FT_Library               library;
+   *     FT_Face                  face;
+   *     FT_Prop_BytecodeProfile  profile;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *     FT_New_Face( library, "foo.ttf", 0, &face );
+   *
+   *     ... load glyphs ...
+   *
+   *     profile.face = face;
+   *     FT_Property_Get( library, "truetype",
+   *                               "bytecode-profile", &profile );
+   *   ```
+   *
+   * @since:
+   *   2.10
+   */
+
+
+  /**************************************************************************
+   *
+   * @enum:
+   *   FT_BYTECODE_PROFILE_XXX
+   *
+   * @description:
+   *   Indices and array sizes of an @FT_Prop_BytecodeProfile structure.
+   *
+   * @values:
+   *   FT_BYTECODE_PROFILE_FONT ::
+   *     The index of the font program (`fpgm`) in the `program_XXX` arrays.
+   *
+   *   FT_BYTECODE_PROFILE_CVT ::
+   *     The index of the control value program (`prep`).
+   *
+   *   FT_BYTECODE_PROFILE_GLYPH ::
+   *     The index of the glyph programs.
+   *
+   *   FT_BYTECODE_PROFILE_PROGRAMS ::
+   *     The size of the `program_XXX` arrays.
+   *
+   *   FT_BYTECODE_PROFILE_GLYPHS ::
+   *     The maximum number of glyphs listed in the `glyphs` array.
+   *
+   * @since:
+   *   2.10
+   */
+#define FT_BYTECODE_PROFILE_FONT      0
+#define FT_BYTECODE_PROFILE_CVT       1
+#define FT_BYTECODE_PROFILE_GLYPH     2
+#define FT_BYTECODE_PROFILE_PROGRAMS  3
+
+#define FT_BYTECODE_PROFILE_GLYPHS  16
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FT_Prop_BytecodeGlyph
+   *
+   * @description:
+   *   The cost of hinting a glyph, as reported by the @bytecode-profile
+   *   property.
+   *
+   * @fields:
+   *   glyph_index ::
+   *     The glyph index.
+   *
+   *   ppem ::
+   *     The vertical pixel size of the glyph.
+   *
+   *   instructions ::
+   *     The number of instructions executed to hint the glyph, including
+   *     the functions it calls and the glyph programs of its components.
+   *
+   *   cycles ::
+   *     An estimate of the time needed for that.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct  FT_Prop_BytecodeGlyph_
+  {
+    FT_UInt    glyph_index;
+    FT_UShort  ppem;
+    FT_ULong   instructions;
+    FT_ULong   cycles;
+
+  } FT_Prop_BytecodeGlyph;
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FT_Prop_BytecodeProfile
+   *
+   * @description:
+   *   The data exchange structure for the @bytecode-profile property.
+   *
+   * @fields:
+   *   face ::
+   *     The face the numbers are collected for.  Must be set by the caller.
+   *
+   *   opcode_count ::
+   *     The number of times each opcode has been executed, indexed by the
+   *     opcode.  Instructions defined by the font with `IDEF` are counted
+   *     under their own opcode.
+   *
+   *   opcode_cycles ::
+   *     The estimated time spent in each opcode.  For function calls, this
+   *     is the time needed to enter the function only.
+   *
+   *   program_runs ::
+   *     The number of runs of the font program, the control value
+   *     program, and the glyph programs, indexed by the
+   *     @FT_BYTECODE_PROFILE_XXX values.
+   *
+   *   program_instructions ::
+   *     The number of instructions executed by these programs, including
+   *     the functions they call.
+   *
+   *   program_cycles ::
+   *     The estimated time spent in these programs.
+   *
+   *   calls ::
+   *     The number of function calls, made by `CALL`, `LOOPCALL`, or
+   *     instructions defined with `IDEF`.  A `LOOPCALL` counts once.
+   *
+   *   max_call_depth ::
+   *     The deepest nesting of function calls seen.
+   *
+   *   num_glyphs ::
+   *     The number of valid entries in `glyphs`.
+   *
+   *   glyphs ::
+   *     The glyphs with the largest number of executed instructions, most
+   *     expensive first.  A glyph is listed at most once per pixel size.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct  FT_Prop_BytecodeProfile_
+  {
+    FT_Face                face;
+
+    FT_ULong               opcode_count[256];
+    FT_ULong               opcode_cycles[256];
+
+    FT_ULong               program_runs[FT_BYTECODE_PROFILE_PROGRAMS];
+    FT_ULong               program_instructions[FT_BYTECODE_PROFILE_PROGRAMS];
+    FT_ULong               program_cycles[FT_BYTECODE_PROFILE_PROGRAMS];
+
+    FT_ULong               calls;
+    FT_UInt                max_call_depth;
+
+    FT_UInt                num_glyphs;
+    FT_Prop_BytecodeGlyph  glyphs[FT_BYTECODE_PROFILE_GLYPHS];
+
+  } FT_Prop_BytecodeProfile;
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   hinting-cost-limit
+   *
+   * @description:
+   *   Some fonts have font, cvt, or glyph programs that loop until they
+   *   hit the interpreter's limits each time they are run.  If this
+   *   property is set to a value other than zero (the default), the
+   *   TrueType driver checks the bytecode of a face without running it
+   *   when the face gets opened, and the bytecode of each glyph the first
+   *   time the glyph gets loaded.  The check finds programs that are
+   *   broken (for example, with unbalanced `IF` and `EIF` instructions,
+   *   jumps out of the program, or recursive functions) and estimates the
+   *   number of instructions a run executes; the property sets the
+   *   largest estimate (as an @FT_ULong) that is still accepted.
+   *
+   *   If the font or cvt program of a face gets rejected, the face doesn't
+   *   have the @FT_FACE_FLAG_HINTER flag, and @FT_Load_Glyph uses the
+   *   auto-hinter for it (or loads glyphs unhinted if the auto-hinter
+   *   isn't available or @FT_LOAD_NO_AUTOHINT is set).  A rejected glyph
+   *   program is not run; the glyph gets loaded without its hints.  Glyph
+   *   programs that hit the limits of the interpreter are rejected too.
+   *   The verdict on each glyph is kept until the face is closed.
+   *
+   *   @hinting-cost returns the estimates for a face.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   This property can be set via the `FREETYPE_PROPERTIES` environment
+   *   variable.
+   *
+   *   The property only affects faces opened after it has been set.
+   *   Tricky fonts (see @FT_FACE_FLAG_TRICKY) are never checked.
+   *
+   *   The estimates are rough and not an upper bound: both branches of an
+   *   `IF` are counted, loops whose iteration count is not a constant are
+   *   assumed to run 16 times, and the estimate for a composite glyph
+   *   doesn't include the programs of its components.  A limit of about
+   *   100000 only catches pathological fonts.
+   *
+   * @example:
+   *   ```
+   *     FT_Library  library;
+   *     FT_ULong    limit = 100000;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     FT_Property_Set( library, "truetype",
+   *                               "hinting-cost-limit", &limit );
+   *   ```
+   *
+   * @since:
+   *   2.10
+   */
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   hinting-cost
+   *
+   * @description:
+   *   Retrieve the hinting cost estimates for a face (see
+   *   @hinting-cost-limit) with @FT_Property_Get, using an
+   *   @FT_Prop_HintingCost structure whose `face` field is set.
+   *
+   * @note:
+   *   This property is read-only.
+   *
+   * @since:
+   *   2.10
+   */
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FT_Prop_HintingCost
+   *
+   * @description:
+   *   The data exchange structure for the @hinting-cost property.
+   *
+   * @fields:
+   *   face ::
+   *     The face.  Must be set by the caller.
+   *
+   *   verified ::
+   *     True if the bytecode of the face has been checked.  If false, the
+   *     other fields are zero.
+   *
+   *   rejected ::
+   *     True if native hinting has been switched off for the face.
+   *
+   *   font_program ::
+   *     The estimated number of instructions executed by the font program
+   *     (`fpgm`).  It runs once per face.
+   *
+   *   cvt_program ::
+   *     The estimated number of instructions executed by the control
+   *     value program (`prep`).  It runs once per size.
+   *
+   *   max_glyph ::
+   *     The highest estimate for a glyph program among the glyphs loaded
+   *     so far.
+   *
+   *   num_rejected ::
+   *     The number of glyph programs rejected so far.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct  FT_Prop_HintingCost_
+  {
+    FT_Face   face;
+
+    FT_Bool   verified;
+    FT_Bool   rejected;
+
+    FT_ULong  font_program;
+    FT_ULong  cvt_program;
+    FT_ULong  max_glyph;
+    FT_UInt   num_rejected;
+
+  } FT_Prop_HintingCost;
+
+
   /**************************************************************************
    *
    * @property:
@@ -1220,6 +1579,135 @@ FT_BEGIN_HEADER
    */
 
 
+  /**************************************************************************
+   *
+   * @property:
+   *   band-executor
+   *
+   * @description:
+   *   Let the 'smooth' renderer split large outlines into horizontal bands
+   *   that are rendered concurrently by a client-supplied executor, for
+   *   example a thread pool.  The value is a pointer to an
+   *   @FT_Raster_Executor structure; the structure gets copied.  Set its
+   *   `execute` field to NULL to return to serial rendering, which is the
+   *   default.
+   *
+   *   The output is identical to serial rendering.  Only bitmap targets
+   *   are rendered in parallel; span callbacks (@FT_RASTER_FLAG_DIRECT)
+   *   are always called from the calling thread.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   The 'smooth-lcd' and 'smooth-lcdv' modules understand this property,
+   *   too.  The monochrome 'raster1' module also does; it splits both its
+   *   vertical pass (into bands of rows) and its horizontal drop-out pass
+   *   (into bands of columns).
+   *
+   * @example:
+   *   ```
+   *     FT_Library          library;
+   *     FT_Raster_Executor  executor;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     executor.execute   = my_run_jobs;
+   *     executor.pool      = my_pool;
+   *     executor.max_bands = my_num_threads;
+   *     executor.min_rows  = 0;
+   *
+   *     FT_Property_Set( library, "smooth", "band-executor", &executor );
+   *   ```
+   *
+   * @since:
+   *   2.10
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   max-pool-size
+   *
+   * @description:
+   *   The 'smooth' renderer starts with a fixed-size render pool of
+   *   `FT_RENDER_POOL_SIZE` bytes.  If an outline needs more memory, the
+   *   renderer allocates a larger pool on the heap for the current call,
+   *   doubling its size as needed.  This property limits the size of that
+   *   pool (in bytes, as an @FT_ULong); beyond the limit, outlines get
+   *   rendered in several bands.  The default is
+   *   `FT_RENDER_POOL_MAX_SIZE`; values not larger than
+   *   `FT_RENDER_POOL_SIZE` disable the heap pool.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   This property can be set via the `FREETYPE_PROPERTIES` environment
+   *   variable.
+   *
+   *   Each of the 'smooth', 'smooth-lcd', 'smooth-lcdv', and 'raster1'
+   *   modules has its own limit.
+   *
+   * @example:
+   *   ```
+   *     FT_Library  library;
+   *     FT_ULong    max_pool_size = 256 * 1024;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     FT_Property_Set( library, "smooth",
+   *                               "max-pool-size", &max_pool_size );
+   *   ```
+   *
+   * @since:
+   *   2.10
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @property:
+   *   spread
+   *
+   * @description:
+   *   The 'sdf' and 'bsdf' renderers, which handle @FT_RENDER_MODE_SDF for
+   *   outlines and bitmaps, respectively, map distances from -spread to
+   *   +spread pixels to the pixel values 0 to~255; farther pixels get
+   *   clamped.  The generated bitmaps also have a margin of `spread`
+   *   pixels on each side.  The value is an @FT_UInt between 2 and~32; the
+   *   default is~8.
+   *
+   * @note:
+   *   This property can be used with @FT_Property_Get also.
+   *
+   *   This property can be set via the `FREETYPE_PROPERTIES` environment
+   *   variable (using values 2 to~32).
+   *
+   *   Larger values make rendering slower, since more edges are within
+   *   reach of each pixel.
+   *
+   * @example:
+   *   ```
+   *     FT_Library  library;
+   *     FT_UInt     spread = 4;
+   *
+   *
+   *     FT_Init_FreeType( &library );
+   *
+   *     FT_Property_Set( library, "sdf", "spread", &spread );
+   *     FT_Property_Set( library, "bsdf", "spread", &spread );
+   *   ```
+   *
+   * @since:
+   *   2.10
+   *
+   */
+
+
  /* */
 
 
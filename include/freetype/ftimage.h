@@ -795,10 +795,17 @@ FT_BEGIN_HEADER
    *   FT_Raster
    *   FT_Span
    *   FT_SpanFunc
+   *   FT_Span_Line
+   *   FT_Span_Batch
+   *   FT_SpanBatchFunc
    *
    *   FT_Raster_Params
    *   FT_RASTER_FLAG_XXX
    *
+   *   FT_Raster_BandFunc
+   *   FT_Raster_ExecuteFunc
+   *   FT_Raster_Executor
+   *
    *   FT_Raster_NewFunc
    *   FT_Raster_DoneFunc
    *   FT_Raster_ResetFunc
@@ -896,6 +903,119 @@ FT_BEGIN_HEADER
 #define FT_Raster_Span_Func  FT_SpanFunc
 
 
+  /**************************************************************************
+   *
+   * @struct:
+   *   FT_Span_Line
+   *
+   * @description:
+   *   A structure describing the spans of one scanline within an
+   *   @FT_Span_Batch.
+   *
+   * @fields:
+   *   y ::
+   *     The scanline's y~coordinate.
+   *
+   *   count ::
+   *     The number of consecutive entries in the batch's `spans` array that
+   *     belong to this scanline.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct  FT_Span_Line_
+  {
+    int  y;
+    int  count;
+
+  } FT_Span_Line;
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FT_Span_Batch
+   *
+   * @description:
+   *   A run-length encoded list of gray spans covering many scanlines,
+   *   used with @FT_RASTER_FLAG_SPAN_BATCH.
+   *
+   * @fields:
+   *   lines ::
+   *     An array of `max_lines` scanline records.
+   *
+   *   num_lines ::
+   *     The number of valid entries in `lines`, in rendering order.
+   *
+   *   max_lines ::
+   *     The capacity of `lines`.
+   *
+   *   spans ::
+   *     An array of `max_spans` spans; the spans of `lines[0]` come first,
+   *     followed by the spans of `lines[1]`, etc.
+   *
+   *   num_spans ::
+   *     The number of valid entries in `spans`.
+   *
+   *   max_spans ::
+   *     The capacity of `spans`.
+   *
+   * @note:
+   *   Client applications that provide their own batch (in the
+   *   `span_batch` field of @FT_Raster_Params) must set up the `lines`,
+   *   `max_lines`, `spans`, and `max_spans` fields; the raster sets the
+   *   other fields before each call of the @FT_SpanBatchFunc callback.
+   *
+   *   Adjacent spans of a scanline with the same coverage are merged.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef struct  FT_Span_Batch_
+  {
+    FT_Span_Line*  lines;
+    int            num_lines;
+    int            max_lines;
+
+    FT_Span*       spans;
+    int            num_spans;
+    int            max_spans;
+
+  } FT_Span_Batch;
+
+
+  /**************************************************************************
+   *
+   * @functype:
+   *   FT_SpanBatchFunc
+   *
+   * @description:
+   *   A function used as a call-back by the anti-aliased renderer with
+   *   @FT_RASTER_FLAG_SPAN_BATCH, to let client applications draw the gray
+   *   spans of many scanlines at once.
+   *
+   * @input:
+   *   batch ::
+   *     The spans to draw.  It is only valid during the call.
+   *
+   *   user ::
+   *     User-supplied data that is passed to the callback.
+   *
+   * @note:
+   *   The callback is called once per outline if the batch is large
+   *   enough, and otherwise each time the batch is full.  A scanline is
+   *   only split across two calls if it has more than `max_spans` spans;
+   *   otherwise, each scanline appears in exactly one call, and every line
+   *   record has at least one span.
+   *
+   * @since:
+   *   2.10
+   */
+  typedef void
+  (*FT_SpanBatchFunc)( const FT_Span_Batch*  batch,
+                       void*                 user );
+
+
   /**************************************************************************
    *
    * @functype:
@@ -958,11 +1078,20 @@ FT_BEGIN_HEADER
    *     Note that by default, the glyph bitmap is clipped to the target
    *     pixmap, except in direct rendering mode where all spans are
    *     generated if no clipping box is set.
+   *
+   *   FT_RASTER_FLAG_SPAN_BATCH ::
+   *     This flag is only used in direct rendering mode.  If set, the
+   *     raster collects the spans of all scanlines in an @FT_Span_Batch and
+   *     calls the `batch_spans` callback instead of `gray_spans`, usually
+   *     only once per outline.  The `batch_spans` and `span_batch` fields
+   *     of @FT_Raster_Params are ignored if this flag is not set.  Since
+   *     2.10.
    */
-#define FT_RASTER_FLAG_DEFAULT  0x0
-#define FT_RASTER_FLAG_AA       0x1
-#define FT_RASTER_FLAG_DIRECT   0x2
-#define FT_RASTER_FLAG_CLIP     0x4
+#define FT_RASTER_FLAG_DEFAULT     0x0
+#define FT_RASTER_FLAG_AA          0x1
+#define FT_RASTER_FLAG_DIRECT      0x2
+#define FT_RASTER_FLAG_CLIP        0x4
+#define FT_RASTER_FLAG_SPAN_BATCH  0x8
 
   /* these constants are deprecated; use the corresponding */
   /* `FT_RASTER_FLAG_XXX` values instead                   */
@@ -1010,6 +1139,16 @@ FT_BEGIN_HEADER
    *     Note that coordinates here should be expressed in _integer_ pixels
    *     (and not in 26.6 fixed-point units).
    *
+   *   batch_spans ::
+   *     The span batch drawing callback, used instead of `gray_spans` if
+   *     @FT_RASTER_FLAG_SPAN_BATCH is set.
+   *
+   *   span_batch ::
+   *     An optional span batch provided by the client, used with
+   *     @FT_RASTER_FLAG_SPAN_BATCH; its capacity is fixed, so the raster
+   *     doesn't allocate anything.  If NULL, the raster uses a small
+   *     internal batch.
+   *
    * @note:
    *   An anti-aliased glyph bitmap is drawn if the @FT_RASTER_FLAG_AA bit
    *   flag is set in the `flags` field, otherwise a monochrome bitmap is
@@ -1032,10 +1171,112 @@ FT_BEGIN_HEADER
     FT_Raster_BitSet_Func   bit_set;      /* unused */
     void*                   user;
     FT_BBox                 clip_box;
+    FT_SpanBatchFunc        batch_spans;
+    FT_Span_Batch*          span_batch;
 
   } FT_Raster_Params;
 
 
+  /**************************************************************************
+   *
+   * @functype:
+   *   FT_Raster_BandFunc
+   *
+   * @description:
+   *   A function, provided by the raster, that renders one horizontal band
+   *   of the current outline.  See @FT_Raster_Executor.
+   *
+   * @input:
+   *   data ::
+   *     The `data` argument passed to the @FT_Raster_ExecuteFunc callback.
+   *
+   *   band ::
+   *     The band index, ranging from 0 to `num_bands`-1.
+   */
+  typedef void
+  (*FT_Raster_BandFunc)( void*  data,
+                         int    band );
+
+
+  /**************************************************************************
+   *
+   * @functype:
+   *   FT_Raster_ExecuteFunc
+   *
+   * @description:
+   *   A function, provided by client applications, that runs a batch of
+   *   band jobs, typically on a thread pool.  See @FT_Raster_Executor.
+   *
+   * @input:
+   *   pool ::
+   *     The `pool` field of the @FT_Raster_Executor structure.
+   *
+   *   num_bands ::
+   *     The number of jobs to run.
+   *
+   *   func ::
+   *     The job function.  It must be called exactly once for each value of
+   *     `band` in the range 0 to `num_bands`-1, in any order and from any
+   *     thread.
+   *
+   *   data ::
+   *     Opaque job data to be passed to `func`.
+   *
+   * @note:
+   *   The function must not return before all jobs are finished.
+   */
+  typedef void
+  (*FT_Raster_ExecuteFunc)( void*               pool,
+                            int                 num_bands,
+                            FT_Raster_BandFunc  func,
+                            void*               data );
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   FT_Raster_Executor
+   *
+   * @description:
+   *   A structure to let a raster split large outlines into horizontal
+   *   bands that are rendered in parallel.  The bands are independent and
+   *   each one writes to separate rows of the target bitmap; the result is
+   *   the same as with serial rendering.
+   *
+   * @fields:
+   *   execute ::
+   *     The function that runs the band jobs.  Set to NULL to render
+   *     serially, which is the default.
+   *
+   *   pool ::
+   *     User data passed to `execute`, typically a thread pool handle.
+   *
+   *   max_bands ::
+   *     The maximum number of bands an outline is split into, typically
+   *     the number of worker threads.  Values less than~2 disable parallel
+   *     rendering.
+   *
+   *   min_rows ::
+   *     Targets with fewer rows are rendered serially since the threading
+   *     overhead would outweigh the gains.  If zero, the raster selects a
+   *     default.
+   *
+   * @note:
+   *   The smooth and monochrome rasterizers support this structure, but
+   *   only if rendering into a bitmap (i.e., without
+   *   @FT_RASTER_FLAG_DIRECT).  It is set with the 'band-executor' property
+   *   of the 'smooth' and 'raster1' modules; see @FT_Property_Set.
+   */
+  typedef struct  FT_Raster_Executor_
+  {
+    FT_Raster_ExecuteFunc  execute;
+    void*                  pool;
+    int                    max_bands;
+    int                    min_rows;
+
+  } FT_Raster_Executor;
+
+
   /**************************************************************************
    *
    * @functype:
@@ -317,6 +317,59 @@ FT_BEGIN_HEADER
   FT_Library_SetLcdGeometry( FT_Library  library,
                              FT_Vector   sub[3] );
 
+
+  /**************************************************************************
+   *
+   * @function:
+   *   FT_Library_FilterLcdBitmap
+   *
+   * @description:
+   *   Apply the library's current LCD filter (as set with
+   *   @FT_Library_SetLcdFilter or @FT_Library_SetLcdFilterWeights) to a
+   *   range of rows of a bitmap owned by the client, for example, a tile
+   *   of a glyph atlas filled with unfiltered subpixel coverages.
+   *
+   * @input:
+   *   library ::
+   *     A handle to the library instance.
+   *
+   *   first_row ::
+   *     The index of the first row to filter, counting from the top.
+   *
+   *   num_rows ::
+   *     The number of rows to filter.
+   *
+   * @inout:
+   *   bitmap ::
+   *     The bitmap, which must have pixel mode @FT_PIXEL_MODE_LCD (for
+   *     horizontal filtering) or @FT_PIXEL_MODE_LCD_V (for vertical
+   *     filtering).  It is filtered in place.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   The rows are filtered as if they formed a bitmap on their own; this
+   *   only matters for @FT_PIXEL_MODE_LCD_V, where the range should cover
+   *   complete glyph images.  As a consequence, several threads can filter
+   *   disjoint row ranges of the same bitmap simultaneously, provided the
+   *   library's filter settings are not changed at the same time.
+   *
+   *   Nothing happens if the filter is @FT_LCD_FILTER_NONE.
+   *
+   *   This function returns `FT_Err_Unimplemented_Feature` if the
+   *   configuration macro `FT_CONFIG_OPTION_SUBPIXEL_RENDERING` is not
+   *   defined in your build of the library.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FT_Library_FilterLcdBitmap( FT_Library  library,
+                              FT_Bitmap*  bitmap,
+                              FT_UInt     first_row,
+                              FT_UInt     num_rows );
+
   /* */
 
 
@@ -66,6 +66,7 @@ FT_BEGIN_HEADER
    *   FT_Outline_Get_BBox
    *
    *   FT_Outline_Get_Bitmap
+   *   FT_Outline_Get_Bitmaps
    *   FT_Outline_Render
    *   FT_Outline_Decompose
    *   FT_Outline_Funcs
@@ -459,6 +460,63 @@ FT_BEGIN_HEADER
                          const FT_Bitmap  *abitmap );
 
 
+  /**************************************************************************
+   *
+   * @function:
+   *   FT_Outline_Get_Bitmaps
+   *
+   * @description:
+   *   Render a batch of outlines, each one within its own bitmap.  This is
+   *   the same as calling @FT_Outline_Get_Bitmap for each outline, but the
+   *   renderer is looked up only once per pixel mode.
+   *
+   * @input:
+   *   library ::
+   *     A handle to a FreeType library object.
+   *
+   *   num_outlines ::
+   *     The number of outlines to render.
+   *
+   *   outlines ::
+   *     An array of `num_outlines` pointers to source outline descriptors.
+   *
+   *   offsets ::
+   *     An array of `num_outlines` vectors (in 26.6 pixel format) by which
+   *     the outlines are translated before rendering.  Can be NULL.
+   *
+   *   bitmaps ::
+   *     An array of `num_outlines` target bitmap descriptors.
+   *
+   * @return:
+   *   FreeType error code.  0~means success.
+   *
+   * @note:
+   *   As with @FT_Outline_Get_Bitmap, the bitmaps are **not created** by
+   *   this function; you have to set up their fields and allocate (and
+   *   zero) their buffers.
+   *
+   *   To render into a glyph atlas, let the bitmap descriptors point to
+   *   sub-rectangles of the atlas: set `buffer` to the address of the
+   *   sub-rectangle's top-left pixel (or bottom-left for negative pitches),
+   *   `width` and `rows` to its size, and `pitch` to the atlas pitch.
+   *
+   *   The outlines get translated back after rendering; they are
+   *   unchanged on return.
+   *
+   *   Rendering stops at the first error.  All bitmaps before the failing
+   *   one have been rendered.
+   *
+   * @since:
+   *   2.10
+   */
+  FT_EXPORT( FT_Error )
+  FT_Outline_Get_Bitmaps( FT_Library          library,
+                          FT_UInt             num_outlines,
+                          FT_Outline* const*  outlines,
+                          const FT_Vector*    offsets,
+                          const FT_Bitmap*    bitmaps );
+
+
   /**************************************************************************
    *
    * @function:
@@ -1402,6 +1402,23 @@ FT_BEGIN_HEADER
    *     A pointer to the TrueType bytecode interpreters field is also used
    *     to hook the debugger in 'ttdebug'.
    *
+   *   program_cache ::
+   *     The definitions made by the font program and recent results of the
+   *     cvt program, shared by all sizes of the face.  Managed by the
+   *     TrueType driver.
+   *
+   *   glyph_cache ::
+   *     Recently loaded hinted glyphs.  Managed by the TrueType driver.
+   *
+   *   verifier ::
+   *     The hinting cost estimates and the verdicts on the glyph programs
+   *     of the face.  Managed by the TrueType driver.
+   *
+   *   bytecode_profile ::
+   *     Statistics collected by the bytecode interpreter if
+   *     `TT_CONFIG_OPTION_BYTECODE_PROFILE` is defined.  Managed by the
+   *     TrueType driver.
+   *
    *   extra ::
    *     Reserved for third-party font drivers.
    *
@@ -1639,6 +1656,22 @@ FT_BEGIN_HEADER
     /* used to hook the debugger for the `ttdebug' utility.        */
     TT_Interpreter        interpreter;
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+    /* results of the font and cvt programs shared by all sizes */
+    void*                 program_cache;
+
+    /* hinted glyphs, if the `glyph-cache-size' property is set */
+    void*                 glyph_cache;
+
+    /* results of the static verifier, if `hinting-cost-limit' is set */
+    void*                 verifier;
+
+#ifdef TT_CONFIG_OPTION_BYTECODE_PROFILE
+    /* statistics of the bytecode interpreter */
+    void*                 bytecode_profile;
+#endif
+#endif
+
 
     /************************************************************************
      *
@@ -892,14 +892,18 @@
         /* check the size of the `fpgm' and `prep' tables, too --    */
         /* the assumption is that there don't exist real TTFs where  */
         /* both `fpgm' and `prep' tables are missing                 */
+        /*                                                           */
+        /* the TrueType driver removes FT_FACE_FLAG_HINTER from      */
+        /* faces whose bytecode it doesn't want to run               */
         if ( ( mode == FT_RENDER_MODE_LIGHT           &&
                ( !FT_DRIVER_HINTS_LIGHTLY( driver ) &&
-                 !is_light_type1                    ) )         ||
-             ( FT_IS_SFNT( face )                             &&
-               ttface->num_locations                          &&
-               ttface->max_profile.maxSizeOfInstructions == 0 &&
-               ttface->font_program_size == 0                 &&
-               ttface->cvt_program_size == 0                  ) )
+                 !is_light_type1                    ) )           ||
+             ( FT_IS_SFNT( face )                               &&
+               ttface->num_locations                            &&
+               ( !( face->face_flags & FT_FACE_FLAG_HINTER )  ||
+                 ( ttface->max_profile.maxSizeOfInstructions == 0 &&
+                   ttface->font_program_size == 0                 &&
+                   ttface->cvt_program_size == 0                  ) ) ) )
           autohint = TRUE;
       }
     }
@@ -4392,17 +4396,17 @@
       render->glyph_format = clazz->glyph_format;
 
       /* allocate raster object if needed */
-      if ( clazz->glyph_format == FT_GLYPH_FORMAT_OUTLINE &&
-           clazz->raster_class->raster_new                )
+      if ( clazz->raster_class && clazz->raster_class->raster_new )
       {
         error = clazz->raster_class->raster_new( memory, &render->raster );
         if ( error )
           goto Fail;
 
         render->raster_render = clazz->raster_class->raster_render;
-        render->render        = clazz->render_glyph;
       }
 
+      render->render = clazz->render_glyph;
+
       /* add to list */
       node->data = module;
       FT_List_Add( &library->renderers, node );
@@ -4440,8 +4444,7 @@
 
 
       /* release raster object, if any */
-      if ( render->clazz->glyph_format == FT_GLYPH_FORMAT_OUTLINE &&
-           render->raster                                         )
+      if ( render->raster )
         render->clazz->raster_class->raster_done( render->raster );
 
       /* remove from list */
@@ -4537,10 +4540,15 @@
     switch ( slot->format )
     {
     case FT_GLYPH_FORMAT_BITMAP:   /* already a bitmap, don't do anything */
-      break;
+      if ( render_mode != FT_RENDER_MODE_SDF )
+        break;
+
+      /* ... except for converting it into a distance field */
+      /* fall through */
 
     default:
-      if ( slot->internal->load_flags & FT_LOAD_COLOR )
+      if ( slot->format != FT_GLYPH_FORMAT_BITMAP           &&
+           ( slot->internal->load_flags & FT_LOAD_COLOR ) )
       {
         FT_LayerIterator  iterator;
 
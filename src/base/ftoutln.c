@@ -591,35 +591,26 @@
 
   /* documentation is in ftoutln.h */
 
-  FT_EXPORT_DEF( FT_Error )
-  FT_Outline_Render( FT_Library         library,
-                     FT_Outline*        outline,
-                     FT_Raster_Params*  params )
+  /* Render `params->source' with the first renderer that supports     */
+  /* `params'; `*arenderer' is tried first and set to the renderer used. */
+  static FT_Error
+  ft_outline_render( FT_Library         library,
+                     FT_Raster_Params*  params,
+                     FT_Renderer*       arenderer )
   {
     FT_Error     error;
-    FT_Renderer  renderer;
-    FT_ListNode  node;
-    FT_BBox      cbox;
-
+    FT_Renderer  renderer = *arenderer;
+    FT_ListNode  node     = library->renderers.head;
 
-    if ( !library )
-      return FT_THROW( Invalid_Library_Handle );
-
-    if ( !outline )
-      return FT_THROW( Invalid_Outline );
 
-    if ( !params )
-      return FT_THROW( Invalid_Argument );
-
-    FT_Outline_Get_CBox( outline, &cbox );
-    if ( cbox.xMin < -0x1000000L || cbox.yMin < -0x1000000L ||
-         cbox.xMax >  0x1000000L || cbox.yMax >  0x1000000L )
-      return FT_THROW( Invalid_Outline );
+    if ( renderer )
+    {
+      error = renderer->raster_render( renderer->raster, params );
+      if ( !error || FT_ERR_NEQ( error, Cannot_Render_Glyph ) )
+        return error;
+    }
 
     renderer = library->cur_renderer;
-    node     = library->renderers.head;
-
-    params->source = (void*)outline;
 
     error = FT_ERR( Cannot_Render_Glyph );
     while ( renderer )
@@ -638,10 +629,46 @@
                                      &node );
     }
 
+    if ( !error )
+      *arenderer = renderer;
+
     return error;
   }
 
 
+  FT_EXPORT_DEF( FT_Error )
+  FT_Outline_Render( FT_Library         library,
+                     FT_Outline*        outline,
+                     FT_Raster_Params*  params )
+  {
+    FT_Renderer  renderer = NULL;
+    FT_BBox      cbox;
+
+
+    if ( !library )
+      return FT_THROW( Invalid_Library_Handle );
+
+    if ( !outline )
+      return FT_THROW( Invalid_Outline );
+
+    if ( !params )
+      return FT_THROW( Invalid_Argument );
+
+    FT_Outline_Get_CBox( outline, &cbox );
+    if ( cbox.xMin < -0x1000000L || cbox.yMin < -0x1000000L ||
+         cbox.xMax >  0x1000000L || cbox.yMax >  0x1000000L )
+      return FT_THROW( Invalid_Outline );
+
+    params->source = (void*)outline;
+
+    /* flags above 0xFFFF are reserved for the communication between */
+    /* a renderer and its raster; they imply larger parameter blocks */
+    params->flags &= 0xFFFF;
+
+    return ft_outline_render( library, params, &renderer );
+  }
+
+
   /* documentation is in ftoutln.h */
 
   FT_EXPORT_DEF( FT_Error )
@@ -669,6 +696,78 @@
   }
 
 
+  /* documentation is in ftoutln.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FT_Outline_Get_Bitmaps( FT_Library          library,
+                          FT_UInt             num_outlines,
+                          FT_Outline* const*  outlines,
+                          const FT_Vector*    offsets,
+                          const FT_Bitmap*    bitmaps )
+  {
+    FT_Error          error       = FT_Err_Ok;
+    FT_Renderer       renderer[2] = { NULL, NULL };  /* mono, gray */
+    FT_Raster_Params  params;
+    FT_UInt           n;
+
+
+    if ( !library )
+      return FT_THROW( Invalid_Library_Handle );
+
+    if ( !num_outlines )
+      return FT_Err_Ok;
+
+    if ( !outlines || !bitmaps )
+      return FT_THROW( Invalid_Argument );
+
+    FT_ZERO( &params );
+
+    for ( n = 0; n < num_outlines; n++ )
+    {
+      FT_Outline*       outline = outlines[n];
+      const FT_Bitmap*  bitmap  = bitmaps + n;
+      FT_Pos            dx      = offsets ? offsets[n].x : 0;
+      FT_Pos            dy      = offsets ? offsets[n].y : 0;
+      FT_Int            aa;
+      FT_BBox           cbox;
+
+
+      if ( !outline )
+      {
+        error = FT_THROW( Invalid_Outline );
+        break;
+      }
+
+      aa = bitmap->pixel_mode == FT_PIXEL_MODE_GRAY  ||
+           bitmap->pixel_mode == FT_PIXEL_MODE_LCD   ||
+           bitmap->pixel_mode == FT_PIXEL_MODE_LCD_V;
+
+      params.target = bitmap;
+      params.source = (void*)outline;
+      params.flags  = aa ? FT_RASTER_FLAG_AA : 0;
+
+      if ( dx || dy )
+        FT_Outline_Translate( outline, dx, dy );
+
+      /* the same range check as in `FT_Outline_Render' */
+      FT_Outline_Get_CBox( outline, &cbox );
+      if ( cbox.xMin < -0x1000000L || cbox.yMin < -0x1000000L ||
+           cbox.xMax >  0x1000000L || cbox.yMax >  0x1000000L )
+        error = FT_THROW( Invalid_Outline );
+      else
+        error = ft_outline_render( library, &params, &renderer[aa] );
+
+      if ( dx || dy )
+        FT_Outline_Translate( outline, -dx, -dy );
+
+      if ( error )
+        break;
+    }
+
+    return error;
+  }
+
+
   /* documentation is in freetype.h */
 
   FT_EXPORT_DEF( void )
@@ -19,6 +19,7 @@
 #define FT_MAKE_OPTION_SINGLE_OBJECT
 #include <ft2build.h>
 
+#include "ftcatlas.c"
 #include "ftcbasic.c"
 #include "ftccache.c"
 #include "ftccmap.c"
@@ -26,7 +27,10 @@
 #include "ftcimage.c"
 #include "ftcmanag.c"
 #include "ftcmru.c"
+#include "ftcphase.c"
 #include "ftcsbits.c"
+#include "ftcslab.c"
+#include "ftcstore.c"
 
 
 /* END */
@@ -0,0 +1,862 @@
+/****************************************************************************
+ *
+ * ftcatlas.c
+ *
+ *   A glyph atlas cache (body).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#include <ft2build.h>
+#include FT_CACHE_H
+#include "ftcatlas.h"
+#include FT_INTERNAL_OBJECTS_H
+#include FT_INTERNAL_DEBUG_H
+#include FT_ERRORS_H
+
+#include "ftccback.h"
+#include "ftcerror.h"
+
+#undef  FT_COMPONENT
+#define FT_COMPONENT  cache
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                      SKYLINE PACKER                           *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  static void
+  ftc_skyline_reset( FTC_APage  page,
+                     FT_UInt    page_width )
+  {
+    page->skyline[0].x     = 0;
+    page->skyline[0].y     = 0;
+    page->skyline[0].width = (FT_UShort)page_width;
+    page->num_skyline      = 1;
+  }
+
+
+  /* Return the lowest y coordinate at which a rectangle fits if its */
+  /* left edge is at skyline segment `index', or -1 if it doesn't.   */
+  static FT_Long
+  ftc_skyline_fit( FTC_APage  page,
+                   FT_UInt    index,
+                   FT_UInt    width,
+                   FT_UInt    height,
+                   FT_UInt    page_width,
+                   FT_UInt    page_height )
+  {
+    FTC_ASkyline  seg  = page->skyline + index;
+    FT_UInt       left = width;
+    FT_UInt       y    = 0;
+
+
+    if ( seg->x + width > page_width )
+      return -1;
+
+    /* the segments cover the page width, so we can't run off the end */
+    for (;;)
+    {
+      if ( seg->y > y )
+        y = seg->y;
+
+      if ( y + height > page_height )
+        return -1;
+
+      if ( seg->width >= left )
+        break;
+
+      left -= seg->width;
+      seg++;
+    }
+
+    return (FT_Long)y;
+  }
+
+
+  /* merge neighbouring segments of the same height */
+  static void
+  ftc_skyline_merge( FTC_APage  page )
+  {
+    FTC_ASkyline  sky   = page->skyline;
+    FT_UInt       count = page->num_skyline;
+    FT_UInt       nn    = 0;
+
+
+    while ( nn + 1 < count )
+    {
+      if ( sky[nn].y == sky[nn + 1].y )
+      {
+        sky[nn].width = (FT_UShort)( sky[nn].width + sky[nn + 1].width );
+
+        FT_MEM_MOVE( sky + nn + 1, sky + nn + 2,
+                     ( count - nn - 2 ) * sizeof ( *sky ) );
+        count--;
+      }
+      else
+        nn++;
+    }
+
+    page->num_skyline = count;
+  }
+
+
+  /* raise the skyline over a new rectangle placed at segment `index' */
+  static void
+  ftc_skyline_add( FTC_APage  page,
+                   FT_UInt    index,
+                   FT_UInt    top,
+                   FT_UInt    width )
+  {
+    FTC_ASkyline  sky   = page->skyline;
+    FT_UInt       count = page->num_skyline;
+    FT_UInt       nn;
+
+
+    /* there is room for one more segment than the page width */
+    FT_MEM_MOVE( sky + index + 1, sky + index,
+                 ( count - index ) * sizeof ( *sky ) );
+
+    sky[index].y     = (FT_UShort)top;
+    sky[index].width = (FT_UShort)width;
+    count++;
+
+    /* shrink or remove the segments below the new one */
+    nn = index + 1;
+    while ( nn < count )
+    {
+      FT_UInt  end = (FT_UInt)sky[nn - 1].x + sky[nn - 1].width;
+
+
+      if ( sky[nn].x >= end )
+        break;
+
+      if ( sky[nn].x + sky[nn].width > end )
+      {
+        sky[nn].width = (FT_UShort)( sky[nn].x + sky[nn].width - end );
+        sky[nn].x     = (FT_UShort)end;
+        break;
+      }
+
+      FT_MEM_MOVE( sky + nn, sky + nn + 1,
+                   ( count - nn - 1 ) * sizeof ( *sky ) );
+      count--;
+    }
+
+    page->num_skyline = count;
+    ftc_skyline_merge( page );
+  }
+
+
+  /* raise the skyline to at least `top' between `x' and `x + width' */
+  static void
+  ftc_skyline_raise( FTC_APage  page,
+                     FT_UInt    x,
+                     FT_UInt    width,
+                     FT_UInt    top )
+  {
+    FTC_ASkyline  sky   = page->skyline;
+    FT_UInt       count = page->num_skyline;
+    FT_UInt       end   = x + width;
+    FT_UInt       nn;
+
+
+    for ( nn = 0; nn < count; nn++ )
+    {
+      FT_UInt  seg_x   = sky[nn].x;
+      FT_UInt  seg_end = seg_x + sky[nn].width;
+
+
+      if ( seg_x >= end )
+        break;
+
+      if ( seg_end <= x || sky[nn].y >= top )
+        continue;
+
+      /* split off the parts outside of the range; since all segments */
+      /* are at least one pixel wide, there is always room for them    */
+      if ( seg_x < x || seg_end > end )
+      {
+        FT_UInt  split = seg_x < x ? x : end;
+
+
+        FT_MEM_MOVE( sky + nn + 1, sky + nn,
+                     ( count - nn ) * sizeof ( *sky ) );
+        count++;
+
+        sky[nn].width     = (FT_UShort)( split - seg_x );
+        sky[nn + 1].x     = (FT_UShort)split;
+        sky[nn + 1].width = (FT_UShort)( seg_end - split );
+
+        if ( seg_x < x )
+          continue;
+      }
+
+      sky[nn].y = (FT_UShort)top;
+    }
+
+    page->num_skyline = count;
+    ftc_skyline_merge( page );
+  }
+
+
+  /* Find the bottom-left position for a rectangle in a page; */
+  /* return FALSE (and zero outputs) if there is none.        */
+  static FT_Bool
+  ftc_skyline_find( FTC_APage  page,
+                    FT_UInt    width,
+                    FT_UInt    height,
+                    FT_UInt    page_width,
+                    FT_UInt    page_height,
+                    FT_UInt   *aindex,
+                    FT_UInt   *ay )
+  {
+    FT_UInt  best_index = 0;
+    FT_UInt  best_top   = page_height + 1;
+    FT_UInt  nn;
+
+
+    for ( nn = 0; nn < page->num_skyline; nn++ )
+    {
+      FT_Long  y = ftc_skyline_fit( page, nn, width, height,
+                                    page_width, page_height );
+
+
+      if ( y >= 0 && (FT_UInt)y + height < best_top )
+      {
+        best_index = nn;
+        best_top   = (FT_UInt)y + height;
+      }
+    }
+
+    if ( best_top > page_height )
+    {
+      *aindex = 0;
+      *ay     = 0;
+      return FALSE;
+    }
+
+    *aindex = best_index;
+    *ay     = best_top - height;
+    return TRUE;
+  }
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                         ATLAS PAGES                           *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  /* the memory of a page, charged to the cache's `extra_weight' */
+  static FT_Offset
+  ftc_apage_weight( FTC_ACache  acache )
+  {
+    return (FT_Offset)acache->page_width * acache->page_height *
+             acache->bytes_per_pixel                               +
+           ( acache->page_width + 1 ) * sizeof ( FTC_ASkylineRec );
+  }
+
+
+  static FT_Error
+  ftc_apage_open( FTC_ACache  acache,
+                  FTC_APage   page )
+  {
+    FTC_Cache  cache  = FTC_CACHE( acache );
+    FT_Memory  memory = cache->memory;
+    FT_Offset  weight = ftc_apage_weight( acache );
+    FT_Error   error;
+
+
+    if ( FT_QALLOC( page->buffer,
+                    (FT_ULong)acache->page_width * acache->page_height *
+                      acache->bytes_per_pixel )                          ||
+         FT_QNEW_ARRAY( page->skyline, acache->page_width + 1 )       )
+    {
+      FT_FREE( page->buffer );
+      return error;
+    }
+
+    ftc_skyline_reset( page, acache->page_width );
+    page->dirty.width  = 0;
+    page->dirty.height = 0;
+
+    cache->extra_weight        += weight;
+    cache->manager->cur_weight += weight;
+
+    return FT_Err_Ok;
+  }
+
+
+  static void
+  ftc_apage_close( FTC_ACache  acache,
+                   FTC_APage   page )
+  {
+    FTC_Cache  cache  = FTC_CACHE( acache );
+    FT_Memory  memory = cache->memory;
+    FT_Offset  weight = ftc_apage_weight( acache );
+
+
+    FT_FREE( page->buffer );
+    FT_FREE( page->skyline );
+    page->num_skyline = 0;
+
+    cache->extra_weight        -= weight;
+    cache->manager->cur_weight -= weight;
+  }
+
+
+  static void
+  ftc_apage_mark_dirty( FTC_APage  page,
+                        FT_UInt    x,
+                        FT_UInt    y,
+                        FT_UInt    width,
+                        FT_UInt    height )
+  {
+    FTC_AtlasRect  dirty = &page->dirty;
+
+
+    if ( !dirty->width )
+    {
+      dirty->x      = x;
+      dirty->y      = y;
+      dirty->width  = width;
+      dirty->height = height;
+    }
+    else
+    {
+      FT_UInt  x_max = FT_MAX( dirty->x + dirty->width, x + width );
+      FT_UInt  y_max = FT_MAX( dirty->y + dirty->height, y + height );
+
+
+      dirty->x      = FT_MIN( dirty->x, x );
+      dirty->y      = FT_MIN( dirty->y, y );
+      dirty->width  = x_max - dirty->x;
+      dirty->height = y_max - dirty->y;
+    }
+  }
+
+
+  /* Copy a glyph bitmap into a page cell of `width' x `height' pixels, */
+  /* clearing the padding.  The bitmap's format has been checked.       */
+  static void
+  ftc_apage_copy( FTC_ACache  acache,
+                  FTC_APage   page,
+                  FT_UInt     x,
+                  FT_UInt     y,
+                  FT_UInt     width,
+                  FT_UInt     height,
+                  FT_Bitmap*  bitmap )
+  {
+    FT_UInt   bpp       = acache->bytes_per_pixel;
+    FT_UInt   pitch     = acache->page_width * bpp;
+    FT_Byte*  line      = page->buffer + y * pitch + x * bpp;
+    FT_Int    src_pitch = bitmap->pitch;
+    FT_Byte*  src       = bitmap->buffer;
+    FT_UInt   row;
+
+
+    /* the first row of a bitmap with negative pitch is the last in memory */
+    if ( src_pitch < 0 )
+      src -= (FT_Long)src_pitch * (FT_Long)( bitmap->rows - 1 );
+
+    for ( row = 0; row < height; row++, line += pitch, src += src_pitch )
+    {
+      FT_UInt  i;
+
+
+      FT_MEM_ZERO( line, width * bpp );
+
+      if ( row >= bitmap->rows )
+        continue;
+
+      switch ( bitmap->pixel_mode )
+      {
+      case FT_PIXEL_MODE_MONO:
+        for ( i = 0; i < bitmap->width; i++ )
+          if ( src[i >> 3] & ( 0x80 >> ( i & 7 ) ) )
+            FT_MEM_SET( line + i * bpp, 0xFF, bpp );
+        break;
+
+      case FT_PIXEL_MODE_GRAY:
+        if ( bpp == 1 )
+          FT_MEM_COPY( line, src, bitmap->width );
+        else
+          for ( i = 0; i < bitmap->width; i++ )
+            FT_MEM_SET( line + i * bpp, src[i], bpp );
+        break;
+
+      default:  /* FT_PIXEL_MODE_LCD */
+        FT_MEM_COPY( line, src, bitmap->width );
+      }
+    }
+
+    ftc_apage_mark_dirty( page, x, y, width, height );
+  }
+
+
+  /*
+   * Evict the unreferenced nodes of a page through the cache manager, so
+   * that they show up in the statistics.  The page stays allocated; it is
+   * reset when the last node goes, otherwise the skyline is rebuilt over
+   * the remaining nodes, freeing the space above them.
+   */
+  static void
+  ftc_apage_evict( FTC_APage  page,
+                   FTC_Cache  cache )
+  {
+    FTC_ACache  acache = FTC_ACACHE( cache );
+    FTC_ANode   anode  = page->nodes;
+    FTC_ANode   next;
+
+
+    acache->evicting = page;
+
+    for ( ; anode; anode = next )
+    {
+      next = anode->next;
+
+      if ( FTC_NODE( anode )->ref_count == 0 )
+        FTC_Manager_EvictNode( cache->manager, FTC_NODE( anode ) );
+    }
+
+    acache->evicting = NULL;
+
+    if ( !page->num_nodes )
+      return;
+
+    ftc_skyline_reset( page, FTC_ACACHE( cache )->page_width );
+
+    for ( anode = page->nodes; anode; anode = anode->next )
+      ftc_skyline_raise( page,
+                         anode->glyph.x,
+                         anode->glyph.width + FTC_ATLAS_PADDING,
+                         (FT_UInt)anode->glyph.y + anode->glyph.height +
+                           FTC_ATLAS_PADDING );
+  }
+
+
+  /*
+   * Find room for a cell of `width' x `height' pixels, allocating a page
+   * if necessary.  If all pages are in use, their unreferenced nodes are
+   * evicted in LRU order of the pages until the cell fits.  If it still
+   * doesn't, all pages are filled with locked glyphs; flushing other
+   * caches wouldn't help, so we return `Raster_Overflow' instead of an
+   * out-of-memory error.
+   */
+  static FT_Error
+  ftc_acache_alloc( FTC_ACache  acache,
+                    FT_UInt     width,
+                    FT_UInt     height,
+                    FTC_APage  *apage,
+                    FT_UInt    *ax,
+                    FT_UInt    *ay )
+  {
+    FTC_Cache  cache  = FTC_CACHE( acache );
+    FT_Memory  memory = cache->memory;
+    FT_Error   error  = FT_Err_Ok;
+    FTC_APage  page   = NULL;
+    FTC_APage  empty  = NULL;
+    FT_ULong   last   = 0;
+    FT_UInt    index  = 0;
+    FT_UInt    y      = 0;
+    FT_UInt    nn;
+
+
+    if ( !acache->pages &&
+         FT_NEW_ARRAY( acache->pages, acache->max_pages ) )
+      goto Exit;
+
+    /* try the pages in use first */
+    for ( nn = 0; nn < acache->max_pages; nn++ )
+    {
+      page = acache->pages + nn;
+
+      if ( !page->buffer )
+      {
+        if ( !empty )
+          empty = page;
+        continue;
+      }
+
+      if ( ftc_skyline_find( page, width, height,
+                             acache->page_width, acache->page_height,
+                             &index, &y ) )
+        goto Found;
+    }
+
+    if ( empty )
+    {
+      /* set up a new page */
+      page  = empty;
+      error = ftc_apage_open( acache, page );
+      if ( error )
+        goto Exit;
+
+      if ( ftc_skyline_find( page, width, height,
+                             acache->page_width, acache->page_height,
+                             &index, &y ) )
+        goto Found;
+    }
+    else
+    {
+      /* evict pages in LRU order; their stamps are distinct */
+      for (;;)
+      {
+        FTC_APage  victim = NULL;
+
+
+        for ( nn = 0; nn < acache->max_pages; nn++ )
+        {
+          page = acache->pages + nn;
+
+          if ( page->stamp >= last                         &&
+               ( !victim || page->stamp < victim->stamp ) )
+            victim = page;
+        }
+
+        if ( !victim )
+          break;
+
+        page = victim;
+        last = page->stamp + 1;
+
+        ftc_apage_evict( page, cache );
+
+        if ( ftc_skyline_find( page, width, height,
+                               acache->page_width, acache->page_height,
+                               &index, &y ) )
+          goto Found;
+      }
+    }
+
+    FT_TRACE2(( "ftc_acache_alloc: all atlas pages are locked\n" ));
+    error = FT_THROW( Raster_Overflow );
+    goto Exit;
+
+  Found:
+    *apage = page;
+    *ax    = page->skyline[index].x;
+    *ay    = y;
+
+    ftc_skyline_add( page, index, y + height, width );
+
+  Exit:
+    return error;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_ACache_GetPage( FTC_ACache     acache,
+                      FT_UInt        page_index,
+                      FT_Bitmap     *abitmap,
+                      FTC_AtlasRect  adirty )
+  {
+    FTC_APage  page;
+
+
+    if ( page_index >= acache->max_pages )
+      return FT_THROW( Invalid_Argument );
+
+    FT_ZERO( abitmap );
+    if ( adirty )
+      FT_ZERO( adirty );
+
+    if ( !acache->pages || !acache->pages[page_index].buffer )
+      return FT_Err_Ok;
+
+    page = acache->pages + page_index;
+
+    abitmap->rows       = acache->page_height;
+    abitmap->width      = acache->page_width * acache->bytes_per_pixel;
+    abitmap->pitch      = (int)abitmap->width;
+    abitmap->buffer     = page->buffer;
+    abitmap->num_grays  = 256;
+    abitmap->pixel_mode = (unsigned char)acache->pixel_mode;
+
+    if ( adirty )
+      *adirty = page->dirty;
+
+    page->dirty.width  = 0;
+    page->dirty.height = 0;
+
+    return FT_Err_Ok;
+  }
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                      ATLAS CACHE NODES                        *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  FT_LOCAL_DEF( void )
+  ftc_anode_free( FTC_Node   ftcanode,
+                  FTC_Cache  cache )
+  {
+    FTC_ANode  anode = (FTC_ANode)ftcanode;
+    FTC_APage  page  = anode->page;
+
+
+    if ( page )
+    {
+      if ( anode->prev )
+        anode->prev->next = anode->next;
+      else
+        page->nodes = anode->next;
+
+      if ( anode->next )
+        anode->next->prev = anode->prev;
+
+      /* an empty page gives back its memory, unless we are about */
+      /* to fill it again                                         */
+      if ( --page->num_nodes == 0 )
+      {
+        if ( page == FTC_ACACHE( cache )->evicting )
+          ftc_skyline_reset( page, FTC_ACACHE( cache )->page_width );
+        else
+          ftc_apage_close( FTC_ACACHE( cache ), page );
+      }
+    }
+
+    FTC_GNode_Done( FTC_GNODE( anode ), cache );
+
+    FTC_SLAB_FREE( &cache->manager->slabs, anode, sizeof ( *anode ) );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_ANode_Free( FTC_ANode  anode,
+                  FTC_Cache  cache )
+  {
+    ftc_anode_free( FTC_NODE( anode ), cache );
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_ANode_New( FTC_ANode  *panode,
+                 FTC_GQuery  gquery,
+                 FTC_Cache   cache )
+  {
+    FT_Error          error;
+    FTC_ACache        acache = FTC_ACACHE( cache );
+    FTC_ANode         anode  = NULL;
+    FTC_SFamilyClass  clazz  = FTC_CACHE_SFAMILY_CLASS( cache );
+    FT_Face           face;
+
+
+    if ( FTC_SLAB_NEW( &cache->manager->slabs, anode ) )
+      goto Exit;
+
+    FTC_GNode_Init( FTC_GNODE( anode ), gquery->gindex, gquery->family );
+
+    error = clazz->family_load_glyph( gquery->family, gquery->gindex,
+                                      cache->manager, &face );
+    if ( error )
+      goto Fail;
+
+    {
+      FTC_AtlasGlyph  glyph  = &anode->glyph;
+      FT_GlyphSlot    slot   = face->glyph;
+      FT_Bitmap*      bitmap = &slot->bitmap;
+      FT_UInt         width  = bitmap->width;
+      FTC_APage       page   = NULL;
+      FT_UInt         x      = 0;
+      FT_UInt         y      = 0;
+
+
+      if ( slot->format != FT_GLYPH_FORMAT_BITMAP )
+      {
+        error = FT_THROW( Invalid_Glyph_Format );
+        goto Fail;
+      }
+
+      glyph->left     = (FT_Short)slot->bitmap_left;
+      glyph->top      = (FT_Short)slot->bitmap_top;
+      glyph->xadvance = (FT_Short)( ( slot->advance.x + 32 ) >> 6 );
+      glyph->yadvance = (FT_Short)( ( slot->advance.y + 32 ) >> 6 );
+
+      switch ( bitmap->pixel_mode )
+      {
+      case FT_PIXEL_MODE_MONO:
+      case FT_PIXEL_MODE_GRAY:
+        break;
+
+      case FT_PIXEL_MODE_LCD:
+        if ( acache->pixel_mode == FT_PIXEL_MODE_LCD )
+        {
+          width /= 3;
+          break;
+        }
+        /* fall through */
+
+      default:
+        FT_TRACE2(( "FTC_ANode_New:"
+                    " unsupported pixel mode %d\n", bitmap->pixel_mode ));
+        goto Exit;
+      }
+
+      /* empty glyphs don't need room in a page */
+      if ( !width || !bitmap->rows )
+        goto Exit;
+
+      if ( width + FTC_ATLAS_PADDING > acache->page_width         ||
+           bitmap->rows + FTC_ATLAS_PADDING > acache->page_height )
+      {
+        FT_TRACE2(( "FTC_ANode_New: glyph too large for atlas page\n" ));
+        goto Exit;
+      }
+
+      error = ftc_acache_alloc( acache,
+                                width + FTC_ATLAS_PADDING,
+                                bitmap->rows + FTC_ATLAS_PADDING,
+                                &page, &x, &y );
+      if ( error )
+        goto Fail;
+
+      ftc_apage_copy( acache, page, x, y,
+                      width + FTC_ATLAS_PADDING,
+                      bitmap->rows + FTC_ATLAS_PADDING,
+                      bitmap );
+
+      glyph->page   = (FT_UInt)( page - acache->pages );
+      glyph->x      = (FT_UShort)x;
+      glyph->y      = (FT_UShort)y;
+      glyph->width  = (FT_UShort)width;
+      glyph->height = (FT_UShort)bitmap->rows;
+
+      anode->page = page;
+      anode->next = page->nodes;
+      if ( page->nodes )
+        page->nodes->prev = anode;
+      page->nodes = anode;
+      page->num_nodes++;
+      page->stamp = ++acache->stamp;
+    }
+
+  Exit:
+    *panode = anode;
+    return error;
+
+  Fail:
+    FTC_ANode_Free( anode, cache );
+    anode = NULL;
+    goto Exit;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  ftc_anode_new( FTC_Node   *ftcpanode,
+                 FT_Pointer  ftcgquery,
+                 FTC_Cache   cache )
+  {
+    FTC_ANode  *panode = (FTC_ANode*)ftcpanode;
+    FTC_GQuery  gquery = (FTC_GQuery)ftcgquery;
+
+
+    return FTC_ANode_New( panode, gquery, cache );
+  }
+
+
+  FT_LOCAL_DEF( FT_Offset )
+  ftc_anode_weight( FTC_Node   ftcanode,
+                    FTC_Cache  cache )
+  {
+    FT_UNUSED( ftcanode );
+    FT_UNUSED( cache );
+
+    /* the pages are charged to the cache's `extra_weight' */
+    return FTC_SLAB_ROUND_SIZE( sizeof ( FTC_ANodeRec ) );
+  }
+
+
+  FT_LOCAL_DEF( FT_Bool )
+  ftc_anode_compare( FTC_Node    ftcanode,
+                     FT_Pointer  ftcgquery,
+                     FTC_Cache   cache,
+                     FT_Bool*    list_changed )
+  {
+    FTC_ANode   anode  = (FTC_ANode)ftcanode;
+    FTC_GQuery  gquery = (FTC_GQuery)ftcgquery;
+    FTC_GNode   gnode  = FTC_GNODE( anode );
+    FT_Bool     result;
+
+
+    if ( list_changed )
+      *list_changed = FALSE;
+
+    result = FT_BOOL( gnode->family == gquery->family &&
+                      gnode->gindex == gquery->gindex );
+
+    /* pages are evicted in LRU order */
+    if ( result && anode->page )
+      anode->page->stamp = ++FTC_ACACHE( cache )->stamp;
+
+    return result;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  ftc_acache_init( FTC_Cache  cache )
+  {
+    FTC_ACache  acache = FTC_ACACHE( cache );
+
+
+    acache->pixel_mode      = FT_PIXEL_MODE_GRAY;
+    acache->bytes_per_pixel = 1;
+    acache->page_width      = 0;
+    acache->page_height     = 0;
+    acache->max_pages       = 0;
+    acache->pages           = NULL;
+    acache->stamp           = 0;
+    acache->evicting        = NULL;
+
+    return ftc_gcache_init( cache );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  ftc_acache_done( FTC_Cache  cache )
+  {
+    FTC_ACache  acache = FTC_ACACHE( cache );
+    FT_Memory   memory = cache->memory;
+    FT_UInt     nn;
+
+
+    /* the nodes refer to the pages */
+    ftc_gcache_done( cache );
+
+    if ( acache->pages )
+    {
+      for ( nn = 0; nn < acache->max_pages; nn++ )
+      {
+        FT_FREE( acache->pages[nn].buffer );
+        FT_FREE( acache->pages[nn].skyline );
+      }
+
+      FT_FREE( acache->pages );
+    }
+  }
+
+
+/* END */
@@ -0,0 +1,138 @@
+/****************************************************************************
+ *
+ * ftcatlas.h
+ *
+ *   A glyph atlas cache (specification).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+ /*
+  * FTC_ACache is an _abstract_ cache that renders glyph bitmaps into a
+  * small number of fixed-size pages (`atlases'), suitable for uploading
+  * as textures.  A node holds the position of a single glyph; there are
+  * no per-glyph bitmap buffers.
+  *
+  * Rectangles are allocated with a skyline packer, which can't reuse the
+  * space of a single glyph.  Instead, a page is freed when its last glyph
+  * is flushed, and the least recently used page is evicted as a whole if
+  * a new glyph doesn't fit anywhere.  The page buffers are charged to the
+  * cache's `extra_weight', so that they count against the manager's
+  * limit.
+  *
+  * The glyph is loaded with the `family_load_glyph' method of an
+  * FTC_SFamilyClass.  For an implementation example, see FTC_AtlasCache
+  * in `src/cache/ftcbasic.c'.
+  */
+
+
+#ifndef FTCATLAS_H_
+#define FTCATLAS_H_
+
+
+#include <ft2build.h>
+#include FT_CACHE_H
+#include "ftcglyph.h"
+#include "ftcsbits.h"
+
+
+FT_BEGIN_HEADER
+
+  /* empty pixels to the right of and below each glyph */
+#define FTC_ATLAS_PADDING  1
+
+
+  typedef struct FTC_ANodeRec_*  FTC_ANode;
+
+
+  /* a horizontal segment of the skyline, i.e., the top of a page's */
+  /* used area                                                       */
+  typedef struct  FTC_ASkylineRec_
+  {
+    FT_UShort  x;
+    FT_UShort  y;
+    FT_UShort  width;
+
+  } FTC_ASkylineRec, *FTC_ASkyline;
+
+
+  typedef struct  FTC_APageRec_
+  {
+    FT_Byte*          buffer;        /* NULL until the page is used */
+    FTC_ASkyline      skyline;
+    FT_UInt           num_skyline;
+
+    FTC_ANode         nodes;         /* the glyphs in this page     */
+    FT_UInt           num_nodes;
+    FT_ULong          stamp;         /* time of last use            */
+
+    FTC_AtlasRectRec  dirty;
+
+  } FTC_APageRec, *FTC_APage;
+
+
+  typedef struct  FTC_ACacheRec_
+  {
+    FTC_GCacheRec  gcache;
+
+    FT_Pixel_Mode  pixel_mode;       /* GRAY or LCD                 */
+    FT_UInt        bytes_per_pixel;
+    FT_UInt        page_width;
+    FT_UInt        page_height;
+    FT_UInt        max_pages;
+
+    FTC_APage      pages;            /* allocated on first use      */
+    FT_ULong       stamp;
+    FTC_APage      evicting;         /* kept allocated when empty   */
+
+  } FTC_ACacheRec, *FTC_ACache;
+
+#define FTC_ACACHE( x )  ( (FTC_ACache)( x ) )
+
+
+  typedef struct  FTC_ANodeRec_
+  {
+    FTC_GNodeRec       gnode;
+    FTC_APage          page;         /* NULL for empty glyphs       */
+    FTC_ANode          next;         /* in page's list              */
+    FTC_ANode          prev;
+    FTC_AtlasGlyphRec  glyph;
+
+  } FTC_ANodeRec;
+
+#define FTC_ANODE( x )  ( (FTC_ANode)( x ) )
+
+
+  FT_LOCAL( void )
+  FTC_ANode_Free( FTC_ANode  anode,
+                  FTC_Cache  cache );
+
+  FT_LOCAL( FT_Error )
+  FTC_ANode_New( FTC_ANode   *panode,
+                 FTC_GQuery   gquery,
+                 FTC_Cache    cache );
+
+  /* return a page's bitmap and dirty rectangle, then clear the latter */
+  FT_LOCAL( FT_Error )
+  FTC_ACache_GetPage( FTC_ACache      acache,
+                      FT_UInt         page_index,
+                      FT_Bitmap      *abitmap,
+                      FTC_AtlasRect   adirty );
+
+  /* */
+
+FT_END_HEADER
+
+#endif /* FTCATLAS_H_ */
+
+
+/* END */
@@ -23,6 +23,8 @@
 #include "ftcglyph.h"
 #include "ftcimage.h"
 #include "ftcsbits.h"
+#include "ftcphase.h"
+#include "ftcatlas.h"
 
 #include "ftccback.h"
 #include "ftcerror.h"
@@ -226,6 +228,20 @@
   }
 
 
+  FT_CALLBACK_DEF( FTC_FaceID )
+  ftc_basic_gnode_face_id( FTC_Node   ftcgnode,
+                           FTC_Cache  cache )
+  {
+    FTC_GNode        gnode  = (FTC_GNode)ftcgnode;
+    FTC_BasicFamily  family = (FTC_BasicFamily)gnode->family;
+
+    FT_UNUSED( cache );
+
+
+    return family ? family->attrs.scaler.face_id : NULL;
+  }
+
+
  /*
   *
   * basic image cache
@@ -257,6 +273,7 @@
       ftc_gnode_compare,              /* FTC_Node_CompareFunc  node_compare       */
       ftc_basic_gnode_compare_faceid, /* FTC_Node_CompareFunc  node_remove_faceid */
       ftc_inode_free,                 /* FTC_Node_FreeFunc     node_free          */
+      ftc_basic_gnode_face_id,        /* FTC_Node_FaceIDFunc   node_face_id       */
 
       sizeof ( FTC_GCacheRec ),
       ftc_gcache_init,                /* FTC_Cache_InitFunc    cache_init         */
@@ -327,6 +344,7 @@
     query.attrs.scaler.y_res = 0;
 
     hash = FTC_BASIC_ATTR_HASH( &query.attrs ) + gindex;
+    cache = (FTC_ImageCache)FTC_CACHE_LOCK( cache, hash );
 
 #if 1  /* inlining is about 50% faster! */
     FTC_GCACHE_LOOKUP_CMP( cache,
@@ -353,6 +371,8 @@
       }
     }
 
+    FTC_CACHE_UNLOCK( cache, error ? NULL : node );
+
   Exit:
     return error;
   }
@@ -402,6 +422,7 @@
     query.attrs.load_flags = (FT_UInt)load_flags;
 
     hash = FTC_BASIC_ATTR_HASH( &query.attrs ) + gindex;
+    cache = (FTC_ImageCache)FTC_CACHE_LOCK( cache, hash );
 
     FTC_GCACHE_LOOKUP_CMP( cache,
                            ftc_basic_family_compare,
@@ -421,6 +442,8 @@
       }
     }
 
+    FTC_CACHE_UNLOCK( cache, error ? NULL : node );
+
   Exit:
     return error;
   }
@@ -432,19 +455,78 @@
    *
    */
 
+  /* a basic family with its key in a persistent store */
+  typedef struct  FTC_BasicSFamilyRec_
+  {
+    FTC_BasicFamilyRec  basic;
+    FT_Bool             has_key;
+    FT_UInt32           key[FTC_STORE_KEY_SIZE];
+
+  } FTC_BasicSFamilyRec, *FTC_BasicSFamily;
+
+
+  FT_CALLBACK_DEF( FT_Error )
+  ftc_basic_sfamily_init( FTC_MruNode  ftcfamily,
+                          FT_Pointer   ftcquery,
+                          FT_Pointer   ftccache )
+  {
+    FTC_BasicSFamily  family = (FTC_BasicSFamily)ftcfamily;
+
+
+    family->has_key = 0;
+    return ftc_basic_family_init( ftcfamily, ftcquery, ftccache );
+  }
+
+
+  FT_CALLBACK_DEF( FT_Error )
+  ftc_basic_family_get_key( FTC_Family   ftcfamily,
+                            FTC_Manager  manager,
+                            FT_UInt32*   key )
+  {
+    FTC_BasicSFamily  family = (FTC_BasicSFamily)ftcfamily;
+    FTC_Scaler        scaler = &family->basic.attrs.scaler;
+    FT_Error          error;
+
+
+    if ( !family->has_key )
+    {
+      /* the font data is hashed once per face, not per family */
+      error = FTC_Manager_LookupFaceKey( manager, scaler->face_id,
+                                         family->key );
+      if ( error )
+        return error;
+
+      family->key[4] = (FT_UInt32)scaler->width;
+      family->key[5] = (FT_UInt32)scaler->height;
+      family->key[6] = scaler->pixel ? 0xFFFFFFFFUL
+                                     : (FT_UInt32)scaler->x_res;
+      family->key[7] = scaler->pixel ? 0xFFFFFFFFUL
+                                     : (FT_UInt32)scaler->y_res;
+      family->key[8] = (FT_UInt32)family->basic.attrs.load_flags;
+
+      family->has_key = 1;
+    }
+
+    FT_MEM_COPY( key, family->key, sizeof ( family->key ) );
+
+    return FT_Err_Ok;
+  }
+
+
   static
   const FTC_SFamilyClassRec  ftc_basic_sbit_family_class =
   {
     {
-      sizeof ( FTC_BasicFamilyRec ),
+      sizeof ( FTC_BasicSFamilyRec ),
       ftc_basic_family_compare,     /* FTC_MruNode_CompareFunc  node_compare */
-      ftc_basic_family_init,        /* FTC_MruNode_InitFunc     node_init    */
+      ftc_basic_sfamily_init,       /* FTC_MruNode_InitFunc     node_init    */
       NULL,                         /* FTC_MruNode_ResetFunc    node_reset   */
       NULL                          /* FTC_MruNode_DoneFunc     node_done    */
     },
 
     ftc_basic_family_get_count,
-    ftc_basic_family_load_bitmap
+    ftc_basic_family_load_bitmap,
+    ftc_basic_family_get_key
   };
 
 
@@ -457,8 +539,9 @@
       ftc_snode_compare,              /* FTC_Node_CompareFunc  node_compare       */
       ftc_basic_gnode_compare_faceid, /* FTC_Node_CompareFunc  node_remove_faceid */
       ftc_snode_free,                 /* FTC_Node_FreeFunc     node_free          */
+      ftc_basic_gnode_face_id,        /* FTC_Node_FaceIDFunc   node_face_id       */
 
-      sizeof ( FTC_GCacheRec ),
+      sizeof ( FTC_SCacheRec ),
       ftc_gcache_init,                /* FTC_Cache_InitFunc    cache_init         */
       ftc_gcache_done                 /* FTC_Cache_DoneFunc    cache_done         */
     },
@@ -478,6 +561,41 @@
   }
 
 
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_SBitCache_SetStore( FTC_SBitCache  cache,
+                          FT_Pointer     base,
+                          FT_ULong       size )
+  {
+    FT_Error     error;
+    FTC_SCache   scache = FTC_SCACHE( cache );
+    FTC_Manager  manager;
+    FT_UInt      nn;
+
+
+    if ( !scache )
+      return FT_THROW( Invalid_Argument );
+
+    /* nodes may point into the current store */
+    if ( scache->store.base )
+      return FT_THROW( Invalid_Argument );
+
+    manager = FTC_CACHE( scache )->manager;
+
+    error = FTC_Store_Init( &scache->store, manager->library, base, size );
+    if ( error )
+      return error;
+
+    /* the shards of a concurrent manager have their own instances */
+    for ( nn = 0; nn < manager->num_shards; nn++ )
+      FTC_SCACHE( manager->shards[nn]->caches[FTC_CACHE( scache )->index] )
+        ->store = scache->store;
+
+    return FT_Err_Ok;
+  }
+
+
   /* documentation is in ftcache.h */
 
   FT_EXPORT_DEF( FT_Error )
@@ -527,6 +645,7 @@
     /* beware, the hash must be the same for all glyph ranges! */
     hash = FTC_BASIC_ATTR_HASH( &query.attrs ) +
            gindex / FTC_SBIT_ITEMS_PER_NODE;
+    cache = (FTC_SBitCache)FTC_CACHE_LOCK( cache, hash );
 
 #if 1  /* inlining is about 50% faster! */
     FTC_GCACHE_LOOKUP_CMP( cache,
@@ -556,6 +675,8 @@
     }
 
   Exit:
+    FTC_CACHE_UNLOCK( cache, error ? NULL : node );
+
     return error;
   }
 
@@ -604,6 +725,7 @@
     /* beware, the hash must be the same for all glyph ranges! */
     hash = FTC_BASIC_ATTR_HASH( &query.attrs ) +
              gindex / FTC_SBIT_ITEMS_PER_NODE;
+    cache = (FTC_SBitCache)FTC_CACHE_LOCK( cache, hash );
 
     FTC_GCACHE_LOOKUP_CMP( cache,
                            ftc_basic_family_compare,
@@ -624,9 +746,671 @@
       node->ref_count++;
     }
 
+  Exit:
+    FTC_CACHE_UNLOCK( cache, error ? NULL : node );
+
+    return error;
+  }
+
+
+  /*
+   *
+   * basic subpixel phase cache
+   *
+   */
+
+  typedef struct  FTC_BasicPhaseQueryRec_
+  {
+    FTC_BasicQueryRec  basic;
+    FT_UInt            phase;
+
+  } FTC_BasicPhaseQueryRec, *FTC_BasicPhaseQuery;
+
+
+  FT_CALLBACK_DEF( FT_Error )
+  ftc_basic_family_load_outline( FTC_Family       ftcfamily,
+                                 FT_UInt          gindex,
+                                 FTC_Cache        cache,
+                                 FT_Glyph        *aglyph,
+                                 FT_Render_Mode  *amode )
+  {
+    FTC_BasicFamily  family = (FTC_BasicFamily)ftcfamily;
+
+
+    *amode = FT_LOAD_TARGET_MODE( family->attrs.load_flags );
+
+    return ftc_basic_family_load_glyph( ftcfamily, gindex, cache, aglyph );
+  }
+
+
+  FT_CALLBACK_DEF( FT_Error )
+  ftc_basic_pnode_new( FTC_Node   *ftcppnode,
+                       FT_Pointer  ftcquery,
+                       FTC_Cache   cache )
+  {
+    FTC_PNode           *ppnode = (FTC_PNode*)ftcppnode;
+    FTC_BasicPhaseQuery  query  = (FTC_BasicPhaseQuery)ftcquery;
+
+
+    return FTC_PNode_New( ppnode, &query->basic.gquery, query->phase,
+                          cache );
+  }
+
+
+  FT_CALLBACK_DEF( FT_Bool )
+  ftc_basic_pnode_compare( FTC_Node    ftcpnode,
+                           FT_Pointer  ftcquery,
+                           FTC_Cache   cache,
+                           FT_Bool*    list_changed )
+  {
+    FTC_PNode            pnode = (FTC_PNode)ftcpnode;
+    FTC_BasicPhaseQuery  query = (FTC_BasicPhaseQuery)ftcquery;
+
+
+    return FTC_PNode_Compare( pnode, &query->basic.gquery, query->phase,
+                              cache, list_changed );
+  }
+
+
+  static
+  const FTC_PFamilyClassRec  ftc_basic_phase_family_class =
+  {
+    {
+      sizeof ( FTC_BasicFamilyRec ),
+      ftc_basic_family_compare,     /* FTC_MruNode_CompareFunc  node_compare */
+      ftc_basic_family_init,        /* FTC_MruNode_InitFunc     node_init    */
+      NULL,                         /* FTC_MruNode_ResetFunc    node_reset   */
+      NULL                          /* FTC_MruNode_DoneFunc     node_done    */
+    },
+
+    ftc_basic_family_load_outline
+  };
+
+
+  static
+  const FTC_GCacheClassRec  ftc_basic_phase_cache_class =
+  {
+    {
+      ftc_basic_pnode_new,            /* FTC_Node_NewFunc      node_new           */
+      ftc_pnode_weight,               /* FTC_Node_WeightFunc   node_weight        */
+      ftc_basic_pnode_compare,        /* FTC_Node_CompareFunc  node_compare       */
+      ftc_basic_gnode_compare_faceid, /* FTC_Node_CompareFunc  node_remove_faceid */
+      ftc_pnode_free,                 /* FTC_Node_FreeFunc     node_free          */
+      ftc_basic_gnode_face_id,        /* FTC_Node_FaceIDFunc   node_face_id       */
+
+      sizeof ( FTC_PCacheRec ),
+      ftc_pcache_init,                /* FTC_Cache_InitFunc    cache_init         */
+      ftc_gcache_done                 /* FTC_Cache_DoneFunc    cache_done         */
+    },
+
+    (FTC_MruListClass)&ftc_basic_phase_family_class
+  };
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_PhaseCache_New( FTC_Manager      manager,
+                      FT_UInt          x_phases,
+                      FT_UInt          y_phases,
+                      FTC_PhaseCache  *acache )
+  {
+    FT_Error    error;
+    FTC_PCache  pcache = NULL;
+    FT_UInt     nn;
+
+
+    if ( !acache )
+      return FT_THROW( Invalid_Argument );
+
+    *acache = NULL;
+
+    if ( x_phases < 1 || x_phases > FTC_PHASE_MAX ||
+         y_phases < 1 || y_phases > FTC_PHASE_MAX ||
+         x_phases * y_phases > FTC_PHASE_MAX      )
+      return FT_THROW( Invalid_Argument );
+
+    error = FTC_GCache_New( manager, &ftc_basic_phase_cache_class,
+                            (FTC_GCache*)&pcache );
+    if ( error )
+      return error;
+
+    pcache->x_phases = x_phases;
+    pcache->y_phases = y_phases;
+
+    /* the shards of a concurrent manager have their own instances */
+    for ( nn = 0; nn < manager->num_shards; nn++ )
+    {
+      FTC_PCache  shard_cache;
+
+
+      shard_cache = FTC_PCACHE(
+                      manager->shards[nn]->caches[FTC_CACHE( pcache )->index] );
+
+      shard_cache->x_phases = x_phases;
+      shard_cache->y_phases = y_phases;
+    }
+
+    *acache = (FTC_PhaseCache)pcache;
+
+    return FT_Err_Ok;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_PhaseCache_Lookup( FTC_PhaseCache  cache,
+                         FTC_Scaler      scaler,
+                         FT_ULong        load_flags,
+                         FT_UInt         gindex,
+                         FT_Pos          x_offset,
+                         FT_Pos          y_offset,
+                         FTC_SBit       *ansbit,
+                         FTC_Node       *anode )
+  {
+    FT_Error                error;
+    FTC_BasicPhaseQueryRec  query;
+    FTC_PCache              pcache = FTC_PCACHE( cache );
+    FTC_Node                node   = 0; /* make compiler happy */
+    FT_Offset               hash;
+    FT_UInt                 x_phase, y_phase;
+
+
+    if ( anode )
+      *anode = NULL;
+
+    if ( !ansbit || !scaler )
+      return FT_THROW( Invalid_Argument );
+
+    *ansbit = NULL;
+
+    if ( !cache )
+      return FT_THROW( Invalid_Cache_Handle );
+
+#if FT_ULONG_MAX > FT_UINT_MAX
+    if ( load_flags > FT_UINT_MAX )
+      FT_TRACE1(( "FTC_PhaseCache_Lookup:"
+                  " higher bits in load_flags 0x%x are dropped\n",
+                  load_flags & ~((FT_ULong)FT_UINT_MAX) ));
+#endif
+
+    /* round the fractional parts down to the nearest phase */
+    x_phase = (FT_UInt)( ( ( x_offset & 63 ) *
+                           (FT_Pos)pcache->x_phases ) >> 6 );
+    y_phase = (FT_UInt)( ( ( y_offset & 63 ) *
+                           (FT_Pos)pcache->y_phases ) >> 6 );
+
+    query.phase = y_phase * pcache->x_phases + x_phase;
+
+    /* the nodes hold glyph images; we render them ourselves */
+    query.basic.attrs.scaler     = scaler[0];
+    query.basic.attrs.load_flags = (FT_UInt)( load_flags & ~FT_LOAD_RENDER );
+
+    /* all phases of a glyph share the same node, thus the same hash */
+    hash  = FTC_BASIC_ATTR_HASH( &query.basic.attrs ) + gindex;
+    cache = (FTC_PhaseCache)FTC_CACHE_LOCK( cache, hash );
+
+    FTC_GCACHE_LOOKUP_CMP( cache,
+                           ftc_basic_family_compare,
+                           ftc_basic_pnode_compare,
+                           hash, gindex,
+                           &query,
+                           node,
+                           error );
+    if ( error )
+      goto Exit;
+
+    *ansbit = FTC_PNODE_SBIT( node, query.phase );
+
+    if ( anode )
+    {
+      *anode = node;
+      node->ref_count++;
+    }
+
+  Exit:
+    FTC_CACHE_UNLOCK( cache, error ? NULL : node );
+
+    return error;
+  }
+
+
+  /*
+   *
+   * basic glyph atlas cache
+   *
+   */
+
+  static
+  const FTC_GCacheClassRec  ftc_basic_atlas_cache_class =
+  {
+    {
+      ftc_anode_new,                  /* FTC_Node_NewFunc      node_new           */
+      ftc_anode_weight,               /* FTC_Node_WeightFunc   node_weight        */
+      ftc_anode_compare,              /* FTC_Node_CompareFunc  node_compare       */
+      ftc_basic_gnode_compare_faceid, /* FTC_Node_CompareFunc  node_remove_faceid */
+      ftc_anode_free,                 /* FTC_Node_FreeFunc     node_free          */
+      ftc_basic_gnode_face_id,        /* FTC_Node_FaceIDFunc   node_face_id       */
+
+      sizeof ( FTC_ACacheRec ),
+      ftc_acache_init,                /* FTC_Cache_InitFunc    cache_init         */
+      ftc_acache_done                 /* FTC_Cache_DoneFunc    cache_done         */
+    },
+
+    /* the glyphs are loaded like small bitmaps */
+    (FTC_MruListClass)&ftc_basic_sbit_family_class
+  };
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_AtlasCache_New( FTC_Manager      manager,
+                      FT_Pixel_Mode    pixel_mode,
+                      FT_UInt          page_width,
+                      FT_UInt          page_height,
+                      FT_UInt          max_pages,
+                      FTC_AtlasCache  *acache )
+  {
+    FT_Error    error;
+    FTC_ACache  cache = NULL;
+
+
+    if ( !acache )
+      return FT_THROW( Invalid_Argument );
+
+    *acache = NULL;
+
+    if ( !manager )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    /* the pages of a shard's cache would be invisible to the client */
+    if ( manager->num_shards )
+      return FT_THROW( Invalid_Argument );
+
+    if ( ( pixel_mode != FT_PIXEL_MODE_GRAY &&
+           pixel_mode != FT_PIXEL_MODE_LCD  ) ||
+         page_width  < 1 || page_width  > 16384  ||
+         page_height < 1 || page_height > 16384  ||
+         max_pages   < 1                         )
+      return FT_THROW( Invalid_Argument );
+
+    error = FTC_GCache_New( manager, &ftc_basic_atlas_cache_class,
+                            (FTC_GCache*)&cache );
+    if ( error )
+      return error;
+
+    cache->pixel_mode      = pixel_mode;
+    cache->bytes_per_pixel = pixel_mode == FT_PIXEL_MODE_LCD ? 3 : 1;
+    cache->page_width      = page_width;
+    cache->page_height     = page_height;
+    cache->max_pages       = max_pages;
+
+    *acache = (FTC_AtlasCache)cache;
+
+    return FT_Err_Ok;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_AtlasCache_Lookup( FTC_AtlasCache   cache,
+                         FTC_Scaler       scaler,
+                         FT_ULong         load_flags,
+                         FT_UInt          gindex,
+                         FTC_AtlasGlyph  *aglyph,
+                         FTC_Node        *anode )
+  {
+    FT_Error           error;
+    FTC_BasicQueryRec  query;
+    FTC_Node           node = 0; /* make compiler happy */
+    FT_Offset          hash;
+    FT_Render_Mode     mode;
+
+
+    if ( anode )
+      *anode = NULL;
+
+    if ( !aglyph || !scaler )
+      return FT_THROW( Invalid_Argument );
+
+    *aglyph = NULL;
+
+    if ( !cache )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    /* the render mode must match the page format */
+    mode = FT_LOAD_TARGET_MODE( load_flags );
+    if ( FTC_ACACHE( cache )->pixel_mode == FT_PIXEL_MODE_LCD )
+      mode = FT_RENDER_MODE_LCD;
+    else if ( mode == FT_RENDER_MODE_LCD || mode == FT_RENDER_MODE_LCD_V )
+      mode = FT_RENDER_MODE_NORMAL;
+
+    load_flags = ( load_flags & ~(FT_ULong)FT_LOAD_TARGET_( 15 ) ) |
+                 (FT_ULong)FT_LOAD_TARGET_( mode );
+
+#if FT_ULONG_MAX > FT_UINT_MAX
+    if ( load_flags > FT_UINT_MAX )
+      FT_TRACE1(( "FTC_AtlasCache_Lookup:"
+                  " higher bits in load_flags 0x%x are dropped\n",
+                  load_flags & ~((FT_ULong)FT_UINT_MAX) ));
+#endif
+
+    query.attrs.scaler     = scaler[0];
+    query.attrs.load_flags = (FT_UInt)load_flags;
+
+    hash = FTC_BASIC_ATTR_HASH( &query.attrs ) + gindex;
+
+    FTC_GCACHE_LOOKUP_CMP( cache,
+                           ftc_basic_family_compare,
+                           ftc_anode_compare,
+                           hash, gindex,
+                           &query,
+                           node,
+                           error );
+    if ( error )
+      goto Exit;
+
+    *aglyph = &FTC_ANODE( node )->glyph;
+
+    if ( anode )
+    {
+      *anode = node;
+      node->ref_count++;
+    }
+
   Exit:
     return error;
   }
 
 
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_AtlasCache_GetPage( FTC_AtlasCache  cache,
+                          FT_UInt         page_index,
+                          FT_Bitmap      *abitmap,
+                          FTC_AtlasRect   adirty )
+  {
+    if ( !cache )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    if ( !abitmap )
+      return FT_THROW( Invalid_Argument );
+
+    return FTC_ACache_GetPage( FTC_ACACHE( cache ), page_index,
+                               abitmap, adirty );
+  }
+
+
+
+  /*
+   *
+   * batched lookups
+   *
+   */
+
+  /* number of glyphs whose hash buckets are prefetched together; */
+  /* also the size of the node array on the stack                 */
+#define FTC_BATCH_CHUNK  32
+
+  /* the largest run; each glyph can add a reference to the same node */
+  /* and `ref_count' is an FT_Short                                    */
+#define FTC_BATCH_MAX  0x7FFF
+
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define FTC_PREFETCH( p )  __builtin_prefetch( p )
+#else
+#define FTC_PREFETCH( p )  ( (void)( p ) )
+#endif
+
+
+  /*
+   * Look up `count' glyphs with the same attributes in an image cache or,
+   * if `sbit' is set, in an sbit cache; `outputs' is an array of
+   * `FT_Glyph' or `FTC_SBit' handles, respectively.  The family is
+   * resolved once; for each chunk of glyphs, the hash buckets are
+   * prefetched before the lookups start.  All nodes are referenced until
+   * the end so that loading a glyph can't flush the results for previous
+   * ones; if the client doesn't want the nodes, a node found for
+   * consecutive glyphs is referenced only once.
+   *
+   * Since this function is called with a constant `sbit' argument, the
+   * compiler can replace the node comparison with a direct call.
+   */
+  static FT_Error
+  ftc_basic_lookup_batch( FTC_GCache      cache,
+                          FTC_Scaler      scaler,
+                          FT_ULong        load_flags,
+                          const FT_UInt*  gindices,
+                          FT_UInt         count,
+                          FT_Bool         sbit,
+                          FT_Pointer      outputs,
+                          FTC_Node       *anodes )
+  {
+    FT_Memory          memory = FTC_CACHE( cache )->memory;
+    FTC_BasicQueryRec  query;
+    FTC_MruNode        mrunode;
+    FTC_Family         family;
+    FTC_Node           local[FTC_BATCH_CHUNK];
+    FTC_Node*          nodes  = anodes;
+    FTC_Node           last   = NULL;
+    FT_Offset          hashes[FTC_BATCH_CHUNK];
+    FT_Offset          base;
+    FT_Error           error;
+    FT_Error           result = FT_Err_Ok;
+    FT_UInt            start, nn, num;
+
+    FT_Glyph*  glyphs = (FT_Glyph*)outputs;
+    FTC_SBit*  sbits  = (FTC_SBit*)outputs;
+    FT_UInt    items  = sbit ? FTC_SBIT_ITEMS_PER_NODE : 1;
+
+
+    if ( !nodes )
+    {
+      if ( count <= FTC_BATCH_CHUNK )
+        nodes = local;
+      else if ( FT_QNEW_ARRAY( nodes, count ) )
+        return error;
+    }
+
+    for ( nn = 0; nn < count; nn++ )
+    {
+      if ( sbit )
+        sbits[nn] = NULL;
+      else
+        glyphs[nn] = NULL;
+
+      nodes[nn] = NULL;
+    }
+
+    query.attrs.scaler     = scaler[0];
+    query.attrs.load_flags = (FT_UInt)load_flags;
+    query.gquery.gindex    = 0;
+
+    FTC_MRULIST_LOOKUP( &cache->families, &query, mrunode, error );
+    if ( error )
+    {
+      result = error;
+      goto Exit;
+    }
+
+    family              = FTC_FAMILY( mrunode );
+    query.gquery.family = family;
+    family->num_nodes++;
+
+    base = FTC_BASIC_ATTR_HASH( &query.attrs );
+
+    for ( start = 0; start < count; start += num )
+    {
+      num = count - start;
+      if ( num > FTC_BATCH_CHUNK )
+        num = FTC_BATCH_CHUNK;
+
+      for ( nn = 0; nn < num; nn++ )
+      {
+        hashes[nn] = base + gindices[start + nn] / items;
+        FTC_PREFETCH( FTC_NODE_TOP_FOR_HASH( FTC_CACHE( cache ),
+                                             hashes[nn] ) );
+      }
+
+      for ( nn = 0; nn < num; nn++ )
+      {
+        FTC_Node   node;
+        FT_Offset  hash   = hashes[nn];
+        FT_UInt    gindex = gindices[start + nn];
+
+
+        query.gquery.gindex = gindex;
+
+        FTC_CACHE_LOOKUP_CMP( cache,
+                              sbit ? (FTC_Node_CompareFunc)FTC_SNode_Compare
+                                   : (FTC_Node_CompareFunc)FTC_GNode_Compare,
+                              hash, &query, node, error );
+        if ( error )
+        {
+          if ( !result )
+            result = error;
+          continue;
+        }
+
+        if ( nodes == anodes || node != last )
+        {
+          node->ref_count++;
+          nodes[start + nn] = node;
+          last              = node;
+        }
+
+        if ( sbit )
+          sbits[start + nn] = FTC_SNODE( node )->sbits +
+                              ( gindex - FTC_GNODE( node )->gindex );
+        else
+          glyphs[start + nn] = FTC_INODE( node )->glyph;
+      }
+    }
+
+    if ( --family->num_nodes == 0 )
+      FTC_FAMILY_FREE( family, cache );
+
+  Exit:
+    /* release the nodes if the client doesn't want them */
+    if ( nodes != anodes )
+    {
+      for ( nn = 0; nn < count; nn++ )
+        if ( nodes[nn] )
+          nodes[nn]->ref_count--;
+
+      if ( nodes != local )
+        FT_FREE( nodes );
+    }
+
+    return result;
+  }
+
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_ImageCache_LookupBatch( FTC_ImageCache  cache,
+                              FTC_Scaler      scaler,
+                              FT_ULong        load_flags,
+                              const FT_UInt*  gindices,
+                              FT_UInt         count,
+                              FT_Glyph       *aglyphs,
+                              FTC_Node       *anodes )
+  {
+    FT_Error  error = FT_Err_Ok;
+    FT_UInt   nn;
+
+
+    if ( !cache )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    if ( !scaler || ( count && ( !gindices || !aglyphs ) ) ||
+         count > FTC_BATCH_MAX                             )
+      return FT_THROW( Invalid_Argument );
+
+    /* the nodes of a concurrent manager are distributed over shards */
+    if ( FTC_CACHE( cache )->manager->num_shards )
+    {
+      for ( nn = 0; nn < count; nn++ )
+      {
+        FT_Error  err;
+
+
+        err = FTC_ImageCache_LookupScaler( cache, scaler, load_flags,
+                                           gindices[nn], aglyphs + nn,
+                                           anodes ? anodes + nn : NULL );
+        if ( err && !error )
+          error = err;
+      }
+
+      return error;
+    }
+
+    return ftc_basic_lookup_batch( FTC_GCACHE( cache ),
+                                   scaler,
+                                   load_flags,
+                                   gindices,
+                                   count,
+                                   0,
+                                   aglyphs,
+                                   anodes );
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_SBitCache_LookupBatch( FTC_SBitCache   cache,
+                             FTC_Scaler      scaler,
+                             FT_ULong        load_flags,
+                             const FT_UInt*  gindices,
+                             FT_UInt         count,
+                             FTC_SBit       *sbits,
+                             FTC_Node       *anodes )
+  {
+    FT_Error  error = FT_Err_Ok;
+    FT_UInt   nn;
+
+
+    if ( !cache )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    if ( !scaler || ( count && ( !gindices || !sbits ) ) ||
+         count > FTC_BATCH_MAX                           )
+      return FT_THROW( Invalid_Argument );
+
+    /* the nodes of a concurrent manager are distributed over shards */
+    if ( FTC_CACHE( cache )->manager->num_shards )
+    {
+      for ( nn = 0; nn < count; nn++ )
+      {
+        FT_Error  err;
+
+
+        err = FTC_SBitCache_LookupScaler( cache, scaler, load_flags,
+                                          gindices[nn], sbits + nn,
+                                          anodes ? anodes + nn : NULL );
+        if ( err && !error )
+          error = err;
+      }
+
+      return error;
+    }
+
+    return ftc_basic_lookup_batch( FTC_GCACHE( cache ),
+                                   scaler,
+                                   load_flags,
+                                   gindices,
+                                   count,
+                                   1,
+                                   sbits,
+                                   anodes );
+  }
+
+
 /* END */
@@ -74,6 +74,8 @@
 
 #ifndef FTC_INLINE
 
+#ifndef FTC_CLOCK
+
   /* move a node to the head of the manager's MRU list */
   static void
   ftc_node_mru_up( FTC_Node     node,
@@ -83,6 +85,8 @@
                     (FTC_MruNode)node );
   }
 
+#endif
+
 
   /* get a top bucket for specified hash from cache,
    * body for FTC_NODE_TOP_FOR_HASH( cache, hash )
@@ -274,6 +278,7 @@
                     FTC_Manager  manager )
   {
     FTC_Cache  cache;
+    FT_Offset  weight;
 
 
 #ifdef FT_DEBUG_ERROR
@@ -295,13 +300,16 @@
     }
 #endif
 
-    manager->cur_weight -= cache->clazz.node_weight( node, cache );
+    weight               = cache->clazz.node_weight( node, cache );
+    manager->cur_weight -= weight;
+    FTC_Manager_QuotaRemove( manager, node, weight );
 
     /* remove node from mru list */
     ftc_node_mru_unlink( node, manager );
 
     /* remove node from cache's hash table */
-    ftc_node_hash_unlink( node, cache );
+    if ( !node->removed )
+      ftc_node_hash_unlink( node, cache );
 
     /* now finalize it */
     cache->clazz.node_free( node, cache );
@@ -315,6 +323,29 @@
   }
 
 
+  FT_LOCAL_DEF( void )
+  ftc_node_reweigh( FTC_Node   node,
+                    FTC_Cache  cache,
+                    FT_Offset  plus,
+                    FT_Offset  minus )
+  {
+    FTC_Manager  manager = cache->manager;
+
+
+    manager->cur_weight += plus;
+    manager->cur_weight -= minus;
+
+    if ( node->face_slot )
+    {
+      FTC_FaceQuota  quota = manager->quotas + node->face_slot - 1;
+
+
+      quota->weight += plus;
+      quota->weight -= minus;
+    }
+  }
+
+
   /*************************************************************************/
   /*************************************************************************/
   /*****                                                               *****/
@@ -347,16 +378,63 @@
   }
 
 
+  /* free a node that is no longer in the hash table */
+  static void
+  ftc_cache_free_node( FTC_Cache  cache,
+                       FTC_Node   node )
+  {
+    FTC_Manager  manager = cache->manager;
+    FT_Offset    weight;
+
+
+    node->link = NULL;
+
+    /* remove node from mru list */
+    ftc_node_mru_unlink( node, manager );
+
+    /* now finalize it */
+    weight               = cache->clazz.node_weight( node, cache );
+    manager->cur_weight -= weight;
+    FTC_Manager_QuotaRemove( manager, node, weight );
+
+    cache->clazz.node_free( node, cache );
+  }
+
+
   static void
   FTC_Cache_Clear( FTC_Cache  cache )
   {
     if ( cache && cache->buckets )
     {
       FTC_Manager  manager = cache->manager;
+      FTC_Node     first   = manager->nodes_list;
       FT_UFast     i;
       FT_UFast     count;
 
 
+      /* the nodes kept by `FTC_Cache_RemoveFaceID' are only in the */
+      /* mru list                                                   */
+      if ( first )
+      {
+        FTC_Node  node = FTC_NODE_PREV( first );
+
+
+        for (;;)
+        {
+          FTC_Node  prev = ( node == first ) ? NULL : FTC_NODE_PREV( node );
+
+
+          if ( node->removed                                &&
+               (FT_UInt)node->cache_index == cache->index )
+            ftc_cache_free_node( cache, node );
+
+          if ( !prev )
+            break;
+
+          node = prev;
+        }
+      }
+
       count = cache->p + cache->mask + 1;
 
       for ( i = 0; i < count; i++ )
@@ -366,16 +444,8 @@
 
         while ( node )
         {
-          next        = node->link;
-          node->link  = NULL;
-
-          /* remove node from mru list */
-          ftc_node_mru_unlink( node, manager );
-
-          /* now finalize it */
-          manager->cur_weight -= cache->clazz.node_weight( node, cache );
-
-          cache->clazz.node_free( node, cache );
+          next = node->link;
+          ftc_cache_free_node( cache, node );
           node = next;
         }
         cache->buckets[i] = NULL;
@@ -418,17 +488,24 @@
                  FTC_Node   node )
   {
     node->hash        = hash;
-    node->cache_index = (FT_UInt16)cache->index;
+    node->cache_index = (FT_Byte)cache->index;
+    node->referenced  = 0;
     node->ref_count   = 0;
+    node->face_slot   = 0;
+    node->removed     = 0;
 
     ftc_node_hash_link( node, cache );
     ftc_node_mru_link( node, cache->manager );
 
     {
       FTC_Manager  manager = cache->manager;
+      FT_Offset    weight  = cache->clazz.node_weight( node, cache );
+
 
+      manager->cur_weight += weight;
 
-      manager->cur_weight += cache->clazz.node_weight( node, cache );
+      if ( manager->face_quota )
+        FTC_Manager_QuotaAdd( manager, node, weight );
 
       if ( manager->cur_weight >= manager->max_weight )
       {
@@ -440,6 +517,88 @@
   }
 
 
+  FT_LOCAL_DEF( FT_ULong )
+  FTC_Cache_BeginMiss( FTC_Cache  cache )
+  {
+    FTC_StatsHooksRec*  hooks = &cache->manager->hooks;
+
+
+    return hooks->clock ? hooks->clock( hooks->data ) : 0;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Cache_EndMiss( FTC_Cache  cache,
+                     FT_ULong   start )
+  {
+    FTC_StatsHooksRec*  hooks = &cache->manager->hooks;
+
+
+    cache->misses++;
+
+    if ( hooks->clock )
+    {
+      FT_ULong  ticks = hooks->clock( hooks->data ) - start;
+      FT_UInt   bin   = 0;
+
+
+      /* bin n > 0 holds times in the range [2^(n-1),2^n[ */
+      while ( ticks && bin < FTC_STATS_LOAD_TIME_BINS - 1 )
+      {
+        ticks >>= 1;
+        bin++;
+      }
+
+      cache->load_times[bin]++;
+    }
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Cache_AddStats( FTC_Cache           cache,
+                      FTC_CacheStatsRec  *astats )
+  {
+    FT_UFast  i, count;
+    FT_UInt   nn;
+
+
+    astats->lookups   += cache->lookups;
+    astats->misses    += cache->misses;
+    astats->evictions += cache->evictions;
+
+    for ( nn = 0; nn < FTC_STATS_LOAD_TIME_BINS; nn++ )
+      astats->load_times[nn] += cache->load_times[nn];
+
+    if ( cache->families )
+      astats->num_families += cache->families->num_nodes;
+
+    astats->weight += cache->extra_weight;
+
+    if ( !cache->buckets )
+      return;
+
+    count = cache->p + cache->mask + 1;
+    astats->num_buckets += count;
+
+    for ( i = 0; i < count; i++ )
+    {
+      FTC_Node  node;
+      FT_ULong  chain = 0;
+
+
+      for ( node = cache->buckets[i]; node; node = node->link )
+      {
+        astats->weight += cache->clazz.node_weight( node, cache );
+        chain++;
+      }
+
+      astats->num_nodes += chain;
+      if ( chain > astats->max_bucket_nodes )
+        astats->max_bucket_nodes = chain;
+    }
+  }
+
+
   FT_LOCAL_DEF( FT_Error )
   FTC_Cache_NewNode( FTC_Cache   cache,
                      FT_Offset   hash,
@@ -448,6 +607,7 @@
   {
     FT_Error  error;
     FTC_Node  node;
+    FT_ULong  start = FTC_Cache_BeginMiss( cache );
 
 
     /*
@@ -462,6 +622,8 @@
     }
     FTC_CACHE_TRYLOOP_END( NULL );
 
+    FTC_Cache_EndMiss( cache, start );
+
     if ( error )
       node = NULL;
     else
@@ -497,6 +659,9 @@
     if ( !cache || !anode )
       return FT_THROW( Invalid_Argument );
 
+    if ( cache->count_lookups )
+      cache->lookups++;
+
     /* Go to the `top' node of the list sharing same masked hash */
     bucket = pnode = FTC_NODE_TOP_FOR_HASH( cache, hash );
 
@@ -533,6 +698,15 @@
       }
     }
 
+#ifdef FTC_CLOCK
+
+    FT_UNUSED( bucket );
+
+    if ( !node->referenced )
+      node->referenced = 1;
+
+#else /* !FTC_CLOCK */
+
     /* Reorder the list to move the found node to the `top' */
     if ( node != *bucket )
     {
@@ -549,6 +723,9 @@
       if ( node != manager->nodes_list )
         ftc_node_mru_up( node, manager );
     }
+
+#endif /* !FTC_CLOCK */
+
     *anode = node;
 
     return error;
@@ -564,9 +741,8 @@
   FTC_Cache_RemoveFaceID( FTC_Cache   cache,
                           FTC_FaceID  face_id )
   {
-    FT_UFast     i, count;
-    FTC_Manager  manager = cache->manager;
-    FTC_Node     frees   = NULL;
+    FT_UFast  i, count;
+    FTC_Node  frees = NULL;
 
 
     count = cache->p + cache->mask + 1;
@@ -588,9 +764,21 @@
         if ( cache->clazz.node_remove_faceid( node, face_id,
                                               cache, &list_changed ) )
         {
-          *pnode     = node->link;
-          node->link = frees;
-          frees      = node;
+          *pnode = node->link;
+          cache->slack++;
+
+          /* another user (possibly another thread) still holds */
+          /* the node; `FTC_Node_Unref' will destroy it         */
+          if ( node->ref_count > 0 )
+          {
+            node->link    = NULL;
+            node->removed = 1;
+          }
+          else
+          {
+            node->link = frees;
+            frees      = node;
+          }
         }
         else
           pnode = &node->link;
@@ -600,18 +788,11 @@
     /* remove all nodes in the free list */
     while ( frees )
     {
-      FTC_Node  node;
+      FTC_Node  node = frees;
 
 
-      node  = frees;
       frees = node->link;
-
-      manager->cur_weight -= cache->clazz.node_weight( node, cache );
-      ftc_node_mru_unlink( node, manager );
-
-      cache->clazz.node_free( node, cache );
-
-      cache->slack++;
+      ftc_cache_free_node( cache, node );
     }
 
     ftc_cache_resize( cache );
@@ -52,16 +52,31 @@ FT_BEGIN_HEADER
    * the cache.  It can be an individual glyph image, a set of bitmaps
    * glyphs for a given size, some metrics, etc.
    *
+   * If `FTC_CLOCK' is defined, a lookup that finds a node only sets its
+   * `referenced' flag instead of moving it to the head of the global
+   * list.  Old nodes are then flushed in CLOCK (`second chance') order:
+   * a referenced node at the end of the list gets its flag cleared and is
+   * moved to the head instead of being destroyed.  This way, cache hits
+   * don't write to the list, the hash buckets, or other nodes.  Note that
+   * a hit in a cache of a concurrent manager (see
+   * `FTC_Manager_NewConcurrent') still locks the shard's mutex.
+   *
    */
 
-  /* structure size should be 20 bytes on 32-bits machines */
+#define FTC_CLOCK
+
+
+  /* structure size should be 24 bytes on 32-bits machines */
   typedef struct  FTC_NodeRec_
   {
     FTC_MruNodeRec  mru;          /* circular mru list pointer           */
     FTC_Node        link;         /* used for hashing                    */
     FT_Offset       hash;         /* used for hashing too                */
-    FT_UShort       cache_index;  /* index of cache the node belongs to  */
+    FT_Byte         cache_index;  /* index of cache the node belongs to  */
+    FT_Byte         referenced;   /* set by lookups if FTC_CLOCK         */
     FT_Short        ref_count;    /* reference count for this node       */
+    FT_UShort       face_slot;    /* in manager's face quotas, or 0      */
+    FT_Byte         removed;      /* see `FTC_Cache_RemoveFaceID'        */
 
   } FTC_NodeRec;
 
@@ -117,6 +132,11 @@ FT_BEGIN_HEADER
   (*FTC_Node_FreeFunc)( FTC_Node   node,
                         FTC_Cache  cache );
 
+  /* return the face ID of the data held by a node */
+  typedef FTC_FaceID
+  (*FTC_Node_FaceIDFunc)( FTC_Node   node,
+                          FTC_Cache  cache );
+
   typedef FT_Error
   (*FTC_Cache_InitFunc)( FTC_Cache  cache );
 
@@ -131,6 +151,7 @@ FT_BEGIN_HEADER
     FTC_Node_CompareFunc  node_compare;
     FTC_Node_CompareFunc  node_remove_faceid;
     FTC_Node_FreeFunc     node_free;
+    FTC_Node_FaceIDFunc   node_face_id;
 
     FT_Offset             cache_size;
     FTC_Cache_InitFunc    cache_init;
@@ -146,6 +167,7 @@ FT_BEGIN_HEADER
     FT_UFast           mask;
     FT_Long            slack;
     FTC_Node*          buckets;
+    FT_Bool            count_lookups;  /* from the manager's hooks */
 
     FTC_CacheClassRec  clazz;       /* local copy, for speed  */
 
@@ -155,6 +177,18 @@ FT_BEGIN_HEADER
 
     FTC_CacheClass     org_class;   /* original class pointer */
 
+    FTC_MruList        families;    /* NULL if not a glyph cache */
+
+    FT_Offset          extra_weight;  /* part of the manager's weight */
+                                      /* not held by nodes, e.g., the */
+                                      /* pages of an atlas cache      */
+
+    /* statistics, see `FTC_Manager_GetCacheStats' */
+    FT_ULong           lookups;
+    FT_ULong           misses;
+    FT_ULong           evictions;
+    FT_ULong           load_times[FTC_STATS_LOAD_TIME_BINS];
+
   } FTC_CacheRec;
 
 
@@ -170,6 +204,22 @@ FT_BEGIN_HEADER
   FT_LOCAL( void )
   FTC_Cache_Done( FTC_Cache  cache );
 
+  /* Call these functions around the load of data missing from the
+   * cache.  The value returned by `FTC_Cache_BeginMiss' must be passed
+   * to `FTC_Cache_EndMiss', which updates the statistics.
+   */
+  FT_LOCAL( FT_ULong )
+  FTC_Cache_BeginMiss( FTC_Cache  cache );
+
+  FT_LOCAL( void )
+  FTC_Cache_EndMiss( FTC_Cache  cache,
+                     FT_ULong   start );
+
+  /* add the statistics of `cache' to `astats' */
+  FT_LOCAL( void )
+  FTC_Cache_AddStats( FTC_Cache           cache,
+                      FTC_CacheStatsRec  *astats );
+
   /* Call this function to look up the cache.  If no corresponding
    * node is found, a new one is automatically created.  This function
    * is capable of flushing the cache adequately to make room for the
@@ -193,12 +243,13 @@ FT_BEGIN_HEADER
   /* Remove all nodes that relate to a given face_id.  This is useful
    * when un-installing fonts.  Note that if a cache node relates to
    * the face_id but is locked (i.e., has `ref_count > 0'), the node
-   * will _not_ be destroyed, but its internal face_id reference will
-   * be modified.
+   * will _not_ be destroyed, but removed from the hash table and
+   * marked with the `removed' flag.
    *
    * The final result will be that the node will never come back
-   * in further lookup requests, and will be flushed on demand from
-   * the cache normally when its reference count reaches 0.
+   * in further lookup requests, and will be destroyed by
+   * `FTC_Node_Unref' when its reference count reaches 0 (or flushed
+   * normally if it gets unlocked otherwise).
    */
   FT_LOCAL( void )
   FTC_Cache_RemoveFaceID( FTC_Cache   cache,
@@ -207,6 +258,44 @@ FT_BEGIN_HEADER
 
 #ifdef FTC_INLINE
 
+#ifdef FTC_CLOCK
+
+  /* mark a node found by `FTC_CACHE_LOOKUP_CMP' */
+#define FTC_CACHE_HIT_( cache, bucket, pnode, node )  \
+  FT_BEGIN_STMNT                                      \
+    FT_UNUSED( bucket );                              \
+    FT_UNUSED( pnode );                               \
+                                                      \
+    if ( !(node)->referenced )                        \
+      (node)->referenced = 1;                         \
+  FT_END_STMNT
+
+#else /* !FTC_CLOCK */
+
+  /* move a node found by `FTC_CACHE_LOOKUP_CMP' to the top of its */
+  /* bucket and to the head of the manager's MRU list              */
+#define FTC_CACHE_HIT_( cache, bucket, pnode, node )              \
+  FT_BEGIN_STMNT                                                  \
+    if ( (node) != *(bucket) )                                    \
+    {                                                             \
+      *(pnode)     = (node)->link;                                \
+      (node)->link = *(bucket);                                   \
+      *(bucket)    = (node);                                      \
+    }                                                             \
+                                                                  \
+    {                                                             \
+      FTC_Manager  _manager = (cache)->manager;                   \
+      void*        _nl      = &_manager->nodes_list;              \
+                                                                  \
+                                                                  \
+      if ( (node) != _manager->nodes_list )                       \
+        FTC_MruNode_Up( (FTC_MruNode*)_nl,                        \
+                        (FTC_MruNode)(node) );                    \
+    }                                                             \
+  FT_END_STMNT
+
+#endif /* !FTC_CLOCK */
+
 #define FTC_CACHE_LOOKUP_CMP( cache, nodecmp, hash, query, node, error ) \
   FT_BEGIN_STMNT                                                         \
     FTC_Node             *_bucket, *_pnode, _node;                       \
@@ -219,6 +308,9 @@ FT_BEGIN_HEADER
     error = FT_Err_Ok;                                                   \
     node  = NULL;                                                        \
                                                                          \
+    if ( _cache->count_lookups )                                         \
+      _cache->lookups++;                                                 \
+                                                                         \
     /* Go to the `top' node of the list sharing same masked hash */      \
     _bucket = _pnode = FTC_NODE_TOP_FOR_HASH( _cache, _hash );           \
                                                                          \
@@ -255,24 +347,7 @@ FT_BEGIN_HEADER
       }                                                                  \
     }                                                                    \
                                                                          \
-    /* Reorder the list to move the found node to the `top' */           \
-    if ( _node != *_bucket )                                             \
-    {                                                                    \
-      *_pnode     = _node->link;                                         \
-      _node->link = *_bucket;                                            \
-      *_bucket    = _node;                                               \
-    }                                                                    \
-                                                                         \
-    /* Update MRU list */                                                \
-    {                                                                    \
-      FTC_Manager  _manager = _cache->manager;                           \
-      void*        _nl      = &_manager->nodes_list;                     \
-                                                                         \
-                                                                         \
-      if ( _node != _manager->nodes_list )                               \
-        FTC_MruNode_Up( (FTC_MruNode*)_nl,                               \
-                        (FTC_MruNode)_node );                            \
-    }                                                                    \
+    FTC_CACHE_HIT_( _cache, _bucket, _pnode, _node );                    \
     goto Ok_;                                                            \
                                                                          \
   NewNode_:                                                              \
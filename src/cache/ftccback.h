@@ -25,6 +25,8 @@
 #include "ftcmanag.h"
 #include "ftcglyph.h"
 #include "ftcsbits.h"
+#include "ftcphase.h"
+#include "ftcatlas.h"
 
 
   FT_LOCAL( void )
@@ -61,6 +63,44 @@
                      FT_Bool*    list_changed );
 
 
+  FT_LOCAL( void )
+  ftc_pnode_free( FTC_Node   pnode,
+                  FTC_Cache  cache );
+
+  FT_LOCAL( FT_Offset )
+  ftc_pnode_weight( FTC_Node   pnode,
+                    FTC_Cache  cache );
+
+  FT_LOCAL( FT_Error )
+  ftc_pcache_init( FTC_Cache  cache );
+
+
+  FT_LOCAL( void )
+  ftc_anode_free( FTC_Node   anode,
+                  FTC_Cache  cache );
+
+  FT_LOCAL( FT_Error )
+  ftc_anode_new( FTC_Node   *panode,
+                 FT_Pointer  gquery,
+                 FTC_Cache   cache );
+
+  FT_LOCAL( FT_Offset )
+  ftc_anode_weight( FTC_Node   anode,
+                    FTC_Cache  cache );
+
+  FT_LOCAL( FT_Bool )
+  ftc_anode_compare( FTC_Node    anode,
+                     FT_Pointer  gquery,
+                     FTC_Cache   cache,
+                     FT_Bool*    list_changed );
+
+  FT_LOCAL( FT_Error )
+  ftc_acache_init( FTC_Cache  cache );
+
+  FT_LOCAL( void )
+  ftc_acache_done( FTC_Cache  cache );
+
+
   FT_LOCAL( FT_Bool )
   ftc_gnode_compare( FTC_Node    gnode,
                      FT_Pointer  gquery,
@@ -85,6 +125,14 @@
   ftc_node_destroy( FTC_Node     node,
                     FTC_Manager  manager );
 
+  /* account for `plus' bytes added to and `minus' bytes removed from */
+  /* a node after it has been added to its cache                      */
+  FT_LOCAL( void )
+  ftc_node_reweigh( FTC_Node   node,
+                    FTC_Cache  cache,
+                    FT_Offset  plus,
+                    FT_Offset  minus );
+
 
 #endif /* FTCCBACK_H_ */
 
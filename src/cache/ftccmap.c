@@ -82,6 +82,54 @@
 #define FTC_CMAP_UNKNOWN  (FT_UInt16)~0
 
 
+  /**************************************************************************
+   *
+   * A cache created with `FTC_CMapCache_NewFlat' holds a single node per
+   * face and charmap, with a two-level table: a directory indexed by the
+   * upper bits of the character code points to pages of
+   * FTC_CMAP_PAGE_SIZE glyph indices.  Pages are allocated when one of
+   * their character codes is looked up first; the directory only grows
+   * up to the highest page used.
+   *
+   * The cache remembers the table used last, so that lookups for the same
+   * face and charmap need neither hashing nor list updates.
+   *
+   */
+
+#define FTC_CMAP_PAGE_BITS  8
+#define FTC_CMAP_PAGE_SIZE  ( 1 << FTC_CMAP_PAGE_BITS )
+
+  /* character codes above this value are not cached by flat tables */
+#define FTC_CMAP_FLAT_MAX   0x10FFFFUL
+
+#define FTC_CMAP_TABLE_HASH( faceid, index )                  \
+          ( FTC_FACE_ID_HASH( faceid ) + 211 * (index) )
+
+  /* the flat cmap table node */
+  typedef struct  FTC_CMapTableRec_
+  {
+    FTC_NodeRec  node;
+    FTC_FaceID   face_id;
+    FT_UInt      cmap_index;
+    FT_UInt      num_pages;   /* size of the directory          */
+    FT_UInt      used_pages;  /* number of allocated pages      */
+    FT_UInt16**  pages;       /* NULL entries for unused pages  */
+
+  } FTC_CMapTableRec, *FTC_CMapTable;
+
+#define FTC_CMAP_TABLE( x )  ( (FTC_CMapTable)( x ) )
+
+
+  typedef struct  FTC_CMapCacheRec_
+  {
+    FTC_CacheRec   cache;
+    FTC_CMapTable  last;      /* table used last, or NULL */
+
+  } FTC_CMapCacheRec;
+
+#define FTC_CMAP_CACHE( x )  ( (FTC_CMapCache)( x ) )
+
+
   /*************************************************************************/
   /*************************************************************************/
   /*****                                                               *****/
@@ -95,11 +143,10 @@
   ftc_cmap_node_free( FTC_Node   ftcnode,
                       FTC_Cache  cache )
   {
-    FTC_CMapNode  node   = (FTC_CMapNode)ftcnode;
-    FT_Memory     memory = cache->memory;
+    FTC_CMapNode  node = (FTC_CMapNode)ftcnode;
 
 
-    FT_FREE( node );
+    FTC_SLAB_FREE( &cache->manager->slabs, node, sizeof ( *node ) );
   }
 
 
@@ -112,12 +159,11 @@
     FTC_CMapNode  *anode  = (FTC_CMapNode*)ftcanode;
     FTC_CMapQuery  query  = (FTC_CMapQuery)ftcquery;
     FT_Error       error;
-    FT_Memory      memory = cache->memory;
     FTC_CMapNode   node   = NULL;
     FT_UInt        nn;
 
 
-    if ( !FT_NEW( node ) )
+    if ( !FTC_SLAB_NEW( &cache->manager->slabs, node ) )
     {
       node->face_id    = query->face_id;
       node->cmap_index = query->cmap_index;
@@ -141,7 +187,7 @@
     FT_UNUSED( cnode );
     FT_UNUSED( cache );
 
-    return sizeof ( *cnode );
+    return FTC_SLAB_ROUND_SIZE( sizeof ( FTC_CMapNodeRec ) );
   }
 
 
@@ -189,6 +235,186 @@
   }
 
 
+  FT_CALLBACK_DEF( FTC_FaceID )
+  ftc_cmap_node_face_id( FTC_Node   ftcnode,
+                         FTC_Cache  cache )
+  {
+    FT_UNUSED( cache );
+
+    return FTC_CMAP_NODE( ftcnode )->face_id;
+  }
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                      FLAT CHARMAP TABLES                      *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  FT_CALLBACK_DEF( void )
+  ftc_cmap_table_free( FTC_Node   ftcnode,
+                       FTC_Cache  cache )
+  {
+    FTC_CMapTable  table  = (FTC_CMapTable)ftcnode;
+    FTC_SlabPool   pool   = &cache->manager->slabs;
+    FT_Memory      memory = cache->memory;
+    FT_UInt        nn;
+
+
+    if ( FTC_CMAP_CACHE( cache )->last == table )
+      FTC_CMAP_CACHE( cache )->last = NULL;
+
+    for ( nn = 0; nn < table->num_pages; nn++ )
+      FTC_SLAB_FREE( pool, table->pages[nn],
+                     FTC_CMAP_PAGE_SIZE * sizeof ( FT_UInt16 ) );
+
+    FT_FREE( table->pages );
+    FTC_SLAB_FREE( pool, table, sizeof ( *table ) );
+  }
+
+
+  FT_CALLBACK_DEF( FT_Error )
+  ftc_cmap_table_new( FTC_Node   *ftcatable,
+                      FT_Pointer  ftcquery,
+                      FTC_Cache   cache )
+  {
+    FTC_CMapTable  *atable = (FTC_CMapTable*)ftcatable;
+    FTC_CMapQuery   query  = (FTC_CMapQuery)ftcquery;
+    FT_Error        error;
+    FTC_CMapTable   table  = NULL;
+
+
+    if ( !FTC_SLAB_NEW( &cache->manager->slabs, table ) )
+    {
+      table->face_id    = query->face_id;
+      table->cmap_index = query->cmap_index;
+    }
+
+    *atable = table;
+    return error;
+  }
+
+
+  FT_CALLBACK_DEF( FT_Offset )
+  ftc_cmap_table_weight( FTC_Node   ftcnode,
+                         FTC_Cache  cache )
+  {
+    FTC_CMapTable  table = (FTC_CMapTable)ftcnode;
+
+    FT_UNUSED( cache );
+
+
+    return FTC_SLAB_ROUND_SIZE( sizeof ( FTC_CMapTableRec ) )            +
+           table->num_pages * sizeof ( FT_UInt16* )                     +
+           table->used_pages * FTC_CMAP_PAGE_SIZE * sizeof ( FT_UInt16 );
+  }
+
+
+  FT_CALLBACK_DEF( FT_Bool )
+  ftc_cmap_table_compare( FTC_Node    ftcnode,
+                          FT_Pointer  ftcquery,
+                          FTC_Cache   cache,
+                          FT_Bool*    list_changed )
+  {
+    FTC_CMapTable  table = (FTC_CMapTable)ftcnode;
+    FTC_CMapQuery  query = (FTC_CMapQuery)ftcquery;
+
+    FT_UNUSED( cache );
+
+
+    if ( list_changed )
+      *list_changed = FALSE;
+
+    return FT_BOOL( table->face_id    == query->face_id    &&
+                    table->cmap_index == query->cmap_index );
+  }
+
+
+  FT_CALLBACK_DEF( FT_Bool )
+  ftc_cmap_table_remove_faceid( FTC_Node    ftcnode,
+                                FT_Pointer  ftcface_id,
+                                FTC_Cache   cache,
+                                FT_Bool*    list_changed )
+  {
+    FT_UNUSED( cache );
+
+    if ( list_changed )
+      *list_changed = FALSE;
+
+    return FT_BOOL( FTC_CMAP_TABLE( ftcnode )->face_id ==
+                    (FTC_FaceID)ftcface_id );
+  }
+
+
+  FT_CALLBACK_DEF( FTC_FaceID )
+  ftc_cmap_table_face_id( FTC_Node   ftcnode,
+                          FTC_Cache  cache )
+  {
+    FT_UNUSED( cache );
+
+    return FTC_CMAP_TABLE( ftcnode )->face_id;
+  }
+
+
+  /* return the page of `table' for `char_code', allocating it if */
+  /* necessary; NULL if out of memory                             */
+  static FT_UInt16*
+  ftc_cmap_table_get_page( FTC_CMapTable  table,
+                           FTC_Cache      cache,
+                           FT_UInt32      char_code )
+  {
+    FT_Memory   memory = cache->memory;
+    FT_Error    error;
+    FT_UInt     idx    = (FT_UInt)( char_code >> FTC_CMAP_PAGE_BITS );
+    FT_UInt16*  page;
+    FT_UInt     nn;
+
+
+    if ( idx >= table->num_pages )
+    {
+      FT_UInt  new_pages = idx + 1;
+
+
+      /* grow the directory by at least 1/4 */
+      if ( new_pages < table->num_pages + ( table->num_pages >> 2 ) )
+        new_pages = table->num_pages + ( table->num_pages >> 2 );
+      if ( new_pages > ( FTC_CMAP_FLAT_MAX >> FTC_CMAP_PAGE_BITS ) + 1 )
+        new_pages = ( FTC_CMAP_FLAT_MAX >> FTC_CMAP_PAGE_BITS ) + 1;
+
+      if ( FT_RENEW_ARRAY( table->pages, table->num_pages, new_pages ) )
+        return NULL;
+
+      ftc_node_reweigh( FTC_NODE( table ), cache,
+                        ( new_pages - table->num_pages ) *
+                          sizeof ( FT_UInt16* ),
+                        0 );
+      table->num_pages = new_pages;
+    }
+
+    page = table->pages[idx];
+    if ( !page )
+    {
+      if ( FTC_SLAB_QALLOC( &cache->manager->slabs, page,
+                            FTC_CMAP_PAGE_SIZE * sizeof ( FT_UInt16 ) ) )
+        return NULL;
+
+      for ( nn = 0; nn < FTC_CMAP_PAGE_SIZE; nn++ )
+        page[nn] = FTC_CMAP_UNKNOWN;
+
+      table->pages[idx] = page;
+      table->used_pages++;
+
+      ftc_node_reweigh( FTC_NODE( table ), cache,
+                        FTC_CMAP_PAGE_SIZE * sizeof ( FT_UInt16 ), 0 );
+    }
+
+    return page;
+  }
+
+
   /*************************************************************************/
   /*************************************************************************/
   /*****                                                               *****/
@@ -206,13 +432,30 @@
     ftc_cmap_node_compare,       /* FTC_Node_CompareFunc  node_compare       */
     ftc_cmap_node_remove_faceid, /* FTC_Node_CompareFunc  node_remove_faceid */
     ftc_cmap_node_free,          /* FTC_Node_FreeFunc     node_free          */
+    ftc_cmap_node_face_id,       /* FTC_Node_FaceIDFunc   node_face_id       */
 
-    sizeof ( FTC_CacheRec ),
+    sizeof ( FTC_CMapCacheRec ),
     ftc_cache_init,              /* FTC_Cache_InitFunc    cache_init         */
     ftc_cache_done,              /* FTC_Cache_DoneFunc    cache_done         */
   };
 
 
+  static
+  const FTC_CacheClassRec  ftc_cmap_flat_cache_class =
+  {
+    ftc_cmap_table_new,           /* FTC_Node_NewFunc      node_new           */
+    ftc_cmap_table_weight,        /* FTC_Node_WeightFunc   node_weight        */
+    ftc_cmap_table_compare,       /* FTC_Node_CompareFunc  node_compare       */
+    ftc_cmap_table_remove_faceid, /* FTC_Node_CompareFunc  node_remove_faceid */
+    ftc_cmap_table_free,          /* FTC_Node_FreeFunc     node_free          */
+    ftc_cmap_table_face_id,       /* FTC_Node_FaceIDFunc   node_face_id       */
+
+    sizeof ( FTC_CMapCacheRec ),
+    ftc_cache_init,               /* FTC_Cache_InitFunc    cache_init         */
+    ftc_cache_done,               /* FTC_Cache_DoneFunc    cache_done         */
+  };
+
+
   /* documentation is in ftcache.h */
 
   FT_EXPORT_DEF( FT_Error )
@@ -225,6 +468,151 @@
   }
 
 
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_CMapCache_NewFlat( FTC_Manager     manager,
+                         FTC_CMapCache  *acache )
+  {
+    return FTC_Manager_RegisterCache( manager,
+                                      &ftc_cmap_flat_cache_class,
+                                      FTC_CACHE_P( acache ) );
+  }
+
+
+  /* map `char_code' with a face's charmap */
+  static FT_Error
+  ftc_cmap_get_index( FTC_Cache   cache,
+                      FTC_FaceID  face_id,
+                      FT_UInt     cmap_index,
+                      FT_Bool     no_cmap_change,
+                      FT_UInt32   char_code,
+                      FT_UInt    *agindex )
+  {
+    FT_Face   face;
+    FT_Error  error;
+
+
+    *agindex = 0;
+
+    error = FTC_Manager_LookupFace( cache->manager, face_id, &face );
+    if ( error )
+      return error;
+
+    if ( cmap_index < (FT_UInt)face->num_charmaps )
+    {
+      FT_CharMap  old, cmap  = NULL;
+
+
+      old  = face->charmap;
+      cmap = face->charmaps[cmap_index];
+
+      if ( old != cmap && !no_cmap_change )
+        FT_Set_Charmap( face, cmap );
+
+      *agindex = FT_Get_Char_Index( face, char_code );
+
+      if ( old != cmap && !no_cmap_change )
+        FT_Set_Charmap( face, old );
+    }
+
+    return FT_Err_Ok;
+  }
+
+
+  static FT_UInt
+  ftc_cmap_flat_lookup( FTC_Cache   cache,
+                        FTC_FaceID  face_id,
+                        FT_UInt     cmap_index,
+                        FT_Bool     no_cmap_change,
+                        FT_UInt32   char_code )
+  {
+    FTC_CMapTable  table;
+    FT_UInt16*     page;
+    FT_UInt        gindex = 0;
+    FT_Offset      hash;
+    FT_ULong       start;
+    FT_Error       error;
+
+
+    hash  = FTC_CMAP_TABLE_HASH( face_id, cmap_index );
+    cache = FTC_CACHE_LOCK( cache, hash );
+
+    table = FTC_CMAP_CACHE( cache )->last;
+    if ( table                            &&
+         table->face_id    == face_id     &&
+         table->cmap_index == cmap_index  )
+    {
+      if ( cache->count_lookups )
+        cache->lookups++;
+
+#ifdef FTC_CLOCK
+      if ( !FTC_NODE( table )->referenced )
+        FTC_NODE( table )->referenced = 1;
+#else
+      if ( FTC_NODE( table ) != cache->manager->nodes_list )
+        FTC_MruNode_Up( (FTC_MruNode*)(void*)&cache->manager->nodes_list,
+                        (FTC_MruNode)table );
+#endif
+    }
+    else
+    {
+      FTC_CMapQueryRec  query;
+      FTC_Node          node;
+
+
+      query.face_id    = face_id;
+      query.cmap_index = cmap_index;
+      query.char_code  = char_code;
+
+      FTC_CACHE_LOOKUP_CMP( cache, ftc_cmap_table_compare, hash, &query,
+                            node, error );
+      if ( error )
+      {
+        /* `table' is the last table; don't protect it */
+        table = NULL;
+        goto Exit;
+      }
+
+      table = FTC_CMAP_TABLE( node );
+      FTC_CMAP_CACHE( cache )->last = table;
+    }
+
+    if ( char_code <= FTC_CMAP_FLAT_MAX )
+    {
+      FT_UInt  idx = (FT_UInt)( char_code >> FTC_CMAP_PAGE_BITS );
+
+
+      if ( idx < table->num_pages && table->pages[idx] )
+      {
+        gindex = table->pages[idx][char_code & ( FTC_CMAP_PAGE_SIZE - 1 )];
+        if ( gindex != FTC_CMAP_UNKNOWN )
+          goto Exit;
+      }
+    }
+
+    start = FTC_Cache_BeginMiss( cache );
+    error = ftc_cmap_get_index( cache, face_id, cmap_index, no_cmap_change,
+                                char_code, &gindex );
+    FTC_Cache_EndMiss( cache, start );
+
+    /* if out of memory, the glyph index is simply not cached */
+    if ( !error                         &&
+         char_code <= FTC_CMAP_FLAT_MAX &&
+         gindex < FTC_CMAP_UNKNOWN      )
+    {
+      page = ftc_cmap_table_get_page( table, cache, char_code );
+      if ( page )
+        page[char_code & ( FTC_CMAP_PAGE_SIZE - 1 )] = (FT_UInt16)gindex;
+    }
+
+  Exit:
+    FTC_CACHE_UNLOCK( cache, FTC_NODE( table ) );
+
+    return gindex;
+  }
+
+
   /* documentation is in ftcache.h */
 
   FT_EXPORT_DEF( FT_UInt )
@@ -259,11 +647,16 @@
       return 0;
     }
 
+    if ( cache->org_class == &ftc_cmap_flat_cache_class )
+      return ftc_cmap_flat_lookup( cache, face_id, (FT_UInt)cmap_index,
+                                   (FT_Bool)no_cmap_change, char_code );
+
     query.face_id    = face_id;
     query.cmap_index = (FT_UInt)cmap_index;
     query.char_code  = char_code;
 
-    hash = FTC_CMAP_HASH( face_id, (FT_UInt)cmap_index, char_code );
+    hash  = FTC_CMAP_HASH( face_id, (FT_UInt)cmap_index, char_code );
+    cache = FTC_CACHE_LOCK( cache, hash );
 
 #if 1
     FTC_CACHE_LOOKUP_CMP( cache, ftc_cmap_node_compare, hash, &query,
@@ -280,46 +673,29 @@
     /* something rotten can happen with rogue clients */
     if ( (FT_UInt)( char_code - FTC_CMAP_NODE( node )->first >=
                     FTC_CMAP_INDICES_MAX ) )
-      return 0; /* XXX: should return appropriate error */
+      goto Exit; /* XXX: should return appropriate error */
 
     gindex = FTC_CMAP_NODE( node )->indices[char_code -
                                             FTC_CMAP_NODE( node )->first];
     if ( gindex == FTC_CMAP_UNKNOWN )
     {
-      FT_Face  face;
-
-
-      gindex = 0;
-
-      error = FTC_Manager_LookupFace( cache->manager,
-                                      FTC_CMAP_NODE( node )->face_id,
-                                      &face );
+      error = ftc_cmap_get_index( cache,
+                                  FTC_CMAP_NODE( node )->face_id,
+                                  (FT_UInt)cmap_index,
+                                  (FT_Bool)no_cmap_change,
+                                  char_code,
+                                  &gindex );
       if ( error )
         goto Exit;
 
-      if ( (FT_UInt)cmap_index < (FT_UInt)face->num_charmaps )
-      {
-        FT_CharMap  old, cmap  = NULL;
-
-
-        old  = face->charmap;
-        cmap = face->charmaps[cmap_index];
-
-        if ( old != cmap && !no_cmap_change )
-          FT_Set_Charmap( face, cmap );
-
-        gindex = FT_Get_Char_Index( face, char_code );
-
-        if ( old != cmap && !no_cmap_change )
-          FT_Set_Charmap( face, old );
-      }
-
       FTC_CMAP_NODE( node )->indices[char_code -
                                      FTC_CMAP_NODE( node )->first]
         = (FT_UShort)gindex;
     }
 
   Exit:
+    FTC_CACHE_UNLOCK( cache, NULL );
+
     return gindex;
   }
 
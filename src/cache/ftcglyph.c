@@ -132,6 +132,8 @@
                         0,  /* no maximum here! */
                         cache,
                         FTC_CACHE( cache )->memory );
+
+      FTC_CACHE( cache )->families = &cache->families;
     }
 
     return error;
@@ -32,7 +32,6 @@
                   FTC_Cache  cache )
   {
     FTC_INode  inode = (FTC_INode)ftcinode;
-    FT_Memory  memory = cache->memory;
 
 
     if ( inode->glyph )
@@ -42,7 +41,7 @@
     }
 
     FTC_GNode_Done( FTC_GNODE( inode ), cache );
-    FT_FREE( inode );
+    FTC_SLAB_FREE( &cache->manager->slabs, inode, sizeof ( *inode ) );
   }
 
 
@@ -60,12 +59,11 @@
                  FTC_GQuery   gquery,
                  FTC_Cache    cache )
   {
-    FT_Memory  memory = cache->memory;
     FT_Error   error;
     FTC_INode  inode  = NULL;
 
 
-    if ( !FT_NEW( inode ) )
+    if ( !FTC_SLAB_NEW( &cache->manager->slabs, inode ) )
     {
       FTC_GNode         gnode  = FTC_GNODE( inode );
       FTC_Family        family = gquery->family;
@@ -145,7 +143,8 @@
       ;
     }
 
-    size += sizeof ( *inode );
+    /* the glyph image is on the heap, the node in the slab pool */
+    size += FTC_SLAB_ROUND_SIZE( sizeof ( *inode ) );
     return size;
   }
 
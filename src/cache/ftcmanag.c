@@ -24,6 +24,7 @@
 #include FT_SIZES_H
 
 #include "ftccback.h"
+#include "ftcstore.h"
 #include "ftcerror.h"
 
 
@@ -32,19 +33,14 @@
 
 
   static FT_Error
-  ftc_scaler_lookup_size( FTC_Manager  manager,
-                          FTC_Scaler   scaler,
-                          FT_Size     *asize )
+  ftc_face_new_size( FT_Face     face,
+                     FTC_Scaler  scaler,
+                     FT_Size    *asize )
   {
-    FT_Face   face;
     FT_Size   size = NULL;
     FT_Error  error;
 
 
-    error = FTC_Manager_LookupFace( manager, scaler->face_id, &face );
-    if ( error )
-      goto Exit;
-
     error = FT_New_Size( face, &size );
     if ( error )
       goto Exit;
@@ -71,6 +67,26 @@
   }
 
 
+  static FT_Error
+  ftc_scaler_lookup_size( FTC_Manager  manager,
+                          FTC_Scaler   scaler,
+                          FT_Size     *asize )
+  {
+    FT_Face   face;
+    FT_Error  error;
+
+
+    error = FTC_Manager_LookupFace( manager, scaler->face_id, &face );
+    if ( error )
+    {
+      *asize = NULL;
+      return error;
+    }
+
+    return ftc_face_new_size( face, scaler, asize );
+  }
+
+
   typedef struct  FTC_SizeNodeRec_
   {
     FTC_MruNodeRec  node;
@@ -173,498 +189,2093 @@
   }
 
 
-  /* documentation is in ftcache.h */
-
-  FT_EXPORT_DEF( FT_Error )
-  FTC_Manager_LookupSize( FTC_Manager  manager,
-                          FTC_Scaler   scaler,
-                          FT_Size     *asize )
-  {
-    FT_Error     error;
-    FTC_MruNode  mrunode;
-
-
-    if ( !asize || !scaler )
-      return FT_THROW( Invalid_Argument );
-
-    *asize = NULL;
-
-    if ( !manager )
-      return FT_THROW( Invalid_Cache_Handle );
-
-#ifdef FTC_INLINE
-
-    FTC_MRULIST_LOOKUP_CMP( &manager->sizes, scaler, ftc_size_node_compare,
-                            mrunode, error );
-
-#else
-    error = FTC_MruList_Lookup( &manager->sizes, scaler, &mrunode );
-#endif
-
-    if ( !error )
-      *asize = FTC_SIZE_NODE( mrunode )->size;
-
-    return error;
-  }
-
-
   /*************************************************************************/
   /*************************************************************************/
   /*****                                                               *****/
-  /*****                    FACE MRU IMPLEMENTATION                    *****/
+  /*****                  FACE POOL IMPLEMENTATION                     *****/
   /*****                                                               *****/
   /*************************************************************************/
   /*************************************************************************/
 
-  typedef struct  FTC_FaceNodeRec_
+  /*
+   * The face pool of a concurrent manager holds FT_Face objects, each one
+   * with a small MRU list of FT_Size objects.  A face ID can have several
+   * entries since an entry is used by one thread at a time: a shard takes
+   * the entries it needs while it is locked and gives them back when it
+   * gets unlocked; `FTC_Manager_AcquireSize' hands out entries to client
+   * applications.
+   *
+   * The pool is protected by the root manager's lock.  Faces are opened
+   * and closed without it, so that a cold miss doesn't block the other
+   * shards; the root's `face_lock' serializes these calls instead, as
+   * required for the library.  While a face gets opened, its entry is in
+   * the pool as a busy placeholder with a NULL `face' field.
+   */
+
+  typedef struct  FTC_PoolFaceRec_
   {
-    FTC_MruNodeRec  node;
+    FTC_PoolFace    next;       /* in the root's pool, MRU first     */
+    FTC_PoolFace    link;       /* in the list of entries of a shard */
     FTC_FaceID      face_id;
     FT_Face         face;
+    FT_Bool         busy;
+    FT_Bool         removed;    /* destroy when given back           */
+    FTC_MruListRec  sizes;      /* owned by the shard while busy     */
+    FT_UInt         num_sizes;  /* `sizes.num_nodes' when released   */
+    FT_Bool         has_key;
+    FT_UInt32       key[FTC_STORE_FACE_KEY_SIZE];
 
-  } FTC_FaceNodeRec, *FTC_FaceNode;
-
-#define FTC_FACE_NODE( x ) ( ( FTC_FaceNode )( x ) )
+  } FTC_PoolFaceRec;
 
 
   FT_CALLBACK_DEF( FT_Error )
-  ftc_face_node_init( FTC_MruNode  ftcnode,
-                      FT_Pointer   ftcface_id,
-                      FT_Pointer   ftcmanager )
+  ftc_pool_size_node_init( FTC_MruNode  ftcnode,
+                           FT_Pointer   ftcscaler,
+                           FT_Pointer   ftcpface )
   {
-    FTC_FaceNode  node    = (FTC_FaceNode)ftcnode;
-    FTC_FaceID    face_id = (FTC_FaceID)ftcface_id;
-    FTC_Manager   manager = (FTC_Manager)ftcmanager;
-    FT_Error      error;
-
+    FTC_SizeNode  node   = (FTC_SizeNode)ftcnode;
+    FTC_Scaler    scaler = (FTC_Scaler)ftcscaler;
+    FTC_PoolFace  pface  = (FTC_PoolFace)ftcpface;
 
-    node->face_id = face_id;
 
-    error = manager->request_face( face_id,
-                                   manager->library,
-                                   manager->request_data,
-                                   &node->face );
-    if ( !error )
-    {
-      /* destroy initial size object; it will be re-created later */
-      if ( node->face->size )
-        FT_Done_Size( node->face->size );
-    }
+    node->scaler = scaler[0];
 
-    return error;
+    return ftc_face_new_size( pface->face, scaler, &node->size );
   }
 
 
-  FT_CALLBACK_DEF( void )
-  ftc_face_node_done( FTC_MruNode  ftcnode,
-                      FT_Pointer   ftcmanager )
+  FT_CALLBACK_DEF( FT_Error )
+  ftc_pool_size_node_reset( FTC_MruNode  ftcnode,
+                            FT_Pointer   ftcscaler,
+                            FT_Pointer   ftcpface )
   {
-    FTC_FaceNode  node    = (FTC_FaceNode)ftcnode;
-    FTC_Manager   manager = (FTC_Manager)ftcmanager;
+    FTC_SizeNode  node = (FTC_SizeNode)ftcnode;
 
 
-    /* we must begin by removing all scalers for the target face */
-    /* from the manager's list                                   */
-    FTC_MruList_RemoveSelection( &manager->sizes,
-                                 ftc_size_node_compare_faceid,
-                                 node->face_id );
+    FT_Done_Size( node->size );
 
-    /* all right, we can discard the face now */
-    FT_Done_Face( node->face );
-    node->face    = NULL;
-    node->face_id = NULL;
+    return ftc_pool_size_node_init( ftcnode, ftcscaler, ftcpface );
   }
 
 
-  FT_CALLBACK_DEF( FT_Bool )
-  ftc_face_node_compare( FTC_MruNode  ftcnode,
-                         FT_Pointer   ftcface_id )
+  static
+  const FTC_MruListClassRec  ftc_pool_size_list_class =
   {
-    FTC_FaceNode  node    = (FTC_FaceNode)ftcnode;
-    FTC_FaceID    face_id = (FTC_FaceID)ftcface_id;
-
+    sizeof ( FTC_SizeNodeRec ),
 
-    return FT_BOOL( node->face_id == face_id );
-  }
+    ftc_size_node_compare,     /* FTC_MruNode_CompareFunc  node_compare */
+    ftc_pool_size_node_init,   /* FTC_MruNode_InitFunc     node_init    */
+    ftc_pool_size_node_reset,  /* FTC_MruNode_ResetFunc    node_reset   */
+    ftc_size_node_done         /* FTC_MruNode_DoneFunc     node_done    */
+  };
 
 
-  static
-  const FTC_MruListClassRec  ftc_face_list_class =
+  static void
+  ftc_pool_face_done( FTC_Manager   manager,
+                      FTC_PoolFace  pface )
   {
-    sizeof ( FTC_FaceNodeRec),
+    FT_Memory  memory = manager->memory;
 
-    ftc_face_node_compare,  /* FTC_MruNode_CompareFunc  node_compare */
-    ftc_face_node_init,     /* FTC_MruNode_InitFunc     node_init    */
-    NULL,                   /* FTC_MruNode_ResetFunc    node_reset   */
-    ftc_face_node_done      /* FTC_MruNode_DoneFunc     node_done    */
-  };
 
+    FTC_MruList_Done( &pface->sizes );
+    FT_Done_Face( pface->face );
+    FT_FREE( pface );
+  }
 
-  /* documentation is in ftcache.h */
 
-  FT_EXPORT_DEF( FT_Error )
-  FTC_Manager_LookupFace( FTC_Manager  manager,
-                          FTC_FaceID   face_id,
-                          FT_Face     *aface )
+  /* unlock the root and destroy the entries flushed while it was locked */
+  static void
+  ftc_pool_unlock( FTC_Manager  manager )
   {
-    FT_Error     error;
-    FTC_MruNode  mrunode;
+    FTC_PoolFace  pface = manager->pool_dead;
+    FTC_PoolFace  next;
 
 
-    if ( !aface )
-      return FT_THROW( Invalid_Argument );
+    manager->pool_dead = NULL;
+    manager->locker.unlock( manager->lock );
 
-    *aface = NULL;
+    if ( !pface )
+      return;
 
-    if ( !manager )
-      return FT_THROW( Invalid_Cache_Handle );
+    manager->locker.lock( manager->face_lock );
 
-    /* we break encapsulation for the sake of speed */
-#ifdef FTC_INLINE
+    for ( ; pface; pface = next )
+    {
+      next = pface->next;
+      ftc_pool_face_done( manager, pface );
+    }
 
-    FTC_MRULIST_LOOKUP_CMP( &manager->faces, face_id, ftc_face_node_compare,
-                            mrunode, error );
+    manager->locker.unlock( manager->face_lock );
+  }
 
-#else
-    error = FTC_MruList_Lookup( &manager->faces, face_id, &mrunode );
-#endif
 
-    if ( !error )
-      *aface = FTC_FACE_NODE( mrunode )->face;
+  /* remove unused entries except the `max_idle' most recently used  */
+  /* ones; removed entries are always flushed.  The caller holds the */
+  /* root's lock and must release it with `ftc_pool_unlock'          */
+  static void
+  ftc_pool_flush( FTC_Manager  manager,
+                  FT_UInt      max_idle )
+  {
+    FTC_PoolFace*  ppface = &manager->pool;
+    FTC_PoolFace   pface;
+    FT_UInt        idle = 0;
 
-    return error;
-  }
 
+    while ( ( pface = *ppface ) != NULL )
+    {
+      if ( !pface->busy && ( pface->removed || idle >= max_idle ) )
+      {
+        *ppface = pface->next;
+        manager->pool_idle--;
 
-  /*************************************************************************/
-  /*************************************************************************/
-  /*****                                                               *****/
-  /*****                    CACHE MANAGER ROUTINES                     *****/
-  /*****                                                               *****/
-  /*************************************************************************/
-  /*************************************************************************/
+        pface->next        = manager->pool_dead;
+        manager->pool_dead = pface;
+        continue;
+      }
 
+      if ( !pface->busy )
+        idle++;
 
-  /* documentation is in ftcache.h */
+      ppface = &pface->next;
+    }
+  }
 
-  FT_EXPORT_DEF( FT_Error )
-  FTC_Manager_New( FT_Library          library,
-                   FT_UInt             max_faces,
-                   FT_UInt             max_sizes,
-                   FT_ULong            max_bytes,
-                   FTC_Face_Requester  requester,
-                   FT_Pointer          req_data,
-                   FTC_Manager        *amanager )
+
+  /* take an unused entry for `face_id' from the pool, or create a new */
+  /* one; the caller holds the root's lock, which is released while    */
+  /* the face gets opened                                              */
+  static FT_Error
+  ftc_pool_acquire( FTC_Manager    manager,
+                    FTC_FaceID     face_id,
+                    FTC_PoolFace  *apface )
   {
-    FT_Error     error;
-    FT_Memory    memory;
-    FTC_Manager  manager = 0;
+    FT_Memory      memory = manager->memory;
+    FT_Error       error  = FT_Err_Ok;
+    FTC_PoolFace*  ppface = &manager->pool;
+    FTC_PoolFace   pface;
+    FT_Face        face   = NULL;
 
 
-    if ( !library )
-      return FT_THROW( Invalid_Library_Handle );
+    for (;;)
+    {
+      pface = *ppface;
+      if ( !pface )
+        break;
 
-    if ( !amanager || !requester )
-      return FT_THROW( Invalid_Argument );
+      if ( !pface->busy && !pface->removed && pface->face_id == face_id )
+      {
+        *ppface = pface->next;
+        manager->pool_idle--;
+        goto Found;
+      }
 
-    memory = library->memory;
+      ppface = &pface->next;
+    }
 
-    if ( FT_NEW( manager ) )
+    if ( FT_NEW( pface ) )
       goto Exit;
 
-    if ( max_faces == 0 )
-      max_faces = FTC_MAX_FACES_DEFAULT;
+    /* a placeholder, so that `FTC_Manager_RemoveFaceID' can mark it */
+    pface->face_id = face_id;
+    pface->busy    = 1;
+    pface->next    = manager->pool;
+    manager->pool  = pface;
 
-    if ( max_sizes == 0 )
-      max_sizes = FTC_MAX_SIZES_DEFAULT;
+    FTC_MruList_Init( &pface->sizes,
+                      &ftc_pool_size_list_class,
+                      manager->pool_sizes,
+                      pface,
+                      memory );
 
-    if ( max_bytes == 0 )
-      max_bytes = FTC_MAX_BYTES_DEFAULT;
+    manager->locker.unlock( manager->lock );
+    manager->locker.lock( manager->face_lock );
 
-    manager->library      = library;
-    manager->memory       = memory;
-    manager->max_weight   = max_bytes;
+    error = manager->request_face( face_id,
+                                   manager->library,
+                                   manager->request_data,
+                                   &face );
 
-    manager->request_face = requester;
-    manager->request_data = req_data;
+    /* destroy initial size object; it will be re-created later */
+    if ( !error && face->size )
+      FT_Done_Size( face->size );
 
-    FTC_MruList_Init( &manager->faces,
-                      &ftc_face_list_class,
-                      max_faces,
-                      manager,
-                      memory );
+    manager->locker.unlock( manager->face_lock );
+    manager->locker.lock( manager->lock );
 
-    FTC_MruList_Init( &manager->sizes,
-                      &ftc_size_list_class,
-                      max_sizes,
-                      manager,
-                      memory );
+    if ( error )
+    {
+      for ( ppface = &manager->pool; *ppface != pface; )
+        ppface = &(*ppface)->next;
 
-    *amanager = manager;
+      *ppface = pface->next;
+      FT_FREE( pface );
+      goto Exit;
+    }
+
+    /* other threads read the `face' field of busy entries */
+    pface->face = face;
+    goto Exit;
+
+  Found:
+    pface->busy   = 1;
+    pface->next   = manager->pool;
+    manager->pool = pface;
 
   Exit:
+    *apface = pface;
     return error;
   }
 
 
-  /* documentation is in ftcache.h */
-
-  FT_EXPORT_DEF( void )
-  FTC_Manager_Done( FTC_Manager  manager )
+  /* give back an entry; the caller holds the root's lock and must */
+  /* release it with `ftc_pool_unlock'                              */
+  static void
+  ftc_pool_release( FTC_Manager   manager,
+                    FTC_PoolFace  pface )
   {
-    FT_Memory  memory;
-    FT_UInt    idx;
+    pface->busy = 0;
+    manager->pool_idle++;
 
+    if ( pface->sizes.max_nodes != manager->pool_sizes )
+      FTC_MruList_SetMax( &pface->sizes, manager->pool_sizes );
 
-    if ( !manager || !manager->library )
-      return;
+    pface->num_sizes = pface->sizes.num_nodes;
 
-    memory = manager->memory;
+    if ( pface->removed || manager->pool_idle > manager->pool_faces )
+      ftc_pool_flush( manager, manager->pool_faces );
+  }
 
-    /* now discard all caches */
-    for (idx = manager->num_caches; idx-- > 0; )
-    {
-      FTC_Cache  cache = manager->caches[idx];
 
+  /* get a size object of an entry in use */
+  static FT_Error
+  ftc_pool_lookup_size( FTC_PoolFace  pface,
+                        FTC_Scaler    scaler,
+                        FT_Size      *asize )
+  {
+    FT_Error     error;
+    FTC_MruNode  mrunode;
 
-      if ( cache )
-      {
-        cache->clazz.cache_done( cache );
-        FT_FREE( cache );
-        manager->caches[idx] = NULL;
-      }
-    }
-    manager->num_caches = 0;
 
-    /* discard faces and sizes */
-    FTC_MruList_Done( &manager->sizes );
-    FTC_MruList_Done( &manager->faces );
+    FTC_MRULIST_LOOKUP( &pface->sizes, scaler, mrunode, error );
 
-    manager->library = NULL;
-    manager->memory  = NULL;
+    *asize = error ? NULL : FTC_SIZE_NODE( mrunode )->size;
+    return error;
+  }
+
+
+  /* get the entry for `face_id' of a locked shard */
+  static FT_Error
+  ftc_shard_lookup_face( FTC_Manager    shard,
+                         FTC_FaceID     face_id,
+                         FTC_PoolFace  *apface )
+  {
+    FTC_Manager   root  = shard->root;
+    FT_Error      error = FT_Err_Ok;
+    FTC_PoolFace  pface;
+
+
+    for ( pface = shard->held; pface; pface = pface->link )
+      if ( pface->face_id == face_id )
+        goto Exit;
+
+    root->locker.lock( root->lock );
+    error = ftc_pool_acquire( root, face_id, &pface );
+    root->locker.unlock( root->lock );
+
+    if ( !error )
+    {
+      pface->link = shard->held;
+      shard->held = pface;
+    }
+
+  Exit:
+    *apface = pface;
+    return error;
+  }
+
+
+  /* destroy an old node to make room, updating the statistics */
+  static void
+  ftc_manager_evict( FTC_Manager  manager,
+                     FTC_Node     node )
+  {
+    FTC_Cache  cache;
+
+
+    /* nodes of removed faces are not reported */
+    if ( !node->removed                                   &&
+         (FT_UInt)node->cache_index < manager->num_caches )
+    {
+      cache = manager->caches[node->cache_index];
+      cache->evictions++;
+
+      if ( manager->hooks.evict )
+      {
+        FTC_Manager  top = manager->root ? manager->root : manager;
+
+
+        /* report the cache handle known to the client */
+        manager->hooks.evict( top->caches[node->cache_index],
+                              cache->clazz.node_weight( node, cache ),
+                              manager->hooks.data );
+      }
+    }
+
+    ftc_node_destroy( node, manager );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_Manager_EvictNode( FTC_Manager  manager,
+                         FTC_Node     node )
+  {
+    ftc_manager_evict( manager, node );
+  }
+
+
+  /* Flush at least one old node, then continue until the weight of  */
+  /* `manager' is at most `limit'.  With FTC_CLOCK, referenced nodes   */
+  /* get a second chance, so that a second pass over the list may be */
+  /* necessary.                                                       */
+  static void
+  ftc_manager_flush_old( FTC_Manager  manager,
+                         FT_Offset    limit )
+  {
+    FT_Bool  flushed = 0;
+    FT_Int   pass;
+
+
+    for ( pass = 0; pass < 2; pass++ )
+    {
+      FTC_Node  node, first = manager->nodes_list;
+      FT_Bool   moved       = 0;
+
+
+      if ( !first )
+        break;
+
+      /* go to last node -- it's a circular list */
+      node = FTC_NODE_PREV( first );
+      do
+      {
+        FTC_Node  prev;
+
+
+        prev = ( node == first ) ? NULL : FTC_NODE_PREV( node );
+
+        if ( node->ref_count <= 0 )
+        {
+#ifdef FTC_CLOCK
+          if ( node->referenced )
+          {
+            node->referenced = 0;
+            FTC_MruNode_Up( (FTC_MruNode*)(void*)&manager->nodes_list,
+                            (FTC_MruNode)node );
+            moved = 1;
+          }
+          else
+#endif
+          {
+            ftc_manager_evict( manager, node );
+            flushed = 1;
+          }
+        }
+
+        node = prev;
+
+      } while ( node && ( !flushed || manager->cur_weight > limit ) );
+
+      if ( !moved || ( flushed && manager->cur_weight <= limit ) )
+        break;
+    }
+  }
+
+
+  /* Give back the pool entries of a locked shard and add its weight */
+  /* change to the root; return TRUE if the root exceeds its limit.  */
+  static FT_Bool
+  ftc_shard_sync( FTC_Manager  shard )
+  {
+    FTC_Manager  root = shard->root;
+    FT_Bool      over;
+
+
+    root->locker.lock( root->lock );
+
+    while ( shard->held )
+    {
+      FTC_PoolFace  pface = shard->held;
+
+
+      shard->held = pface->link;
+      ftc_pool_release( root, pface );
+    }
+
+    root->cur_weight  += shard->cur_weight - shard->lock_weight;
+    shard->lock_weight = shard->cur_weight;
+
+    over = FT_BOOL( root->cur_weight > root->max_weight );
+
+    ftc_pool_unlock( root );
+
+    return over;
+  }
+
+
+  /* Return the share of a shard in the root's limit, which */
+  /* `FTC_Manager_SetLimits' may change at any time.         */
+  static FT_Offset
+  ftc_manager_share( FTC_Manager  root )
+  {
+    FT_Offset  share;
+
+
+    root->locker.lock( root->lock );
+    share = root->max_weight / root->num_shards;
+    root->locker.unlock( root->lock );
+
+    return share;
+  }
+
+
+  /* Flush old nodes of shards that hold more than their share of the */
+  /* root's limit until the root meets it.  No lock may be held.      */
+  static void
+  ftc_manager_balance( FTC_Manager  manager )
+  {
+    FT_Offset  share = ftc_manager_share( manager );
+    FT_UInt    nn;
+
+
+    for ( nn = 0; nn < manager->num_shards; nn++ )
+    {
+      FTC_Manager  shard = manager->shards[nn];
+      FT_Bool      over;
+
+
+      manager->locker.lock( shard->lock );
+      if ( shard->cur_weight > share )
+        ftc_manager_flush_old( shard, share );
+      over = ftc_shard_sync( shard );
+      manager->locker.unlock( shard->lock );
+
+      if ( !over )
+        break;
+    }
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_LookupSize( FTC_Manager  manager,
+                          FTC_Scaler   scaler,
+                          FT_Size     *asize )
+  {
+    FT_Error     error;
+    FTC_MruNode  mrunode;
+
+
+    if ( !asize || !scaler )
+      return FT_THROW( Invalid_Argument );
+
+    *asize = NULL;
+
+    if ( !manager )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    if ( manager->root )
+    {
+      FTC_PoolFace  pface;
+
+
+      error = ftc_shard_lookup_face( manager, scaler->face_id, &pface );
+      if ( !error )
+        error = ftc_pool_lookup_size( pface, scaler, asize );
+
+      return error;
+    }
+
+    if ( manager->num_shards )
+      return FT_THROW( Invalid_Cache_Handle );
+
+#ifdef FTC_INLINE
+
+    FTC_MRULIST_LOOKUP_CMP( &manager->sizes, scaler, ftc_size_node_compare,
+                            mrunode, error );
+
+#else
+    error = FTC_MruList_Lookup( &manager->sizes, scaler, &mrunode );
+#endif
+
+    if ( !error )
+      *asize = FTC_SIZE_NODE( mrunode )->size;
+
+    return error;
+  }
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                    FACE MRU IMPLEMENTATION                    *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+  typedef struct  FTC_FaceNodeRec_
+  {
+    FTC_MruNodeRec  node;
+    FTC_FaceID      face_id;
+    FT_Face         face;
+    FT_Bool         has_key;    /* see `FTC_Manager_LookupFaceKey' */
+    FT_UInt32       key[FTC_STORE_FACE_KEY_SIZE];
+
+  } FTC_FaceNodeRec, *FTC_FaceNode;
+
+#define FTC_FACE_NODE( x ) ( ( FTC_FaceNode )( x ) )
+
+
+  FT_CALLBACK_DEF( FT_Error )
+  ftc_face_node_init( FTC_MruNode  ftcnode,
+                      FT_Pointer   ftcface_id,
+                      FT_Pointer   ftcmanager )
+  {
+    FTC_FaceNode  node    = (FTC_FaceNode)ftcnode;
+    FTC_FaceID    face_id = (FTC_FaceID)ftcface_id;
+    FTC_Manager   manager = (FTC_Manager)ftcmanager;
+    FT_Error      error;
+
+
+    node->face_id = face_id;
+    node->has_key = 0;
+
+    error = manager->request_face( face_id,
+                                   manager->library,
+                                   manager->request_data,
+                                   &node->face );
+    if ( !error )
+    {
+      /* destroy initial size object; it will be re-created later */
+      if ( node->face->size )
+        FT_Done_Size( node->face->size );
+    }
+
+    return error;
+  }
+
+
+  FT_CALLBACK_DEF( void )
+  ftc_face_node_done( FTC_MruNode  ftcnode,
+                      FT_Pointer   ftcmanager )
+  {
+    FTC_FaceNode  node    = (FTC_FaceNode)ftcnode;
+    FTC_Manager   manager = (FTC_Manager)ftcmanager;
+
+
+    /* we must begin by removing all scalers for the target face */
+    /* from the manager's list                                   */
+    FTC_MruList_RemoveSelection( &manager->sizes,
+                                 ftc_size_node_compare_faceid,
+                                 node->face_id );
+
+    /* all right, we can discard the face now */
+    FT_Done_Face( node->face );
+    node->face    = NULL;
+    node->face_id = NULL;
+  }
+
+
+  FT_CALLBACK_DEF( FT_Bool )
+  ftc_face_node_compare( FTC_MruNode  ftcnode,
+                         FT_Pointer   ftcface_id )
+  {
+    FTC_FaceNode  node    = (FTC_FaceNode)ftcnode;
+    FTC_FaceID    face_id = (FTC_FaceID)ftcface_id;
+
+
+    return FT_BOOL( node->face_id == face_id );
+  }
+
+
+  static
+  const FTC_MruListClassRec  ftc_face_list_class =
+  {
+    sizeof ( FTC_FaceNodeRec),
+
+    ftc_face_node_compare,  /* FTC_MruNode_CompareFunc  node_compare */
+    ftc_face_node_init,     /* FTC_MruNode_InitFunc     node_init    */
+    NULL,                   /* FTC_MruNode_ResetFunc    node_reset   */
+    ftc_face_node_done      /* FTC_MruNode_DoneFunc     node_done    */
+  };
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_LookupFace( FTC_Manager  manager,
+                          FTC_FaceID   face_id,
+                          FT_Face     *aface )
+  {
+    FT_Error     error;
+    FTC_MruNode  mrunode;
+
+
+    if ( !aface )
+      return FT_THROW( Invalid_Argument );
+
+    *aface = NULL;
+
+    if ( !manager )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    if ( manager->root )
+    {
+      FTC_PoolFace  pface;
+
+
+      error = ftc_shard_lookup_face( manager, face_id, &pface );
+      if ( !error )
+        *aface = pface->face;
+
+      return error;
+    }
+
+    if ( manager->num_shards )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    /* we break encapsulation for the sake of speed */
+#ifdef FTC_INLINE
+
+    FTC_MRULIST_LOOKUP_CMP( &manager->faces, face_id, ftc_face_node_compare,
+                            mrunode, error );
+
+#else
+    error = FTC_MruList_Lookup( &manager->faces, face_id, &mrunode );
+#endif
+
+    if ( !error )
+      *aface = FTC_FACE_NODE( mrunode )->face;
+
+    return error;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_Manager_LookupFaceKey( FTC_Manager  manager,
+                             FTC_FaceID   face_id,
+                             FT_UInt32*   key )
+  {
+    FT_Error    error;
+    FT_Face     face;
+    FT_Bool*    has_key;
+    FT_UInt32*  face_key;
+
+
+    if ( manager->root )
+    {
+      FTC_PoolFace  pface;
+
+
+      /* the entry is held by the locked shard until it gets unlocked */
+      error = ftc_shard_lookup_face( manager, face_id, &pface );
+      if ( error )
+        return error;
+
+      face     = pface->face;
+      has_key  = &pface->has_key;
+      face_key = pface->key;
+    }
+    else
+    {
+      FTC_MruNode   mrunode;
+      FTC_FaceNode  node;
+
+
+      if ( manager->num_shards )
+        return FT_THROW( Invalid_Cache_Handle );
+
+#ifdef FTC_INLINE
+      FTC_MRULIST_LOOKUP_CMP( &manager->faces, face_id,
+                              ftc_face_node_compare, mrunode, error );
+#else
+      error = FTC_MruList_Lookup( &manager->faces, face_id, &mrunode );
+#endif
+      if ( error )
+        return error;
+
+      node     = FTC_FACE_NODE( mrunode );
+      face     = node->face;
+      has_key  = &node->has_key;
+      face_key = node->key;
+    }
+
+    if ( !*has_key )
+    {
+      error = FTC_Store_FaceKey( face, face_key );
+      if ( error )
+        return error;
+
+      *has_key = 1;
+    }
+
+    FT_ARRAY_COPY( key, face_key, FTC_STORE_FACE_KEY_SIZE );
+
+    return FT_Err_Ok;
+  }
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                    CACHE MANAGER ROUTINES                     *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  static void
+  ftc_manager_init( FTC_Manager         manager,
+                    FT_Library          library,
+                    FT_UInt             max_faces,
+                    FT_UInt             max_sizes,
+                    FT_ULong            max_bytes,
+                    FTC_Face_Requester  requester,
+                    FT_Pointer          req_data )
+  {
+    FT_Memory  memory = library->memory;
+
+
+    if ( max_faces == 0 )
+      max_faces = FTC_MAX_FACES_DEFAULT;
+
+    if ( max_sizes == 0 )
+      max_sizes = FTC_MAX_SIZES_DEFAULT;
+
+    if ( max_bytes == 0 )
+      max_bytes = FTC_MAX_BYTES_DEFAULT;
+
+    manager->library      = library;
+    manager->memory       = memory;
+    manager->max_weight   = max_bytes;
+
+    manager->request_face = requester;
+    manager->request_data = req_data;
+
+    manager->pool_faces   = max_faces;
+    manager->pool_sizes   = max_sizes;
+
+    FTC_MruList_Init( &manager->faces,
+                      &ftc_face_list_class,
+                      max_faces,
+                      manager,
+                      memory );
+
+    FTC_MruList_Init( &manager->sizes,
+                      &ftc_size_list_class,
+                      max_sizes,
+                      manager,
+                      memory );
+
+    FTC_SlabPool_Init( &manager->slabs, memory );
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_New( FT_Library          library,
+                   FT_UInt             max_faces,
+                   FT_UInt             max_sizes,
+                   FT_ULong            max_bytes,
+                   FTC_Face_Requester  requester,
+                   FT_Pointer          req_data,
+                   FTC_Manager        *amanager )
+  {
+    FT_Error     error;
+    FT_Memory    memory;
+    FTC_Manager  manager = 0;
+
+
+    if ( !library )
+      return FT_THROW( Invalid_Library_Handle );
+
+    if ( !amanager || !requester )
+      return FT_THROW( Invalid_Argument );
+
+    memory = library->memory;
+
+    if ( FT_NEW( manager ) )
+      goto Exit;
+
+    ftc_manager_init( manager, library, max_faces, max_sizes, max_bytes,
+                      requester, req_data );
+
+    *amanager = manager;
+
+  Exit:
+    return error;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_NewConcurrent( FT_Library            library,
+                             FT_UInt               max_faces,
+                             FT_UInt               max_sizes,
+                             FT_ULong              max_bytes,
+                             FTC_Face_Requester    requester,
+                             FT_Pointer            req_data,
+                             FT_UInt               num_shards,
+                             const FTC_LockerRec*  locker,
+                             FTC_Manager          *amanager )
+  {
+    FT_Error     error;
+    FT_Memory    memory;
+    FTC_Manager  manager = NULL;
+    FT_UInt      nn;
+
+
+    if ( !library )
+      return FT_THROW( Invalid_Library_Handle );
+
+    if ( !amanager || !requester || !locker                   ||
+         !locker->lock_new || !locker->lock_done              ||
+         !locker->lock     || !locker->unlock                 )
+      return FT_THROW( Invalid_Argument );
+
+    *amanager = NULL;
+
+    if ( num_shards == 0 )
+      num_shards = FTC_SHARDS_DEFAULT;
+    if ( num_shards > FTC_MAX_SHARDS )
+      num_shards = FTC_MAX_SHARDS;
+
+    memory = library->memory;
+
+    if ( FT_NEW( manager ) )
+      goto Exit;
+
+    ftc_manager_init( manager, library, max_faces, max_sizes, max_bytes,
+                      requester, req_data );
+
+    manager->locker = *locker;
+
+    manager->lock      = locker->lock_new( locker->data );
+    manager->face_lock = locker->lock_new( locker->data );
+    if ( !manager->lock || !manager->face_lock )
+      goto Oops;
+
+    if ( FT_NEW_ARRAY( manager->shards, num_shards ) )
+      goto Fail;
+
+    manager->num_shards = num_shards;
+
+    for ( nn = 0; nn < num_shards; nn++ )
+    {
+      FTC_Manager  shard;
+
+
+      if ( FT_NEW( shard ) )
+        goto Fail;
+
+      manager->shards[nn] = shard;
+
+      /* the face and size limits of shards are unused */
+      ftc_manager_init( shard, library, max_faces, max_sizes,
+                        manager->max_weight, requester, req_data );
+
+      shard->root = manager;
+      shard->lock = locker->lock_new( locker->data );
+      if ( !shard->lock )
+        goto Oops;
+    }
+
+    *amanager = manager;
+
+  Exit:
+    return error;
+
+  Oops:
+    error = FT_THROW( Out_Of_Memory );
+
+  Fail:
+    FTC_Manager_Done( manager );
+    goto Exit;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( void )
+  FTC_Manager_Done( FTC_Manager  manager )
+  {
+    FT_Memory  memory;
+    FT_UInt    idx;
+
+
+    if ( !manager || !manager->library )
+      return;
+
+    memory = manager->memory;
+
+    /* discard the shards of a concurrent manager */
+    if ( manager->shards )
+    {
+      for ( idx = 0; idx < manager->num_shards; idx++ )
+      {
+        FTC_Manager  shard = manager->shards[idx];
+
+
+        if ( shard )
+        {
+          FT_Pointer  lock = shard->lock;
+
+
+          shard->lock = NULL;
+          FTC_Manager_Done( shard );
+          if ( lock )
+            manager->locker.lock_done( manager->locker.data, lock );
+        }
+      }
+
+      FT_FREE( manager->shards );
+      manager->num_shards = 0;
+    }
+
+    while ( manager->pool )
+    {
+      FTC_PoolFace  pface = manager->pool;
+
+
+      manager->pool = pface->next;
+      ftc_pool_face_done( manager, pface );
+    }
+
+    if ( manager->lock )
+      manager->locker.lock_done( manager->locker.data, manager->lock );
+    if ( manager->face_lock )
+      manager->locker.lock_done( manager->locker.data, manager->face_lock );
+
+    /* now discard all caches */
+    for (idx = manager->num_caches; idx-- > 0; )
+    {
+      FTC_Cache  cache = manager->caches[idx];
+
+
+      if ( cache )
+      {
+        cache->clazz.cache_done( cache );
+        FT_FREE( cache );
+        manager->caches[idx] = NULL;
+      }
+    }
+    manager->num_caches = 0;
+
+    /* all nodes are gone now */
+    FTC_SlabPool_Done( &manager->slabs );
+    FT_FREE( manager->quotas );
+
+    /* discard faces and sizes */
+    FTC_MruList_Done( &manager->sizes );
+    FTC_MruList_Done( &manager->faces );
+
+    manager->library = NULL;
+    manager->memory  = NULL;
+
+    FT_FREE( manager );
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( void )
+  FTC_Manager_Reset( FTC_Manager  manager )
+  {
+    if ( !manager )
+      return;
+
+    if ( manager->num_shards )
+    {
+      FT_UInt  nn;
+
+
+      for ( nn = 0; nn < manager->num_shards; nn++ )
+      {
+        FTC_Manager  shard = manager->shards[nn];
+
+
+        manager->locker.lock( shard->lock );
+        FTC_Manager_FlushN( shard, shard->num_nodes );
+        FTC_SlabPool_Trim( &shard->slabs );
+        ftc_shard_sync( shard );
+        manager->locker.unlock( shard->lock );
+      }
+
+      manager->locker.lock( manager->lock );
+      ftc_pool_flush( manager, 0 );
+      ftc_pool_unlock( manager );
+
+      return;
+    }
+
+    FTC_MruList_Reset( &manager->sizes );
+    FTC_MruList_Reset( &manager->faces );
+
+    FTC_Manager_FlushN( manager, manager->num_nodes );
+    FTC_SlabPool_Trim( &manager->slabs );
+  }
+
+
+#ifdef FT_DEBUG_ERROR
+
+  static void
+  FTC_Manager_Check( FTC_Manager  manager )
+  {
+    FTC_Node  node, first;
+
+
+    first = manager->nodes_list;
+
+    /* check node weights */
+    if ( first )
+    {
+      FT_Offset  weight = 0;
+      FT_UInt    nn;
+
+
+      node = first;
+
+      do
+      {
+        FTC_Cache  cache = manager->caches[node->cache_index];
+
+
+        if ( (FT_UInt)node->cache_index >= manager->num_caches )
+          FT_TRACE0(( "FTC_Manager_Check: invalid node (cache index = %ld\n",
+                      node->cache_index ));
+        else
+          weight += cache->clazz.node_weight( node, cache );
+
+        node = FTC_NODE_NEXT( node );
+
+      } while ( node != first );
+
+      /* add the memory that isn't held by nodes */
+      for ( nn = 0; nn < manager->num_caches; nn++ )
+        weight += manager->caches[nn]->extra_weight;
+
+      if ( weight != manager->cur_weight )
+        FT_TRACE0(( "FTC_Manager_Check: invalid weight %ld instead of %ld\n",
+                    manager->cur_weight, weight ));
+    }
+
+    /* check circular list */
+    if ( first )
+    {
+      FT_UFast  count = 0;
+
+
+      node = first;
+      do
+      {
+        count++;
+        node = FTC_NODE_NEXT( node );
+
+      } while ( node != first );
+
+      if ( count != manager->num_nodes )
+        FT_TRACE0(( "FTC_Manager_Check:"
+                    " invalid cache node count %d instead of %d\n",
+                    manager->num_nodes, count ));
+    }
+  }
+
+#endif /* FT_DEBUG_ERROR */
+
+
+  /* `Compress' the manager's data, i.e., get rid of old cache nodes */
+  /* that are not referenced anymore in order to limit the total     */
+  /* memory used by the cache.                                       */
+
+  /* documentation is in ftcmanag.h */
+
+  FT_LOCAL_DEF( void )
+  FTC_Manager_Compress( FTC_Manager  manager )
+  {
+    FTC_Node  first;
+
+
+    if ( !manager )
+      return;
+
+    first = manager->nodes_list;
+
+#ifdef FT_DEBUG_ERROR
+    FTC_Manager_Check( manager );
+
+    FT_TRACE0(( "compressing, weight = %ld, max = %ld, nodes = %d\n",
+                manager->cur_weight, manager->max_weight,
+                manager->num_nodes ));
+#endif
+
+    if ( manager->cur_weight < manager->max_weight || !first )
+      return;
+
+    ftc_manager_flush_old( manager, manager->max_weight );
+  }
+
+
+  /* discard the cache registered last */
+  static void
+  ftc_manager_drop_cache( FTC_Manager  manager )
+  {
+    FT_Memory  memory = manager->memory;
+    FTC_Cache  cache  = manager->caches[--manager->num_caches];
+
+
+    cache->clazz.cache_done( cache );
+    FT_FREE( cache );
+    manager->caches[manager->num_caches] = NULL;
+  }
+
+
+  /* documentation is in ftcmanag.h */
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_Manager_RegisterCache( FTC_Manager      manager,
+                             FTC_CacheClass   clazz,
+                             FTC_Cache       *acache )
+  {
+    FT_Error   error = FT_ERR( Invalid_Argument );
+    FTC_Cache  cache = NULL;
+
+
+    if ( manager && clazz && acache )
+    {
+      FT_Memory  memory = manager->memory;
+
+
+      if ( manager->num_caches >= FTC_MAX_CACHES )
+      {
+        error = FT_THROW( Too_Many_Caches );
+        FT_ERROR(( "FTC_Manager_RegisterCache:"
+                   " too many registered caches\n" ));
+        goto Exit;
+      }
+
+      if ( !FT_ALLOC( cache, clazz->cache_size ) )
+      {
+        cache->manager   = manager;
+        cache->memory    = memory;
+        cache->clazz     = clazz[0];
+        cache->org_class = clazz;
+
+        /* THIS IS VERY IMPORTANT!  IT WILL WRETCH THE MANAGER */
+        /* IF IT IS NOT SET CORRECTLY                          */
+        cache->index = manager->num_caches;
+
+        cache->count_lookups = manager->hooks.count_lookups;
+
+        error = clazz->cache_init( cache );
+        if ( error )
+        {
+          clazz->cache_done( cache );
+          FT_FREE( cache );
+          goto Exit;
+        }
+
+        manager->caches[manager->num_caches++] = cache;
+
+        /* a concurrent manager needs an instance in each shard; */
+        /* it is not used itself                                 */
+        if ( manager->num_shards )
+        {
+          FT_UInt  nn;
+
+
+          for ( nn = 0; nn < manager->num_shards; nn++ )
+          {
+            FTC_Cache  shard_cache;
+
+
+            error = FTC_Manager_RegisterCache( manager->shards[nn],
+                                               clazz,
+                                               &shard_cache );
+            if ( error )
+              break;
+          }
+
+          if ( error )
+          {
+            while ( nn-- > 0 )
+              ftc_manager_drop_cache( manager->shards[nn] );
+
+            ftc_manager_drop_cache( manager );
+            cache = NULL;
+          }
+        }
+      }
+    }
+
+  Exit:
+    if ( acache )
+      *acache = cache;
+    return error;
+  }
+
+
+  FT_LOCAL_DEF( FT_UInt )
+  FTC_Manager_FlushN( FTC_Manager  manager,
+                      FT_UInt      count )
+  {
+    FTC_Node  first = manager->nodes_list;
+    FTC_Node  node;
+    FT_UInt   result;
+
+
+    /* try to remove `count' nodes from the list */
+    if ( !first )  /* empty list! */
+      return 0;
+
+    /* go to last node - it's a circular list */
+    node = FTC_NODE_PREV(first);
+    for ( result = 0; result < count; )
+    {
+      FTC_Node  prev = FTC_NODE_PREV( node );
+
+
+      /* don't touch locked nodes */
+      if ( node->ref_count <= 0 )
+      {
+        ftc_manager_evict( manager, node );
+        result++;
+      }
+
+      if ( node == first )
+        break;
+
+      node = prev;
+    }
+    return  result;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( void )
+  FTC_Manager_RemoveFaceID( FTC_Manager  manager,
+                            FTC_FaceID   face_id )
+  {
+    FT_UInt  nn;
+
+
+    if ( !manager )
+      return;
+
+    if ( manager->num_shards )
+    {
+      FTC_PoolFace  pface;
+
+
+      for ( nn = 0; nn < manager->num_shards; nn++ )
+      {
+        FTC_Manager  shard = manager->shards[nn];
+        FT_UInt      idx;
+
+
+        manager->locker.lock( shard->lock );
+        for ( idx = 0; idx < shard->num_caches; idx++ )
+          FTC_Cache_RemoveFaceID( shard->caches[idx], face_id );
+        FTC_SlabPool_Trim( &shard->slabs );
+        ftc_shard_sync( shard );
+        manager->locker.unlock( shard->lock );
+      }
+
+      /* entries still in use get destroyed when given back; their */
+      /* `face_id' field is read by the shard without our lock      */
+      manager->locker.lock( manager->lock );
+      for ( pface = manager->pool; pface; pface = pface->next )
+        if ( pface->face_id == face_id )
+          pface->removed = 1;
+      ftc_pool_flush( manager, manager->pool_faces );
+      ftc_pool_unlock( manager );
+
+      return;
+    }
+
+    /* this will remove all FTC_SizeNode that correspond to
+     * the face_id as well
+     */
+    FTC_MruList_RemoveSelection( &manager->faces,
+                                 ftc_face_node_compare,
+                                 face_id );
+
+    for ( nn = 0; nn < manager->num_caches; nn++ )
+      FTC_Cache_RemoveFaceID( manager->caches[nn], face_id );
+
+    /* give the slabs emptied by the face's nodes back to the system */
+    FTC_SlabPool_Trim( &manager->slabs );
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( void )
+  FTC_Node_Unref( FTC_Node     node,
+                  FTC_Manager  manager )
+  {
+    if ( node && manager && manager->num_shards )
+    {
+      FTC_Manager  shard =
+        manager->shards[FTC_SHARD_INDEX( node->hash, manager->num_shards )];
+
+
+      manager->locker.lock( shard->lock );
+      if ( (FT_UInt)node->cache_index < shard->num_caches &&
+           --node->ref_count <= 0                         &&
+           node->removed                                  )
+      {
+        ftc_node_destroy( node, shard );
+        ftc_shard_sync( shard );
+      }
+      manager->locker.unlock( shard->lock );
+    }
+    else if ( node                                        &&
+              manager                                     &&
+              (FT_UInt)node->cache_index < manager->num_caches &&
+              --node->ref_count <= 0                      &&
+              node->removed                               )
+      ftc_node_destroy( node, manager );
+  }
+
+
+  /* documentation is in ftcmanag.h */
+
+  FT_LOCAL_DEF( FTC_Cache )
+  FTC_Manager_LockCache( FTC_Cache  cache,
+                         FT_Offset  hash )
+  {
+    FTC_Manager  manager = cache->manager;
+    FTC_Manager  shard   =
+      manager->shards[FTC_SHARD_INDEX( hash, manager->num_shards )];
+
+
+    manager->locker.lock( shard->lock );
+
+    return shard->caches[cache->index];
+  }
+
+
+  /* documentation is in ftcmanag.h */
+
+  FT_LOCAL_DEF( void )
+  FTC_Manager_UnlockCache( FTC_Cache  cache,
+                           FTC_Node   node )
+  {
+    FTC_Manager  shard = cache->manager;
+    FTC_Manager  root  = shard->root;
+    FT_Offset    share;
+    FT_Bool      over;
+
+
+    /* the common case of a cache hit doesn't need the root's lock */
+    if ( shard->cur_weight == shard->lock_weight && !shard->held )
+    {
+      root->locker.unlock( shard->lock );
+      return;
+    }
+
+    over = ftc_shard_sync( shard );
+    if ( !over )
+      goto Unlock;
+
+    share = ftc_manager_share( root );
+    if ( shard->cur_weight > share )
+    {
+      /* keep the node that is about to be returned */
+      if ( node )
+        node->ref_count++;
+
+      ftc_manager_flush_old( shard, share );
+
+      if ( node )
+        node->ref_count--;
+
+      over = ftc_shard_sync( shard );
+    }
+
+  Unlock:
+    root->locker.unlock( shard->lock );
+
+    if ( over )
+      ftc_manager_balance( root );
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_AcquireSize( FTC_Manager  manager,
+                           FTC_Scaler   scaler,
+                           FT_Size     *asize )
+  {
+    FT_Error      error;
+    FTC_PoolFace  pface;
+
+
+    if ( !asize || !scaler )
+      return FT_THROW( Invalid_Argument );
+
+    *asize = NULL;
+
+    if ( !manager )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    if ( !manager->num_shards )
+      return FTC_Manager_LookupSize( manager, scaler, asize );
+
+    manager->locker.lock( manager->lock );
+    error = ftc_pool_acquire( manager, scaler->face_id, &pface );
+    manager->locker.unlock( manager->lock );
+
+    if ( error )
+      return error;
+
+    /* the entry is ours until it is given back */
+    error = ftc_pool_lookup_size( pface, scaler, asize );
+    if ( error )
+    {
+      manager->locker.lock( manager->lock );
+      ftc_pool_release( manager, pface );
+      ftc_pool_unlock( manager );
+    }
+
+    return error;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( void )
+  FTC_Manager_ReleaseSize( FTC_Manager  manager,
+                           FT_Size      size )
+  {
+    FTC_PoolFace  pface;
+
+
+    if ( !manager || !size || !manager->num_shards )
+      return;
+
+    manager->locker.lock( manager->lock );
+
+    for ( pface = manager->pool; pface; pface = pface->next )
+    {
+      if ( pface->busy && pface->face == size->face )
+      {
+        ftc_pool_release( manager, pface );
+        break;
+      }
+    }
+
+    ftc_pool_unlock( manager );
+  }
+
+
+  /* return the index of the cache with handle `cache', or -1 */
+  static FT_Int
+  ftc_manager_find_cache( FTC_Manager  manager,
+                          FT_Pointer   cache )
+  {
+    FT_UInt  idx;
+
+
+    for ( idx = 0; idx < manager->num_caches; idx++ )
+      if ( (FT_Pointer)manager->caches[idx] == cache )
+        return (FT_Int)idx;
+
+    return -1;
+  }
+
+
+  static void
+  ftc_stats_set_hits( FTC_CacheStatsRec*  stats )
+  {
+    /* a failed load in a node can be followed by a second miss */
+    stats->hits = stats->lookups > stats->misses
+                    ? stats->lookups - stats->misses
+                    : 0;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_GetCacheStats( FTC_Manager         manager,
+                             FT_Pointer          cache,
+                             FTC_CacheStatsRec  *astats )
+  {
+    FT_Int  idx;
+
+
+    if ( !astats )
+      return FT_THROW( Invalid_Argument );
+
+    if ( !manager )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    idx = ftc_manager_find_cache( manager, cache );
+    if ( idx < 0 )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    FT_ZERO( astats );
+
+    if ( manager->num_shards )
+    {
+      FT_UInt  nn;
+
+
+      /* the root's own instance is never used */
+      for ( nn = 0; nn < manager->num_shards; nn++ )
+      {
+        FTC_Manager  shard = manager->shards[nn];
+
+
+        manager->locker.lock( shard->lock );
+        FTC_Cache_AddStats( shard->caches[idx], astats );
+        manager->locker.unlock( shard->lock );
+      }
+    }
+    else
+      FTC_Cache_AddStats( manager->caches[idx], astats );
+
+    ftc_stats_set_hits( astats );
+
+    return FT_Err_Ok;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_GetStats( FTC_Manager           manager,
+                        FTC_ManagerStatsRec  *astats )
+  {
+    FT_UInt  idx;
+
+
+    if ( !astats )
+      return FT_THROW( Invalid_Argument );
+
+    if ( !manager )
+      return FT_THROW( Invalid_Cache_Handle );
+
+    FT_ZERO( astats );
+
+    astats->num_caches = manager->num_caches;
+
+    if ( manager->num_shards )
+    {
+      FTC_PoolFace  pface;
+      FT_UInt       nn;
+
+
+      for ( nn = 0; nn < manager->num_shards; nn++ )
+      {
+        FTC_Manager  shard = manager->shards[nn];
+
+
+        manager->locker.lock( shard->lock );
+        for ( idx = 0; idx < shard->num_caches; idx++ )
+          FTC_Cache_AddStats( shard->caches[idx], &astats->caches );
+        astats->slab_bytes += shard->slabs.resident;
+        manager->locker.unlock( shard->lock );
+      }
+
+      /* the size lists of busy entries belong to their shards */
+      manager->locker.lock( manager->lock );
+      astats->max_bytes = manager->max_weight;
+      for ( pface = manager->pool; pface; pface = pface->next )
+      {
+        /* skip faces being opened */
+        if ( !pface->face )
+          continue;
+
+        astats->num_faces++;
+        astats->num_sizes += pface->num_sizes;
+      }
+      manager->locker.unlock( manager->lock );
+    }
+    else
+    {
+      for ( idx = 0; idx < manager->num_caches; idx++ )
+        FTC_Cache_AddStats( manager->caches[idx], &astats->caches );
+
+      astats->max_bytes  = manager->max_weight;
+      astats->slab_bytes = manager->slabs.resident;
+      astats->num_faces  = manager->faces.num_nodes;
+      astats->num_sizes  = manager->sizes.num_nodes;
+    }
+
+    ftc_stats_set_hits( &astats->caches );
+
+    return FT_Err_Ok;
+  }
+
+
+  static void
+  ftc_manager_reset_stats( FTC_Manager  manager )
+  {
+    FT_UInt  idx;
+
+
+    for ( idx = 0; idx < manager->num_caches; idx++ )
+    {
+      FTC_Cache  cache = manager->caches[idx];
+
+
+      cache->lookups   = 0;
+      cache->misses    = 0;
+      cache->evictions = 0;
+      FT_ARRAY_ZERO( cache->load_times, FTC_STATS_LOAD_TIME_BINS );
+    }
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( void )
+  FTC_Manager_ResetStats( FTC_Manager  manager )
+  {
+    FT_UInt  nn;
+
+
+    if ( !manager )
+      return;
+
+    for ( nn = 0; nn < manager->num_shards; nn++ )
+    {
+      FTC_Manager  shard = manager->shards[nn];
+
+
+      manager->locker.lock( shard->lock );
+      ftc_manager_reset_stats( shard );
+      manager->locker.unlock( shard->lock );
+    }
+
+    ftc_manager_reset_stats( manager );
+  }
+
+
+  /* tell the caches of `manager' whether to count all lookups */
+  static void
+  ftc_manager_set_count_lookups( FTC_Manager  manager )
+  {
+    FT_UInt  nn;
+
+
+    for ( nn = 0; nn < manager->num_caches; nn++ )
+      manager->caches[nn]->count_lookups = manager->hooks.count_lookups;
+  }
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_SetStatsHooks( FTC_Manager               manager,
+                             const FTC_StatsHooksRec*  hooks )
+  {
+    FT_UInt  nn;
+
+
+    if ( !manager )
+      return FT_THROW( Invalid_Cache_Handle );
 
-    FT_FREE( manager );
-  }
+    if ( hooks )
+      manager->hooks = *hooks;
+    else
+      FT_ZERO( &manager->hooks );
 
+    ftc_manager_set_count_lookups( manager );
 
-  /* documentation is in ftcache.h */
+    /* shards only use their own copy */
+    for ( nn = 0; nn < manager->num_shards; nn++ )
+    {
+      FTC_Manager  shard = manager->shards[nn];
 
-  FT_EXPORT_DEF( void )
-  FTC_Manager_Reset( FTC_Manager  manager )
-  {
-    if ( !manager )
-      return;
 
-    FTC_MruList_Reset( &manager->sizes );
-    FTC_MruList_Reset( &manager->faces );
+      manager->locker.lock( shard->lock );
+      shard->hooks = manager->hooks;
+      ftc_manager_set_count_lookups( shard );
+      manager->locker.unlock( shard->lock );
+    }
 
-    FTC_Manager_FlushN( manager, manager->num_nodes );
+    return FT_Err_Ok;
   }
 
 
-#ifdef FT_DEBUG_ERROR
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                      PER-FACE QUOTAS                          *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
 
-  static void
-  FTC_Manager_Check( FTC_Manager  manager )
+
+  /* return the slot of `face_id' in the quotas of `manager', creating */
+  /* it if necessary; 0 in case of failure                            */
+  static FT_UInt
+  ftc_manager_quota_slot( FTC_Manager  manager,
+                          FTC_FaceID   face_id )
   {
-    FTC_Node  node, first;
+    FT_Memory      memory = manager->memory;
+    FT_Error       error;
+    FTC_FaceQuota  quota;
+    FT_UInt        nn, unused = 0;
 
 
-    first = manager->nodes_list;
+    for ( nn = 0; nn < manager->num_quotas; nn++ )
+    {
+      quota = manager->quotas + nn;
 
-    /* check node weights */
-    if ( first )
+      if ( !quota->num_nodes )
+      {
+        if ( !unused )
+          unused = nn + 1;
+      }
+      else if ( quota->face_id == face_id )
+        return nn + 1;
+    }
+
+    if ( !unused )
     {
-      FT_Offset  weight = 0;
+      if ( manager->num_quotas >= manager->max_quotas )
+      {
+        FT_UInt  new_max = manager->max_quotas ? manager->max_quotas * 2
+                                               : 8;
 
 
-      node = first;
+        if ( new_max > FTC_MAX_FACE_QUOTAS )
+          new_max = FTC_MAX_FACE_QUOTAS;
 
-      do
-      {
-        FTC_Cache  cache = manager->caches[node->cache_index];
+        if ( new_max <= manager->num_quotas                           ||
+             FT_RENEW_ARRAY( manager->quotas,
+                             manager->max_quotas, new_max )           )
+          return 0;
 
+        manager->max_quotas = new_max;
+      }
 
-        if ( (FT_UInt)node->cache_index >= manager->num_caches )
-          FT_TRACE0(( "FTC_Manager_Check: invalid node (cache index = %ld\n",
-                      node->cache_index ));
-        else
-          weight += cache->clazz.node_weight( node, cache );
+      unused = ++manager->num_quotas;
+    }
 
-        node = FTC_NODE_NEXT( node );
+    quota            = manager->quotas + unused - 1;
+    quota->face_id   = face_id;
+    quota->weight    = 0;
+    quota->num_nodes = 0;
 
-      } while ( node != first );
+    return unused;
+  }
 
-      if ( weight != manager->cur_weight )
-        FT_TRACE0(( "FTC_Manager_Check: invalid weight %ld instead of %ld\n",
-                    manager->cur_weight, weight ));
+
+  /* charge a node to its face; return its slot or 0 */
+  static FT_UInt
+  ftc_manager_quota_charge( FTC_Manager  manager,
+                            FTC_Node     node,
+                            FT_Offset    weight )
+  {
+    FTC_Cache      cache = manager->caches[node->cache_index];
+    FTC_FaceQuota  quota;
+    FT_UInt        slot;
+
+
+    if ( !cache->clazz.node_face_id )
+      return 0;
+
+    slot = ftc_manager_quota_slot( manager,
+                                   cache->clazz.node_face_id( node,
+                                                              cache ) );
+    if ( slot )
+    {
+      quota = manager->quotas + slot - 1;
+
+      quota->weight   += weight;
+      quota->num_nodes++;
+      node->face_slot  = (FT_UShort)slot;
     }
 
-    /* check circular list */
-    if ( first )
+    return slot;
+  }
+
+
+  /* flush the oldest unused nodes of the face in `slot' until it */
+  /* meets its quota                                              */
+  static void
+  ftc_manager_flush_face( FTC_Manager  manager,
+                          FT_UInt      slot )
+  {
+    FTC_FaceQuota  quota = manager->quotas + slot - 1;
+    FTC_Node       first = manager->nodes_list;
+    FTC_Node       node;
+
+
+    if ( !first )
+      return;
+
+    node = FTC_NODE_PREV( first );
+    for (;;)
     {
-      FT_UFast  count = 0;
+      FTC_Node  prev = ( node == first ) ? NULL : FTC_NODE_PREV( node );
 
 
-      node = first;
-      do
-      {
-        count++;
-        node = FTC_NODE_NEXT( node );
+      if ( node->face_slot == slot && node->ref_count <= 0 )
+        ftc_manager_evict( manager, node );
 
-      } while ( node != first );
+      if ( !prev || quota->weight <= manager->face_quota )
+        break;
 
-      if ( count != manager->num_nodes )
-        FT_TRACE0(( "FTC_Manager_Check:"
-                    " invalid cache node count %d instead of %d\n",
-                    manager->num_nodes, count ));
+      node = prev;
     }
   }
 
-#endif /* FT_DEBUG_ERROR */
 
+  /* documentation is in ftcmanag.h */
+
+  FT_LOCAL_DEF( void )
+  FTC_Manager_QuotaAdd( FTC_Manager  manager,
+                        FTC_Node     node,
+                        FT_Offset    weight )
+  {
+    FT_UInt  slot;
+
+
+    if ( !manager->face_quota )
+      return;
+
+    /* without memory for the record, the node is not charged */
+    slot = ftc_manager_quota_charge( manager, node, weight );
+    if ( slot                                                   &&
+         manager->quotas[slot - 1].weight > manager->face_quota )
+    {
+      node->ref_count++;
+      ftc_manager_flush_face( manager, slot );
+      node->ref_count--;
+    }
+  }
 
-  /* `Compress' the manager's data, i.e., get rid of old cache nodes */
-  /* that are not referenced anymore in order to limit the total     */
-  /* memory used by the cache.                                       */
 
   /* documentation is in ftcmanag.h */
 
   FT_LOCAL_DEF( void )
-  FTC_Manager_Compress( FTC_Manager  manager )
+  FTC_Manager_QuotaRemove( FTC_Manager  manager,
+                           FTC_Node     node,
+                           FT_Offset    weight )
   {
-    FTC_Node   node, first;
+    FTC_FaceQuota  quota;
 
 
-    if ( !manager )
+    if ( !node->face_slot )
       return;
 
-    first = manager->nodes_list;
+    quota = manager->quotas + node->face_slot - 1;
 
-#ifdef FT_DEBUG_ERROR
-    FTC_Manager_Check( manager );
+    quota->weight   = weight < quota->weight ? quota->weight - weight : 0;
+    quota->num_nodes--;
+    node->face_slot = 0;
+  }
 
-    FT_TRACE0(( "compressing, weight = %ld, max = %ld, nodes = %d\n",
-                manager->cur_weight, manager->max_weight,
-                manager->num_nodes ));
-#endif
 
-    if ( manager->cur_weight < manager->max_weight || !first )
+  /* change the face quota of a manager or shard */
+  static void
+  ftc_manager_set_face_quota( FTC_Manager  manager,
+                              FT_Offset    face_quota )
+  {
+    FT_Memory  memory = manager->memory;
+    FTC_Node   first  = manager->nodes_list;
+    FTC_Node   node;
+    FT_UInt    nn;
+
+
+    if ( !face_quota )
+    {
+      node = first;
+      if ( node )
+        do
+        {
+          node->face_slot = 0;
+          node            = FTC_NODE( node->mru.next );
+
+        } while ( node != first );
+
+      FT_FREE( manager->quotas );
+      manager->num_quotas = 0;
+      manager->max_quotas = 0;
+      manager->face_quota = 0;
       return;
+    }
 
-    /* go to last node -- it's a circular list */
-    node = FTC_NODE_PREV( first );
-    do
+    /* charge the existing nodes when quotas get enabled */
+    if ( !manager->face_quota )
     {
-      FTC_Node  prev;
+      node = first;
+      if ( node )
+        do
+        {
+          FTC_Cache  cache = manager->caches[node->cache_index];
 
 
-      prev = ( node == first ) ? NULL : FTC_NODE_PREV( node );
+          (void)ftc_manager_quota_charge(
+                  manager, node, cache->clazz.node_weight( node, cache ) );
+          node = FTC_NODE( node->mru.next );
 
-      if ( node->ref_count <= 0 )
-        ftc_node_destroy( node, manager );
+        } while ( node != first );
+    }
 
-      node = prev;
+    manager->face_quota = face_quota;
 
-    } while ( node && manager->cur_weight > manager->max_weight );
+    for ( nn = 0; nn < manager->num_quotas; nn++ )
+      if ( manager->quotas[nn].num_nodes                       &&
+           manager->quotas[nn].weight > manager->face_quota )
+        ftc_manager_flush_face( manager, nn + 1 );
   }
 
 
-  /* documentation is in ftcmanag.h */
+  /* documentation is in ftcache.h */
 
-  FT_LOCAL_DEF( FT_Error )
-  FTC_Manager_RegisterCache( FTC_Manager      manager,
-                             FTC_CacheClass   clazz,
-                             FTC_Cache       *acache )
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_SetFaceQuota( FTC_Manager  manager,
+                            FT_ULong     max_bytes )
   {
-    FT_Error   error = FT_ERR( Invalid_Argument );
-    FTC_Cache  cache = NULL;
+    FT_UInt  nn;
 
 
-    if ( manager && clazz && acache )
-    {
-      FT_Memory  memory = manager->memory;
+    if ( !manager )
+      return FT_THROW( Invalid_Cache_Handle );
 
+    if ( !manager->num_shards )
+    {
+      ftc_manager_set_face_quota( manager, max_bytes );
+      return FT_Err_Ok;
+    }
 
-      if ( manager->num_caches >= FTC_MAX_CACHES )
-      {
-        error = FT_THROW( Too_Many_Caches );
-        FT_ERROR(( "FTC_Manager_RegisterCache:"
-                   " too many registered caches\n" ));
-        goto Exit;
-      }
+    /* the root itself has no nodes */
+    manager->face_quota = max_bytes;
 
-      if ( !FT_ALLOC( cache, clazz->cache_size ) )
-      {
-        cache->manager   = manager;
-        cache->memory    = memory;
-        cache->clazz     = clazz[0];
-        cache->org_class = clazz;
+    for ( nn = 0; nn < manager->num_shards; nn++ )
+    {
+      FTC_Manager  shard = manager->shards[nn];
+      FT_Offset    share = max_bytes / manager->num_shards;
 
-        /* THIS IS VERY IMPORTANT!  IT WILL WRETCH THE MANAGER */
-        /* IF IT IS NOT SET CORRECTLY                          */
-        cache->index = manager->num_caches;
 
-        error = clazz->cache_init( cache );
-        if ( error )
-        {
-          clazz->cache_done( cache );
-          FT_FREE( cache );
-          goto Exit;
-        }
+      if ( max_bytes && !share )
+        share = 1;
 
-        manager->caches[manager->num_caches++] = cache;
-      }
+      manager->locker.lock( shard->lock );
+      ftc_manager_set_face_quota( shard, share );
+      ftc_shard_sync( shard );
+      manager->locker.unlock( shard->lock );
     }
 
-  Exit:
-    if ( acache )
-      *acache = cache;
-    return error;
+    return FT_Err_Ok;
   }
 
 
-  FT_LOCAL_DEF( FT_UInt )
-  FTC_Manager_FlushN( FTC_Manager  manager,
-                      FT_UInt      count )
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                      RUNTIME LIMITS                           *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  /* documentation is in ftcache.h */
+
+  FT_EXPORT_DEF( FT_Error )
+  FTC_Manager_SetLimits( FTC_Manager  manager,
+                         FT_UInt      max_faces,
+                         FT_UInt      max_sizes,
+                         FT_ULong     max_bytes )
   {
-    FTC_Node  first = manager->nodes_list;
-    FTC_Node  node;
-    FT_UInt   result;
+    FT_UInt  nn;
 
 
-    /* try to remove `count' nodes from the list */
-    if ( !first )  /* empty list! */
-      return 0;
+    if ( !manager )
+      return FT_THROW( Invalid_Cache_Handle );
 
-    /* go to last node - it's a circular list */
-    node = FTC_NODE_PREV(first);
-    for ( result = 0; result < count; )
+    if ( !manager->num_shards )
     {
-      FTC_Node  prev = FTC_NODE_PREV( node );
+      if ( max_faces )
+      {
+        manager->pool_faces = max_faces;
+        FTC_MruList_SetMax( &manager->faces, max_faces );
+      }
 
+      if ( max_sizes )
+      {
+        manager->pool_sizes = max_sizes;
+        FTC_MruList_SetMax( &manager->sizes, max_sizes );
+      }
 
-      /* don't touch locked nodes */
-      if ( node->ref_count <= 0 )
+      if ( max_bytes )
       {
-        ftc_node_destroy( node, manager );
-        result++;
+        manager->max_weight = max_bytes;
+        FTC_Manager_Compress( manager );
       }
 
-      if ( node == first )
-        break;
+      return FT_Err_Ok;
+    }
 
-      node = prev;
+    manager->locker.lock( manager->lock );
+
+    if ( max_faces )
+      manager->pool_faces = max_faces;
+
+    if ( max_sizes )
+    {
+      FTC_PoolFace  pface;
+
+
+      /* entries in use are updated when given back */
+      manager->pool_sizes = max_sizes;
+      for ( pface = manager->pool; pface; pface = pface->next )
+        if ( !pface->busy )
+          FTC_MruList_SetMax( &pface->sizes, max_sizes );
     }
-    return  result;
+
+    ftc_pool_flush( manager, manager->pool_faces );
+
+    if ( max_bytes )
+      manager->max_weight = max_bytes;
+
+    ftc_pool_unlock( manager );
+
+    if ( max_bytes )
+    {
+      for ( nn = 0; nn < manager->num_shards; nn++ )
+      {
+        FTC_Manager  shard = manager->shards[nn];
+
+
+        manager->locker.lock( shard->lock );
+        shard->max_weight = max_bytes;
+        manager->locker.unlock( shard->lock );
+      }
+
+      ftc_manager_balance( manager );
+    }
+
+    return FT_Err_Ok;
   }
 
 
   /* documentation is in ftcache.h */
 
   FT_EXPORT_DEF( void )
-  FTC_Manager_RemoveFaceID( FTC_Manager  manager,
-                            FTC_FaceID   face_id )
+  FTC_Manager_Trim( FTC_Manager  manager,
+                    FT_ULong     max_bytes )
   {
     FT_UInt  nn;
 
@@ -672,28 +2283,27 @@
     if ( !manager )
       return;
 
-    /* this will remove all FTC_SizeNode that correspond to
-     * the face_id as well
-     */
-    FTC_MruList_RemoveSelection( &manager->faces,
-                                 ftc_face_node_compare,
-                                 face_id );
-
-    for ( nn = 0; nn < manager->num_caches; nn++ )
-      FTC_Cache_RemoveFaceID( manager->caches[nn], face_id );
-  }
+    if ( !manager->num_shards )
+    {
+      if ( manager->cur_weight > max_bytes )
+        ftc_manager_flush_old( manager, max_bytes );
+      FTC_SlabPool_Trim( &manager->slabs );
+      return;
+    }
 
+    for ( nn = 0; nn < manager->num_shards; nn++ )
+    {
+      FTC_Manager  shard = manager->shards[nn];
+      FT_Offset    share = max_bytes / manager->num_shards;
 
-  /* documentation is in ftcache.h */
 
-  FT_EXPORT_DEF( void )
-  FTC_Node_Unref( FTC_Node     node,
-                  FTC_Manager  manager )
-  {
-    if ( node                                             &&
-         manager                                          &&
-         (FT_UInt)node->cache_index < manager->num_caches )
-      node->ref_count--;
+      manager->locker.lock( shard->lock );
+      if ( shard->cur_weight > share )
+        ftc_manager_flush_old( shard, share );
+      FTC_SlabPool_Trim( &shard->slabs );
+      ftc_shard_sync( shard );
+      manager->locker.unlock( shard->lock );
+    }
   }
 
 
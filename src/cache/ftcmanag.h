@@ -41,6 +41,13 @@
    *   Each node belongs to a single cache, and includes a reference
    *   count to avoid destroying it (due to caching).
    *
+   * A concurrent manager (see `FTC_Manager_NewConcurrent') distributes
+   * the cache nodes over several `shards', i.e., internal managers that
+   * each have their own lock, LRU list, and instance of every cache.  The
+   * hash value of a node selects its shard.  The shards share a pool of
+   * FT_Face objects owned by the concurrent manager, which also keeps
+   * track of the total weight.
+   *
    */
 
 
@@ -67,6 +74,7 @@
 #include FT_CACHE_H
 #include "ftcmru.h"
 #include "ftccache.h"
+#include "ftcslab.h"
 
 
 FT_BEGIN_HEADER
@@ -87,6 +95,27 @@ FT_BEGIN_HEADER
   /* maximum number of caches registered in a single manager */
 #define FTC_MAX_CACHES         16
 
+#define FTC_SHARDS_DEFAULT     16
+#define FTC_MAX_SHARDS         256
+
+
+  /* the nodes of a face, for per-face quotas; a node's `face_slot' */
+  /* is the index of its face's record plus 1                        */
+  typedef struct  FTC_FaceQuotaRec_
+  {
+    FTC_FaceID  face_id;
+    FT_Offset   weight;
+    FT_UInt     num_nodes;    /* 0 if the record is unused */
+
+  } FTC_FaceQuotaRec, *FTC_FaceQuota;
+
+  /* `face_slot' is a 16-bit field */
+#define FTC_MAX_FACE_QUOTAS  0xFFFFU
+
+
+  /* an entry of the face pool of a concurrent manager */
+  typedef struct FTC_PoolFaceRec_*  FTC_PoolFace;
+
 
   typedef struct  FTC_ManagerRec_
   {
@@ -107,6 +136,35 @@ FT_BEGIN_HEADER
     FT_Pointer          request_data;
     FTC_Face_Requester  request_face;
 
+    /* concurrent managers (`root') and their shards */
+    FTC_Manager         root;         /* parent of a shard, or NULL       */
+    FTC_Manager*        shards;       /* shards of the root               */
+    FT_UInt             num_shards;   /* 0 unless this is a root          */
+
+    FTC_LockerRec       locker;       /* root only                        */
+    FT_Pointer          lock;         /* the root's lock protects the     */
+                                      /* pool and `cur_weight'            */
+    FT_Pointer          face_lock;    /* root only; serializes opening    */
+                                      /* and closing faces                */
+    FT_Offset           lock_weight;  /* a shard's weight when locked     */
+
+    FTC_PoolFace        pool;         /* root's face pool, MRU first      */
+    FT_UInt             pool_idle;    /* number of unused entries         */
+    FT_UInt             pool_faces;   /* limit for unused entries         */
+    FT_UInt             pool_sizes;   /* size objects per entry           */
+    FTC_PoolFace        held;         /* pool entries used by a shard     */
+    FTC_PoolFace        pool_dead;    /* flushed entries to destroy after */
+                                      /* unlocking the root               */
+
+    FTC_SlabPoolRec     slabs;        /* memory of nodes and sbits        */
+
+    FTC_StatsHooksRec   hooks;        /* copied to the shards             */
+
+    FT_Offset           face_quota;   /* bytes per face, 0 if no quotas   */
+    FTC_FaceQuota       quotas;
+    FT_UInt             num_quotas;
+    FT_UInt             max_quotas;
+
   } FTC_ManagerRec;
 
 
@@ -144,12 +202,71 @@ FT_BEGIN_HEADER
                       FT_UInt      count );
 
 
+  /* charge a new node of weight `weight' to its face, flushing old */
+  /* nodes of the face if it exceeds its quota                       */
+  FT_LOCAL( void )
+  FTC_Manager_QuotaAdd( FTC_Manager  manager,
+                        FTC_Node     node,
+                        FT_Offset    weight );
+
+  /* give back the weight of a node that is being removed */
+  FT_LOCAL( void )
+  FTC_Manager_QuotaRemove( FTC_Manager  manager,
+                           FTC_Node     node,
+                           FT_Offset    weight );
+
+
+  /* destroy an unreferenced node to make room, counting it as an */
+  /* eviction and calling the eviction hook                         */
+  FT_LOCAL( void )
+  FTC_Manager_EvictNode( FTC_Manager  manager,
+                         FTC_Node     node );
+
+
+  /* get the first FTC_STORE_FACE_KEY_SIZE words of a store key for */
+  /* `face_id' (see `FTC_Store_FaceKey'); the font data is hashed    */
+  /* only once per face object                                      */
+  FT_LOCAL( FT_Error )
+  FTC_Manager_LookupFaceKey( FTC_Manager  manager,
+                             FTC_FaceID   face_id,
+                             FT_UInt32*   key );
+
+
   /* this must be used internally for the moment */
   FT_LOCAL( FT_Error )
   FTC_Manager_RegisterCache( FTC_Manager      manager,
                              FTC_CacheClass   clazz,
                              FTC_Cache       *acache );
 
+  /* select and lock the shard of a concurrent manager for nodes with */
+  /* hash value `hash'; return the shard's instance of `cache'         */
+  FT_LOCAL( FTC_Cache )
+  FTC_Manager_LockCache( FTC_Cache  cache,
+                         FT_Offset  hash );
+
+  /* unlock a shard locked by `FTC_Manager_LockCache', flushing old */
+  /* nodes if necessary; `node' is protected if not NULL            */
+  FT_LOCAL( void )
+  FTC_Manager_UnlockCache( FTC_Cache  cache,
+                           FTC_Node   node );
+
+
+#define FTC_CACHE_LOCK( cache, hash )                                  \
+          ( ( (cache) && FTC_CACHE( cache )->manager->num_shards )     \
+              ? FTC_Manager_LockCache( FTC_CACHE( cache ), (hash) )    \
+              : FTC_CACHE( cache ) )
+
+#define FTC_CACHE_UNLOCK( cache, node )                         \
+  FT_BEGIN_STMNT                                                \
+    if ( (cache) && FTC_CACHE( cache )->manager->root )         \
+      FTC_Manager_UnlockCache( FTC_CACHE( cache ), (node) );    \
+  FT_END_STMNT
+
+  /* the bucket index uses the low bits of the hash value */
+#define FTC_SHARD_INDEX( hash, count )                                   \
+          ( (FT_UInt)( (FT_UInt32)( (FT_UInt32)(hash) * 0x9E3779B1UL ) \
+                       >> 16 ) % (count) )
+
  /* */
 
 #define FTC_SCALER_COMPARE( a, b )                \
@@ -323,6 +323,18 @@
   }
 
 
+  FT_LOCAL_DEF( void )
+  FTC_MruList_SetMax( FTC_MruList  list,
+                      FT_UInt      max_nodes )
+  {
+    list->max_nodes = max_nodes;
+
+    /* remove the least recently used nodes */
+    while ( max_nodes && list->num_nodes > max_nodes )
+      FTC_MruList_Remove( list, list->nodes->prev );
+  }
+
+
   FT_LOCAL_DEF( void )
   FTC_MruList_RemoveSelection( FTC_MruList              list,
                                FTC_MruNode_CompareFunc  selection,
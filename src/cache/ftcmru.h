@@ -153,6 +153,11 @@ FT_BEGIN_HEADER
   FTC_MruList_Remove( FTC_MruList  list,
                       FTC_MruNode  node );
 
+  /* change the maximum number of nodes; 0 means no maximum */
+  FT_LOCAL( void )
+  FTC_MruList_SetMax( FTC_MruList  list,
+                      FT_UInt      max_nodes );
+
   FT_LOCAL( void )
   FTC_MruList_RemoveSelection( FTC_MruList              list,
                                FTC_MruNode_CompareFunc  selection,
@@ -0,0 +1,426 @@
+/****************************************************************************
+ *
+ * ftcphase.c
+ *
+ *   A subpixel phase bitmap cache (body).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#include <ft2build.h>
+#include FT_CACHE_H
+#include "ftcphase.h"
+#include FT_INTERNAL_OBJECTS_H
+#include FT_INTERNAL_DEBUG_H
+#include FT_ERRORS_H
+
+#include "ftccback.h"
+#include "ftcerror.h"
+
+#undef  FT_COMPONENT
+#define FT_COMPONENT  cache
+
+
+  /*************************************************************************/
+  /*************************************************************************/
+  /*****                                                               *****/
+  /*****                     PHASE CACHE NODES                         *****/
+  /*****                                                               *****/
+  /*************************************************************************/
+  /*************************************************************************/
+
+
+  /* the memory used by the glyph image kept in a node */
+  static FT_Offset
+  ftc_pnode_glyph_weight( FT_Glyph  glyph )
+  {
+    FT_Offset  size = 0;
+
+
+    switch ( glyph->format )
+    {
+    case FT_GLYPH_FORMAT_BITMAP:
+      {
+        FT_BitmapGlyph  bitg = (FT_BitmapGlyph)glyph;
+
+
+        size = bitg->bitmap.rows * (FT_Offset)FT_ABS( bitg->bitmap.pitch ) +
+               sizeof ( *bitg );
+      }
+      break;
+
+    case FT_GLYPH_FORMAT_OUTLINE:
+      {
+        FT_OutlineGlyph  outg = (FT_OutlineGlyph)glyph;
+
+
+        size = (FT_Offset)outg->outline.n_points *
+                 ( sizeof ( FT_Vector ) + sizeof ( FT_Byte ) ) +
+               (FT_Offset)outg->outline.n_contours * sizeof ( FT_Short ) +
+               sizeof ( *outg );
+      }
+      break;
+
+    default:
+      ;
+    }
+
+    return size;
+  }
+
+
+  /* release the glyph image once all phases are rendered; */
+  /* return the number of bytes freed                      */
+  static FT_Offset
+  ftc_pnode_drop_glyph( FTC_PNode  pnode )
+  {
+    FT_Offset  size = 0;
+
+
+    if ( pnode->glyph                                             &&
+         pnode->rendered == ( 1U << pnode->num_phases ) - 1U )
+    {
+      size = ftc_pnode_glyph_weight( pnode->glyph );
+
+      FT_Done_Glyph( pnode->glyph );
+      pnode->glyph = NULL;
+    }
+
+    return size;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  ftc_pnode_free( FTC_Node   ftcpnode,
+                  FTC_Cache  cache )
+  {
+    FTC_PNode  pnode  = (FTC_PNode)ftcpnode;
+    FT_Memory  memory = cache->memory;
+    FT_UInt    nn;
+
+
+    for ( nn = 0; nn < pnode->num_phases; nn++ )
+      FT_FREE( pnode->sbits[nn].buffer );
+
+    if ( pnode->glyph )
+    {
+      FT_Done_Glyph( pnode->glyph );
+      pnode->glyph = NULL;
+    }
+
+    FTC_GNode_Done( FTC_GNODE( pnode ), cache );
+
+    FTC_SLAB_FREE( &cache->manager->slabs, pnode,
+                   FTC_PNODE_SIZE( pnode->num_phases ) );
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_PNode_Free( FTC_PNode  pnode,
+                  FTC_Cache  cache )
+  {
+    ftc_pnode_free( FTC_NODE( pnode ), cache );
+  }
+
+
+  /*
+   * Render phase `phase' of a node from its glyph image.  As with
+   * `ftc_snode_load', a non-zero error code is only returned in case of
+   * an out-of-memory condition; for all other errors, the phase's sbit is
+   * marked as unavailable with `buffer == NULL' and `width == 255'.
+   *
+   * The bitmap buffer created by the renderer is taken over without
+   * copying it.
+   */
+  static FT_Error
+  ftc_pnode_render( FTC_PNode   pnode,
+                    FTC_PCache  pcache,
+                    FT_UInt     phase,
+                    FT_ULong   *asize )
+  {
+    FT_Error        error  = FT_Err_Ok;
+    FTC_SBit        sbit   = pnode->sbits + phase;
+    FT_Glyph        glyph  = pnode->glyph;
+    FT_BitmapGlyph  bitg   = NULL;
+    FT_Bitmap*      bitmap;
+    FT_Pos          xadvance, yadvance;
+    FT_Int          temp;
+
+
+    sbit->buffer = NULL;
+    if ( asize )
+      *asize = 0;
+
+    if ( glyph->format == FT_GLYPH_FORMAT_BITMAP )
+      bitg = (FT_BitmapGlyph)glyph;
+    else
+    {
+      FT_Glyph   image = glyph;
+      FT_Vector  origin;
+
+
+      origin.x = (FT_Pos)( phase % pcache->x_phases ) * 64 /
+                   (FT_Pos)pcache->x_phases;
+      origin.y = (FT_Pos)( phase / pcache->x_phases ) * 64 /
+                   (FT_Pos)pcache->y_phases;
+
+      /* this translates `glyph' back and forth without rounding errors */
+      error = FT_Glyph_To_Bitmap( &image,
+                                  (FT_Render_Mode)pnode->render_mode,
+                                  &origin,
+                                  0 );
+      if ( error )
+        goto BadGlyph;
+
+      bitg = (FT_BitmapGlyph)image;
+    }
+
+    bitmap = &bitg->bitmap;
+
+    /* check whether our values fit into 8-bit containers */
+
+#define FTC_PHASE_CHECK_CHAR( d )  \
+          ( temp = (FT_Char)d, (FT_Int) temp == (FT_Int) d )
+#define FTC_PHASE_CHECK_BYTE( d )  \
+          ( temp = (FT_Byte)d, (FT_UInt)temp == (FT_UInt)d )
+
+    xadvance = ( glyph->advance.x + 0x8000L ) >> 16;
+    yadvance = ( glyph->advance.y + 0x8000L ) >> 16;
+
+    if ( !FTC_PHASE_CHECK_BYTE( bitmap->rows  ) ||
+         !FTC_PHASE_CHECK_BYTE( bitmap->width ) ||
+         !FTC_PHASE_CHECK_CHAR( bitmap->pitch ) ||
+         !FTC_PHASE_CHECK_CHAR( bitg->left    ) ||
+         !FTC_PHASE_CHECK_CHAR( bitg->top     ) ||
+         !FTC_PHASE_CHECK_CHAR( xadvance )      ||
+         !FTC_PHASE_CHECK_CHAR( yadvance )      )
+    {
+      FT_TRACE2(( "ftc_pnode_render:"
+                  " glyph too large for phase cache\n" ));
+      goto BadGlyph;
+    }
+
+    sbit->width     = (FT_Byte)bitmap->width;
+    sbit->height    = (FT_Byte)bitmap->rows;
+    sbit->pitch     = (FT_Char)bitmap->pitch;
+    sbit->left      = (FT_Char)bitg->left;
+    sbit->top       = (FT_Char)bitg->top;
+    sbit->xadvance  = (FT_Char)xadvance;
+    sbit->yadvance  = (FT_Char)yadvance;
+    sbit->format    = (FT_Byte)bitmap->pixel_mode;
+    sbit->max_grays = (FT_Byte)( bitmap->num_grays - 1 );
+
+    if ( FT_GLYPH( bitg ) == glyph )
+    {
+      FT_Memory  memory = glyph->library->memory;
+      FT_ULong   size   = (FT_ULong)FT_ABS( sbit->pitch ) * sbit->height;
+
+
+      if ( size && !FT_QALLOC( sbit->buffer, size ) )
+        FT_MEM_COPY( sbit->buffer, bitmap->buffer, size );
+    }
+    else
+    {
+      /* steal the rendered buffer */
+      sbit->buffer   = bitmap->buffer;
+      bitmap->buffer = NULL;
+    }
+
+    if ( !error )
+    {
+      pnode->rendered |= (FT_UShort)( 1U << phase );
+      if ( asize )
+        *asize = (FT_ULong)FT_ABS( sbit->pitch ) * sbit->height;
+    }
+
+  Exit:
+    if ( bitg && FT_GLYPH( bitg ) != glyph )
+      FT_Done_Glyph( FT_GLYPH( bitg ) );
+
+    return error;
+
+  BadGlyph:
+    if ( FT_ERR_EQ( error, Out_Of_Memory ) )
+      goto Exit;
+
+    sbit->width  = 255;
+    sbit->height = 0;
+    sbit->buffer = NULL;
+    error        = FT_Err_Ok;
+
+    pnode->rendered |= (FT_UShort)( 1U << phase );
+    goto Exit;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_PNode_New( FTC_PNode  *ppnode,
+                 FTC_GQuery  gquery,
+                 FT_UInt     phase,
+                 FTC_Cache   cache )
+  {
+    FT_Error          error;
+    FTC_PNode         pnode  = NULL;
+    FTC_PCache        pcache = FTC_PCACHE( cache );
+    FTC_PFamilyClass  clazz  = FTC_CACHE_PFAMILY_CLASS( cache );
+    FT_Glyph          glyph  = NULL;
+    FT_Render_Mode    mode   = FT_RENDER_MODE_NORMAL;
+    FT_UInt           num_phases;
+
+
+    /* the node size depends on the glyph format */
+    error = clazz->family_load_glyph( gquery->family, gquery->gindex,
+                                      cache, &glyph, &mode );
+    if ( error )
+      goto Exit;
+
+    /* bitmaps can't be shifted; all phases share the same one */
+    if ( glyph->format == FT_GLYPH_FORMAT_BITMAP )
+      num_phases = 1;
+    else
+      num_phases = pcache->x_phases * pcache->y_phases;
+
+    pnode = (FTC_PNode)FTC_SlabPool_Alloc( &cache->manager->slabs,
+                                           FTC_PNODE_SIZE( num_phases ),
+                                           1,
+                                           &error );
+    if ( !pnode )
+    {
+      FT_Done_Glyph( glyph );
+      goto Exit;
+    }
+
+    FTC_GNode_Init( FTC_GNODE( pnode ), gquery->gindex, gquery->family );
+
+    pnode->glyph       = glyph;
+    pnode->num_phases  = (FT_Byte)num_phases;
+    pnode->render_mode = (FT_Byte)mode;
+
+    if ( phase >= num_phases )
+      phase = 0;
+
+    error = ftc_pnode_render( pnode, pcache, phase, NULL );
+    if ( error )
+    {
+      FTC_PNode_Free( pnode, cache );
+      pnode = NULL;
+      goto Exit;
+    }
+
+    /* the node's weight is computed by the caller */
+    (void)ftc_pnode_drop_glyph( pnode );
+
+  Exit:
+    *ppnode = pnode;
+    return error;
+  }
+
+
+  FT_LOCAL_DEF( FT_Offset )
+  ftc_pnode_weight( FTC_Node   ftcpnode,
+                    FTC_Cache  cache )
+  {
+    FTC_PNode  pnode = (FTC_PNode)ftcpnode;
+    FTC_SBit   sbit  = pnode->sbits;
+    FT_UInt    count = pnode->num_phases;
+    FT_Offset  size;
+
+    FT_UNUSED( cache );
+
+
+    /* the bitmaps are owned by the library heap, the node by the slab pool */
+    size = FTC_SLAB_ROUND_SIZE( FTC_PNODE_SIZE( count ) );
+
+    if ( pnode->glyph )
+      size += ftc_pnode_glyph_weight( pnode->glyph );
+
+    for ( ; count > 0; count--, sbit++ )
+    {
+      if ( sbit->buffer )
+        size += (FT_Offset)FT_ABS( sbit->pitch ) * sbit->height;
+    }
+
+    return size;
+  }
+
+
+  FT_LOCAL_DEF( FT_Bool )
+  FTC_PNode_Compare( FTC_PNode   pnode,
+                     FTC_GQuery  gquery,
+                     FT_UInt     phase,
+                     FTC_Cache   cache,
+                     FT_Bool*    list_changed )
+  {
+    FTC_GNode  gnode = FTC_GNODE( pnode );
+    FT_Bool    result;
+
+
+    if ( list_changed )
+      *list_changed = FALSE;
+
+    result = FT_BOOL( gnode->family == gquery->family &&
+                      gnode->gindex == gquery->gindex );
+
+    if ( phase >= pnode->num_phases )
+      phase = 0;
+
+    /* render the phase now if necessary; see `ftc_snode_compare' */
+    /* for the handling of out-of-memory errors                   */
+    if ( result && !( pnode->rendered & ( 1U << phase ) ) )
+    {
+      FT_ULong  size  = 0;
+      FT_Error  error;
+      FT_ULong  start = FTC_Cache_BeginMiss( cache );
+
+
+      FTC_NODE( pnode )->ref_count++;  /* lock node to prevent flushing */
+                                       /* in retry loop                 */
+
+      FTC_CACHE_TRYLOOP( cache )
+      {
+        error = ftc_pnode_render( pnode, FTC_PCACHE( cache ), phase, &size );
+      }
+      FTC_CACHE_TRYLOOP_END( list_changed );
+
+      FTC_NODE( pnode )->ref_count--;  /* unlock the node */
+
+      FTC_Cache_EndMiss( cache, start );
+
+      if ( error )
+        result = 0;
+      else
+        ftc_node_reweigh( FTC_NODE( pnode ), cache,
+                          size, ftc_pnode_drop_glyph( pnode ) );
+    }
+
+    return result;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  ftc_pcache_init( FTC_Cache  cache )
+  {
+    FTC_PCache  pcache = FTC_PCACHE( cache );
+
+
+    pcache->x_phases = 1;
+    pcache->y_phases = 1;
+
+    return ftc_gcache_init( cache );
+  }
+
+
+#undef FTC_PHASE_CHECK_CHAR
+#undef FTC_PHASE_CHECK_BYTE
+
+
+/* END */
@@ -0,0 +1,133 @@
+/****************************************************************************
+ *
+ * ftcphase.h
+ *
+ *   A subpixel phase bitmap cache (specification).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+ /*
+  * FTC_PCache is an _abstract_ cache used to store small bitmaps of a
+  * glyph rendered at several subpixel offsets (`phases') of its origin.
+  *
+  * All phases of a glyph live in a single node, which keeps the glyph's
+  * outline until every phase has been rendered from it; the outline is
+  * thus loaded only once.  For an implementation example, see
+  * FTC_PhaseCache in `src/cache/ftcbasic.c'.
+  */
+
+
+#ifndef FTCPHASE_H_
+#define FTCPHASE_H_
+
+
+#include <ft2build.h>
+#include FT_CACHE_H
+#include "ftcglyph.h"
+
+
+FT_BEGIN_HEADER
+
+  /* maximum number of phases per glyph, i.e., x_phases * y_phases */
+#define FTC_PHASE_MAX  16
+
+
+  typedef struct  FTC_PCacheRec_
+  {
+    FTC_GCacheRec  gcache;
+    FT_UInt        x_phases;
+    FT_UInt        y_phases;
+
+  } FTC_PCacheRec, *FTC_PCache;
+
+#define FTC_PCACHE( x )  ( (FTC_PCache)( x ) )
+
+
+  typedef struct  FTC_PNodeRec_
+  {
+    FTC_GNodeRec  gnode;
+    FT_Glyph      glyph;       /* until all phases are rendered */
+    FT_Byte       render_mode;
+    FT_Byte       num_phases;  /* 1 for bitmap glyphs           */
+    FT_UShort     rendered;    /* one bit per phase             */
+    FTC_SBitRec   sbits[1];    /* actually `num_phases' entries */
+
+  } FTC_PNodeRec, *FTC_PNode;
+
+
+  /* the size of a node with `n' phases */
+#define FTC_PNODE_SIZE( n )                                    \
+          ( offsetof( FTC_PNodeRec, sbits ) +                  \
+            (FT_Offset)(n) * sizeof ( FTC_SBitRec ) )
+
+#define FTC_PNODE( x )  ( (FTC_PNode)( x ) )
+
+  /* the small bitmap of a given phase */
+#define FTC_PNODE_SBIT( x, phase )                              \
+          ( FTC_PNODE( x )->sbits +                             \
+            ( (phase) < FTC_PNODE( x )->num_phases ? (phase) : 0 ) )
+
+
+  /* load the unrendered glyph image and return the render mode */
+  typedef FT_Error
+  (*FTC_PFamily_LoadGlyphFunc)( FTC_Family       family,
+                                FT_UInt          gindex,
+                                FTC_Cache        cache,
+                                FT_Glyph        *aglyph,
+                                FT_Render_Mode  *amode );
+
+  typedef struct  FTC_PFamilyClassRec_
+  {
+    FTC_MruListClassRec        clazz;
+    FTC_PFamily_LoadGlyphFunc  family_load_glyph;
+
+  } FTC_PFamilyClassRec;
+
+  typedef const FTC_PFamilyClassRec*  FTC_PFamilyClass;
+
+#define FTC_PFAMILY_CLASS( x )  ((FTC_PFamilyClass)(x))
+
+#define FTC_CACHE_PFAMILY_CLASS( x ) \
+          FTC_PFAMILY_CLASS( FTC_CACHE_GCACHE_CLASS( x )->family_class )
+
+
+  /* Unlike other glyph nodes, the query of a phase node consists of */
+  /* `gquery' and the phase index `phase', which is in the range     */
+  /* [0, x_phases * y_phases).  The hash value of a query must not    */
+  /* depend on the phase.                                             */
+
+  FT_LOCAL( void )
+  FTC_PNode_Free( FTC_PNode  pnode,
+                  FTC_Cache  cache );
+
+  FT_LOCAL( FT_Error )
+  FTC_PNode_New( FTC_PNode   *ppnode,
+                 FTC_GQuery   gquery,
+                 FT_UInt      phase,
+                 FTC_Cache    cache );
+
+  FT_LOCAL( FT_Bool )
+  FTC_PNode_Compare( FTC_PNode   pnode,
+                     FTC_GQuery  gquery,
+                     FT_UInt     phase,
+                     FTC_Cache   cache,
+                     FT_Bool*    list_changed );
+
+  /* */
+
+FT_END_HEADER
+
+#endif /* FTCPHASE_H_ */
+
+
+/* END */
@@ -39,10 +39,24 @@
   /*************************************************************************/
 
 
+  /* the store of a concurrent manager is shared by all shards */
+#define FTC_STORE_LOCK( manager )                                  \
+          FT_BEGIN_STMNT                                           \
+            if ( (manager)->root )                                 \
+              (manager)->root->locker.lock( (manager)->root->lock ); \
+          FT_END_STMNT
+
+#define FTC_STORE_UNLOCK( manager )                                  \
+          FT_BEGIN_STMNT                                             \
+            if ( (manager)->root )                                   \
+              (manager)->root->locker.unlock( (manager)->root->lock ); \
+          FT_END_STMNT
+
+
   static FT_Error
-  ftc_sbit_copy_bitmap( FTC_SBit    sbit,
-                        FT_Bitmap*  bitmap,
-                        FT_Memory   memory )
+  ftc_sbit_copy_bitmap( FTC_SBit      sbit,
+                        FT_Bitmap*    bitmap,
+                        FTC_SlabPool  pool )
   {
     FT_Error  error;
     FT_Int    pitch = bitmap->pitch;
@@ -56,7 +70,7 @@
     if ( !size )
       return FT_Err_Ok;
 
-    if ( !FT_ALLOC( sbit->buffer, size ) )
+    if ( !FTC_SLAB_QALLOC( pool, sbit->buffer, size ) )
       FT_MEM_COPY( sbit->buffer, bitmap->buffer, size );
 
     return error;
@@ -67,18 +81,25 @@
   ftc_snode_free( FTC_Node   ftcsnode,
                   FTC_Cache  cache )
   {
-    FTC_SNode  snode  = (FTC_SNode)ftcsnode;
-    FTC_SBit   sbit   = snode->sbits;
-    FT_UInt    count  = snode->count;
-    FT_Memory  memory = cache->memory;
+    FTC_SNode     snode = (FTC_SNode)ftcsnode;
+    FTC_SBit      sbit  = snode->sbits;
+    FT_UInt       count = snode->count;
+    FTC_SlabPool  pool  = &cache->manager->slabs;
+    FTC_Store     store = &FTC_SCACHE( cache )->store;
 
 
     for ( ; count > 0; sbit++, count-- )
-      FT_FREE( sbit->buffer );
+    {
+      if ( FTC_STORE_OWNS( store, sbit->buffer ) )
+        continue;
+
+      FTC_SLAB_FREE( pool, sbit->buffer,
+                     (FT_Offset)FT_ABS( sbit->pitch ) * sbit->height );
+    }
 
     FTC_GNode_Done( FTC_GNODE( snode ), cache );
 
-    FT_FREE( snode );
+    FTC_SLAB_FREE( pool, snode, sizeof ( *snode ) );
   }
 
 
@@ -97,19 +118,26 @@
    * to a bad font file), this function will mark the sbit as `unavailable'
    * and return a value of 0.
    *
+   * If the cache has a store, the bitmap is taken from there if possible;
+   * otherwise, a newly rendered bitmap is added to it.  Either way, the
+   * buffer stays in the store and doesn't count for the node's weight.
+   *
    * You should also read the comment within the @ftc_snode_compare
    * function below to see how out-of-memory is handled during a lookup.
    */
   static FT_Error
   ftc_snode_load( FTC_SNode    snode,
-                  FTC_Manager  manager,
+                  FTC_Cache    cache,
                   FT_UInt      gindex,
                   FT_ULong    *asize )
   {
     FT_Error          error;
-    FTC_GNode         gnode  = FTC_GNODE( snode );
-    FTC_Family        family = gnode->family;
-    FT_Memory         memory = manager->memory;
+    FTC_GNode         gnode   = FTC_GNODE( snode );
+    FTC_Family        family  = gnode->family;
+    FTC_Manager       manager = cache->manager;
+    FTC_Store         store   = &FTC_SCACHE( cache )->store;
+    FT_Bool           stored  = 0;
+    FT_UInt32         key[FTC_STORE_KEY_SIZE];
     FT_Face           face;
     FTC_SBit          sbit;
     FTC_SFamilyClass  clazz;
@@ -126,6 +154,28 @@
 
     sbit->buffer = 0;
 
+    if ( store->base                                           &&
+         clazz->family_get_key                                 &&
+         !clazz->family_get_key( family, manager, key )        )
+    {
+      FT_Bool  found;
+
+
+      stored = 1;
+
+      FTC_STORE_LOCK( manager );
+      found = FTC_Store_Lookup( store, key, gindex, sbit );
+      FTC_STORE_UNLOCK( manager );
+
+      if ( found )
+      {
+        if ( asize )
+          *asize = 0;
+
+        return FT_Err_Ok;
+      }
+    }
+
     error = clazz->family_load_glyph( family, gindex, manager, &face );
     if ( error )
       goto BadGlyph;
@@ -178,12 +228,28 @@
       sbit->format    = (FT_Byte)bitmap->pixel_mode;
       sbit->max_grays = (FT_Byte)(bitmap->num_grays - 1);
 
-      /* copy the bitmap into a new buffer -- ignore error */
-      error = ftc_sbit_copy_bitmap( sbit, bitmap, memory );
+      if ( stored )
+      {
+        FTC_STORE_LOCK( manager );
+        stored = FTC_Store_Insert( store, key, gindex, sbit, bitmap->buffer );
+        FTC_STORE_UNLOCK( manager );
+      }
 
-      /* now, compute size */
-      if ( asize )
-        *asize = (FT_ULong)FT_ABS( sbit->pitch ) * sbit->height;
+      if ( stored )
+      {
+        if ( asize )
+          *asize = 0;
+      }
+      else
+      {
+        /* copy the bitmap into a new buffer -- ignore error */
+        error = ftc_sbit_copy_bitmap( sbit, bitmap, &manager->slabs );
+
+        /* now, compute size */
+        if ( asize )
+          *asize = FTC_SLAB_ROUND_SIZE( (FT_ULong)FT_ABS( sbit->pitch ) *
+                                        sbit->height );
+      }
 
     } /* glyph loading successful */
 
@@ -211,7 +277,6 @@
                  FTC_GQuery  gquery,
                  FTC_Cache   cache )
   {
-    FT_Memory   memory = cache->memory;
     FT_Error    error;
     FTC_SNode   snode  = NULL;
     FT_UInt     gindex = gquery->gindex;
@@ -229,7 +294,7 @@
       goto Exit;
     }
 
-    if ( !FT_NEW( snode ) )
+    if ( !FTC_SLAB_NEW( &cache->manager->slabs, snode ) )
     {
       FT_UInt  count, start;
 
@@ -248,7 +313,7 @@
       }
 
       error = ftc_snode_load( snode,
-                              cache->manager,
+                              cache,
                               gindex,
                               NULL );
       if ( error )
@@ -284,27 +349,27 @@
     FTC_SNode  snode = (FTC_SNode)ftcsnode;
     FT_UInt    count = snode->count;
     FTC_SBit   sbit  = snode->sbits;
+    FTC_Store  store = &FTC_SCACHE( cache )->store;
     FT_Int     pitch;
     FT_Offset  size;
 
-    FT_UNUSED( cache );
-
 
     FT_ASSERT( snode->count <= FTC_SBIT_ITEMS_PER_NODE );
 
-    /* the node itself */
-    size = sizeof ( *snode );
+    /* the node itself, as allocated in the slab pool */
+    size = FTC_SLAB_ROUND_SIZE( sizeof ( *snode ) );
 
     for ( ; count > 0; count--, sbit++ )
     {
-      if ( sbit->buffer )
+      /* bitmaps in the store are not ours */
+      if ( sbit->buffer && !FTC_STORE_OWNS( store, sbit->buffer ) )
       {
         pitch = sbit->pitch;
         if ( pitch < 0 )
           pitch = -pitch;
 
         /* add the size of a given glyph image */
-        size += (FT_Offset)pitch * sbit->height;
+        size += FTC_SLAB_ROUND_SIZE( (FT_Offset)pitch * sbit->height );
       }
     }
 
@@ -382,6 +447,7 @@
       {
         FT_ULong  size;
         FT_Error  error;
+        FT_ULong  start = FTC_Cache_BeginMiss( cache );
 
 
         ftcsnode->ref_count++;  /* lock node to prevent flushing */
@@ -389,16 +455,18 @@
 
         FTC_CACHE_TRYLOOP( cache )
         {
-          error = ftc_snode_load( snode, cache->manager, gindex, &size );
+          error = ftc_snode_load( snode, cache, gindex, &size );
         }
         FTC_CACHE_TRYLOOP_END( list_changed );
 
         ftcsnode->ref_count--;  /* unlock the node */
 
+        FTC_Cache_EndMiss( cache, start );
+
         if ( error )
           result = 0;
         else
-          cache->manager->cur_weight += size;
+          ftc_node_reweigh( ftcsnode, cache, size, 0 );
       }
     }
 
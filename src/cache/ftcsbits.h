@@ -23,12 +23,23 @@
 #include <ft2build.h>
 #include FT_CACHE_H
 #include "ftcglyph.h"
+#include "ftcstore.h"
 
 
 FT_BEGIN_HEADER
 
 #define FTC_SBIT_ITEMS_PER_NODE  16
 
+  typedef struct  FTC_SCacheRec_
+  {
+    FTC_GCacheRec  gcache;
+    FTC_StoreRec   store;    /* see `FTC_SBitCache_SetStore' */
+
+  } FTC_SCacheRec, *FTC_SCache;
+
+#define FTC_SCACHE( x )  ( (FTC_SCache)( x ) )
+
+
   typedef struct  FTC_SNodeRec_
   {
     FTC_GNodeRec  gnode;
@@ -52,11 +63,19 @@ FT_BEGIN_HEADER
                                 FTC_Manager  manager,
                                 FT_Face     *aface );
 
+  /* fill the FTC_STORE_KEY_SIZE words identifying the family's */
+  /* bitmaps in a persistent store                               */
+  typedef FT_Error
+  (*FTC_SFamily_GetKeyFunc)( FTC_Family   family,
+                             FTC_Manager  manager,
+                             FT_UInt32*   key );
+
   typedef struct  FTC_SFamilyClassRec_
   {
     FTC_MruListClassRec        clazz;
     FTC_SFamily_GetCountFunc   family_get_count;
     FTC_SFamily_LoadGlyphFunc  family_load_glyph;
+    FTC_SFamily_GetKeyFunc     family_get_key;    /* may be NULL */
 
   } FTC_SFamilyClassRec;
 
@@ -0,0 +1,345 @@
+/****************************************************************************
+ *
+ * ftcslab.c
+ *
+ *   FreeType cache slab allocator (body).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#include <ft2build.h>
+#include FT_CACHE_H
+#include "ftcslab.h"
+#include FT_INTERNAL_OBJECTS_H
+#include FT_INTERNAL_DEBUG_H
+
+#include "ftcerror.h"
+
+#undef  FT_COMPONENT
+#define FT_COMPONENT  cache
+
+
+  FT_LOCAL_ARRAY_DEF( FT_UShort )
+  ftc_slab_class_sizes[FTC_SLAB_NUM_CLASSES] =
+  {
+     16,  32,  48,  64,  80,  96, 112, 128,
+    160, 192, 224, 256, 320, 384, 448, 512
+  };
+
+
+  /* A slab starts with this header, followed by objects of a single */
+  /* size class.  Freed objects form a singly-linked list; objects   */
+  /* between `top' and `limit' have never been used.                 */
+  typedef struct  FTC_SlabRec_
+  {
+    FTC_Slab  next;          /* in class's partial list */
+    FT_Byte*  free;
+    FT_Byte*  top;
+    FT_Byte*  limit;
+    FT_UInt   num_used;
+    FT_Bool   in_partial;
+
+  } FTC_SlabRec;
+
+  /* keep objects aligned on 16 bytes */
+#define FTC_SLAB_HEADER_SIZE  ( ( sizeof ( FTC_SlabRec ) + 15 ) & ~15U )
+
+#define FTC_SLAB_IS_FULL( slab, osize )                          \
+          ( !(slab)->free && (slab)->top + (osize) > (slab)->limit )
+
+
+  FT_LOCAL_DEF( void )
+  FTC_SlabPool_Init( FTC_SlabPool  pool,
+                     FT_Memory     memory )
+  {
+    FT_ZERO( pool );
+    pool->memory = memory;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_SlabPool_Done( FTC_SlabPool  pool )
+  {
+    FT_Memory  memory = pool->memory;
+    FT_UInt    cc, nn;
+
+
+    if ( !memory )
+      return;
+
+    for ( cc = 0; cc < FTC_SLAB_NUM_CLASSES; cc++ )
+    {
+      FTC_SlabClass  cls = pool->classes + cc;
+
+
+      for ( nn = 0; nn < cls->num_slabs; nn++ )
+        FT_FREE( cls->slabs[nn] );
+
+      FT_FREE( cls->slabs );
+      cls->num_slabs = 0;
+      cls->max_slabs = 0;
+      cls->partial   = NULL;
+    }
+
+    pool->num_empty = 0;
+    pool->resident  = 0;
+  }
+
+
+  /* add a new slab to a class and make it the head of the partial list */
+  static FT_Error
+  ftc_slab_class_grow( FTC_SlabPool   pool,
+                       FTC_SlabClass  cls )
+  {
+    FT_Memory  memory = pool->memory;
+    FT_Error   error;
+    FTC_Slab   slab;
+    FT_UInt    lo, hi;
+
+
+    if ( cls->num_slabs >= cls->max_slabs )
+    {
+      FT_UInt  new_max = cls->max_slabs ? cls->max_slabs * 2 : 8;
+
+
+      if ( FT_QRENEW_ARRAY( cls->slabs, cls->max_slabs, new_max ) )
+        return error;
+
+      cls->max_slabs = new_max;
+    }
+
+    if ( FT_QALLOC( slab, FTC_SLAB_SIZE ) )
+      return error;
+
+    slab->free       = NULL;
+    slab->top        = (FT_Byte*)slab + FTC_SLAB_HEADER_SIZE;
+    slab->limit      = (FT_Byte*)slab + FTC_SLAB_SIZE;
+    slab->num_used   = 0;
+    slab->in_partial = 1;
+    slab->next       = cls->partial;
+    cls->partial     = slab;
+
+    /* keep the array sorted by address for `FTC_SlabPool_Free' */
+    lo = 0;
+    hi = cls->num_slabs;
+    while ( lo < hi )
+    {
+      FT_UInt  mid = ( lo + hi ) / 2;
+
+
+      if ( (FT_Byte*)cls->slabs[mid] < (FT_Byte*)slab )
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    if ( lo < cls->num_slabs )
+      ft_memmove( cls->slabs + lo + 1,
+                  cls->slabs + lo,
+                  ( cls->num_slabs - lo ) * sizeof ( FTC_Slab ) );
+
+    cls->slabs[lo] = slab;
+    cls->num_slabs++;
+
+    pool->num_empty++;
+    pool->resident += FTC_SLAB_SIZE;
+
+    return FT_Err_Ok;
+  }
+
+
+  FT_LOCAL_DEF( FT_Pointer )
+  FTC_SlabPool_Alloc( FTC_SlabPool  pool,
+                      FT_Offset     size,
+                      FT_Bool       zero,
+                      FT_Error     *perror )
+  {
+    FT_Error       error  = FT_Err_Ok;
+    FT_Byte*       block  = NULL;
+    FTC_SlabClass  cls;
+    FTC_Slab       slab;
+    FT_UInt        osize;
+
+
+    if ( size == 0 )
+      goto Exit;
+
+    if ( size > FTC_SLAB_MAX_OBJECT )
+    {
+      FT_Memory  memory = pool->memory;
+
+
+      if ( zero )
+        block = (FT_Byte*)ft_mem_alloc( memory, (FT_Long)size, &error );
+      else
+        block = (FT_Byte*)ft_mem_qalloc( memory, (FT_Long)size, &error );
+
+      goto Exit;
+    }
+
+    cls   = pool->classes + FTC_SLAB_CLASS( size );
+    osize = ftc_slab_class_sizes[FTC_SLAB_CLASS( size )];
+
+    if ( !cls->partial )
+    {
+      error = ftc_slab_class_grow( pool, cls );
+      if ( error )
+        goto Exit;
+    }
+
+    slab = cls->partial;
+    if ( slab->num_used == 0 )
+      pool->num_empty--;
+
+    if ( slab->free )
+    {
+      block      = slab->free;
+      slab->free = *(FT_Byte**)block;
+    }
+    else
+    {
+      block      = slab->top;
+      slab->top += osize;
+    }
+
+    slab->num_used++;
+
+    if ( FTC_SLAB_IS_FULL( slab, osize ) )
+    {
+      cls->partial     = slab->next;
+      slab->next       = NULL;
+      slab->in_partial = 0;
+    }
+
+    if ( zero )
+      FT_MEM_ZERO( block, size );
+
+  Exit:
+    *perror = error;
+    return block;
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_SlabPool_Free( FTC_SlabPool  pool,
+                     FT_Pointer    block,
+                     FT_Offset     size )
+  {
+    FTC_SlabClass  cls;
+    FTC_Slab       slab;
+    FT_UInt        lo, hi;
+
+
+    if ( !block )
+      return;
+
+    if ( size > FTC_SLAB_MAX_OBJECT )
+    {
+      ft_mem_free( pool->memory, block );
+      return;
+    }
+
+    cls = pool->classes + FTC_SLAB_CLASS( size );
+
+    /* find the last slab starting below `block' */
+    lo = 0;
+    hi = cls->num_slabs;
+    while ( lo < hi )
+    {
+      FT_UInt  mid = ( lo + hi ) / 2;
+
+
+      if ( (FT_Byte*)cls->slabs[mid] < (FT_Byte*)block )
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+    if ( lo == 0 )
+      goto Bad;
+
+    slab = cls->slabs[lo - 1];
+    if ( (FT_Byte*)block >= slab->limit )
+      goto Bad;
+
+    *(FT_Byte**)block = slab->free;
+    slab->free        = (FT_Byte*)block;
+    slab->num_used--;
+
+    if ( !slab->in_partial )
+    {
+      slab->next       = cls->partial;
+      cls->partial     = slab;
+      slab->in_partial = 1;
+    }
+
+    if ( slab->num_used == 0 && ++pool->num_empty > FTC_SLAB_MAX_EMPTY )
+      FTC_SlabPool_Trim( pool );
+
+    return;
+
+  Bad:
+    FT_TRACE0(( "FTC_SlabPool_Free: block %p of size %lu not in pool\n",
+                block, (FT_ULong)size ));
+  }
+
+
+  FT_LOCAL_DEF( void )
+  FTC_SlabPool_Trim( FTC_SlabPool  pool )
+  {
+    FT_Memory  memory = pool->memory;
+    FT_UInt    cc, nn, count;
+
+
+    if ( pool->num_empty == 0 )
+      return;
+
+    for ( cc = 0; cc < FTC_SLAB_NUM_CLASSES; cc++ )
+    {
+      FTC_SlabClass  cls   = pool->classes + cc;
+      FT_UInt        osize = ftc_slab_class_sizes[cc];
+      FTC_Slab*      plast = &cls->partial;
+
+
+      count = 0;
+      for ( nn = 0; nn < cls->num_slabs; nn++ )
+      {
+        FTC_Slab  slab = cls->slabs[nn];
+
+
+        if ( slab->num_used == 0 )
+        {
+          FT_FREE( slab );
+          pool->resident -= FTC_SLAB_SIZE;
+          continue;
+        }
+
+        cls->slabs[count++] = slab;
+
+        /* rebuild the partial list in address order */
+        slab->in_partial = !FTC_SLAB_IS_FULL( slab, osize );
+        if ( slab->in_partial )
+        {
+          *plast = slab;
+          plast  = &slab->next;
+        }
+      }
+
+      *plast         = NULL;
+      cls->num_slabs = count;
+    }
+
+    pool->num_empty = 0;
+  }
+
+
+/* END */
@@ -0,0 +1,151 @@
+/****************************************************************************
+ *
+ * ftcslab.h
+ *
+ *   FreeType cache slab allocator (specification).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+ /*
+  * Each cache manager owns a slab pool for cache nodes and small bitmap
+  * buffers.  Objects of up to FTC_SLAB_MAX_OBJECT bytes are rounded up to
+  * one of FTC_SLAB_NUM_CLASSES size classes and carved from slabs of
+  * FTC_SLAB_SIZE bytes; larger objects come from the heap.
+  *
+  * Objects carry no header, so the caller must pass the allocated size
+  * when freeing them.  Slabs that become empty are released in bulk when
+  * there are too many of them, and by `FTC_SlabPool_Trim'.
+  *
+  * The weight functions of the caches use FTC_SLAB_ROUND_SIZE so that the
+  * manager's `cur_weight' counts the bytes actually taken in slabs.
+  */
+
+
+#ifndef FTCSLAB_H_
+#define FTCSLAB_H_
+
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_INTERNAL_MEMORY_H
+
+
+FT_BEGIN_HEADER
+
+
+#define FTC_SLAB_SIZE         8192
+#define FTC_SLAB_NUM_CLASSES  16
+#define FTC_SLAB_MAX_OBJECT   512
+
+  /* the number of empty slabs that triggers a trim */
+#define FTC_SLAB_MAX_EMPTY    8
+
+
+  /* the size class of `size' bytes; 16-byte steps up to 128 bytes,  */
+  /* 32-byte steps up to 256 bytes, and 64-byte steps up to 512 bytes */
+#define FTC_SLAB_CLASS( size )                                       \
+          ( (size) <= 128 ? ( (FT_UInt)(size) + 15 ) / 16 - 1        \
+          : (size) <= 256 ? ( (FT_UInt)(size) - 129 ) / 32 + 8       \
+                          : ( (FT_UInt)(size) - 257 ) / 64 + 12 )
+
+  /* the number of bytes used by an object of `size' bytes */
+#define FTC_SLAB_ROUND_SIZE( size )                                   \
+          ( (size) == 0 || (size) > FTC_SLAB_MAX_OBJECT               \
+              ? (FT_Offset)(size)                                     \
+              : (FT_Offset)ftc_slab_class_sizes[FTC_SLAB_CLASS( size )] )
+
+
+  typedef struct FTC_SlabRec_*  FTC_Slab;
+
+
+  typedef struct  FTC_SlabClassRec_
+  {
+    FTC_Slab*  slabs;        /* sorted by address            */
+    FT_UInt    num_slabs;
+    FT_UInt    max_slabs;
+    FTC_Slab   partial;      /* slabs with free objects      */
+
+  } FTC_SlabClassRec, *FTC_SlabClass;
+
+
+  typedef struct  FTC_SlabPoolRec_
+  {
+    FT_Memory         memory;
+    FTC_SlabClassRec  classes[FTC_SLAB_NUM_CLASSES];
+    FT_UInt           num_empty;
+    FT_Offset         resident;     /* bytes held in slabs */
+
+  } FTC_SlabPoolRec, *FTC_SlabPool;
+
+
+  FT_LOCAL_ARRAY( FT_UShort )
+  ftc_slab_class_sizes[FTC_SLAB_NUM_CLASSES];
+
+
+  FT_LOCAL( void )
+  FTC_SlabPool_Init( FTC_SlabPool  pool,
+                     FT_Memory     memory );
+
+  FT_LOCAL( void )
+  FTC_SlabPool_Done( FTC_SlabPool  pool );
+
+  /* allocate `size' bytes, cleared if `zero' is set; */
+  /* return NULL for zero size                        */
+  FT_LOCAL( FT_Pointer )
+  FTC_SlabPool_Alloc( FTC_SlabPool  pool,
+                      FT_Offset     size,
+                      FT_Bool       zero,
+                      FT_Error     *perror );
+
+  /* `size' must be the value given to `FTC_SlabPool_Alloc' */
+  FT_LOCAL( void )
+  FTC_SlabPool_Free( FTC_SlabPool  pool,
+                     FT_Pointer    block,
+                     FT_Offset     size );
+
+  /* release all empty slabs */
+  FT_LOCAL( void )
+  FTC_SlabPool_Trim( FTC_SlabPool  pool );
+
+
+  /* these macros need an `error' variable, like the FT_ALLOC family */
+
+#define FTC_SLAB_NEW( pool, ptr )                                    \
+          FT_MEM_SET_ERROR(                                          \
+            FT_ASSIGNP_INNER( ptr,                                   \
+                              FTC_SlabPool_Alloc( (pool),            \
+                                                  sizeof ( *(ptr) ), \
+                                                  1,                 \
+                                                  &error ) ) )
+
+#define FTC_SLAB_QALLOC( pool, ptr, size )                           \
+          FT_MEM_SET_ERROR(                                          \
+            FT_ASSIGNP_INNER( ptr,                                   \
+                              FTC_SlabPool_Alloc( (pool),            \
+                                                  (size),            \
+                                                  0,                 \
+                                                  &error ) ) )
+
+#define FTC_SLAB_FREE( pool, ptr, size )                  \
+          FT_BEGIN_STMNT                                  \
+            FTC_SlabPool_Free( (pool), (ptr), (size) );   \
+            (ptr) = NULL;                                 \
+          FT_END_STMNT
+
+
+FT_END_HEADER
+
+#endif /* FTCSLAB_H_ */
+
+
+/* END */
@@ -0,0 +1,454 @@
+/****************************************************************************
+ *
+ * ftcstore.c
+ *
+ *   FreeType persistent sbit store (body).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#include <ft2build.h>
+#include FT_CACHE_H
+#include FT_MODULE_H
+#include "ftcstore.h"
+#include FT_INTERNAL_OBJECTS_H
+#include FT_INTERNAL_STREAM_H
+#include FT_INTERNAL_DEBUG_H
+
+#include "ftcerror.h"
+
+#undef  FT_COMPONENT
+#define FT_COMPONENT  cache
+
+
+#define FTC_STORE_MAGIC   FT_MAKE_TAG( 'F', 'T', 'C', 'S' )
+
+  /* increment this if the layout of the store changes */
+#define FTC_STORE_FORMAT  1
+
+#define FTC_STORE_VERSION  ( ( FREETYPE_MAJOR << 16 ) | \
+                             ( FREETYPE_MINOR <<  8 ) | \
+                               FREETYPE_PATCH         )
+
+  /* one bucket per this many bytes of store */
+#define FTC_STORE_BUCKET_BYTES  256
+#define FTC_STORE_MAX_BUCKETS   0x100000UL
+
+#define FTC_STORE_MIN_SIZE  4096
+
+
+  typedef struct  FTC_StoreHeaderRec_
+  {
+    FT_UInt32  magic;
+    FT_UInt32  format;
+    FT_UInt32  version;
+    FT_UInt32  config;         /* fingerprint of library settings */
+    FT_UInt32  size;
+    FT_UInt32  num_buckets;
+    FT_UInt32  top;            /* offset of free heap space       */
+    FT_UInt32  count;          /* number of records               */
+
+  } FTC_StoreHeaderRec, *FTC_StoreHeader;
+
+
+  /* followed by the bitmap, padded to a multiple of 4 bytes */
+  typedef struct  FTC_StoreRecordRec_
+  {
+    FT_UInt32  next;           /* offset of next record in bucket */
+    FT_UInt32  key[FTC_STORE_KEY_SIZE];
+    FT_UInt32  gindex;
+
+    FT_Byte    width;
+    FT_Byte    height;
+    FT_Char    left;
+    FT_Char    top;
+    FT_Byte    format;
+    FT_Byte    max_grays;
+    FT_Short   pitch;
+    FT_Char    xadvance;
+    FT_Char    yadvance;
+    FT_Byte    pad[2];
+
+  } FTC_StoreRecordRec, *FTC_StoreRecord;
+
+
+#define FTC_STORE_HEADER( store )  ( (FTC_StoreHeader)(store)->base )
+
+#define FTC_STORE_DATA_SIZE( rec )                                \
+          ( (FT_UInt32)FT_ABS( (rec)->pitch ) * (rec)->height )
+
+#define FTC_STORE_PAD( x )  ( ( (x) + 3 ) & ~(FT_UInt32)3 )
+
+
+  /* FNV-1a */
+  static FT_UInt32
+  ftc_store_hash( FT_UInt32       hash,
+                  const FT_Byte*  p,
+                  FT_ULong        len )
+  {
+    for ( ; len > 0; len--, p++ )
+      hash = (FT_UInt32)( ( hash ^ *p ) * 0x01000193UL );
+
+    return hash;
+  }
+
+
+#define FTC_STORE_HASH_INIT  0x811C9DC5UL
+
+
+  /* Settings that change the rendering of a glyph with the same load */
+  /* flags.  Properties of absent modules simply don't contribute.    */
+  static const struct
+  {
+    const char*  module_name;
+    const char*  property_name;
+    FT_Bool      is_bool;
+
+  } ftc_store_properties[] =
+  {
+    { "truetype",   "interpreter-version", 0 },
+    { "cff",        "hinting-engine",      0 },
+    { "type1",      "hinting-engine",      0 },
+    { "t1cid",      "hinting-engine",      0 },
+    { "cff",        "no-stem-darkening",   1 },
+    { "autofitter", "no-stem-darkening",   1 },
+  };
+
+
+  static FT_UInt32
+  ftc_store_config( FT_Library  library )
+  {
+    FT_UInt32  hash = FTC_STORE_HASH_INIT;
+    FT_UInt    nn;
+
+
+    for ( nn = 0; nn < sizeof ( ftc_store_properties ) /
+                         sizeof ( *ftc_store_properties ); nn++ )
+    {
+      FT_UInt   value = 0;
+      FT_Bool   flag  = 0;
+      FT_Error  error;
+
+
+      if ( ftc_store_properties[nn].is_bool )
+      {
+        error = FT_Property_Get( library,
+                                 ftc_store_properties[nn].module_name,
+                                 ftc_store_properties[nn].property_name,
+                                 &flag );
+        value = flag;
+      }
+      else
+        error = FT_Property_Get( library,
+                                 ftc_store_properties[nn].module_name,
+                                 ftc_store_properties[nn].property_name,
+                                 &value );
+      if ( error )
+        value = 0xFFFFFFFFUL;
+
+      hash = ftc_store_hash( hash, (FT_Byte*)&value, sizeof ( value ) );
+    }
+
+#ifdef FT_CONFIG_OPTION_SUBPIXEL_RENDERING
+    hash = ftc_store_hash( hash,
+                           library->lcd_weights,
+                           sizeof ( library->lcd_weights ) );
+#else
+    hash = ftc_store_hash( hash,
+                           (FT_Byte*)library->lcd_geometry,
+                           sizeof ( library->lcd_geometry ) );
+#endif
+
+    return hash;
+  }
+
+
+  /* the number of buckets of a store with `size' bytes */
+  static FT_UInt32
+  ftc_store_num_buckets( FT_ULong  size )
+  {
+    FT_UInt32  num_buckets = 16;
+
+
+    while ( num_buckets < FTC_STORE_MAX_BUCKETS                   &&
+            num_buckets * 2 * FTC_STORE_BUCKET_BYTES <= size )
+      num_buckets *= 2;
+
+    return num_buckets;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_Store_Init( FTC_Store   store,
+                  FT_Library  library,
+                  FT_Pointer  base,
+                  FT_ULong    size )
+  {
+    FTC_StoreHeader  header = (FTC_StoreHeader)base;
+    FT_UInt32        config;
+    FT_UInt32        num_buckets;
+    FT_UInt32        heap;
+
+
+    if ( !base || size < FTC_STORE_MIN_SIZE )
+      return FT_THROW( Invalid_Argument );
+
+    /* offsets are 32-bit */
+    if ( size > 0x7FFFFFFFUL )
+      size = 0x7FFFFFFFUL;
+
+    config = ftc_store_config( library );
+
+    /* the bucket count follows from the size; a header with another */
+    /* one is damaged                                                */
+    num_buckets = ftc_store_num_buckets( size );
+    heap        = (FT_UInt32)sizeof ( *header ) + num_buckets * 4;
+
+    /* the heap is either empty or holds at least one record */
+    if ( header->magic       != FTC_STORE_MAGIC                     ||
+         header->format      != FTC_STORE_FORMAT                    ||
+         header->version     != FTC_STORE_VERSION                   ||
+         header->config      != config                              ||
+         header->size        != (FT_UInt32)size                     ||
+         header->num_buckets != num_buckets                         ||
+         header->top < heap                                         ||
+         header->top > size                                         ||
+         ( header->top != heap                                   &&
+           header->top < heap + sizeof ( FTC_StoreRecordRec ) ) )
+    {
+      FT_TRACE1(( "FTC_Store_Init: clearing store\n" ));
+
+      /* write the magic number last */
+      header->magic       = 0;
+      header->format      = FTC_STORE_FORMAT;
+      header->version     = FTC_STORE_VERSION;
+      header->config      = config;
+      header->size        = (FT_UInt32)size;
+      header->num_buckets = num_buckets;
+      header->top         = heap;
+      header->count       = 0;
+
+      FT_MEM_ZERO( header + 1, num_buckets * 4 );
+
+      header->magic = FTC_STORE_MAGIC;
+    }
+
+    store->base        = (FT_Byte*)base;
+    store->size        = size;
+    store->buckets     = (FT_UInt32*)( header + 1 );
+    store->num_buckets = num_buckets;
+    store->heap        = heap;
+
+    return FT_Err_Ok;
+  }
+
+
+  /* A second hash over 32-bit words makes collisions of both very */
+  /* unlikely.  `len' must be a multiple of 4 except for the last   */
+  /* chunk of data.                                                 */
+  static void
+  ftc_store_hash_data( FT_UInt32*      hashes,
+                       const FT_Byte*  p,
+                       FT_ULong        len )
+  {
+    FT_UInt32  hash2 = hashes[1];
+    FT_ULong   nn;
+
+
+    hashes[0] = ftc_store_hash( hashes[0], p, len );
+
+    for ( nn = 0; nn + 4 <= len; nn += 4 )
+      hash2 = (FT_UInt32)( ( hash2 ^ FT_PEEK_ULONG( p + nn ) ) *
+                           0x9E3779B1UL + 1 );
+
+    hashes[1] = hash2;
+  }
+
+
+  FT_LOCAL_DEF( FT_Error )
+  FTC_Store_FaceKey( FT_Face     face,
+                     FT_UInt32*  key )
+  {
+    FT_Stream  stream = face->stream;
+    FT_Error   error  = FT_Err_Ok;
+
+
+    key[0] = FTC_STORE_HASH_INIT;
+    key[1] = 0;
+
+    /* hash the whole font data; the `base' field of a disk-based */
+    /* stream holds the current frame, if any                     */
+    if ( !stream->read )
+      ftc_store_hash_data( key, stream->base, stream->size );
+    else
+    {
+      FT_Byte   buffer[1024];
+      FT_ULong  pos;
+
+
+      for ( pos = 0; pos < stream->size; pos += sizeof ( buffer ) )
+      {
+        FT_ULong  count = stream->size - pos;
+
+
+        if ( count > sizeof ( buffer ) )
+          count = sizeof ( buffer );
+
+        error = FT_Stream_ReadAt( stream, pos, buffer, count );
+        if ( error )
+          goto Exit;
+
+        ftc_store_hash_data( key, buffer, count );
+      }
+    }
+
+    key[2] = (FT_UInt32)stream->size;
+    key[3] = (FT_UInt32)face->face_index;
+
+  Exit:
+    return error;
+  }
+
+
+  static FT_UInt32
+  ftc_store_bucket( FTC_Store         store,
+                    const FT_UInt32*  key,
+                    FT_UInt           gindex )
+  {
+    FT_UInt32  hash = (FT_UInt32)gindex * 0x9E3779B1UL;
+    FT_UInt    nn;
+
+
+    for ( nn = 0; nn < FTC_STORE_KEY_SIZE; nn++ )
+      hash = (FT_UInt32)( ( hash ^ key[nn] ) * 0x01000193UL );
+
+    return ( hash ^ ( hash >> 16 ) ) & ( store->num_buckets - 1 );
+  }
+
+
+  FT_LOCAL_DEF( FT_Bool )
+  FTC_Store_Lookup( FTC_Store         store,
+                    const FT_UInt32*  key,
+                    FT_UInt           gindex,
+                    FTC_SBit          sbit )
+  {
+    FTC_StoreHeader  header = FTC_STORE_HEADER( store );
+    FT_UInt32        top    = header->top;
+    FT_UInt32        count  = header->count;
+    FT_UInt32        offset;
+
+
+    if ( top < store->heap || top > store->size )
+      return 0;
+
+    offset = store->buckets[ftc_store_bucket( store, key, gindex )];
+
+    /* don't trust the offsets; the store might be damaged */
+    while ( offset && count-- > 0 )
+    {
+      FTC_StoreRecord  rec;
+
+
+      if ( offset < store->heap                              ||
+           offset > top                                      ||
+           offset + sizeof ( FTC_StoreRecordRec ) > top      ||
+           ( offset & 3 )                                    )
+        break;
+
+      rec = (FTC_StoreRecord)( store->base + offset );
+
+      if ( rec->gindex == gindex                                  &&
+           !ft_memcmp( rec->key, key, sizeof ( rec->key ) )       )
+      {
+        if ( FTC_STORE_DATA_SIZE( rec ) >
+               top - offset - sizeof ( FTC_StoreRecordRec ) ||
+             rec->width > (FT_UInt)FT_ABS( rec->pitch ) * 8 )
+          break;
+
+        sbit->width     = rec->width;
+        sbit->height    = rec->height;
+        sbit->left      = rec->left;
+        sbit->top       = rec->top;
+        sbit->format    = rec->format;
+        sbit->max_grays = rec->max_grays;
+        sbit->pitch     = rec->pitch;
+        sbit->xadvance  = rec->xadvance;
+        sbit->yadvance  = rec->yadvance;
+        sbit->buffer    = FTC_STORE_DATA_SIZE( rec ) != 0
+                            ? (FT_Byte*)( rec + 1 )
+                            : NULL;
+        return 1;
+      }
+
+      offset = rec->next;
+    }
+
+    return 0;
+  }
+
+
+  FT_LOCAL_DEF( FT_Bool )
+  FTC_Store_Insert( FTC_Store         store,
+                    const FT_UInt32*  key,
+                    FT_UInt           gindex,
+                    FTC_SBit          sbit,
+                    const FT_Byte*    buffer )
+  {
+    FTC_StoreHeader  header = FTC_STORE_HEADER( store );
+    FT_UInt32        top    = header->top;
+    FT_UInt32        data_size;
+    FT_UInt32        rec_size;
+    FT_UInt32*       bucket;
+    FTC_StoreRecord  rec;
+
+
+    data_size = (FT_UInt32)FT_ABS( sbit->pitch ) * sbit->height;
+    rec_size  = (FT_UInt32)sizeof ( FTC_StoreRecordRec ) +
+                FTC_STORE_PAD( data_size );
+
+    if ( top < store->heap || top > store->size  ||
+         rec_size > store->size - top            )
+      return 0;
+
+    bucket = store->buckets + ftc_store_bucket( store, key, gindex );
+    rec    = (FTC_StoreRecord)( store->base + top );
+
+    rec->next = *bucket;
+    FT_MEM_COPY( rec->key, key, sizeof ( rec->key ) );
+    rec->gindex    = gindex;
+    rec->width     = sbit->width;
+    rec->height    = sbit->height;
+    rec->left      = sbit->left;
+    rec->top       = sbit->top;
+    rec->format    = sbit->format;
+    rec->max_grays = sbit->max_grays;
+    rec->pitch     = sbit->pitch;
+    rec->xadvance  = sbit->xadvance;
+    rec->yadvance  = sbit->yadvance;
+    rec->pad[0]    = 0;
+    rec->pad[1]    = 0;
+
+    if ( data_size )
+      FT_MEM_COPY( rec + 1, buffer, data_size );
+
+    /* the record is complete; make it visible */
+    header->top = top + rec_size;
+    *bucket     = top;
+    header->count++;
+
+    sbit->buffer = data_size ? (FT_Byte*)( rec + 1 ) : NULL;
+
+    return 1;
+  }
+
+
+/* END */
@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * ftcstore.h
+ *
+ *   FreeType persistent sbit store (specification).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+ /*
+  * A store is a block of client memory, typically a memory-mapped file,
+  * that keeps small bitmaps across program runs.  It starts with a
+  * header, followed by a table of hash buckets and a heap of records.
+  * Records are only ever appended; once the heap is full, new bitmaps
+  * are no longer added.
+  *
+  * A record is identified by a key of FTC_STORE_KEY_SIZE words and a
+  * glyph index.  The first words of the key are a fingerprint of the font
+  * data (see `FTC_Store_FaceKey'); the rest is up to the cache.  The
+  * header holds the FreeType version and a fingerprint of the library
+  * settings that influence rendering; the store is cleared if either
+  * doesn't match.
+  *
+  * All values are stored in native byte order.  The store does no
+  * locking of its own.
+  */
+
+
+#ifndef FTCSTORE_H_
+#define FTCSTORE_H_
+
+
+#include <ft2build.h>
+#include FT_CACHE_H
+
+
+FT_BEGIN_HEADER
+
+
+#define FTC_STORE_KEY_SIZE       9
+
+  /* the number of key words filled by `FTC_Store_FaceKey' */
+#define FTC_STORE_FACE_KEY_SIZE  4
+
+
+  typedef struct  FTC_StoreRec_
+  {
+    FT_Byte*    base;          /* NULL if there is no store */
+    FT_ULong    size;
+    FT_UInt32*  buckets;
+    FT_UInt32   num_buckets;   /* a power of 2              */
+    FT_UInt32   heap;          /* offset of first record    */
+
+  } FTC_StoreRec, *FTC_Store;
+
+
+  /* does `p' point into the store? */
+#define FTC_STORE_OWNS( store, p )                           \
+          ( (store)->base                                 && \
+            (FT_Byte*)(p) >= (store)->base                && \
+            (FT_Byte*)(p) <  (store)->base + (store)->size )
+
+
+  /* attach `size' bytes at `base', clearing them unless they hold */
+  /* a compatible store                                             */
+  FT_LOCAL( FT_Error )
+  FTC_Store_Init( FTC_Store   store,
+                  FT_Library  library,
+                  FT_Pointer  base,
+                  FT_ULong    size );
+
+  /* compute the first FTC_STORE_FACE_KEY_SIZE words of a key */
+  FT_LOCAL( FT_Error )
+  FTC_Store_FaceKey( FT_Face     face,
+                     FT_UInt32*  key );
+
+  /* look up a bitmap; on success, `sbit->buffer' points into the store */
+  FT_LOCAL( FT_Bool )
+  FTC_Store_Lookup( FTC_Store         store,
+                    const FT_UInt32*  key,
+                    FT_UInt           gindex,
+                    FTC_SBit          sbit );
+
+  /* add a bitmap described by `sbit' with pixels `buffer'; */
+  /* on success, `sbit->buffer' points into the store        */
+  FT_LOCAL( FT_Bool )
+  FTC_Store_Insert( FTC_Store         store,
+                    const FT_UInt32*  key,
+                    FT_UInt           gindex,
+                    FTC_SBit          sbit,
+                    const FT_Byte*    buffer );
+
+  /* */
+
+FT_END_HEADER
+
+#endif /* FTCSTORE_H_ */
+
+
+/* END */
@@ -466,6 +466,16 @@
 #define FT_MAX_BLACK_POOL  ( 2048 / sizeof ( Long ) )
 #endif
 
+  typedef struct  black_TRaster_
+  {
+    void*               memory;
+    FT_Raster_Executor  executor;
+
+    ULong               pool_max;   /* limit for growing the render pool */
+
+  } black_TRaster, *black_PRaster;
+
+
   /* The most used variables are positioned at the top of the structure. */
   /* Thus, their offset can be coded with less opcodes, resulting in a   */
   /* smaller executable.                                                 */
@@ -535,14 +545,15 @@
     black_TBand  band_stack[16];    /* band stack used for sub-banding     */
     Int          band_top;          /* band stack top                      */
 
-  };
+    Short        scan_min;          /* scanlines drawn by `Draw_Sweep'     */
+    Short        scan_max;
+    Short        scan_last;         /* last scanline of the current pass   */
 
+    black_PRaster  raster;          /* allows a heap pool if not NULL      */
+    PLong          heap_pool;       /* heap render pool of this call       */
 
-  typedef struct  black_TRaster_
-  {
-    void*          memory;
+  };
 
-  } black_TRaster, *black_PRaster;
 
 #ifdef FT_STATIC_RASTER
 
@@ -1000,6 +1011,12 @@
    *   maxy ::
    *     An upper vertical clipping bound value.
    *
+   *   clipy ::
+   *     The lower clipping bound of the whole sweep, i.e., without
+   *     sub-banding.  The x-coordinates are computed as if clipping there
+   *     (and skipping the scanlines up to `miny'), so that they don't
+   *     depend on the band limits.
+   *
    * @Return:
    *   SUCCESS on success, FAILURE on render pool overflow.
    */
@@ -1009,7 +1026,8 @@
                     Long  x2,
                     Long  y2,
                     Long  miny,
-                    Long  maxy )
+                    Long  maxy,
+                    Long  clipy )
   {
     Long   Dx, Dy;
     Int    e1, e2, f1, f2, size;     /* XXX: is `Short' sufficient? */
@@ -1024,12 +1042,12 @@
     if ( Dy <= 0 || y2 < miny || y1 > maxy )
       return SUCCESS;
 
-    if ( y1 < miny )
+    if ( y1 < clipy )
     {
-      /* Take care: miny-y1 can be a very large value; we use     */
+      /* Take care: clipy-y1 can be a very large value; we use    */
       /*            a slow MulDiv function to avoid clipping bugs */
-      x1 += SMulDiv( Dx, miny - y1, Dy );
-      e1  = (Int)TRUNC( miny );
+      x1 += SMulDiv( Dx, clipy - y1, Dy );
+      e1  = (Int)TRUNC( clipy );
       f1  = 0;
     }
     else
@@ -1069,19 +1087,6 @@
 
     ras.joint = (char)( f2 == 0 );
 
-    if ( ras.fresh )
-    {
-      ras.cProfile->start = e1;
-      ras.fresh           = FALSE;
-    }
-
-    size = e2 - e1 + 1;
-    if ( ras.top + size >= ras.maxBuff )
-    {
-      ras.error = FT_THROW( Overflow );
-      return FAILURE;
-    }
-
     if ( Dx > 0 )
     {
       Ix = SMulDiv_No_Round( ras.precision, Dx, Dy );
@@ -1095,7 +1100,37 @@
       Dx = -1;
     }
 
-    Ax  = -Dy;
+    Ax = -Dy;
+
+    if ( e1 < TRUNC( miny ) )
+    {
+      /* Skip the scanlines below `miny' in one go but with exactly the */
+      /* same result as the loop below, so that the x-coordinates don't */
+      /* depend on the band being rendered.  The remainder is computed  */
+      /* modulo 2^n since the products might overflow, but not their    */
+      /* difference.                                                    */
+      Long  k = TRUNC( miny ) - e1;
+      Long  n = SMulDiv_No_Round( k, Rx, Dy );
+
+
+      x1 += k * Ix + n * Dx;
+      Ax += (Long)( (ULong)k * (ULong)Rx - (ULong)n * (ULong)Dy );
+      e1  = (Int)TRUNC( miny );
+    }
+
+    if ( ras.fresh )
+    {
+      ras.cProfile->start = e1;
+      ras.fresh           = FALSE;
+    }
+
+    size = e2 - e1 + 1;
+    if ( ras.top + size >= ras.maxBuff )
+    {
+      ras.error = FT_THROW( Overflow );
+      return FAILURE;
+    }
+
     top = ras.top;
 
     while ( size > 0 )
@@ -1161,7 +1196,8 @@
 
     fresh  = ras.fresh;
 
-    result = Line_Up( RAS_VARS x1, -y1, x2, -y2, -maxy, -miny );
+    result = Line_Up( RAS_VARS x1, -y1, x2, -y2, -maxy, -miny,
+                      -(Long)ras.scan_last * ras.precision );
 
     if ( fresh && !ras.fresh )
       ras.cProfile->start = -ras.cProfile->start;
@@ -1439,7 +1475,7 @@
     {
     case Ascending_State:
       if ( Line_Up( RAS_VARS ras.lastX, ras.lastY,
-                             x, y, ras.minY, ras.maxY ) )
+                             x, y, ras.minY, ras.maxY, 0 ) )
         return FAILURE;
       break;
 
@@ -2777,6 +2813,10 @@
 
       while ( y < y_change )
       {
+        /* skip the extra scanlines converted by `Render_Single_Pass' */
+        if ( y < ras.scan_min || y > ras.scan_max )
+          goto Next_Line;
+
         /* let's trace */
 
         dropouts = 0;
@@ -2996,6 +3036,66 @@
 #endif /* STANDALONE_ */
 
 
+#ifndef STANDALONE_
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   Grow_Render_Pool
+   *
+   * @Description:
+   *   Replace the worker's render pool with a heap pool twice as large
+   *   (the first one is the stack buffer of `ft_black_render'), but not
+   *   larger than `pool_max'.  The contents are not preserved.  The pool
+   *   is kept for the horizontal pass, so that the profiles of complex
+   *   glyphs are usually computed only once per pass instead of once per
+   *   band; `ft_black_render' frees it.  It is not kept in the raster
+   *   object since several threads may render with the same raster.
+   *
+   * @Return:
+   *   SUCCESS if the current worker uses a larger pool now.
+   */
+  static Bool
+  Grow_Render_Pool( RAS_ARG )
+  {
+    black_PRaster  raster = ras.raster;
+    FT_Memory      memory;
+    FT_Error       error;
+    PLong          pool;
+    ULong          size;
+
+
+    if ( !raster )
+      return FAILURE;
+
+    memory = (FT_Memory)raster->memory;
+
+    size = (ULong)( ras.sizeBuff - ras.buff ) * sizeof ( Long ) * 2;
+    if ( size > raster->pool_max )
+      size = raster->pool_max;
+
+    size -= size % sizeof ( Long );
+    if ( size <= (ULong)( ras.sizeBuff - ras.buff ) * sizeof ( Long ) )
+      return FAILURE;
+
+    /* the worker might still use the old pool if this fails */
+    if ( FT_QALLOC( pool, size ) )
+      return FAILURE;
+
+    FT_FREE( ras.heap_pool );
+
+    ras.heap_pool = pool;
+    ras.buff      = pool;
+    ras.sizeBuff  = pool + size / sizeof ( Long );
+
+    FT_TRACE7(( "Grow_Render_Pool: %lu bytes\n", (unsigned long)size ));
+
+    return SUCCESS;
+  }
+
+#endif /* !STANDALONE_ */
+
+
   /**************************************************************************
    *
    * @Function:
@@ -3019,8 +3119,19 @@
 
     while ( ras.band_top >= 0 )
     {
-      ras.maxY = (Long)ras.band_stack[ras.band_top].y_max * ras.precision;
-      ras.minY = (Long)ras.band_stack[ras.band_top].y_min * ras.precision;
+      ras.scan_min = ras.band_stack[ras.band_top].y_min;
+      ras.scan_max = ras.band_stack[ras.band_top].y_max;
+
+      /* Profiles get clipped to the band.  To make drop-out control */
+      /* independent of the band limits (which can't distinguish a   */
+      /* clipped profile from one that ends there), we convert one   */
+      /* more scanline on each side that borders on another band,    */
+      /* without drawing it.                                         */
+      ras.minY = (Long)( ras.scan_min > 0 ? ras.scan_min - 1
+                                          : ras.scan_min ) * ras.precision;
+      ras.maxY = (Long)( ras.scan_max < ras.scan_last ? ras.scan_max + 1
+                                                      : ras.scan_max ) *
+                   ras.precision;
 
       ras.top = ras.buff;
 
@@ -3033,6 +3144,13 @@
 
         ras.error = Raster_Err_None;
 
+#ifndef STANDALONE_
+        /* render pool overflow; if possible, get a bigger pool and */
+        /* retry the current band                                   */
+        if ( !Grow_Render_Pool( RAS_VAR ) )
+          continue;
+#endif
+
         /* sub-banding */
 
 #ifdef DEBUG_RASTER
@@ -3072,6 +3190,138 @@
   }
 
 
+#ifndef FT_STATIC_RASTER
+
+  /* maximum number of bands rendered in parallel */
+#define FT_MAX_BLACK_BANDS  32
+
+  /* default minimum number of scanlines for parallel rendering */
+#define FT_BLACK_BANDS_MIN_ROWS  256
+
+
+  typedef struct  black_TBandJob_
+  {
+    black_PWorker  proto;        /* worker set up by `Render_Glyph'  */
+    Bool           flipped;      /* the pass being rendered          */
+    Short          band_height;  /* scanlines per band               */
+    Short          max;          /* last scanline of the pass        */
+    int            errors[FT_MAX_BLACK_BANDS];
+
+  } black_TBandJob;
+
+
+  /* an `FT_Raster_BandFunc' callback; it uses a private copy of the */
+  /* prototype worker and its own render pool                        */
+  static void
+  Render_Band( void*  data,
+               int    band )
+  {
+    black_TBandJob*  job = (black_TBandJob*)data;
+    black_TWorker    worker[1];
+    Long             buffer[FT_MAX_BLACK_POOL];
+    Short            y_min, y_max;
+
+
+    y_min = (Short)( band * job->band_height );
+    y_max = (Short)( y_min + job->band_height - 1 );
+    if ( y_max > job->max )
+      y_max = job->max;
+
+    *worker      = *job->proto;
+    ras.raster   = NULL;  /* the heap pool can't be shared */
+    ras.buff     = buffer;
+    ras.sizeBuff = (&buffer)[1];
+
+    ras.scan_last           = job->max;
+    ras.band_top            = 0;
+    ras.band_stack[0].y_min = y_min;
+    ras.band_stack[0].y_max = y_max;
+
+    job->errors[band] = Render_Single_Pass( RAS_VARS job->flipped );
+  }
+
+#endif /* !FT_STATIC_RASTER */
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   Render_Pass
+   *
+   * @Description:
+   *   Perform one sweep over scanlines 0 to `max'.  If the client has set
+   *   up an executor, large targets are split into bands that get
+   *   rendered concurrently.  The bands of the vertical pass are disjoint
+   *   sets of rows; in the horizontal pass, they are sets of columns
+   *   aligned to whole bytes.  Either way, the output is identical to a
+   *   serial sweep.
+   *
+   * @Input:
+   *   flipped ::
+   *     If set, flip the direction of the outline.
+   *
+   *   max ::
+   *     The last scanline (i.e., row or column) to render.
+   *
+   * @Return:
+   *   Renderer error code.
+   */
+  static int
+  Render_Pass( RAS_ARGS Bool   flipped,
+                        Short  max )
+  {
+#ifndef FT_STATIC_RASTER
+    const FT_Raster_Executor*  executor = ras.raster ? &ras.raster->executor
+                                                     : NULL;
+
+
+    if ( executor                                             &&
+         executor->execute                                    &&
+         executor->max_bands > 1                              &&
+         max + 1 >= ( executor->min_rows > 0 ? executor->min_rows
+                                             : FT_BLACK_BANDS_MIN_ROWS ) )
+    {
+      black_TBandJob  job;
+      int             num_bands, n;
+
+
+      num_bands = executor->max_bands < FT_MAX_BLACK_BANDS
+                    ? executor->max_bands
+                    : FT_MAX_BLACK_BANDS;
+
+      job.proto       = worker;
+      job.flipped     = flipped;
+      job.max         = max;
+      job.band_height = (Short)( ( max + num_bands ) / num_bands );
+
+      /* bands of columns must not share bytes */
+      if ( flipped )
+        job.band_height = (Short)( ( job.band_height + 7 ) & ~7 );
+
+      num_bands = ( max + job.band_height ) / job.band_height;
+
+      FT_TRACE7(( "Render_Pass: %d bands of %d scanlines\n",
+                  num_bands, job.band_height ));
+
+      executor->execute( executor->pool, num_bands, Render_Band, &job );
+
+      for ( n = 0; n < num_bands; n++ )
+        if ( job.errors[n] )
+          return job.errors[n];
+
+      return Raster_Err_None;
+    }
+#endif /* !FT_STATIC_RASTER */
+
+    ras.scan_last           = max;
+    ras.band_top            = 0;
+    ras.band_stack[0].y_min = 0;
+    ras.band_stack[0].y_max = max;
+
+    return Render_Single_Pass( RAS_VARS flipped );
+  }
+
+
   /**************************************************************************
    *
    * @Function:
@@ -3116,17 +3366,14 @@
     ras.Proc_Sweep_Drop = Vertical_Sweep_Drop;
     ras.Proc_Sweep_Step = Vertical_Sweep_Step;
 
-    ras.band_top            = 0;
-    ras.band_stack[0].y_min = 0;
-    ras.band_stack[0].y_max = (Short)( ras.target.rows - 1 );
-
     ras.bWidth  = (UShort)ras.target.width;
     ras.bOrigin = (Byte*)ras.target.buffer;
 
     if ( ras.target.pitch > 0 )
       ras.bOrigin += (Long)( ras.target.rows - 1 ) * ras.target.pitch;
 
-    if ( ( error = Render_Single_Pass( RAS_VARS 0 ) ) != 0 )
+    error = Render_Pass( RAS_VARS 0, (Short)( ras.target.rows - 1 ) );
+    if ( error )
       return error;
 
     /* Horizontal Sweep */
@@ -3139,11 +3386,9 @@
       ras.Proc_Sweep_Drop = Horizontal_Sweep_Drop;
       ras.Proc_Sweep_Step = Horizontal_Sweep_Step;
 
-      ras.band_top            = 0;
-      ras.band_stack[0].y_min = 0;
-      ras.band_stack[0].y_max = (Short)( ras.target.width - 1 );
-
-      if ( ( error = Render_Single_Pass( RAS_VARS 1 ) ) != 0 )
+      /* the grown render pool of the vertical pass is reused here */
+      error = Render_Pass( RAS_VARS 1, (Short)( ras.target.width - 1 ) );
+      if ( error )
         return error;
     }
 
@@ -3203,7 +3448,8 @@
     *araster = 0;
     if ( !FT_NEW( raster ) )
     {
-      raster->memory = memory;
+      raster->memory   = memory;
+      raster->pool_max = FT_RENDER_POOL_MAX_SIZE;
       ft_black_init( raster );
 
       *araster = raster;
@@ -3242,9 +3488,26 @@
                      ULong      mode,
                      void*      args )
   {
+#ifdef STANDALONE_
     FT_UNUSED( raster );
     FT_UNUSED( mode );
     FT_UNUSED( args );
+#else
+    if ( mode == FT_BLACK_MODE_EXECUTOR )
+    {
+      if ( !args )
+        return FT_THROW( Invalid );
+
+      ( (black_PRaster)raster )->executor = *(FT_Raster_Executor*)args;
+    }
+    else if ( mode == FT_BLACK_MODE_MAX_POOL_SIZE )
+    {
+      if ( !args )
+        return FT_THROW( Invalid );
+
+      ( (black_PRaster)raster )->pool_max = *(ULong*)args;
+    }
+#endif
 
     return 0;
   }
@@ -3256,8 +3519,11 @@
   {
     const FT_Outline*  outline    = (const FT_Outline*)params->source;
     const FT_Bitmap*   target_map = params->target;
+    FT_Error           error;
 
+#ifndef FT_STATIC_RASTER
     black_TWorker  worker[1];
+#endif
 
     Long  buffer[FT_MAX_BLACK_POOL];
 
@@ -3296,13 +3562,26 @@
     if ( !target_map->buffer )
       return FT_THROW( Invalid );
 
-    ras.outline = *outline;
-    ras.target  = *target_map;
+    ras.outline   = *outline;
+    ras.target    = *target_map;
+    ras.raster    = (black_PRaster)raster;
+    ras.heap_pool = NULL;
+
+    ras.buff     = buffer;
+    ras.sizeBuff = (&buffer)[1]; /* Points to right after buffer. */
+
+    error = Render_Glyph( RAS_VAR );
+
+#ifndef STANDALONE_
+    {
+      FT_Memory  memory = (FT_Memory)ras.raster->memory;
 
-    worker->buff     = buffer;
-    worker->sizeBuff = (&buffer)[1]; /* Points to right after buffer. */
 
-    return Render_Glyph( RAS_VAR );
+      FT_FREE( ras.heap_pool );
+    }
+#endif
+
+    return error;
   }
 
 
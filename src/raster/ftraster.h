@@ -38,6 +38,23 @@ FT_BEGIN_HEADER
   FT_EXPORT_VAR( const FT_Raster_Funcs )  ft_standard_raster;
 
 
+  /* `raster_set_mode' tag to set up band-parallel rendering; */
+  /* `args' is a pointer to an `FT_Raster_Executor' structure */
+#define FT_BLACK_MODE_EXECUTOR                                  \
+          ( ( (unsigned long)'b' << 24 ) |                      \
+            ( (unsigned long)'e' << 16 ) |                      \
+            ( (unsigned long)'x' <<  8 ) |                      \
+              (unsigned long)'e'         )
+
+  /* `raster_set_mode' tag to limit the growth of the render pool; */
+  /* `args' is a pointer to an `unsigned long' value (in bytes)    */
+#define FT_BLACK_MODE_MAX_POOL_SIZE                             \
+          ( ( (unsigned long)'p' << 24 ) |                      \
+            ( (unsigned long)'o' << 16 ) |                      \
+            ( (unsigned long)'o' <<  8 ) |                      \
+              (unsigned long)'l'         )
+
+
 FT_END_HEADER
 
 #endif /* FTRASTER_H_ */
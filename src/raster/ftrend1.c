@@ -20,22 +20,150 @@
 #include FT_INTERNAL_DEBUG_H
 #include FT_INTERNAL_OBJECTS_H
 #include FT_OUTLINE_H
+#include FT_DRIVER_H
+#include FT_SERVICE_PROPERTIES_H
 #include "ftrend1.h"
 #include "ftraster.h"
 
 #include "rasterrs.h"
 
 
+  /**************************************************************************
+   *
+   * The macro FT_COMPONENT is used in trace mode.  It is an implicit
+   * parameter of the FT_TRACE() and FT_ERROR() macros, used to print/log
+   * messages during execution.
+   */
+#undef  FT_COMPONENT
+#define FT_COMPONENT  raster
+
+
   /* initialize renderer -- init its raster */
   static FT_Error
   ft_raster1_init( FT_Renderer  render )
   {
+    /* the raster object uses the same default */
+    ( (FT_Raster1_Renderer)render )->max_pool_size = FT_RENDER_POOL_MAX_SIZE;
+
     render->clazz->raster_class->raster_reset( render->raster, NULL, 0 );
 
     return FT_Err_Ok;
   }
 
 
+  static FT_Error
+  ft_raster1_property_set( FT_Module    module,
+                           const char*  property_name,
+                           const void*  value,
+                           FT_Bool      value_is_string )
+  {
+    FT_Raster1_Renderer  render = (FT_Raster1_Renderer)module;
+
+#ifndef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+    FT_UNUSED( value_is_string );
+#endif
+
+
+    if ( !ft_strcmp( property_name, "band-executor" ) )
+    {
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+        return FT_THROW( Invalid_Argument );
+#endif
+
+      render->executor = *(const FT_Raster_Executor*)value;
+
+      return render->root.clazz->raster_class->raster_set_mode(
+               render->root.raster,
+               FT_BLACK_MODE_EXECUTOR,
+               &render->executor );
+    }
+    else if ( !ft_strcmp( property_name, "max-pool-size" ) )
+    {
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s = (const char*)value;
+        long         size = ft_strtol( s, NULL, 10 );
+
+
+        if ( size < 0 )
+          return FT_THROW( Invalid_Argument );
+
+        render->max_pool_size = (FT_ULong)size;
+      }
+      else
+#endif
+        render->max_pool_size = *(const FT_ULong*)value;
+
+      return render->root.clazz->raster_class->raster_set_mode(
+               render->root.raster,
+               FT_BLACK_MODE_MAX_POOL_SIZE,
+               &render->max_pool_size );
+    }
+
+    FT_TRACE0(( "ft_raster1_property_set: missing property `%s'\n",
+                property_name ));
+    return FT_THROW( Missing_Property );
+  }
+
+
+  static FT_Error
+  ft_raster1_property_get( FT_Module    module,
+                           const char*  property_name,
+                           void*        value )
+  {
+    FT_Raster1_Renderer  render = (FT_Raster1_Renderer)module;
+
+
+    if ( !ft_strcmp( property_name, "band-executor" ) )
+    {
+      FT_Raster_Executor*  val = (FT_Raster_Executor*)value;
+
+
+      *val = render->executor;
+
+      return FT_Err_Ok;
+    }
+    else if ( !ft_strcmp( property_name, "max-pool-size" ) )
+    {
+      FT_ULong*  val = (FT_ULong*)value;
+
+
+      *val = render->max_pool_size;
+
+      return FT_Err_Ok;
+    }
+
+    FT_TRACE0(( "ft_raster1_property_get: missing property `%s'\n",
+                property_name ));
+    return FT_THROW( Missing_Property );
+  }
+
+
+  FT_DEFINE_SERVICE_PROPERTIESREC(
+    ft_raster1_service_properties,
+
+    (FT_Properties_SetFunc)ft_raster1_property_set,    /* set_property */
+    (FT_Properties_GetFunc)ft_raster1_property_get )   /* get_property */
+
+
+  FT_DEFINE_SERVICEDESCREC1(
+    ft_raster1_services,
+
+    FT_SERVICE_ID_PROPERTIES, &ft_raster1_service_properties )
+
+
+  FT_CALLBACK_DEF( FT_Module_Interface )
+  ft_raster1_get_interface( FT_Module    module,
+                            const char*  module_interface )
+  {
+    FT_UNUSED( module );
+
+    return ft_service_list_lookup( ft_raster1_services, module_interface );
+  }
+
+
   /* set render-specific mode */
   static FT_Error
   ft_raster1_set_mode( FT_Renderer  render,
@@ -181,7 +309,7 @@
     ft_raster1_renderer_class,
 
       FT_MODULE_RENDERER,
-      sizeof ( FT_RendererRec ),
+      sizeof ( FT_Raster1_RendererRec ),
 
       "raster1",
       0x10000L,
@@ -189,9 +317,9 @@
 
       NULL,    /* module specific interface */
 
-      (FT_Module_Constructor)ft_raster1_init,  /* module_init   */
-      (FT_Module_Destructor) NULL,             /* module_done   */
-      (FT_Module_Requester)  NULL,             /* get_interface */
+      (FT_Module_Constructor)ft_raster1_init,           /* module_init   */
+      (FT_Module_Destructor) NULL,                      /* module_done   */
+      (FT_Module_Requester)  ft_raster1_get_interface,  /* get_interface */
 
     FT_GLYPH_FORMAT_OUTLINE,
 
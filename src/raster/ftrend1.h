@@ -27,6 +27,17 @@
 FT_BEGIN_HEADER
 
 
+  /* the monochrome renderer's module object */
+  typedef struct  FT_Raster1_RendererRec_
+  {
+    FT_RendererRec      root;
+
+    FT_Raster_Executor  executor;       /* `band-executor' property */
+    FT_ULong            max_pool_size;  /* `max-pool-size' property */
+
+  } FT_Raster1_RendererRec, *FT_Raster1_Renderer;
+
+
   FT_DECLARE_RENDERER( ft_raster1_renderer_class )
 
 
@@ -0,0 +1,327 @@
+/****************************************************************************
+ *
+ * ftbsdf.c
+ *
+ *   Signed distance field raster for bitmaps (body).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+  /**************************************************************************
+   *
+   * A pixel is inside if its coverage is at least 128.  Since distances
+   * beyond `spread' pixels get clamped anyway, we compute an exact
+   * Euclidean distance transform restricted to that range, in two
+   * separable passes: first the horizontal distance of every pixel to the
+   * nearest inside and outside pixel of its row, then the minimum over
+   * the neighbouring rows.  Pixels next to the other class use their
+   * coverage to place the edge with subpixel accuracy.
+   *
+   */
+
+
+#include <ft2build.h>
+#include FT_INTERNAL_DEBUG_H
+#include FT_INTERNAL_OBJECTS_H
+
+#include "ftsdf.h"
+#include "ftsdfcommon.h"
+
+#include "ftsdferrs.h"
+
+
+  /**************************************************************************
+   *
+   * The macro FT_COMPONENT is used in trace mode.  It is an implicit
+   * parameter of the FT_TRACE() and FT_ERROR() macros, used to print/log
+   * messages during execution.
+   */
+#undef  FT_COMPONENT
+#define FT_COMPONENT  sdf
+
+
+  typedef struct  BSDF_TRaster_
+  {
+    FT_Memory  memory;
+
+  } BSDF_TRaster, *BSDF_PRaster;
+
+
+  /* Compute, for each pixel of a row, the distance to the closest pixel */
+  /* with `inside' status `state', clamped to `cap'.                     */
+  static void
+  bsdf_row_distances( const FT_Byte*  coverage,
+                      FT_Byte*        dist,
+                      FT_Int          width,
+                      FT_Bool         state,
+                      FT_Byte         cap )
+  {
+    FT_Byte  d = cap;
+    FT_Int   x;
+
+
+    for ( x = 0; x < width; x++ )
+    {
+      if ( ( coverage[x] >= 128 ) == state )
+        d = 0;
+      else if ( d < cap )
+        d++;
+
+      dist[x] = d;
+    }
+
+    d = cap;
+    for ( x = width - 1; x >= 0; x-- )
+    {
+      if ( ( coverage[x] >= 128 ) == state )
+        d = 0;
+      else if ( d < cap )
+        d++;
+
+      if ( d < dist[x] )
+        dist[x] = d;
+    }
+  }
+
+
+  static FT_Error
+  bsdf_generate( FT_Memory         memory,
+                 const FT_Bitmap*  source,
+                 const FT_Bitmap*  target,
+                 FT_UInt           spread )
+  {
+    FT_Error  error;
+    FT_Int    width  = (FT_Int)target->width;
+    FT_Int    rows   = (FT_Int)target->rows;
+    FT_Int    pad    = (FT_Int)spread;
+    FT_Byte   cap    = (FT_Byte)( spread + 1 );
+    FT_Long   size   = (FT_Long)width * rows;
+    FT_Byte*  buffer = NULL;
+    FT_Byte*  coverage;
+    FT_Byte*  to_inside;
+    FT_Byte*  to_outside;
+    FT_Byte*  line;
+    FT_Int    x, y;
+
+
+    /* coverage, with `spread' pixels of padding, and row distances */
+    if ( FT_ALLOC_MULT( buffer, size, 3 ) )
+      return error;
+
+    coverage   = buffer;
+    to_inside  = buffer + size;
+    to_outside = buffer + 2 * size;
+
+    for ( y = 0; y < (FT_Int)source->rows; y++ )
+    {
+      const FT_Byte*  src = source->buffer;
+
+
+      if ( source->pitch < 0 )
+        src -= ( (FT_Int)source->rows - 1 - y ) * source->pitch;
+      else
+        src += y * source->pitch;
+
+      FT_MEM_COPY( coverage + ( y + pad ) * width + pad,
+                   src,
+                   source->width );
+    }
+
+    for ( y = 0; y < rows; y++ )
+    {
+      bsdf_row_distances( coverage + y * width, to_inside + y * width,
+                          width, 1, cap );
+      bsdf_row_distances( coverage + y * width, to_outside + y * width,
+                          width, 0, cap );
+    }
+
+    for ( y = 0; y < rows; y++ )
+    {
+      line = target->buffer;
+      if ( target->pitch < 0 )
+        line -= ( rows - 1 - y ) * target->pitch;
+      else
+        line += y * target->pitch;
+
+      for ( x = 0; x < width; x++ )
+      {
+        FT_Int    offset = y * width + x;
+        FT_Byte   a      = coverage[offset];
+        FT_Bool   inside = (FT_Bool)( a >= 128 );
+        FT_Byte*  other  = inside ? to_outside : to_inside;
+        FT_Int    best   = other[offset] * other[offset];
+        FT_Int    dy;
+        FT_Pos    dist;
+
+
+        /* the columns are independent: take the closest row */
+        for ( dy = 1; dy <= pad && dy * dy < best; dy++ )
+        {
+          FT_Int  d;
+
+
+          if ( y >= dy )
+          {
+            d = other[offset - dy * width];
+            if ( d * d + dy * dy < best )
+              best = d * d + dy * dy;
+          }
+          if ( y + dy < rows )
+          {
+            d = other[offset + dy * width];
+            if ( d * d + dy * dy < best )
+              best = d * d + dy * dy;
+          }
+        }
+
+        if ( best == 1 )
+        {
+          /* the edge runs through this pixel or its neighbour */
+          dist = ( ( 2 * a - 255 ) * 32 ) / 255;
+        }
+        else
+        {
+          /* the edge lies about half a pixel before the closest */
+          /* pixel of the other class                            */
+          if ( best >= cap * cap )
+            dist = 64 * pad;
+          else
+            dist = (FT_Pos)ft_sdf_sqrt( (FT_UInt32)best << 12 ) - 32;
+
+          if ( !inside )
+            dist = -dist;
+        }
+
+        line[x] = ft_sdf_pixel( dist, spread );
+      }
+    }
+
+    FT_FREE( buffer );
+
+    return FT_Err_Ok;
+  }
+
+
+  static int
+  bsdf_raster_new( FT_Memory   memory,
+                   FT_Raster*  araster )
+  {
+    FT_Error      error;
+    BSDF_PRaster  raster = NULL;
+
+
+    if ( !FT_NEW( raster ) )
+      raster->memory = memory;
+
+    *araster = (FT_Raster)raster;
+
+    return error;
+  }
+
+
+  static void
+  bsdf_raster_reset( FT_Raster       raster,
+                     unsigned char*  pool_base,
+                     unsigned long   pool_size )
+  {
+    FT_UNUSED( raster );
+    FT_UNUSED( pool_base );
+    FT_UNUSED( pool_size );
+  }
+
+
+  static int
+  bsdf_raster_set_mode( FT_Raster      raster,
+                        unsigned long  mode,
+                        void*          args )
+  {
+    FT_UNUSED( raster );
+    FT_UNUSED( mode );
+    FT_UNUSED( args );
+
+    return 0;
+  }
+
+
+  static int
+  bsdf_raster_render( FT_Raster                raster,
+                      const FT_Raster_Params*  params )
+  {
+    BSDF_PRaster              bsdf = (BSDF_PRaster)raster;
+    const SDF_Raster_Params*  sdf_params;
+    const FT_Bitmap*          source;
+    const FT_Bitmap*          target;
+    FT_UInt                   spread;
+
+
+    if ( !bsdf || !params )
+      return FT_THROW( Invalid_Argument );
+
+    if ( !( params->flags & SDF_RASTER_FLAG_SDF ) )
+      return FT_THROW( Cannot_Render_Glyph );
+
+    sdf_params = (const SDF_Raster_Params*)params;
+    source     = (const FT_Bitmap*)params->source;
+    target     = params->target;
+    spread     = sdf_params->spread;
+
+    if ( !source || !target )
+      return FT_THROW( Invalid_Argument );
+
+    if ( spread < SDF_MIN_SPREAD || spread > SDF_MAX_SPREAD )
+      return FT_THROW( Invalid_Argument );
+
+    if ( source->pixel_mode != FT_PIXEL_MODE_GRAY ||
+         target->pixel_mode != FT_PIXEL_MODE_GRAY )
+      return FT_THROW( Invalid_Argument );
+
+    if ( target->width != source->width + 2 * spread ||
+         target->rows  != source->rows + 2 * spread  )
+      return FT_THROW( Invalid_Argument );
+
+    if ( !target->buffer || ( source->rows && !source->buffer ) )
+      return FT_THROW( Invalid_Argument );
+
+    return bsdf_generate( bsdf->memory, source, target, spread );
+  }
+
+
+  static void
+  bsdf_raster_done( FT_Raster  raster )
+  {
+    BSDF_PRaster  bsdf = (BSDF_PRaster)raster;
+
+
+    if ( bsdf )
+    {
+      FT_Memory  memory = bsdf->memory;
+
+
+      FT_FREE( bsdf );
+    }
+  }
+
+
+  FT_DEFINE_RASTER_FUNCS(
+    ft_bitmap_sdf_raster,
+
+    FT_GLYPH_FORMAT_BITMAP,
+
+    (FT_Raster_New_Func)     bsdf_raster_new,       /* raster_new      */
+    (FT_Raster_Reset_Func)   bsdf_raster_reset,     /* raster_reset    */
+    (FT_Raster_Set_Mode_Func)bsdf_raster_set_mode,  /* raster_set_mode */
+    (FT_Raster_Render_Func)  bsdf_raster_render,    /* raster_render   */
+    (FT_Raster_Done_Func)    bsdf_raster_done       /* raster_done     */
+  )
+
+
+/* END */
@@ -0,0 +1,845 @@
+/****************************************************************************
+ *
+ * ftsdf.c
+ *
+ *   Signed distance field raster for outlines (body).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+  /**************************************************************************
+   *
+   * The outline is flattened into line segments (`edges'), which are
+   * distributed into a coarse grid of square cells: a cell lists all edges
+   * that can be closer than `spread' pixels to one of its pixel centers.
+   * The unsigned distance of a pixel is then the minimum distance to the
+   * few edges of its cell; pixels without a close edge get clamped
+   * values.  The sign comes from a scanline pass over the edges sorted by
+   * their lowest y coordinate, honouring the outline's fill rule.
+   *
+   * All coordinates are in 26.6 pixels, shifted by half a pixel so that
+   * pixel centers lie on integer pixel positions.
+   *
+   */
+
+
+#include <ft2build.h>
+#include FT_INTERNAL_DEBUG_H
+#include FT_INTERNAL_OBJECTS_H
+#include FT_INTERNAL_CALC_H
+#include FT_OUTLINE_H
+#include FT_TRIGONOMETRY_H
+
+#include "ftsdf.h"
+#include "ftsdfcommon.h"
+
+#include "ftsdferrs.h"
+
+
+  /**************************************************************************
+   *
+   * The macro FT_COMPONENT is used in trace mode.  It is an implicit
+   * parameter of the FT_TRACE() and FT_ERROR() macros, used to print/log
+   * messages during execution.
+   */
+#undef  FT_COMPONENT
+#define FT_COMPONENT  sdf
+
+
+  /* maximum distance between a curve and its flattened version */
+#define SDF_FLATNESS  4   /* 1/16th of a pixel */
+
+  /* maximum recursion depth when flattening curves */
+#define SDF_MAX_SPLIT  16
+
+  /* minimum size of the grid cells in pixels */
+#define SDF_MIN_CELL_SIZE  4
+
+
+  typedef struct  SDF_TRaster_
+  {
+    FT_Memory  memory;
+
+  } SDF_TRaster, *SDF_PRaster;
+
+
+  typedef struct  SDF_Edge_
+  {
+    FT_Vector  start;
+    FT_Vector  end;
+    FT_Vector  dir;     /* unit vector from `start' to `end', in 16.16 */
+    FT_Pos     length;
+    FT_BBox    bbox;
+
+  } SDF_Edge;
+
+
+  typedef struct  SDF_Crossing_
+  {
+    FT_Pos  x;
+    FT_Int  dir;        /* +1 for upwards edges, -1 for downwards ones */
+
+  } SDF_Crossing;
+
+
+  typedef struct  SDF_Grid_
+  {
+    FT_Int    width;      /* in cells        */
+    FT_Int    height;
+    FT_Pos    cell_size;  /* in 26.6 pixels  */
+    FT_UInt*  starts;     /* `width * height + 1' offsets into `entries' */
+    FT_UInt*  entries;    /* edge indices    */
+
+  } SDF_Grid;
+
+
+  typedef struct  SDF_Worker_
+  {
+    FT_Memory  memory;
+
+    SDF_Edge*  edges;
+    FT_UInt    num_edges;
+    FT_UInt    max_edges;
+
+    FT_Vector  last;
+
+  } SDF_Worker;
+
+
+  /*************************************************************************/
+  /*                                                                       */
+  /* Outline flattening.                                                   */
+  /*                                                                       */
+
+  static FT_Error
+  sdf_add_edge( SDF_Worker*       worker,
+                const FT_Vector*  from,
+                const FT_Vector*  to )
+  {
+    FT_Memory  memory = worker->memory;
+    FT_Error   error  = FT_Err_Ok;
+    SDF_Edge*  edge;
+    FT_Vector  d;
+
+
+    d.x = to->x - from->x;
+    d.y = to->y - from->y;
+
+    if ( !d.x && !d.y )
+      return FT_Err_Ok;
+
+    if ( worker->num_edges >= worker->max_edges )
+    {
+      FT_UInt  new_max = worker->max_edges ? 2 * worker->max_edges : 64;
+
+
+      if ( FT_QRENEW_ARRAY( worker->edges, worker->max_edges, new_max ) )
+        return error;
+
+      worker->max_edges = new_max;
+    }
+
+    edge = worker->edges + worker->num_edges++;
+
+    edge->start  = *from;
+    edge->end    = *to;
+    edge->length = (FT_Pos)FT_Vector_Length( &d );
+    edge->dir.x  = FT_DivFix( d.x, edge->length );
+    edge->dir.y  = FT_DivFix( d.y, edge->length );
+
+    edge->bbox.xMin = FT_MIN( from->x, to->x );
+    edge->bbox.xMax = FT_MAX( from->x, to->x );
+    edge->bbox.yMin = FT_MIN( from->y, to->y );
+    edge->bbox.yMax = FT_MAX( from->y, to->y );
+
+    return FT_Err_Ok;
+  }
+
+
+  static FT_Error
+  sdf_split_conic( SDF_Worker*       worker,
+                   const FT_Vector*  p0,
+                   const FT_Vector*  p1,
+                   const FT_Vector*  p2,
+                   FT_Int            depth )
+  {
+    FT_Vector  a, b, m;
+    FT_Error   error;
+    FT_Pos     dx = p0->x - 2 * p1->x + p2->x;
+    FT_Pos     dy = p0->y - 2 * p1->y + p2->y;
+
+
+    /* the curve deviates from its chord by a quarter of that vector */
+    if ( depth <= 0 || FT_ABS( dx ) + FT_ABS( dy ) <= 4 * SDF_FLATNESS )
+      return sdf_add_edge( worker, p0, p2 );
+
+    a.x = ( p0->x + p1->x ) / 2;
+    a.y = ( p0->y + p1->y ) / 2;
+    b.x = ( p1->x + p2->x ) / 2;
+    b.y = ( p1->y + p2->y ) / 2;
+    m.x = ( a.x + b.x ) / 2;
+    m.y = ( a.y + b.y ) / 2;
+
+    error = sdf_split_conic( worker, p0, &a, &m, depth - 1 );
+    if ( !error )
+      error = sdf_split_conic( worker, &m, &b, p2, depth - 1 );
+
+    return error;
+  }
+
+
+  static FT_Error
+  sdf_split_cubic( SDF_Worker*       worker,
+                   const FT_Vector*  p0,
+                   const FT_Vector*  p1,
+                   const FT_Vector*  p2,
+                   const FT_Vector*  p3,
+                   FT_Int            depth )
+  {
+    FT_Vector  ab, bc, cd, abc, bcd, m;
+    FT_Error   error;
+    FT_Pos     d1, d2;
+
+
+    d1 = FT_ABS( p0->x - 2 * p1->x + p2->x ) +
+         FT_ABS( p0->y - 2 * p1->y + p2->y );
+    d2 = FT_ABS( p1->x - 2 * p2->x + p3->x ) +
+         FT_ABS( p1->y - 2 * p2->y + p3->y );
+
+    /* the deviation is at most 3/4 of the larger second difference */
+    if ( depth <= 0 || 3 * FT_MAX( d1, d2 ) <= 4 * SDF_FLATNESS )
+      return sdf_add_edge( worker, p0, p3 );
+
+    ab.x  = ( p0->x + p1->x ) / 2;
+    ab.y  = ( p0->y + p1->y ) / 2;
+    bc.x  = ( p1->x + p2->x ) / 2;
+    bc.y  = ( p1->y + p2->y ) / 2;
+    cd.x  = ( p2->x + p3->x ) / 2;
+    cd.y  = ( p2->y + p3->y ) / 2;
+    abc.x = ( ab.x + bc.x ) / 2;
+    abc.y = ( ab.y + bc.y ) / 2;
+    bcd.x = ( bc.x + cd.x ) / 2;
+    bcd.y = ( bc.y + cd.y ) / 2;
+    m.x   = ( abc.x + bcd.x ) / 2;
+    m.y   = ( abc.y + bcd.y ) / 2;
+
+    error = sdf_split_cubic( worker, p0, &ab, &abc, &m, depth - 1 );
+    if ( !error )
+      error = sdf_split_cubic( worker, &m, &bcd, &cd, p3, depth - 1 );
+
+    return error;
+  }
+
+
+  /* shift a point so that pixel centers are at integer positions */
+#define SDF_SHIFT( v, p )        \
+          FT_BEGIN_STMNT         \
+            (v).x = (p)->x - 32; \
+            (v).y = (p)->y - 32; \
+          FT_END_STMNT
+
+
+  static int
+  sdf_move_to( const FT_Vector*  to,
+               void*             user )
+  {
+    SDF_Worker*  worker = (SDF_Worker*)user;
+
+
+    SDF_SHIFT( worker->last, to );
+
+    return 0;
+  }
+
+
+  static int
+  sdf_line_to( const FT_Vector*  to,
+               void*             user )
+  {
+    SDF_Worker*  worker = (SDF_Worker*)user;
+    FT_Vector    p;
+    FT_Error     error;
+
+
+    SDF_SHIFT( p, to );
+
+    error        = sdf_add_edge( worker, &worker->last, &p );
+    worker->last = p;
+
+    return error;
+  }
+
+
+  static int
+  sdf_conic_to( const FT_Vector*  control,
+                const FT_Vector*  to,
+                void*             user )
+  {
+    SDF_Worker*  worker = (SDF_Worker*)user;
+    FT_Vector    c, p;
+    FT_Error     error;
+
+
+    SDF_SHIFT( c, control );
+    SDF_SHIFT( p, to );
+
+    error        = sdf_split_conic( worker, &worker->last, &c, &p,
+                                    SDF_MAX_SPLIT );
+    worker->last = p;
+
+    return error;
+  }
+
+
+  static int
+  sdf_cubic_to( const FT_Vector*  control1,
+                const FT_Vector*  control2,
+                const FT_Vector*  to,
+                void*             user )
+  {
+    SDF_Worker*  worker = (SDF_Worker*)user;
+    FT_Vector    c1, c2, p;
+    FT_Error     error;
+
+
+    SDF_SHIFT( c1, control1 );
+    SDF_SHIFT( c2, control2 );
+    SDF_SHIFT( p, to );
+
+    error        = sdf_split_cubic( worker, &worker->last, &c1, &c2, &p,
+                                    SDF_MAX_SPLIT );
+    worker->last = p;
+
+    return error;
+  }
+
+
+  FT_DEFINE_OUTLINE_FUNCS(
+    sdf_decompose_funcs,
+
+    (FT_Outline_MoveTo_Func) sdf_move_to,   /* move_to  */
+    (FT_Outline_LineTo_Func) sdf_line_to,   /* line_to  */
+    (FT_Outline_ConicTo_Func)sdf_conic_to,  /* conic_to */
+    (FT_Outline_CubicTo_Func)sdf_cubic_to,  /* cubic_to */
+
+    0,                                      /* shift    */
+    0                                       /* delta    */
+  )
+
+
+  /*************************************************************************/
+  /*                                                                       */
+  /* Edge bucketing.                                                       */
+  /*                                                                       */
+
+  /* ft_qsort callback to sort edges by their lowest y coordinate */
+  FT_CALLBACK_DEF( int )
+  sdf_compare_edges( const void*  a,
+                     const void*  b )
+  {
+    const SDF_Edge*  edge1 = (const SDF_Edge*)a;
+    const SDF_Edge*  edge2 = (const SDF_Edge*)b;
+
+
+    if ( edge1->bbox.yMin < edge2->bbox.yMin )
+      return -1;
+    if ( edge1->bbox.yMin > edge2->bbox.yMin )
+      return 1;
+
+    return 0;
+  }
+
+
+  /* Visit all grid cells containing a pixel center within `spread' of */
+  /* `edge'.  If `grid->entries' is NULL, only count the edge in       */
+  /* `grid->starts'; otherwise store `index' (after counting).         */
+  static void
+  sdf_bucket_edge( SDF_Grid*        grid,
+                   const SDF_Edge*  edge,
+                   FT_UInt          index,
+                   FT_Pos           spread )
+  {
+    FT_Pos  size = grid->cell_size;
+    FT_Pos  y_min, y_max;
+    FT_Int  cy, cy_min, cy_max;
+
+
+    y_min = edge->bbox.yMin - spread;
+    y_max = edge->bbox.yMax + spread;
+
+    if ( y_max < 0 || edge->bbox.xMax + spread < 0 )
+      return;
+
+    cy_min = y_min < 0 ? 0 : (FT_Int)( y_min / size );
+    cy_max = (FT_Int)( y_max / size );
+    if ( cy_max >= grid->height )
+      cy_max = grid->height - 1;
+
+    for ( cy = cy_min; cy <= cy_max; cy++ )
+    {
+      /* the part of the edge that can reach pixels of this cell row */
+      FT_Pos  band_min = cy * size - spread;
+      FT_Pos  band_max = cy * size + size - 64 + spread;
+      FT_Pos  x_min, x_max;
+      FT_Int  cx, cx_min, cx_max;
+
+
+      if ( edge->start.y == edge->end.y )
+      {
+        x_min = edge->bbox.xMin;
+        x_max = edge->bbox.xMax;
+      }
+      else
+      {
+        FT_Pos  ya = FT_MAX( band_min, edge->bbox.yMin );
+        FT_Pos  yb = FT_MIN( band_max, edge->bbox.yMax );
+        FT_Pos  dx = edge->end.x - edge->start.x;
+        FT_Pos  dy = edge->end.y - edge->start.y;
+
+
+        if ( ya > yb )
+          continue;
+
+        x_min = edge->start.x + FT_MulDiv( ya - edge->start.y, dx, dy );
+        x_max = edge->start.x + FT_MulDiv( yb - edge->start.y, dx, dy );
+
+        if ( x_min > x_max )
+        {
+          FT_Pos  tmp = x_min;
+
+
+          x_min = x_max;
+          x_max = tmp;
+        }
+      }
+
+      x_min -= spread;
+      x_max += spread;
+
+      if ( x_max < 0 )
+        continue;
+
+      cx_min = x_min < 0 ? 0 : (FT_Int)( x_min / size );
+      cx_max = (FT_Int)( x_max / size );
+      if ( cx_max >= grid->width )
+        cx_max = grid->width - 1;
+
+      for ( cx = cx_min; cx <= cx_max; cx++ )
+      {
+        FT_UInt*  start = grid->starts + cy * grid->width + cx;
+
+
+        if ( grid->entries )
+          grid->entries[--*start] = index;
+        else
+          ( *start )++;
+      }
+    }
+  }
+
+
+  /* Lower the squared distances in `band' (`rows' rows of `width' */
+  /* pixels, starting at pixel row `y0') for the pixels in columns  */
+  /* `x0' to `x1' (exclusive) within reach of `edge'.               */
+  static void
+  sdf_edge_distances( const SDF_Edge*  edge,
+                      FT_Long*         band,
+                      FT_Int           width,
+                      FT_Int           x0,
+                      FT_Int           x1,
+                      FT_Int           y0,
+                      FT_Int           rows,
+                      FT_Pos           spread )
+  {
+    FT_Int  x, y;
+
+
+    for ( y = 0; y < rows; y++ )
+    {
+      FT_Long*  dist2 = band + y * width;
+      FT_Pos    yc    = 64 * ( y0 + y );
+      FT_Pos    vy    = yc - edge->start.y;
+      FT_Pos    wy    = yc - edge->end.y;
+      FT_Pos    vy_x, vy_y;
+
+
+      if ( yc <= edge->bbox.yMin - spread ||
+           yc >= edge->bbox.yMax + spread )
+        continue;
+
+      /* the contributions of the row to the projections */
+      vy_x = FT_MulFix( vy, edge->dir.x );
+      vy_y = FT_MulFix( vy, edge->dir.y );
+
+      for ( x = x0; x < x1; x++ )
+      {
+        FT_Pos  xc = 64 * x;
+        FT_Pos  vx = xc - edge->start.x;
+        FT_Pos  dx, dy, proj;
+
+
+        proj = FT_MulFix( vx, edge->dir.x ) + vy_y;
+
+        if ( proj <= 0 )
+        {
+          dx = vx;
+          dy = vy;
+        }
+        else if ( proj >= edge->length )
+        {
+          dx = xc - edge->end.x;
+          dy = wy;
+        }
+        else
+        {
+          /* distance to the line */
+          dx = FT_MulFix( vx, edge->dir.y ) - vy_x;
+          dy = 0;
+        }
+
+        dx = FT_ABS( dx );
+        dy = FT_ABS( dy );
+        if ( dx < spread && dy < spread && dx * dx + dy * dy < dist2[x] )
+          dist2[x] = dx * dx + dy * dy;
+      }
+    }
+  }
+
+
+  static FT_Error
+  sdf_generate( SDF_Worker*       worker,
+                const FT_Bitmap*  target,
+                FT_UInt           spread,
+                FT_Bool           even_odd )
+  {
+    FT_Memory  memory    = worker->memory;
+    FT_Error   error     = FT_Err_Ok;
+    SDF_Edge*  edges     = worker->edges;
+    FT_UInt    num_edges = worker->num_edges;
+    FT_Int     width     = (FT_Int)target->width;
+    FT_Int     rows      = (FT_Int)target->rows;
+    FT_Int     pitch     = target->pitch;
+    FT_Pos     max_dist  = 64 * (FT_Pos)spread;
+    FT_Long    max_dist2 = max_dist * max_dist;
+    FT_Int     cell_size = (FT_Int)FT_MAX( spread, SDF_MIN_CELL_SIZE );
+    FT_Byte*   origin;
+
+    SDF_Grid       grid;
+    FT_Long*       band      = NULL;
+    FT_UInt*       active    = NULL;
+    SDF_Crossing*  crossings = NULL;
+    FT_UInt        num_active, next;
+    FT_UInt        total, i;
+    FT_Int         num_cells, x, y, cx, cy;
+
+
+    grid.width     = ( width + cell_size - 1 ) / cell_size;
+    grid.height    = ( rows + cell_size - 1 ) / cell_size;
+    grid.cell_size = 64 * cell_size;
+    grid.starts    = NULL;
+    grid.entries   = NULL;
+
+    num_cells = grid.width * grid.height;
+
+    if ( FT_NEW_ARRAY( grid.starts, num_cells + 1 )          ||
+         FT_QNEW_ARRAY( band, (FT_ULong)width * cell_size )  ||
+         FT_QNEW_ARRAY( active, num_edges + 1 )              ||
+         FT_QNEW_ARRAY( crossings, num_edges + 1 )           )
+      goto Exit;
+
+    ft_qsort( edges, num_edges, sizeof ( SDF_Edge ), sdf_compare_edges );
+
+    /* count the cell entries, then fill them back to front */
+    for ( i = 0; i < num_edges; i++ )
+      sdf_bucket_edge( &grid, edges + i, i, max_dist );
+
+    total = 0;
+    for ( x = 0; x < num_cells; x++ )
+    {
+      total          += grid.starts[x];
+      grid.starts[x]  = total;
+    }
+    grid.starts[num_cells] = total;
+
+    FT_TRACE5(( "sdf_generate: %d edges, %d cells, %d entries\n",
+                num_edges, num_cells, total ));
+
+    if ( FT_QNEW_ARRAY( grid.entries, total + 1 ) )
+      goto Exit;
+
+    for ( i = 0; i < num_edges; i++ )
+      sdf_bucket_edge( &grid, edges + i, i, max_dist );
+
+    origin = target->buffer;
+    if ( pitch > 0 )
+      origin += (FT_UInt)( rows - 1 ) * (FT_UInt)pitch;
+
+    num_active = 0;
+    next       = 0;
+
+    /* work on one row of cells at a time, from bottom to top */
+    for ( cy = 0; cy < grid.height; cy++ )
+    {
+      FT_Int  y0        = cy * cell_size;
+      FT_Int  band_rows = FT_MIN( cell_size, rows - y0 );
+
+
+      /* unsigned distances, edge by edge within each cell */
+      for ( x = 0; x < band_rows * width; x++ )
+        band[x] = max_dist2;
+
+      for ( cx = 0; cx < grid.width; cx++ )
+      {
+        FT_Int          cell  = cy * grid.width + cx;
+        const FT_UInt*  p     = grid.entries + grid.starts[cell];
+        const FT_UInt*  limit = grid.entries + grid.starts[cell + 1];
+        FT_Int          x0    = cx * cell_size;
+        FT_Int          x1    = FT_MIN( x0 + cell_size, width );
+
+
+        for ( ; p < limit; p++ )
+          sdf_edge_distances( edges + *p, band, width,
+                              x0, x1, y0, band_rows, max_dist );
+      }
+
+      /* signs, with a scanline pass over the edges */
+      for ( y = y0; y < y0 + band_rows; y++ )
+      {
+        FT_Byte*  line          = origin - y * pitch;
+        FT_Long*  dist2         = band + ( y - y0 ) * width;
+        FT_Pos    yc            = 64 * y;
+        FT_UInt   num_crossings = 0;
+        FT_UInt   k             = 0;
+        FT_Int    winding       = 0;
+        FT_UInt   n;
+
+
+        while ( next < num_edges && edges[next].bbox.yMin <= yc )
+          active[num_active++] = next++;
+
+        /* drop finished edges; collect the crossings of the others, */
+        /* using the half-open interval [yMin;yMax[                  */
+        n = 0;
+        for ( i = 0; i < num_active; i++ )
+        {
+          const SDF_Edge*  edge = edges + active[i];
+          FT_Pos           xc;
+          FT_UInt          j;
+
+
+          if ( edge->bbox.yMax <= yc )
+            continue;
+
+          active[n++] = active[i];
+
+          xc = edge->start.x + FT_MulDiv( yc - edge->start.y,
+                                          edge->end.x - edge->start.x,
+                                          edge->end.y - edge->start.y );
+
+          for ( j = num_crossings++;
+                j > 0 && crossings[j - 1].x > xc;
+                j-- )
+            crossings[j] = crossings[j - 1];
+
+          crossings[j].x   = xc;
+          crossings[j].dir = edge->end.y > edge->start.y ? 1 : -1;
+        }
+        num_active = n;
+
+        for ( x = 0; x < width; x++ )
+        {
+          FT_Pos   xc = 64 * x;
+          FT_Pos   dist;
+          FT_Bool  inside;
+
+
+          while ( k < num_crossings && crossings[k].x < xc )
+          {
+            winding += even_odd ? 1 : crossings[k].dir;
+            k++;
+          }
+
+          inside = (FT_Bool)( even_odd ? ( winding & 1 )
+                                       : ( winding != 0 ) );
+
+          dist = dist2[x] >= max_dist2
+                   ? max_dist
+                   : (FT_Pos)ft_sdf_sqrt( (FT_UInt32)dist2[x] );
+
+          line[x] = ft_sdf_pixel( inside ? dist : -dist, spread );
+        }
+      }
+    }
+
+  Exit:
+    FT_FREE( grid.starts );
+    FT_FREE( grid.entries );
+    FT_FREE( band );
+    FT_FREE( active );
+    FT_FREE( crossings );
+
+    return error;
+  }
+
+
+  /*************************************************************************/
+  /*                                                                       */
+  /* Raster interface.                                                     */
+  /*                                                                       */
+
+  static int
+  sdf_raster_new( FT_Memory   memory,
+                  FT_Raster*  araster )
+  {
+    FT_Error     error;
+    SDF_PRaster  raster = NULL;
+
+
+    if ( !FT_NEW( raster ) )
+      raster->memory = memory;
+
+    *araster = (FT_Raster)raster;
+
+    return error;
+  }
+
+
+  static void
+  sdf_raster_reset( FT_Raster       raster,
+                    unsigned char*  pool_base,
+                    unsigned long   pool_size )
+  {
+    FT_UNUSED( raster );
+    FT_UNUSED( pool_base );
+    FT_UNUSED( pool_size );
+  }
+
+
+  static int
+  sdf_raster_set_mode( FT_Raster      raster,
+                       unsigned long  mode,
+                       void*          args )
+  {
+    FT_UNUSED( raster );
+    FT_UNUSED( mode );
+    FT_UNUSED( args );
+
+    return 0;
+  }
+
+
+  static int
+  sdf_raster_render( FT_Raster                raster,
+                     const FT_Raster_Params*  params )
+  {
+    SDF_PRaster               sdf = (SDF_PRaster)raster;
+    const SDF_Raster_Params*  sdf_params;
+    const FT_Outline*         outline;
+    const FT_Bitmap*          target;
+    FT_Memory                 memory;
+    FT_Error                  error;
+    SDF_Worker                worker;
+
+
+    if ( !sdf || !params )
+      return FT_THROW( Invalid_Argument );
+
+    /* we can be called by `FT_Outline_Render' with normal parameters */
+    if ( !( params->flags & SDF_RASTER_FLAG_SDF ) )
+      return FT_THROW( Cannot_Render_Glyph );
+
+    sdf_params = (const SDF_Raster_Params*)params;
+    outline    = (const FT_Outline*)params->source;
+    target     = params->target;
+    memory     = sdf->memory;
+
+    if ( !outline )
+      return FT_THROW( Invalid_Outline );
+
+    if ( !target || !target->buffer                 ||
+         target->pixel_mode != FT_PIXEL_MODE_GRAY   ||
+         sdf_params->spread < SDF_MIN_SPREAD        ||
+         sdf_params->spread > SDF_MAX_SPREAD        )
+      return FT_THROW( Invalid_Argument );
+
+    if ( outline->n_points <= 0 || outline->n_contours <= 0 )
+    {
+      /* everything is outside */
+      FT_Int  y;
+
+
+      for ( y = 0; y < (FT_Int)target->rows; y++ )
+        FT_MEM_ZERO( target->buffer + y * FT_ABS( target->pitch ),
+                     target->width );
+
+      return FT_Err_Ok;
+    }
+
+    if ( !outline->contours || !outline->points )
+      return FT_THROW( Invalid_Outline );
+
+    if ( outline->n_points !=
+           outline->contours[outline->n_contours - 1] + 1 )
+      return FT_THROW( Invalid_Outline );
+
+    if ( !target->width || !target->rows )
+      return FT_Err_Ok;
+
+    FT_ZERO( &worker );
+    worker.memory = memory;
+
+    error = FT_Outline_Decompose( (FT_Outline*)outline,
+                                  &sdf_decompose_funcs,
+                                  &worker );
+    if ( !error )
+      error = sdf_generate( &worker,
+                            target,
+                            sdf_params->spread,
+                            (FT_Bool)( ( outline->flags &
+                                         FT_OUTLINE_EVEN_ODD_FILL ) != 0 ) );
+
+    FT_FREE( worker.edges );
+
+    return error;
+  }
+
+
+  static void
+  sdf_raster_done( FT_Raster  raster )
+  {
+    SDF_PRaster  sdf = (SDF_PRaster)raster;
+
+
+    if ( sdf )
+    {
+      FT_Memory  memory = sdf->memory;
+
+
+      FT_FREE( sdf );
+    }
+  }
+
+
+  FT_DEFINE_RASTER_FUNCS(
+    ft_sdf_raster,
+
+    FT_GLYPH_FORMAT_OUTLINE,
+
+    (FT_Raster_New_Func)     sdf_raster_new,       /* raster_new      */
+    (FT_Raster_Reset_Func)   sdf_raster_reset,     /* raster_reset    */
+    (FT_Raster_Set_Mode_Func)sdf_raster_set_mode,  /* raster_set_mode */
+    (FT_Raster_Render_Func)  sdf_raster_render,    /* raster_render   */
+    (FT_Raster_Done_Func)    sdf_raster_done       /* raster_done     */
+  )
+
+
+/* END */
@@ -0,0 +1,40 @@
+/****************************************************************************
+ *
+ * ftsdf.h
+ *
+ *   Signed distance field rasters (specification).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#ifndef FTSDF_H_
+#define FTSDF_H_
+
+
+#include <ft2build.h>
+#include FT_IMAGE_H
+
+
+FT_BEGIN_HEADER
+
+  /* computes a distance field from an `FT_Outline' (ftsdf.c) */
+  FT_EXPORT_VAR( const FT_Raster_Funcs )  ft_sdf_raster;
+
+  /* computes a distance field from an `FT_Bitmap' (ftbsdf.c) */
+  FT_EXPORT_VAR( const FT_Raster_Funcs )  ft_bitmap_sdf_raster;
+
+FT_END_HEADER
+
+#endif /* FTSDF_H_ */
+
+
+/* END */
@@ -0,0 +1,78 @@
+/****************************************************************************
+ *
+ * ftsdfcommon.c
+ *
+ *   Auxiliary functions for the signed distance field rasters (body).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#include <ft2build.h>
+#include FT_INTERNAL_OBJECTS_H
+#include FT_INTERNAL_CALC_H
+#include "ftsdfcommon.h"
+
+
+  /* documentation is in ftsdfcommon.h */
+
+  FT_LOCAL_DEF( FT_UInt32 )
+  ft_sdf_sqrt( FT_UInt32  x )
+  {
+    FT_UInt32  root = 0;
+    FT_UInt32  bit;
+
+
+    if ( !x )
+      return 0;
+
+    /* the highest power of 4 not larger than `x' */
+    bit = (FT_UInt32)1 << ( FT_MSB( x ) & ~1 );
+
+    while ( bit )
+    {
+      if ( x >= root + bit )
+      {
+        x    -= root + bit;
+        root  = ( root >> 1 ) + bit;
+      }
+      else
+        root >>= 1;
+
+      bit >>= 2;
+    }
+
+    return root;
+  }
+
+
+  /* documentation is in ftsdfcommon.h */
+
+  FT_LOCAL_DEF( FT_Byte )
+  ft_sdf_pixel( FT_Pos   dist,
+                FT_UInt  spread )
+  {
+    FT_Pos  value;
+
+
+    /* `spread' pixels, i.e., `64 * spread' units, map to 128 levels */
+    value = ( 2 * dist ) / (FT_Pos)spread;
+
+    if ( value >= 128 )
+      return 255;
+    if ( value <= -128 )
+      return 0;
+
+    return (FT_Byte)( 128 + value );
+  }
+
+
+/* END */
@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * ftsdfcommon.h
+ *
+ *   Auxiliary data for the signed distance field rasters (specification).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#ifndef FTSDFCOMMON_H_
+#define FTSDFCOMMON_H_
+
+
+#include <ft2build.h>
+#include FT_IMAGE_H
+
+
+FT_BEGIN_HEADER
+
+
+  /* default and allowed spread of the distance field, in pixels */
+#define SDF_DEFAULT_SPREAD  8
+#define SDF_MIN_SPREAD      2
+#define SDF_MAX_SPREAD      32
+
+  /* `FT_Raster_Params' flag telling the rasters that `params' points to */
+  /* an `SDF_Raster_Params' structure; `FT_Outline_Render' clears it, so */
+  /* that the outline raster rejects parameters coming from clients      */
+#define SDF_RASTER_FLAG_SDF  0x20000
+
+
+  /**************************************************************************
+   *
+   * @struct:
+   *   SDF_Raster_Params
+   *
+   * @description:
+   *   The parameters passed to the `raster_render' function of both
+   *   signed distance field rasters.
+   *
+   * @fields:
+   *   root ::
+   *     The usual raster parameters, with `SDF_RASTER_FLAG_SDF' set in
+   *     the `flags' field.  The target must be an 8-bit gray bitmap.  For the outline raster, the source is an `FT_Outline',
+   *     for the bitmap raster, an 8-bit gray `FT_Bitmap'.
+   *
+   *   spread ::
+   *     The distance in pixels (between `SDF_MIN_SPREAD' and
+   *     `SDF_MAX_SPREAD') that maps to the extreme pixel values.
+   *     Farther pixels are clamped.
+   */
+  typedef struct  SDF_Raster_Params_
+  {
+    FT_Raster_Params  root;
+    FT_UInt           spread;
+
+  } SDF_Raster_Params;
+
+
+  /* integer square root, rounded down */
+  FT_LOCAL( FT_UInt32 )
+  ft_sdf_sqrt( FT_UInt32  x );
+
+  /* map a signed distance in 26.6 pixels (positive inside) to a */
+  /* pixel value, with 128 representing the outline              */
+  FT_LOCAL( FT_Byte )
+  ft_sdf_pixel( FT_Pos   dist,
+                FT_UInt  spread );
+
+
+FT_END_HEADER
+
+#endif /* FTSDFCOMMON_H_ */
+
+
+/* END */
@@ -0,0 +1,507 @@
+/****************************************************************************
+ *
+ * ftsdfrend.c
+ *
+ *   Signed distance field renderer interface (body).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#include <ft2build.h>
+#include FT_INTERNAL_DEBUG_H
+#include FT_INTERNAL_OBJECTS_H
+#include FT_OUTLINE_H
+#include FT_BITMAP_H
+#include FT_DRIVER_H
+#include FT_SERVICE_PROPERTIES_H
+#include "ftsdfrend.h"
+#include "ftsdf.h"
+#include "ftsdfcommon.h"
+
+#include "ftsdferrs.h"
+
+
+  /**************************************************************************
+   *
+   * The macro FT_COMPONENT is used in trace mode.  It is an implicit
+   * parameter of the FT_TRACE() and FT_ERROR() macros, used to print/log
+   * messages during execution.
+   */
+#undef  FT_COMPONENT
+#define FT_COMPONENT  sdf
+
+
+  static FT_Error
+  ft_sdf_init( FT_Renderer  render )
+  {
+    ( (SDF_Renderer)render )->spread = SDF_DEFAULT_SPREAD;
+
+    return FT_Err_Ok;
+  }
+
+
+  static FT_Error
+  ft_sdf_property_set( FT_Module    module,
+                       const char*  property_name,
+                       const void*  value,
+                       FT_Bool      value_is_string )
+  {
+    SDF_Renderer  render = (SDF_Renderer)module;
+
+#ifndef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+    FT_UNUSED( value_is_string );
+#endif
+
+
+    if ( !ft_strcmp( property_name, "spread" ) )
+    {
+      FT_Long  spread;
+
+
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+        spread = ft_strtol( (const char*)value, NULL, 10 );
+      else
+#endif
+        spread = (FT_Long)*(const FT_UInt*)value;
+
+      if ( spread < SDF_MIN_SPREAD || spread > SDF_MAX_SPREAD )
+      {
+        FT_TRACE0(( "ft_sdf_property_set: spread %ld out of range\n",
+                    spread ));
+        return FT_THROW( Invalid_Argument );
+      }
+
+      render->spread = (FT_UInt)spread;
+
+      return FT_Err_Ok;
+    }
+
+    FT_TRACE0(( "ft_sdf_property_set: missing property `%s'\n",
+                property_name ));
+    return FT_THROW( Missing_Property );
+  }
+
+
+  static FT_Error
+  ft_sdf_property_get( FT_Module    module,
+                       const char*  property_name,
+                       void*        value )
+  {
+    SDF_Renderer  render = (SDF_Renderer)module;
+
+
+    if ( !ft_strcmp( property_name, "spread" ) )
+    {
+      FT_UInt*  val = (FT_UInt*)value;
+
+
+      *val = render->spread;
+
+      return FT_Err_Ok;
+    }
+
+    FT_TRACE0(( "ft_sdf_property_get: missing property `%s'\n",
+                property_name ));
+    return FT_THROW( Missing_Property );
+  }
+
+
+  FT_DEFINE_SERVICE_PROPERTIESREC(
+    ft_sdf_service_properties,
+
+    (FT_Properties_SetFunc)ft_sdf_property_set,     /* set_property */
+    (FT_Properties_GetFunc)ft_sdf_property_get )    /* get_property */
+
+
+  FT_DEFINE_SERVICEDESCREC1(
+    ft_sdf_services,
+
+    FT_SERVICE_ID_PROPERTIES, &ft_sdf_service_properties )
+
+
+  FT_CALLBACK_DEF( FT_Module_Interface )
+  ft_sdf_get_interface( FT_Module    module,
+                        const char*  module_interface )
+  {
+    FT_UNUSED( module );
+
+    return ft_service_list_lookup( ft_sdf_services, module_interface );
+  }
+
+
+  /* sets render-specific mode */
+  static FT_Error
+  ft_sdf_set_mode( FT_Renderer  render,
+                   FT_ULong     mode_tag,
+                   FT_Pointer   data )
+  {
+    /* we simply pass it to the raster */
+    return render->clazz->raster_class->raster_set_mode( render->raster,
+                                                         mode_tag,
+                                                         data );
+  }
+
+
+  /*************************************************************************/
+  /*                                                                       */
+  /* Outlines.                                                             */
+  /*                                                                       */
+
+  /* transform a given glyph image */
+  static FT_Error
+  ft_sdf_transform( FT_Renderer       render,
+                    FT_GlyphSlot      slot,
+                    const FT_Matrix*  matrix,
+                    const FT_Vector*  delta )
+  {
+    if ( slot->format != render->glyph_format )
+      return FT_THROW( Invalid_Argument );
+
+    if ( matrix )
+      FT_Outline_Transform( &slot->outline, matrix );
+
+    if ( delta )
+      FT_Outline_Translate( &slot->outline, delta->x, delta->y );
+
+    return FT_Err_Ok;
+  }
+
+
+  /* return the glyph's control box */
+  static void
+  ft_sdf_get_cbox( FT_Renderer   render,
+                   FT_GlyphSlot  slot,
+                   FT_BBox*      cbox )
+  {
+    FT_ZERO( cbox );
+
+    if ( slot->format == render->glyph_format )
+      FT_Outline_Get_CBox( &slot->outline, cbox );
+  }
+
+
+  /* convert a slot's outline into a distance field */
+  static FT_Error
+  ft_sdf_render( FT_Renderer       module,
+                 FT_GlyphSlot      slot,
+                 FT_Render_Mode    mode,
+                 const FT_Vector*  origin )
+  {
+    SDF_Renderer  render  = (SDF_Renderer)module;
+    FT_Error      error   = FT_Err_Ok;
+    FT_Outline*   outline = &slot->outline;
+    FT_Bitmap*    bitmap  = &slot->bitmap;
+    FT_Memory     memory  = module->root.memory;
+    FT_UInt       spread  = render->spread;
+    FT_Pos        x_shift = 0;
+    FT_Pos        y_shift = 0;
+
+    SDF_Raster_Params  params;
+
+
+    /* check glyph image format */
+    if ( slot->format != module->glyph_format )
+    {
+      error = FT_THROW( Invalid_Argument );
+      goto Exit;
+    }
+
+    /* check mode */
+    if ( mode != FT_RENDER_MODE_SDF )
+    {
+      error = FT_THROW( Cannot_Render_Glyph );
+      goto Exit;
+    }
+
+    /* release old bitmap buffer */
+    if ( slot->internal->flags & FT_GLYPH_OWN_BITMAP )
+    {
+      FT_FREE( bitmap->buffer );
+      slot->internal->flags &= ~FT_GLYPH_OWN_BITMAP;
+    }
+
+    if ( ft_glyphslot_preset_bitmap( slot, mode, origin ) )
+    {
+      error = FT_THROW( Raster_Overflow );
+      goto Exit;
+    }
+
+    if ( bitmap->width > 0xFFFFU - 2 * spread ||
+         bitmap->rows  > 0xFFFFU - 2 * spread )
+    {
+      error = FT_THROW( Raster_Overflow );
+      goto Exit;
+    }
+
+    /* the field extends `spread' pixels beyond the outline */
+    bitmap->width += 2 * spread;
+    bitmap->rows  += 2 * spread;
+    bitmap->pitch  = (int)bitmap->width;
+
+    slot->bitmap_left -= (FT_Int)spread;
+    slot->bitmap_top  += (FT_Int)spread;
+
+    /* allocate new one; every pixel gets written */
+    if ( FT_QALLOC_MULT( bitmap->buffer, bitmap->rows, bitmap->pitch ) )
+      goto Exit;
+
+    slot->internal->flags |= FT_GLYPH_OWN_BITMAP;
+
+    x_shift = 64 * -slot->bitmap_left;
+    y_shift = 64 * -slot->bitmap_top + 64 * (FT_Int)bitmap->rows;
+
+    if ( origin )
+    {
+      x_shift += origin->x;
+      y_shift += origin->y;
+    }
+
+    /* translate outline to render it into the bitmap */
+    if ( x_shift || y_shift )
+      FT_Outline_Translate( outline, x_shift, y_shift );
+
+    /* set up parameters */
+    FT_ZERO( &params );
+    params.root.target = bitmap;
+    params.root.source = outline;
+    params.root.flags  = SDF_RASTER_FLAG_SDF;
+    params.spread      = spread;
+
+    error = module->raster_render( module->raster,
+                                   (const FT_Raster_Params*)&params );
+
+  Exit:
+    if ( !error )
+    {
+      /* everything is fine; the glyph is now officially a bitmap */
+      slot->format = FT_GLYPH_FORMAT_BITMAP;
+    }
+    else if ( slot->internal->flags & FT_GLYPH_OWN_BITMAP )
+    {
+      FT_FREE( bitmap->buffer );
+      slot->internal->flags &= ~FT_GLYPH_OWN_BITMAP;
+    }
+
+    if ( x_shift || y_shift )
+      FT_Outline_Translate( outline, -x_shift, -y_shift );
+
+    return error;
+  }
+
+
+  /*************************************************************************/
+  /*                                                                       */
+  /* Bitmaps.                                                              */
+  /*                                                                       */
+
+  /* bitmaps are not transformed; this only keeps `FT_Load_Glyph' happy */
+  static FT_Error
+  ft_bsdf_transform( FT_Renderer       render,
+                     FT_GlyphSlot      slot,
+                     const FT_Matrix*  matrix,
+                     const FT_Vector*  delta )
+  {
+    FT_UNUSED( render );
+    FT_UNUSED( slot );
+    FT_UNUSED( matrix );
+    FT_UNUSED( delta );
+
+    return FT_Err_Ok;
+  }
+
+
+  /* return the bitmap's control box */
+  static void
+  ft_bsdf_get_cbox( FT_Renderer   render,
+                    FT_GlyphSlot  slot,
+                    FT_BBox*      cbox )
+  {
+    FT_ZERO( cbox );
+
+    if ( slot->format == render->glyph_format )
+    {
+      cbox->xMin = 64 * slot->bitmap_left;
+      cbox->yMax = 64 * slot->bitmap_top;
+      cbox->xMax = cbox->xMin + 64 * (FT_Pos)slot->bitmap.width;
+      cbox->yMin = cbox->yMax - 64 * (FT_Pos)slot->bitmap.rows;
+    }
+  }
+
+
+  /* convert a slot's bitmap into a distance field */
+  static FT_Error
+  ft_bsdf_render( FT_Renderer       module,
+                  FT_GlyphSlot      slot,
+                  FT_Render_Mode    mode,
+                  const FT_Vector*  origin )
+  {
+    SDF_Renderer  render = (SDF_Renderer)module;
+    FT_Error      error  = FT_Err_Ok;
+    FT_Bitmap*    bitmap = &slot->bitmap;
+    FT_Memory     memory = module->root.memory;
+    FT_UInt       spread = render->spread;
+    FT_Bitmap     source;
+    FT_Bitmap     target;
+    FT_Bool       converted = 0;
+
+    SDF_Raster_Params  params;
+
+    FT_UNUSED( origin );
+
+
+    FT_Bitmap_Init( &source );
+    FT_Bitmap_Init( &target );
+
+    /* check glyph image format */
+    if ( slot->format != module->glyph_format )
+    {
+      error = FT_THROW( Invalid_Argument );
+      goto Exit;
+    }
+
+    /* check mode */
+    if ( mode != FT_RENDER_MODE_SDF )
+    {
+      error = FT_THROW( Cannot_Render_Glyph );
+      goto Exit;
+    }
+
+    if ( bitmap->width > 0xFFFFU - 2 * spread ||
+         bitmap->rows  > 0xFFFFU - 2 * spread )
+    {
+      error = FT_THROW( Raster_Overflow );
+      goto Exit;
+    }
+
+    /* we need 256 levels of coverage */
+    if ( bitmap->pixel_mode == FT_PIXEL_MODE_GRAY )
+      source = *bitmap;
+    else
+    {
+      FT_Int  y;
+
+
+      error = FT_Bitmap_Convert( module->root.library, bitmap, &source, 1 );
+      converted = 1;
+      if ( error )
+        goto Exit;
+
+      if ( source.num_grays > 1 && source.num_grays < 256 )
+      {
+        for ( y = 0; y < (FT_Int)source.rows; y++ )
+        {
+          FT_Byte*  p     = source.buffer + y * source.pitch;
+          FT_Byte*  limit = p + source.width;
+
+
+          for ( ; p < limit; p++ )
+            *p = (FT_Byte)( *p * 255 / ( source.num_grays - 1 ) );
+        }
+      }
+    }
+
+    target.width      = source.width + 2 * spread;
+    target.rows       = source.rows + 2 * spread;
+    target.pitch      = (int)target.width;
+    target.pixel_mode = FT_PIXEL_MODE_GRAY;
+    target.num_grays  = 256;
+
+    if ( FT_QALLOC_MULT( target.buffer, target.rows, target.pitch ) )
+      goto Exit;
+
+    FT_ZERO( &params );
+    params.root.target = &target;
+    params.root.source = &source;
+    params.root.flags  = SDF_RASTER_FLAG_SDF;
+    params.spread      = spread;
+
+    error = module->raster_render( module->raster,
+                                   (const FT_Raster_Params*)&params );
+    if ( error )
+    {
+      FT_FREE( target.buffer );
+      goto Exit;
+    }
+
+    /* replace the slot's bitmap */
+    ft_glyphslot_set_bitmap( slot, target.buffer );
+    slot->internal->flags |= FT_GLYPH_OWN_BITMAP;
+
+    *bitmap = target;
+
+    slot->bitmap_left -= (FT_Int)spread;
+    slot->bitmap_top  += (FT_Int)spread;
+
+  Exit:
+    if ( converted )
+      FT_Bitmap_Done( module->root.library, &source );
+
+    return error;
+  }
+
+
+  FT_DEFINE_RENDERER(
+    ft_sdf_renderer_class,
+
+      FT_MODULE_RENDERER,
+      sizeof ( SDF_Renderer_Module ),
+
+      "sdf",
+      0x10000L,
+      0x20000L,
+
+      NULL,    /* module specific interface */
+
+      (FT_Module_Constructor)ft_sdf_init,           /* module_init   */
+      (FT_Module_Destructor) NULL,                  /* module_done   */
+      (FT_Module_Requester)  ft_sdf_get_interface,  /* get_interface */
+
+    FT_GLYPH_FORMAT_OUTLINE,
+
+    (FT_Renderer_RenderFunc)   ft_sdf_render,     /* render_glyph    */
+    (FT_Renderer_TransformFunc)ft_sdf_transform,  /* transform_glyph */
+    (FT_Renderer_GetCBoxFunc)  ft_sdf_get_cbox,   /* get_glyph_cbox  */
+    (FT_Renderer_SetModeFunc)  ft_sdf_set_mode,   /* set_mode        */
+
+    (FT_Raster_Funcs*)&ft_sdf_raster              /* raster_class    */
+  )
+
+
+  FT_DEFINE_RENDERER(
+    ft_bitmap_sdf_renderer_class,
+
+      FT_MODULE_RENDERER,
+      sizeof ( SDF_Renderer_Module ),
+
+      "bsdf",
+      0x10000L,
+      0x20000L,
+
+      NULL,    /* module specific interface */
+
+      (FT_Module_Constructor)ft_sdf_init,           /* module_init   */
+      (FT_Module_Destructor) NULL,                  /* module_done   */
+      (FT_Module_Requester)  ft_sdf_get_interface,  /* get_interface */
+
+    FT_GLYPH_FORMAT_BITMAP,
+
+    (FT_Renderer_RenderFunc)   ft_bsdf_render,     /* render_glyph    */
+    (FT_Renderer_TransformFunc)ft_bsdf_transform,  /* transform_glyph */
+    (FT_Renderer_GetCBoxFunc)  ft_bsdf_get_cbox,   /* get_glyph_cbox  */
+    (FT_Renderer_SetModeFunc)  ft_sdf_set_mode,    /* set_mode        */
+
+    (FT_Raster_Funcs*)&ft_bitmap_sdf_raster        /* raster_class    */
+  )
+
+
+/* END */
@@ -0,0 +1,52 @@
+/****************************************************************************
+ *
+ * ftsdfrend.h
+ *
+ *   Signed distance field renderer interface (specification).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#ifndef FTSDFREND_H_
+#define FTSDFREND_H_
+
+
+#include <ft2build.h>
+#include FT_RENDER_H
+
+
+FT_BEGIN_HEADER
+
+
+  /* the module object of both signed distance field renderers */
+  typedef struct  SDF_Renderer_Module_
+  {
+    FT_RendererRec  root;
+
+    FT_UInt         spread;   /* `spread' property */
+
+  } SDF_Renderer_Module, *SDF_Renderer;
+
+
+  /* renders outlines */
+  FT_DECLARE_RENDERER( ft_sdf_renderer_class )
+
+  /* renders bitmaps */
+  FT_DECLARE_RENDERER( ft_bitmap_sdf_renderer_class )
+
+
+FT_END_HEADER
+
+#endif /* FTSDFREND_H_ */
+
+
+/* END */
@@ -0,0 +1,28 @@
+/****************************************************************************
+ *
+ * sdf.c
+ *
+ *   FreeType signed distance field renderer module component (body only).
+ *
+ * Copyright 2019 by
+ * David Turner, Robert Wilhelm, and Werner Lemberg.
+ *
+ * This file is part of the FreeType project, and may only be used,
+ * modified, and distributed under the terms of the FreeType project
+ * license, LICENSE.TXT.  By continuing to use, modify, or distribute
+ * this file you indicate that you have read the license and
+ * understand and accept it fully.
+ *
+ */
+
+
+#define FT_MAKE_OPTION_SINGLE_OBJECT
+#include <ft2build.h>
+
+#include "ftsdfcommon.c"
+#include "ftsdf.c"
+#include "ftbsdf.c"
+#include "ftsdfrend.c"
+
+
+/* END */
@@ -152,6 +152,7 @@
 
 
 #define ft_memset   memset
+#define ft_memcpy   memcpy
 
 #define ft_setjmp   setjmp
 #define ft_longjmp  longjmp
@@ -295,6 +296,10 @@ typedef ptrdiff_t  FT_PtrDist;
 #define FT_MEM_ZERO( dest, count )  FT_MEM_SET( dest, 0, count )
 #endif
 
+#ifndef FT_MEM_COPY
+#define FT_MEM_COPY( dest, source, count )  ft_memcpy( dest, source, count )
+#endif
+
 #ifndef FT_ZERO
 #define FT_ZERO( p )  FT_MEM_ZERO( p, sizeof ( *(p) ) )
 #endif
@@ -393,6 +398,24 @@ typedef ptrdiff_t  FT_PtrDist;
     ( sizeof( long ) * FT_CHAR_BIT - PIXEL_BITS ) )
 
 
+  /**************************************************************************
+   *
+   * SSE2 is part of the x86_64 baseline and an optional feature of 32-bit
+   * x86; if the compiler targets it, `gray_sweep' converts runs of
+   * adjacent cells to coverage values eight at a time.  All other
+   * platforms (including ARM with NEON) use the scalar code, which gives
+   * bit-identical results.  Define FT_CONFIG_OPTION_NO_ASSEMBLER to
+   * disable this.
+   */
+#if !defined( FT_CONFIG_OPTION_NO_ASSEMBLER )                     && \
+    ( defined( __SSE2__ )                                        || \
+      defined( _M_X64 )                                          || \
+      ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )               )
+#define GRAY_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
   /**************************************************************************
    *
    * TYPE DEFINITIONS
@@ -418,6 +441,17 @@ typedef ptrdiff_t  FT_PtrDist;
 
   } TCell;
 
+  /* In LCD mode, a cell covers the three subpixels of a pixel; the  */
+  /* first one uses the fields of `cell', the others `cover'/`area'. */
+  /* `cell.x' counts pixels from subpixel `min_ex - 1' onwards.      */
+  typedef struct  TCellLcd_
+  {
+    TCell   cell;
+    TCoord  cover[2];
+    TArea   area[2];
+
+  } TCellLcd;
+
   typedef struct TPixmap_
   {
     unsigned char*  origin;  /* pixmap origin at the bottom-left */
@@ -425,6 +459,16 @@ typedef ptrdiff_t  FT_PtrDist;
 
   } TPixmap;
 
+  /* maximum number of adjacent cells converted in one go by `gray_sweep' */
+#define FT_MAX_GRAY_RUN  32
+
+  /* maximum number of spans passed to `gray_spans' in one go */
+#define FT_MAX_GRAY_SPANS  16
+
+  /* capacity of the internal span batch for FT_RASTER_FLAG_SPAN_BATCH */
+#define FT_MAX_GRAY_BATCH_LINES  128
+#define FT_MAX_GRAY_BATCH_SPANS  512
+
   /* maximum number of gray cells in the buffer */
 #if FT_RENDER_POOL_SIZE > 2048
 #define FT_MAX_GRAY_POOL  ( FT_RENDER_POOL_SIZE / sizeof ( TCell ) )
@@ -441,6 +485,16 @@ typedef ptrdiff_t  FT_PtrDist;
 #pragma warning( disable : 4324 )
 #endif /* _MSC_VER */
 
+  typedef struct gray_TRaster_
+  {
+    void*               memory;
+    FT_Raster_Executor  executor;
+
+    unsigned long       pool_max;   /* limit for growing the cell pool */
+
+  } gray_TRaster, *gray_PRaster;
+
+
   typedef struct  gray_TWorker_
   {
     ft_jmp_buf  jump_buffer;
@@ -458,14 +512,34 @@ typedef ptrdiff_t  FT_PtrDist;
     FT_PtrDist  max_cells;
     FT_PtrDist  num_cells;
 
+    TCoord*     dense_cover;  /* dense accumulation buffers, or NULL */
+    TArea*      dense_area;
+    TCoord      dense_pitch;
+
+    gray_PRaster  raster;     /* allows a heap pool if not NULL  */
+    TCell*        heap_pool;  /* heap cell pool of this call     */
+    size_t        heap_size;  /* its size in bytes               */
+
     TPos    x,  y;
 
     FT_Outline  outline;
     TPixmap     target;
 
+    int                   lcd;          /* triple horizontal resolution; */
+                                        /* `cells' holds `TCellLcd'     */
+    const unsigned char*  lcd_weights;  /* row filter, or NULL          */
+
     FT_Raster_Span_Func  render_span;
     void*                render_span_data;
 
+    FT_Span  spans[FT_MAX_GRAY_SPANS];  /* pending spans of `span_y' */
+    int      num_spans;
+    int      span_y;
+
+    FT_SpanBatchFunc  render_batch;       /* FT_RASTER_FLAG_SPAN_BATCH */
+    void*             render_batch_data;
+    FT_Span_Batch*    batch;
+
   } gray_TWorker, *gray_PWorker;
 
 #if defined( _MSC_VER )
@@ -480,13 +554,6 @@ typedef ptrdiff_t  FT_PtrDist;
 #endif
 
 
-  typedef struct gray_TRaster_
-  {
-    void*         memory;
-
-  } gray_TRaster, *gray_PRaster;
-
-
 #ifdef FT_DEBUG_LEVEL_TRACE
 
   /* to be called while in the debugger --                                */
@@ -523,7 +590,29 @@ typedef ptrdiff_t  FT_PtrDist;
   {
     PCell  *pcell, cell;
     TCoord  x = ras.ex;
+    int     sub;
+
+
+    if ( ras.dense_cover )
+    {
+      /* column 0 collects the cells left of the clipping region */
+      FT_PtrDist  idx = (FT_PtrDist)( ras.ey - ras.min_ey ) * ras.dense_pitch +
+                        ( x - ras.min_ex + 1 );
+
+
+      ras.dense_cover[idx] += ras.cover;
+      ras.dense_area[idx]  += ras.area;
+      return;
+    }
 
+    sub = 0;
+    if ( ras.lcd )
+    {
+      /* `x' is at least `min_ex - 1' */
+      x  -= ras.min_ex - 1;
+      sub = x % 3;
+      x  /= 3;
+    }
 
     pcell = &ras.ycells[ras.ey - ras.min_ey];
     for (;;)
@@ -542,20 +631,49 @@ typedef ptrdiff_t  FT_PtrDist;
       ft_longjmp( ras.jump_buffer, 1 );
 
     /* insert new cell */
-    cell        = ras.cells + ras.num_cells++;
-    cell->x     = x;
-    cell->area  = ras.area;
-    cell->cover = ras.cover;
+    if ( ras.lcd )
+    {
+      TCellLcd*  lcd = (TCellLcd*)ras.cells + ras.num_cells++;
+
 
-    cell->next  = *pcell;
-    *pcell      = cell;
+      lcd->cover[0] = 0;
+      lcd->cover[1] = 0;
+      lcd->area[0]  = 0;
+      lcd->area[1]  = 0;
 
-    return;
+      cell        = &lcd->cell;
+      cell->area  = 0;
+      cell->cover = 0;
+    }
+    else
+    {
+      cell        = ras.cells + ras.num_cells++;
+      cell->area  = ras.area;
+      cell->cover = ras.cover;
+    }
+
+    cell->x    = x;
+    cell->next = *pcell;
+    *pcell     = cell;
+
+    if ( !ras.lcd )
+      return;
 
   Found:
     /* update old cell */
-    cell->area  += ras.area;
-    cell->cover += ras.cover;
+    if ( sub )
+    {
+      TCellLcd*  lcd = (TCellLcd*)cell;
+
+
+      lcd->area[sub - 1]  += ras.area;
+      lcd->cover[sub - 1] += ras.cover;
+    }
+    else
+    {
+      cell->area  += ras.area;
+      cell->cover += ras.cover;
+    }
   }
 
 
@@ -1228,6 +1346,196 @@ typedef ptrdiff_t  FT_PtrDist;
   }
 
 
+  /**************************************************************************
+   *
+   * For horizontal LCD rendering, the outline is decomposed with a shift
+   * of 1, so that implicit on-curve points are exact, and these callbacks
+   * map the doubled coordinates to the subpixel grid.  The rounding is the
+   * same as if the outline itself had been scaled by 3 horizontally.
+   */
+#define LCD_SCALE( v, u )  ( (v).x = (u)->x * 3 / 2, (v).y = (u)->y / 2 )
+
+
+  static int
+  gray_lcd_move_to( const FT_Vector*  to,
+                    gray_PWorker      worker )
+  {
+    FT_Vector  v;
+
+
+    LCD_SCALE( v, to );
+
+    return gray_move_to( &v, worker );
+  }
+
+
+  static int
+  gray_lcd_line_to( const FT_Vector*  to,
+                    gray_PWorker      worker )
+  {
+    FT_Vector  v;
+
+
+    LCD_SCALE( v, to );
+
+    return gray_line_to( &v, worker );
+  }
+
+
+  static int
+  gray_lcd_conic_to( const FT_Vector*  control,
+                     const FT_Vector*  to,
+                     gray_PWorker      worker )
+  {
+    FT_Vector  c, v;
+
+
+    LCD_SCALE( c, control );
+    LCD_SCALE( v, to );
+
+    return gray_conic_to( &c, &v, worker );
+  }
+
+
+  static int
+  gray_lcd_cubic_to( const FT_Vector*  control1,
+                     const FT_Vector*  control2,
+                     const FT_Vector*  to,
+                     gray_PWorker      worker )
+  {
+    FT_Vector  c1, c2, v;
+
+
+    LCD_SCALE( c1, control1 );
+    LCD_SCALE( c2, control2 );
+    LCD_SCALE( v, to );
+
+    return gray_cubic_to( &c1, &c2, &v, worker );
+  }
+
+
+  /* pass the pending spans of the current scanline to the callback */
+  static void
+  gray_flush_spans( RAS_ARG )
+  {
+    if ( ras.num_spans )
+    {
+      ras.render_span( ras.span_y,
+                       ras.num_spans,
+                       ras.spans,
+                       ras.render_span_data );
+      ras.num_spans = 0;
+    }
+  }
+
+
+  /* pass the collected span batch to the callback */
+  static void
+  gray_flush_batch( RAS_ARG )
+  {
+    FT_Span_Batch*  batch = ras.batch;
+
+
+    if ( batch->num_lines )
+    {
+      ras.render_batch( batch, ras.render_batch_data );
+
+      batch->num_lines = 0;
+      batch->num_spans = 0;
+    }
+  }
+
+
+  /* pass all but the last scanline of the full batch to the callback, */
+  /* then move the last one to the front; a scanline that fills the     */
+  /* whole batch is passed as is                                        */
+  static void
+  gray_split_batch( RAS_ARG )
+  {
+    FT_Span_Batch*  batch = ras.batch;
+    FT_Span_Line    last;
+    int             start;
+
+
+    if ( batch->num_lines < 2 )
+    {
+      gray_flush_batch( RAS_VAR );
+      return;
+    }
+
+    last  = batch->lines[batch->num_lines - 1];
+    start = batch->num_spans - last.count;
+
+    batch->num_lines--;
+    batch->num_spans = start;
+
+    ras.render_batch( batch, ras.render_batch_data );
+
+    FT_MEM_MOVE( batch->spans,
+                 batch->spans + start,
+                 (size_t)last.count * sizeof ( FT_Span ) );
+
+    batch->lines[0]  = last;
+    batch->num_lines = 1;
+    batch->num_spans = last.count;
+  }
+
+
+  /* an `FT_SpanFunc' callback that appends a scanline to the batch */
+  static void
+  gray_batch_spans( int             y,
+                    int             count,
+                    const FT_Span*  spans,
+                    void*           user )
+  {
+#ifndef FT_STATIC_RASTER
+    gray_PWorker    worker = (gray_PWorker)user;
+#endif
+    FT_Span_Batch*  batch  = ras.batch;
+
+#ifdef FT_STATIC_RASTER
+    FT_UNUSED( user );
+#endif
+
+
+    while ( count > 0 )
+    {
+      FT_Span_Line*  line = batch->lines + batch->num_lines - 1;
+      int            n;
+
+
+      /* continue the last line if it is the same scanline */
+      if ( !batch->num_lines || line->y != y )
+      {
+        /* the previous scanlines are complete */
+        if ( batch->num_lines == batch->max_lines ||
+             batch->num_spans == batch->max_spans )
+          gray_flush_batch( RAS_VAR );
+
+        line        = batch->lines + batch->num_lines++;
+        line->y     = y;
+        line->count = 0;
+      }
+      else if ( batch->num_spans == batch->max_spans )
+      {
+        gray_split_batch( RAS_VAR );
+        continue;
+      }
+
+      n = FT_MIN( count, batch->max_spans - batch->num_spans );
+
+      FT_MEM_COPY( batch->spans + batch->num_spans,
+                   spans,
+                   (size_t)n * sizeof ( FT_Span ) );
+
+      batch->num_spans += n;
+      line->count      += n;
+      spans            += n;
+      count            -= n;
+    }
+  }
+
+
   static void
   gray_hline( RAS_ARG_ TCoord  x,
                        TCoord  y,
@@ -1256,14 +1564,31 @@ typedef ptrdiff_t  FT_PtrDist;
 
     if ( ras.render_span )  /* for FT_RASTER_FLAG_DIRECT only */
     {
-      FT_Span  span;
+      FT_Span*  span = ras.spans + ras.num_spans - 1;
+
+
+      /* extend the previous span if possible */
+      if ( ras.num_spans                                 &&
+           ras.span_y == y                               &&
+           span->x + span->len == x                      &&
+           span->coverage == (unsigned char)coverage     &&
+           span->len + acount <= 0xFFFF                  )
+      {
+        span->len = (unsigned short)( span->len + acount );
+        return;
+      }
 
+      if ( ras.num_spans                                   &&
+           ( ras.span_y != y                             ||
+             ras.num_spans == FT_MAX_GRAY_SPANS          ) )
+        gray_flush_spans( RAS_VAR );
 
-      span.x        = (short)x;
-      span.len      = (unsigned short)acount;
-      span.coverage = (unsigned char)coverage;
+      span = ras.spans + ras.num_spans++;
 
-      ras.render_span( y, 1, &span, ras.render_span_data );
+      span->x        = (short)x;
+      span->len      = (unsigned short)acount;
+      span->coverage = (unsigned char)coverage;
+      ras.span_y     = y;
     }
     else
     {
@@ -1292,6 +1617,167 @@ typedef ptrdiff_t  FT_PtrDist;
   }
 
 
+  /**************************************************************************
+   *
+   * Store the coverage of `count' adjacent cells, starting at column `x',
+   * into the target pixmap.  `areas' holds the accumulated areas as
+   * passed to `gray_hline', which produces the same output cell by cell.
+   * Not used for FT_RASTER_FLAG_DIRECT.
+   */
+  static void
+  gray_hline_cells( RAS_ARG_ TCoord        x,
+                             TCoord        y,
+                             const TArea*  areas,
+                             int           count )
+  {
+    unsigned char*  q        = ras.target.origin - ras.target.pitch * y + x;
+    int             even_odd = ras.outline.flags & FT_OUTLINE_EVEN_ODD_FILL;
+    int             i        = 0;
+
+
+#ifdef GRAY_USE_SSE2
+
+    if ( even_odd )
+    {
+      const __m128i  one = _mm_set1_epi32( 1 );
+      const __m128i  max = _mm_set1_epi32( 255 );
+
+
+      for ( ; i + 8 <= count; i += 8 )
+      {
+        __m128i  a = _mm_loadu_si128( (const __m128i*)( areas + i ) );
+        __m128i  b = _mm_loadu_si128( (const __m128i*)( areas + i + 4 ) );
+
+
+        /* scale to 0..256 and map negative values `c' to `-c - 1' */
+        a = _mm_srai_epi32( a, PIXEL_BITS * 2 + 1 - 8 );
+        b = _mm_srai_epi32( b, PIXEL_BITS * 2 + 1 - 8 );
+        a = _mm_xor_si128( a, _mm_srai_epi32( a, 31 ) );
+        b = _mm_xor_si128( b, _mm_srai_epi32( b, 31 ) );
+
+        /* `c & 511' folded at 256 equals `( c ^ -( c >> 8 & 1 ) ) & 255' */
+        a = _mm_xor_si128( a, _mm_sub_epi32( _mm_setzero_si128(),
+                                             _mm_and_si128(
+                                               _mm_srli_epi32( a, 8 ),
+                                               one ) ) );
+        b = _mm_xor_si128( b, _mm_sub_epi32( _mm_setzero_si128(),
+                                             _mm_and_si128(
+                                               _mm_srli_epi32( b, 8 ),
+                                               one ) ) );
+        a = _mm_and_si128( a, max );
+        b = _mm_and_si128( b, max );
+
+        a = _mm_packs_epi32( a, b );
+        _mm_storel_epi64( (__m128i*)( q + i ), _mm_packus_epi16( a, a ) );
+      }
+    }
+    else
+    {
+      for ( ; i + 8 <= count; i += 8 )
+      {
+        __m128i  a = _mm_loadu_si128( (const __m128i*)( areas + i ) );
+        __m128i  b = _mm_loadu_si128( (const __m128i*)( areas + i + 4 ) );
+
+
+        a = _mm_srai_epi32( a, PIXEL_BITS * 2 + 1 - 8 );
+        b = _mm_srai_epi32( b, PIXEL_BITS * 2 + 1 - 8 );
+        a = _mm_xor_si128( a, _mm_srai_epi32( a, 31 ) );
+        b = _mm_xor_si128( b, _mm_srai_epi32( b, 31 ) );
+
+        /* saturating packs clamp the non-zero winding result to 255 */
+        a = _mm_packs_epi32( a, b );
+        _mm_storel_epi64( (__m128i*)( q + i ), _mm_packus_epi16( a, a ) );
+      }
+    }
+
+#endif /* GRAY_USE_SSE2 */
+
+    /* same as in `gray_hline' */
+    for ( ; i < count; i++ )
+    {
+      TArea  coverage = areas[i] >> ( PIXEL_BITS * 2 + 1 - 8 );
+
+
+      if ( coverage < 0 )
+        coverage = -coverage - 1;
+
+      if ( even_odd )
+      {
+        coverage &= 511;
+
+        if ( coverage >= 256 )
+          coverage = 511 - coverage;
+      }
+      else if ( coverage >= 256 )
+        coverage = 255;
+
+      q[i] = (unsigned char)coverage;
+    }
+  }
+
+
+  /**************************************************************************
+   *
+   * Apply the horizontal LCD filter to the columns `x0' to `x1' (not
+   * included) of row `y', right after the row has been swept.  All other
+   * pixels of the row must be zero; the filtered result spreads two
+   * pixels to each side.  This is the same computation as in
+   * `ft_lcd_filter_fir', but done while the row is still in the cache.
+   */
+  static void
+  gray_lcd_filter( RAS_ARG_ TCoord  y,
+                            TCoord  x0,
+                            TCoord  x1 )
+  {
+    const unsigned char*  weights = ras.lcd_weights;
+    unsigned char*        line;
+    unsigned int          fir[5];
+    unsigned int          val;
+    TCoord                xx;
+
+
+    x0 = FT_MAX( x0 - 2, ras.min_ex );
+    x1 = FT_MIN( x1 + 2, ras.max_ex );
+    if ( x1 - x0 < 2 )
+      return;
+
+    line = ras.target.origin - ras.target.pitch * y + x0;
+    x1  -= x0;
+
+    /* `fir' must be at least 32 bit wide, since the sum of */
+    /* the values in `weights' can exceed 0xFF              */
+
+    val    = line[0];
+    fir[2] = weights[2] * val;
+    fir[3] = weights[3] * val;
+    fir[4] = weights[4] * val;
+
+    val    = line[1];
+    fir[1] = fir[2] + weights[1] * val;
+    fir[2] = fir[3] + weights[2] * val;
+    fir[3] = fir[4] + weights[3] * val;
+    fir[4] =          weights[4] * val;
+
+    for ( xx = 2; xx < x1; xx++ )
+    {
+      val    = line[xx];
+      fir[0] = fir[1] + weights[0] * val;
+      fir[1] = fir[2] + weights[1] * val;
+      fir[2] = fir[3] + weights[2] * val;
+      fir[3] = fir[4] + weights[3] * val;
+      fir[4] =          weights[4] * val;
+
+      fir[0]     >>= 8;
+      line[xx - 2] = (unsigned char)( fir[0] > 255 ? 255 : fir[0] );
+    }
+
+    fir[1]     >>= 8;
+    fir[2]     >>= 8;
+    line[xx - 2] = (unsigned char)( fir[1] > 255 ? 255 : fir[1] );
+    line[xx - 1] = (unsigned char)( fir[2] > 255 ? 255 : fir[2] );
+  }
+
+
   static void
   gray_sweep( RAS_ARG )
   {
@@ -1305,23 +1791,152 @@ typedef ptrdiff_t  FT_PtrDist;
       TArea   cover = 0;
       TArea   area;
 
+      TArea   run[FT_MAX_GRAY_RUN];  /* pending adjacent cells */
+      TCoord  run_x = 0;
+      int     run_count = 0;
+
 
       for ( ; cell != NULL; cell = cell->next )
       {
-        if ( cover != 0 && cell->x > x )
-          gray_hline( RAS_VAR_ x, y, cover, cell->x - x );
+        TCoord  cx     = cell->x;
+        TCoord  ccover = cell->cover;
+        TArea   carea  = cell->area;
+        int     sub    = 0;
+
+
+        /* an LCD cell stands for three subpixel cells in a row */
+        if ( ras.lcd )
+          cx = ras.min_ex - 1 + cx * 3;
+
+        for (;;)
+        {
+          if ( cover != 0 && cx > x )
+            gray_hline( RAS_VAR_ x, y, cover, cx - x );
+
+          cover += (TArea)ccover * ( ONE_PIXEL * 2 );
+          area   = cover - carea;
 
-        cover += (TArea)cell->cover * ( ONE_PIXEL * 2 );
-        area   = cover - cell->area;
+          if ( area != 0 && cx >= ras.min_ex )
+          {
+            /* spans must reach the callback in order */
+            if ( ras.render_span )
+              gray_hline( RAS_VAR_ cx, y, area, 1 );
+            else
+            {
+              if ( run_count == FT_MAX_GRAY_RUN    ||
+                   ( run_count                   &&
+                     cx != run_x + run_count     ) )
+              {
+                gray_hline_cells( RAS_VAR_ run_x, y, run, run_count );
+                run_count = 0;
+              }
+
+              if ( !run_count )
+                run_x = cx;
+              run[run_count++] = area;
+            }
+          }
 
-        if ( area != 0 && cell->x >= ras.min_ex )
-          gray_hline( RAS_VAR_ cell->x, y, area, 1 );
+          x = cx + 1;
 
-        x = cell->x + 1;
+          if ( !ras.lcd )
+            break;
+
+          /* skip empty subpixels, which are covered by `gray_hline' */
+          do
+          {
+            if ( ++sub == 3 )
+              break;
+
+            cx++;
+            ccover = ( (TCellLcd*)cell )->cover[sub - 1];
+            carea  = ( (TCellLcd*)cell )->area[sub - 1];
+
+          } while ( !ccover && !carea );
+
+          if ( sub == 3 )
+            break;
+        }
       }
 
+      if ( run_count )
+        gray_hline_cells( RAS_VAR_ run_x, y, run, run_count );
+
       if ( cover != 0 )
+      {
         gray_hline( RAS_VAR_ x, y, cover, ras.max_ex - x );
+        x = ras.max_ex;
+      }
+
+      /* nothing has been written left of the row's first cell */
+      if ( ras.lcd_weights && ras.ycells[y - ras.min_ey] )
+        gray_lcd_filter( RAS_VAR_ y,
+                         FT_MAX( ras.min_ex - 1 +
+                                   ras.ycells[y - ras.min_ey]->x * 3,
+                                 ras.min_ex ),
+                         FT_MIN( x, ras.max_ex ) );
+    }
+  }
+
+
+  /**************************************************************************
+   *
+   * Resolve the dense accumulation buffers into the target pixmap.  The
+   * running cover is a prefix sum along each row; areas are converted in
+   * place and handed over in runs of non-zero values, so the output is
+   * the same as with `gray_sweep'.
+   */
+  static void
+  gray_sweep_dense( RAS_ARG )
+  {
+    TCoord  width = ras.max_ex - ras.min_ex;
+    int     y;
+
+
+    for ( y = ras.min_ey; y < ras.max_ey; y++ )
+    {
+      FT_PtrDist  row    = (FT_PtrDist)( y - ras.min_ey ) * ras.dense_pitch;
+      TCoord*     covers = ras.dense_cover + row;
+      TArea*      areas  = ras.dense_area + row + 1;
+      TArea       cover  = (TArea)covers[0] * ( ONE_PIXEL * 2 );
+      TCoord      x, start, first, last;
+
+
+      covers++;
+
+      for ( x = 0; x < width; x++ )
+      {
+        cover   += (TArea)covers[x] * ( ONE_PIXEL * 2 );
+        areas[x] = cover - areas[x];
+      }
+
+      first = width;
+      last  = 0;
+
+      for ( x = 0; x < width; )
+      {
+        if ( !areas[x] )
+        {
+          x++;
+          continue;
+        }
+
+        start = x;
+        while ( x < width && areas[x] )
+          x++;
+
+        gray_hline_cells( RAS_VAR_ ras.min_ex + start, y,
+                                   areas + start, x - start );
+
+        if ( first == width )
+          first = start;
+        last = x;
+      }
+
+      if ( ras.lcd_weights && first < last )
+        gray_lcd_filter( RAS_VAR_ y,
+                         ras.min_ex + first,
+                         ras.min_ex + last );
     }
   }
 
@@ -1627,6 +2242,19 @@ typedef ptrdiff_t  FT_PtrDist;
   )
 
 
+  FT_DEFINE_OUTLINE_FUNCS(
+    func_interface_lcd,
+
+    (FT_Outline_MoveTo_Func) gray_lcd_move_to,   /* move_to  */
+    (FT_Outline_LineTo_Func) gray_lcd_line_to,   /* line_to  */
+    (FT_Outline_ConicTo_Func)gray_lcd_conic_to,  /* conic_to */
+    (FT_Outline_CubicTo_Func)gray_lcd_cubic_to,  /* cubic_to */
+
+    1,                                           /* shift    */
+    0                                            /* delta    */
+  )
+
+
   static int
   gray_convert_glyph_inner( RAS_ARG,
                             int  continued )
@@ -1638,7 +2266,10 @@ typedef ptrdiff_t  FT_PtrDist;
     {
       if ( continued )
         FT_Trace_Disable();
-      error = FT_Outline_Decompose( &ras.outline, &func_interface, &ras );
+      error = FT_Outline_Decompose( &ras.outline,
+                                    ras.lcd ? &func_interface_lcd
+                                            : &func_interface,
+                                    &ras );
       if ( continued )
         FT_Trace_Enable();
 
@@ -1663,6 +2294,49 @@ typedef ptrdiff_t  FT_PtrDist;
   }
 
 
+#ifndef STANDALONE_
+
+  /**************************************************************************
+   *
+   * Replace the worker's cell pool with a heap pool twice as large (the
+   * first one is the stack buffer of `gray_convert_glyph'), but not
+   * larger than `pool_max'.  The contents are not preserved, and
+   * `gray_raster_render' frees the pool.  It is not kept in the raster
+   * object since several threads may render with the same raster.
+   */
+  static int
+  gray_grow_pool( RAS_ARG )
+  {
+    FT_Memory  memory = (FT_Memory)ras.raster->memory;
+    FT_Error   error;
+    size_t     size;
+
+
+    size = FT_MAX( ras.heap_size, FT_MAX_GRAY_POOL * sizeof ( TCell ) ) * 2;
+    if ( size > ras.raster->pool_max )
+      size = ras.raster->pool_max;
+
+    size -= size % sizeof ( TCell );
+    if ( size <= ras.heap_size                        ||
+         size <= FT_MAX_GRAY_POOL * sizeof ( TCell )  )
+      return 1;
+
+    FT_FREE( ras.heap_pool );
+    ras.heap_size = 0;
+
+    if ( FT_QALLOC( ras.heap_pool, size ) )
+      return 1;
+
+    ras.heap_size = size;
+
+    FT_TRACE7(( "gray_grow_pool: %lu bytes\n", (unsigned long)size ));
+
+    return 0;
+  }
+
+#endif /* !STANDALONE_ */
+
+
   static int
   gray_convert_glyph( RAS_ARG )
   {
@@ -1670,8 +2344,10 @@ typedef ptrdiff_t  FT_PtrDist;
     const TCoord  yMax = ras.max_ey;
 
     TCell    buffer[FT_MAX_GRAY_POOL];
-    size_t   height = (size_t)( yMax - yMin );
-    size_t   n = FT_MAX_GRAY_POOL / 8;
+    TCell*   pool       = buffer;
+    size_t   pool_cells = FT_MAX_GRAY_POOL;
+    size_t   height     = (size_t)( yMax - yMin );
+    size_t   n;
     TCoord   y;
     TCoord   bands[32];  /* enough to accommodate bisections */
     TCoord*  band;
@@ -1679,7 +2355,47 @@ typedef ptrdiff_t  FT_PtrDist;
     int  continued = 0;
 
 
+    ras.dense_cover = NULL;
+    ras.dense_area  = NULL;
+
+    /* Small bitmap targets (the usual case for glyphs at text sizes) */
+    /* are rendered in a single pass with a dense per-pixel buffer    */
+    /* instead of the per-scanline cell lists.                        */
+    if ( !ras.render_span                                      &&
+         height <= FT_MAX_GRAY_POOL                            &&
+         (size_t)( ras.max_ex - ras.min_ex ) < FT_MAX_GRAY_POOL )
+    {
+      size_t  count = ( (size_t)( ras.max_ex - ras.min_ex ) + 1 ) * height;
+
+
+      if ( count * ( sizeof ( TCoord ) + sizeof ( TArea ) ) <=
+             sizeof ( buffer )                                 )
+      {
+        ras.dense_pitch = ras.max_ex - ras.min_ex + 1;
+        ras.dense_cover = (TCoord*)buffer;
+        ras.dense_area  = (TArea*)( ras.dense_cover + count );
+
+        FT_MEM_ZERO( buffer, count * ( sizeof ( TCoord ) +
+                                       sizeof ( TArea )  ) );
+
+        ras.num_cells = 0;
+        ras.invalid   = 1;
+
+        if ( gray_convert_glyph_inner( RAS_VAR, 0 ) )
+          return 1;
+
+        gray_sweep_dense( RAS_VAR );
+        return 0;
+      }
+    }
+
+    y = yMin;
+
+  Setup:
     /* set up vertical bands */
+    height = (size_t)( yMax - y );
+    n      = pool_cells / 8;
+
     if ( height > n )
     {
       /* two divisions rounded up */
@@ -1690,11 +2406,15 @@ typedef ptrdiff_t  FT_PtrDist;
     /* memory management */
     n = ( height * sizeof ( PCell ) + sizeof ( TCell ) - 1 ) / sizeof ( TCell );
 
-    ras.cells     = buffer + n;
-    ras.max_cells = (FT_PtrDist)( FT_MAX_GRAY_POOL - n );
-    ras.ycells    = (PCell*)buffer;
+    ras.cells     = pool + n;
+    ras.max_cells = (FT_PtrDist)( pool_cells - n );
+    ras.ycells    = (PCell*)pool;
+
+    if ( ras.lcd )
+      ras.max_cells = ras.max_cells * (FT_PtrDist)sizeof ( TCell ) /
+                        (FT_PtrDist)sizeof ( TCellLcd );
 
-    for ( y = yMin; y < yMax; )
+    while ( y < yMax )
     {
       ras.min_ey = y;
       y         += height;
@@ -1729,6 +2449,20 @@ typedef ptrdiff_t  FT_PtrDist;
         else if ( error != ErrRaster_Memory_Overflow )
           return 1;
 
+#ifndef STANDALONE_
+        /* Render pool overflow; if possible, get a bigger pool and */
+        /* continue with the current band.  Everything below it is  */
+        /* already done.                                            */
+        if ( ras.raster && !gray_grow_pool( RAS_VAR ) )
+        {
+          pool       = ras.heap_pool;
+          pool_cells = ras.heap_size / sizeof ( TCell );
+          y          = band[1];
+
+          goto Setup;
+        }
+#endif
+
         /* render pool overflow; we will reduce the render band by half */
         width >>= 1;
 
@@ -1749,6 +2483,80 @@ typedef ptrdiff_t  FT_PtrDist;
   }
 
 
+#ifndef FT_STATIC_RASTER
+
+  /* maximum number of bands rendered in parallel */
+#define FT_MAX_GRAY_BANDS  32
+
+  /* default minimum target height for parallel rendering */
+#define FT_GRAY_BANDS_MIN_ROWS  256
+
+
+  typedef struct  gray_TBandJob_
+  {
+    gray_PWorker  proto;        /* worker set up by `gray_raster_render' */
+    TCoord        band_height;
+    int           errors[FT_MAX_GRAY_BANDS];
+
+  } gray_TBandJob;
+
+
+  /* an `FT_Raster_BandFunc' callback; it uses a private copy of the */
+  /* prototype worker, and `gray_convert_glyph' its own cell pool    */
+  static void
+  gray_render_band( void*  data,
+                    int    band )
+  {
+    gray_TBandJob*  job = (gray_TBandJob*)data;
+    gray_TWorker    worker[1];
+
+
+    *worker    = *job->proto;
+    ras.raster = NULL;  /* the heap pool can't be shared */
+    ras.min_ey = job->proto->min_ey + band * job->band_height;
+    ras.max_ey = FT_MIN( ras.min_ey + job->band_height,
+                         job->proto->max_ey );
+
+    job->errors[band] = ras.min_ey < ras.max_ey
+                          ? gray_convert_glyph( RAS_VAR )
+                          : 0;
+  }
+
+
+  /**************************************************************************
+   *
+   * Split the target into horizontal bands and let the client's executor
+   * render them concurrently.  The bands are disjoint sets of bitmap rows,
+   * so the output is identical to `gray_convert_glyph'.
+   */
+  static int
+  gray_convert_glyph_parallel( RAS_ARG_ const FT_Raster_Executor*  executor )
+  {
+    TCoord         height    = ras.max_ey - ras.min_ey;
+    int            num_bands = FT_MIN( executor->max_bands,
+                                       FT_MAX_GRAY_BANDS );
+    gray_TBandJob  job;
+    int            n;
+
+
+    job.proto       = worker;
+    job.band_height = ( height + num_bands - 1 ) / num_bands;
+
+    FT_TRACE7(( "gray_convert_glyph_parallel: %d bands of %d rows\n",
+                num_bands, job.band_height ));
+
+    executor->execute( executor->pool, num_bands, gray_render_band, &job );
+
+    for ( n = 0; n < num_bands; n++ )
+      if ( job.errors[n] )
+        return job.errors[n];
+
+    return 0;
+  }
+
+#endif /* !FT_STATIC_RASTER */
+
+
   static int
   gray_raster_render( FT_Raster                raster,
                       const FT_Raster_Params*  params )
@@ -1756,6 +2564,11 @@ typedef ptrdiff_t  FT_PtrDist;
     const FT_Outline*  outline    = (const FT_Outline*)params->source;
     const FT_Bitmap*   target_map = params->target;
     FT_BBox            clip;
+    int                error;
+
+    FT_Span_Line   batch_lines[FT_MAX_GRAY_BATCH_LINES];
+    FT_Span        batch_spans[FT_MAX_GRAY_BATCH_SPANS];
+    FT_Span_Batch  batch;
 
 #ifndef FT_STATIC_RASTER
     gray_TWorker  worker[1];
@@ -1783,15 +2596,57 @@ typedef ptrdiff_t  FT_PtrDist;
            outline->contours[outline->n_contours - 1] + 1 )
       return FT_THROW( Invalid_Outline );
 
-    ras.outline = *outline;
+    ras.outline   = *outline;
+    ras.raster    = (gray_PRaster)raster;
+    ras.heap_pool = NULL;
+    ras.heap_size = 0;
+
+    ras.lcd         = 0;
+    ras.lcd_weights = NULL;
+
+    ras.num_spans = 0;
+    ras.batch     = NULL;
 
     if ( params->flags & FT_RASTER_FLAG_DIRECT )
     {
-      if ( !params->gray_spans )
-        return 0;
+      if ( params->flags & FT_RASTER_FLAG_SPAN_BATCH )
+      {
+        if ( !params->batch_spans )
+          return 0;
+
+        if ( params->span_batch )
+          ras.batch = params->span_batch;
+        else
+        {
+          batch.lines     = batch_lines;
+          batch.max_lines = FT_MAX_GRAY_BATCH_LINES;
+          batch.spans     = batch_spans;
+          batch.max_spans = FT_MAX_GRAY_BATCH_SPANS;
+
+          ras.batch = &batch;
+        }
 
-      ras.render_span      = (FT_Raster_Span_Func)params->gray_spans;
-      ras.render_span_data = params->user;
+        if ( !ras.batch->lines || ras.batch->max_lines < 1 ||
+             !ras.batch->spans || ras.batch->max_spans < 1 )
+          return FT_THROW( Invalid_Argument );
+
+        ras.batch->num_lines = 0;
+        ras.batch->num_spans = 0;
+
+        /* scanlines are collected by an internal span callback */
+        ras.render_span       = gray_batch_spans;
+        ras.render_span_data  = &ras;
+        ras.render_batch      = params->batch_spans;
+        ras.render_batch_data = params->user;
+      }
+      else
+      {
+        if ( !params->gray_spans )
+          return 0;
+
+        ras.render_span      = (FT_Raster_Span_Func)params->gray_spans;
+        ras.render_span_data = params->user;
+      }
     }
     else
     {
@@ -1816,6 +2671,12 @@ typedef ptrdiff_t  FT_PtrDist;
 
       ras.render_span      = (FT_Raster_Span_Func)NULL;
       ras.render_span_data = NULL;
+
+      if ( params->flags & FT_GRAYS_FLAG_LCD )
+      {
+        ras.lcd         = 1;
+        ras.lcd_weights = ( (const FT_Grays_LcdParams*)params )->weights;
+      }
     }
 
     /* compute clipping box */
@@ -1840,7 +2701,45 @@ typedef ptrdiff_t  FT_PtrDist;
     if ( ras.max_ex <= ras.min_ex || ras.max_ey <= ras.min_ey )
       return 0;
 
-    return gray_convert_glyph( RAS_VAR );
+#ifndef FT_STATIC_RASTER
+    {
+      const FT_Raster_Executor*  executor =
+                                   &( (gray_PRaster)raster )->executor;
+      TCoord                     min_rows = executor->min_rows > 0
+                                              ? executor->min_rows
+                                              : FT_GRAY_BANDS_MIN_ROWS;
+
+
+      /* span callbacks are not necessarily thread-safe */
+      if ( executor->execute                   &&
+           executor->max_bands > 1             &&
+           !ras.render_span                    &&
+           ras.max_ey - ras.min_ey >= min_rows )
+        return gray_convert_glyph_parallel( RAS_VAR_ executor );
+    }
+#endif
+
+    error = gray_convert_glyph( RAS_VAR );
+
+#ifndef STANDALONE_
+    {
+      FT_Memory  memory = (FT_Memory)ras.raster->memory;
+
+
+      FT_FREE( ras.heap_pool );
+    }
+#endif
+
+    /* hand over what is left */
+    if ( ras.render_span )
+    {
+      gray_flush_spans( RAS_VAR );
+
+      if ( ras.batch )
+        gray_flush_batch( RAS_VAR );
+    }
+
+    return error;
   }
 
 
@@ -1885,8 +2784,9 @@ typedef ptrdiff_t  FT_PtrDist;
     *araster = 0;
     if ( !FT_ALLOC( raster, sizeof ( gray_TRaster ) ) )
     {
-      raster->memory = memory;
-      *araster       = (FT_Raster)raster;
+      raster->memory   = memory;
+      raster->pool_max = FT_RENDER_POOL_MAX_SIZE;
+      *araster         = (FT_Raster)raster;
     }
 
     return error;
@@ -1921,12 +2821,22 @@ typedef ptrdiff_t  FT_PtrDist;
                         unsigned long  mode,
                         void*          args )
   {
-    FT_UNUSED( raster );
-    FT_UNUSED( mode );
-    FT_UNUSED( args );
+    if ( mode == FT_GRAYS_MODE_EXECUTOR )
+    {
+      if ( !args )
+        return FT_THROW( Invalid_Argument );
 
+      ( (gray_PRaster)raster )->executor = *(FT_Raster_Executor*)args;
+    }
+    else if ( mode == FT_GRAYS_MODE_MAX_POOL_SIZE )
+    {
+      if ( !args )
+        return FT_THROW( Invalid_Argument );
 
-    return 0; /* nothing to do */
+      ( (gray_PRaster)raster )->pool_max = *(unsigned long*)args;
+    }
+
+    return 0;
   }
 
 
@@ -47,6 +47,38 @@
   FT_EXPORT_VAR( const FT_Raster_Funcs )  ft_grays_raster;
 
 
+  /* `raster_set_mode' tag to set up band-parallel rendering; */
+  /* `args' is a pointer to an `FT_Raster_Executor' structure */
+#define FT_GRAYS_MODE_EXECUTOR                                  \
+          ( ( (unsigned long)'b' << 24 ) |                      \
+            ( (unsigned long)'e' << 16 ) |                      \
+            ( (unsigned long)'x' <<  8 ) |                      \
+              (unsigned long)'e'         )
+
+  /* `raster_set_mode' tag to limit the growth of the render pool; */
+  /* `args' is a pointer to an `unsigned long' value (in bytes)    */
+#define FT_GRAYS_MODE_MAX_POOL_SIZE                             \
+          ( ( (unsigned long)'p' << 24 ) |                      \
+            ( (unsigned long)'o' << 16 ) |                      \
+            ( (unsigned long)'o' <<  8 ) |                      \
+              (unsigned long)'l'         )
+
+  /* `FT_Raster_Params' flag to render horizontal LCD bitmaps without     */
+  /* scaling the outline, i.e., the target is three times as wide as the */
+  /* outline's bounding box; `params' must then point to an              */
+  /* `FT_Grays_LcdParams' structure (`FT_Outline_Render' clears it)      */
+#define FT_GRAYS_FLAG_LCD  0x10000
+
+  typedef struct  FT_Grays_LcdParams_
+  {
+    FT_Raster_Params      root;
+    const unsigned char*  weights;  /* five FIR filter weights applied to */
+                                    /* each row right after rendering it, */
+                                    /* or NULL for unfiltered output      */
+
+  } FT_Grays_LcdParams;
+
+
 #ifdef __cplusplus
   }
 #endif
@@ -20,12 +20,24 @@
 #include FT_INTERNAL_DEBUG_H
 #include FT_INTERNAL_OBJECTS_H
 #include FT_OUTLINE_H
+#include FT_DRIVER_H
+#include FT_SERVICE_PROPERTIES_H
 #include "ftsmooth.h"
 #include "ftgrays.h"
 
 #include "ftsmerrs.h"
 
 
+  /**************************************************************************
+   *
+   * The macro FT_COMPONENT is used in trace mode.  It is an implicit
+   * parameter of the FT_TRACE() and FT_ERROR() macros, used to print/log
+   * messages during execution.
+   */
+#undef  FT_COMPONENT
+#define FT_COMPONENT  smooth
+
+
   /* initialize renderer -- init its raster */
   static FT_Error
   ft_smooth_init( FT_Renderer  render )
@@ -50,12 +62,128 @@
 
 #endif
 
+    /* the raster object uses the same default */
+    ( (FT_Smooth_Renderer)render )->max_pool_size = FT_RENDER_POOL_MAX_SIZE;
+
     render->clazz->raster_class->raster_reset( render->raster, NULL, 0 );
 
     return 0;
   }
 
 
+  static FT_Error
+  ft_smooth_property_set( FT_Module    module,
+                          const char*  property_name,
+                          const void*  value,
+                          FT_Bool      value_is_string )
+  {
+    FT_Smooth_Renderer  render = (FT_Smooth_Renderer)module;
+
+#ifndef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+    FT_UNUSED( value_is_string );
+#endif
+
+
+    if ( !ft_strcmp( property_name, "band-executor" ) )
+    {
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+        return FT_THROW( Invalid_Argument );
+#endif
+
+      render->executor = *(const FT_Raster_Executor*)value;
+
+      return render->root.clazz->raster_class->raster_set_mode(
+               render->root.raster,
+               FT_GRAYS_MODE_EXECUTOR,
+               &render->executor );
+    }
+    else if ( !ft_strcmp( property_name, "max-pool-size" ) )
+    {
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s = (const char*)value;
+        long         size = ft_strtol( s, NULL, 10 );
+
+
+        if ( size < 0 )
+          return FT_THROW( Invalid_Argument );
+
+        render->max_pool_size = (FT_ULong)size;
+      }
+      else
+#endif
+        render->max_pool_size = *(const FT_ULong*)value;
+
+      return render->root.clazz->raster_class->raster_set_mode(
+               render->root.raster,
+               FT_GRAYS_MODE_MAX_POOL_SIZE,
+               &render->max_pool_size );
+    }
+
+    FT_TRACE0(( "ft_smooth_property_set: missing property `%s'\n",
+                property_name ));
+    return FT_THROW( Missing_Property );
+  }
+
+
+  static FT_Error
+  ft_smooth_property_get( FT_Module    module,
+                          const char*  property_name,
+                          void*        value )
+  {
+    FT_Smooth_Renderer  render = (FT_Smooth_Renderer)module;
+
+
+    if ( !ft_strcmp( property_name, "band-executor" ) )
+    {
+      FT_Raster_Executor*  val = (FT_Raster_Executor*)value;
+
+
+      *val = render->executor;
+
+      return FT_Err_Ok;
+    }
+    else if ( !ft_strcmp( property_name, "max-pool-size" ) )
+    {
+      FT_ULong*  val = (FT_ULong*)value;
+
+
+      *val = render->max_pool_size;
+
+      return FT_Err_Ok;
+    }
+
+    FT_TRACE0(( "ft_smooth_property_get: missing property `%s'\n",
+                property_name ));
+    return FT_THROW( Missing_Property );
+  }
+
+
+  FT_DEFINE_SERVICE_PROPERTIESREC(
+    ft_smooth_service_properties,
+
+    (FT_Properties_SetFunc)ft_smooth_property_set,     /* set_property */
+    (FT_Properties_GetFunc)ft_smooth_property_get )    /* get_property */
+
+
+  FT_DEFINE_SERVICEDESCREC1(
+    ft_smooth_services,
+
+    FT_SERVICE_ID_PROPERTIES, &ft_smooth_service_properties )
+
+
+  FT_CALLBACK_DEF( FT_Module_Interface )
+  ft_smooth_get_interface( FT_Module    module,
+                           const char*  module_interface )
+  {
+    FT_UNUSED( module );
+
+    return ft_service_list_lookup( ft_smooth_services, module_interface );
+  }
+
+
   /* sets render-specific mode */
   static FT_Error
   ft_smooth_set_mode( FT_Renderer  render,
@@ -127,6 +255,11 @@
 
     FT_Raster_Params  params;
 
+#ifdef FT_CONFIG_OPTION_SUBPIXEL_RENDERING
+    FT_Byte*                 lcd_weights     = NULL;
+    FT_Bitmap_LcdFilterFunc  lcd_filter_func = NULL;
+#endif
+
 
     /* check glyph image format */
     if ( slot->format != render->glyph_format )
@@ -185,6 +318,38 @@
 
 #ifdef FT_CONFIG_OPTION_SUBPIXEL_RENDERING
 
+    if ( hmul || vmul )
+    {
+      /* Per-face LCD filtering takes priority if set up. */
+      if ( slot->face && slot->face->internal->lcd_filter_func )
+      {
+        lcd_weights     = slot->face->internal->lcd_weights;
+        lcd_filter_func = slot->face->internal->lcd_filter_func;
+      }
+      else
+      {
+        lcd_weights     = slot->library->lcd_weights;
+        lcd_filter_func = slot->library->lcd_filter_func;
+      }
+    }
+
+    /* The raster can render horizontal LCD bitmaps directly, applying */
+    /* the FIR filter to each row right after its sweep.               */
+    if ( hmul && ( !lcd_filter_func                     ||
+                   lcd_filter_func == ft_lcd_filter_fir ) )
+    {
+      FT_Grays_LcdParams  lcd_params;
+
+
+      lcd_params.root        = params;
+      lcd_params.root.flags |= FT_GRAYS_FLAG_LCD;
+      lcd_params.weights     = lcd_filter_func ? lcd_weights : NULL;
+
+      error = render->raster_render( render->raster,
+                                     (FT_Raster_Params*)&lcd_params );
+      goto Exit;
+    }
+
     /* implode outline if needed */
     {
       FT_Vector*  points     = outline->points;
@@ -224,27 +389,8 @@
       goto Exit;
 
     /* finally apply filtering */
-    if ( hmul || vmul )
-    {
-      FT_Byte*                 lcd_weights;
-      FT_Bitmap_LcdFilterFunc  lcd_filter_func;
-
-
-      /* Per-face LCD filtering takes priority if set up. */
-      if ( slot->face && slot->face->internal->lcd_filter_func )
-      {
-        lcd_weights     = slot->face->internal->lcd_weights;
-        lcd_filter_func = slot->face->internal->lcd_filter_func;
-      }
-      else
-      {
-        lcd_weights     = slot->library->lcd_weights;
-        lcd_filter_func = slot->library->lcd_filter_func;
-      }
-
-      if ( lcd_filter_func )
-        lcd_filter_func( bitmap, mode, lcd_weights );
-    }
+    if ( lcd_filter_func )
+      lcd_filter_func( bitmap, mode, lcd_weights );
 
 #else /* !FT_CONFIG_OPTION_SUBPIXEL_RENDERING */
 
@@ -423,7 +569,7 @@
     ft_smooth_renderer_class,
 
       FT_MODULE_RENDERER,
-      sizeof ( FT_RendererRec ),
+      sizeof ( FT_Smooth_RendererRec ),
 
       "smooth",
       0x10000L,
@@ -431,9 +577,9 @@
 
       NULL,    /* module specific interface */
 
-      (FT_Module_Constructor)ft_smooth_init,  /* module_init   */
-      (FT_Module_Destructor) NULL,            /* module_done   */
-      (FT_Module_Requester)  NULL,            /* get_interface */
+      (FT_Module_Constructor)ft_smooth_init,           /* module_init   */
+      (FT_Module_Destructor) NULL,                     /* module_done   */
+      (FT_Module_Requester)  ft_smooth_get_interface,  /* get_interface */
 
     FT_GLYPH_FORMAT_OUTLINE,
 
@@ -450,7 +596,7 @@
     ft_smooth_lcd_renderer_class,
 
       FT_MODULE_RENDERER,
-      sizeof ( FT_RendererRec ),
+      sizeof ( FT_Smooth_RendererRec ),
 
       "smooth-lcd",
       0x10000L,
@@ -458,9 +604,9 @@
 
       NULL,    /* module specific interface */
 
-      (FT_Module_Constructor)ft_smooth_init,  /* module_init   */
-      (FT_Module_Destructor) NULL,            /* module_done   */
-      (FT_Module_Requester)  NULL,            /* get_interface */
+      (FT_Module_Constructor)ft_smooth_init,           /* module_init   */
+      (FT_Module_Destructor) NULL,                     /* module_done   */
+      (FT_Module_Requester)  ft_smooth_get_interface,  /* get_interface */
 
     FT_GLYPH_FORMAT_OUTLINE,
 
@@ -477,7 +623,7 @@
     ft_smooth_lcdv_renderer_class,
 
       FT_MODULE_RENDERER,
-      sizeof ( FT_RendererRec ),
+      sizeof ( FT_Smooth_RendererRec ),
 
       "smooth-lcdv",
       0x10000L,
@@ -485,9 +631,9 @@
 
       NULL,    /* module specific interface */
 
-      (FT_Module_Constructor)ft_smooth_init,  /* module_init   */
-      (FT_Module_Destructor) NULL,            /* module_done   */
-      (FT_Module_Requester)  NULL,            /* get_interface */
+      (FT_Module_Constructor)ft_smooth_init,           /* module_init   */
+      (FT_Module_Destructor) NULL,                     /* module_done   */
+      (FT_Module_Requester)  ft_smooth_get_interface,  /* get_interface */
 
     FT_GLYPH_FORMAT_OUTLINE,
 
@@ -27,6 +27,17 @@
 FT_BEGIN_HEADER
 
 
+  /* the smooth renderers' module object */
+  typedef struct  FT_Smooth_RendererRec_
+  {
+    FT_RendererRec      root;
+
+    FT_Raster_Executor  executor;       /* `band-executor' property */
+    FT_ULong            max_pool_size;  /* `max-pool-size' property */
+
+  } FT_Smooth_RendererRec, *FT_Smooth_Renderer;
+
+
   FT_DECLARE_RENDERER( ft_smooth_renderer_class )
 
   FT_DECLARE_RENDERER( ft_smooth_lcd_renderer_class )
@@ -0,0 +1,304 @@
+/*
+ * Benchmark for band-parallel rendering in the `smooth' and `raster1'
+ * modules.
+ *
+ * Renders a few glyphs of a font at a large size, first serially and then
+ * with the `band-executor' property set to a simple POSIX thread pool of
+ * 2, 3, ..., N threads, checking that the bitmaps are identical.  Option
+ * `-m' selects monochrome rendering.
+ *
+ * Build with something like
+ *
+ *   cc -O2 -I include test_bands.c libfreetype.a -lpthread -lz -lm
+ *
+ * and run as
+ *
+ *   test_bands [-m] font-file [ppem [max-threads]]
+ */
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_DRIVER_H
+#include FT_MODULE_H
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+#define MAX_THREADS  32
+
+
+  typedef struct  Pool_
+  {
+    pthread_mutex_t  lock;
+    pthread_cond_t   wake;
+    pthread_cond_t   done;
+    pthread_t        threads[MAX_THREADS];
+    int              num_threads;
+
+    /* current batch */
+    FT_Raster_BandFunc  func;
+    void*               data;
+    int                 num_jobs;
+    int                 next_job;
+    int                 pending;
+    unsigned long       generation;
+    int                 quit;
+
+  } Pool;
+
+
+  /* take and run jobs of the current batch; called with `lock' held */
+  static void
+  pool_work( Pool*  pool )
+  {
+    while ( pool->next_job < pool->num_jobs )
+    {
+      int  job = pool->next_job++;
+
+
+      pthread_mutex_unlock( &pool->lock );
+      pool->func( pool->data, job );
+      pthread_mutex_lock( &pool->lock );
+
+      if ( --pool->pending == 0 )
+        pthread_cond_broadcast( &pool->done );
+    }
+  }
+
+
+  static void*
+  pool_thread( void*  arg )
+  {
+    Pool*          pool = (Pool*)arg;
+    unsigned long  seen = 0;
+
+
+    pthread_mutex_lock( &pool->lock );
+    for (;;)
+    {
+      while ( !pool->quit && pool->generation == seen )
+        pthread_cond_wait( &pool->wake, &pool->lock );
+
+      if ( pool->quit )
+        break;
+
+      seen = pool->generation;
+      pool_work( pool );
+    }
+    pthread_mutex_unlock( &pool->lock );
+
+    return NULL;
+  }
+
+
+  /* our `FT_Raster_ExecuteFunc'; the calling thread helps out */
+  static void
+  pool_execute( void*               arg,
+                int                 num_bands,
+                FT_Raster_BandFunc  func,
+                void*               data )
+  {
+    Pool*  pool = (Pool*)arg;
+
+
+    pthread_mutex_lock( &pool->lock );
+
+    pool->func     = func;
+    pool->data     = data;
+    pool->num_jobs = num_bands;
+    pool->next_job = 0;
+    pool->pending  = num_bands;
+    pool->generation++;
+    pthread_cond_broadcast( &pool->wake );
+
+    pool_work( pool );
+    while ( pool->pending )
+      pthread_cond_wait( &pool->done, &pool->lock );
+
+    pthread_mutex_unlock( &pool->lock );
+  }
+
+
+  static void
+  pool_start( Pool*  pool,
+              int    num_threads )
+  {
+    int  i;
+
+
+    memset( pool, 0, sizeof ( *pool ) );
+    pthread_mutex_init( &pool->lock, NULL );
+    pthread_cond_init( &pool->wake, NULL );
+    pthread_cond_init( &pool->done, NULL );
+
+    /* the calling thread is the remaining worker */
+    pool->num_threads = num_threads - 1;
+    for ( i = 0; i < pool->num_threads; i++ )
+      pthread_create( &pool->threads[i], NULL, pool_thread, pool );
+  }
+
+
+  static void
+  pool_stop( Pool*  pool )
+  {
+    int  i;
+
+
+    pthread_mutex_lock( &pool->lock );
+    pool->quit = 1;
+    pthread_cond_broadcast( &pool->wake );
+    pthread_mutex_unlock( &pool->lock );
+
+    for ( i = 0; i < pool->num_threads; i++ )
+      pthread_join( pool->threads[i], NULL );
+
+    pthread_mutex_destroy( &pool->lock );
+    pthread_cond_destroy( &pool->wake );
+    pthread_cond_destroy( &pool->done );
+  }
+
+
+  static double
+  get_time( void )
+  {
+    struct timespec  ts;
+
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+  }
+
+
+  /* render some glyphs; return time per glyph and a checksum */
+  static double
+  render_glyphs( FT_Face         face,
+                 FT_Int32        load_flags,
+                 unsigned long*  checksum )
+  {
+    const char*    text = "@&WMBQg";
+    unsigned long  sum  = 0;
+    double         start, count = 0;
+    int            repeat;
+
+
+    start = get_time();
+
+    for ( repeat = 0; repeat < 10; repeat++ )
+    {
+      const char*  p;
+
+
+      for ( p = text; *p; p++ )
+      {
+        FT_Bitmap*    bitmap;
+        unsigned int  row, col, width;
+
+
+        if ( FT_Load_Char( face, (FT_ULong)*p, load_flags ) )
+          continue;
+
+        count++;
+        if ( repeat )
+          continue;
+
+        bitmap = &face->glyph->bitmap;
+        width  = bitmap->pixel_mode == FT_PIXEL_MODE_MONO
+                   ? ( bitmap->width + 7 ) / 8
+                   : bitmap->width;
+
+        for ( row = 0; row < bitmap->rows; row++ )
+          for ( col = 0; col < width; col++ )
+            sum = sum * 31 + bitmap->buffer[row * bitmap->pitch + col];
+      }
+    }
+
+    *checksum = sum;
+    return count ? ( get_time() - start ) / count : 0;
+  }
+
+
+  int
+  main( int     argc,
+        char**  argv )
+  {
+    FT_Library          library;
+    FT_Face             face;
+    FT_Raster_Executor  executor;
+    Pool                pool;
+
+    const char*    module     = "smooth";
+    FT_Int32       load_flags = FT_LOAD_RENDER;
+    unsigned long  serial_sum, sum;
+    double         serial_time, t;
+    int            ppem        = 1000;
+    int            max_threads = 8;
+    int            n;
+
+
+    if ( argc > 1 && !strcmp( argv[1], "-m" ) )
+    {
+      module      = "raster1";
+      load_flags |= FT_LOAD_TARGET_MONO;
+      argc--;
+      argv++;
+    }
+
+    if ( argc < 2 )
+    {
+      fprintf( stderr,
+               "usage: test_bands [-m] font-file [ppem [max-threads]]\n" );
+      return 1;
+    }
+
+    if ( argc > 2 )
+      ppem = atoi( argv[2] );
+    if ( argc > 3 )
+      max_threads = atoi( argv[3] );
+    if ( max_threads > MAX_THREADS )
+      max_threads = MAX_THREADS;
+
+    if ( FT_Init_FreeType( &library )               ||
+         FT_New_Face( library, argv[1], 0, &face )  ||
+         FT_Set_Pixel_Sizes( face, 0, (FT_UInt)ppem ) )
+    {
+      fprintf( stderr, "cannot open `%s'\n", argv[1] );
+      return 1;
+    }
+
+    serial_time = render_glyphs( face, load_flags, &serial_sum );
+    printf( "threads  ms/glyph  speedup\n" );
+    printf( "%7d  %8.3f  %7.2f\n", 1, serial_time * 1000, 1.0 );
+
+    for ( n = 2; n <= max_threads; n++ )
+    {
+      pool_start( &pool, n );
+
+      executor.execute   = pool_execute;
+      executor.pool      = &pool;
+      executor.max_bands = n;
+      executor.min_rows  = 0;
+      FT_Property_Set( library, module, "band-executor", &executor );
+
+      t = render_glyphs( face, load_flags, &sum );
+      printf( "%7d  %8.3f  %7.2f%s\n",
+              n, t * 1000, serial_time / t,
+              sum == serial_sum ? "" : "  MISMATCH" );
+
+      executor.execute = NULL;
+      FT_Property_Set( library, module, "band-executor", &executor );
+
+      pool_stop( &pool );
+    }
+
+    FT_Done_Face( face );
+    FT_Done_FreeType( library );
+
+    return 0;
+  }
+
+
+/* END */
@@ -0,0 +1,304 @@
+/*
+ * Benchmark for the concurrent cache manager.
+ *
+ * Several threads look up small bitmaps of random glyphs at random sizes,
+ * first through an ordinary cache manager protected by a single mutex,
+ * then through a manager created with `FTC_Manager_NewConcurrent'.  Each
+ * thread uses the same sequence of lookups in both runs, so the checksums
+ * must be identical.
+ *
+ * Build with something like
+ *
+ *   cc -O2 -I include test_cache_mt.c libfreetype.a -lpthread -lz -lm
+ *
+ * and run as
+ *
+ *   test_cache_mt font-file [max-threads [max-kbytes [lookups]]]
+ */
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_CACHE_H
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+#define MAX_THREADS  64
+
+
+  typedef struct  Test_
+  {
+    FTC_Manager      manager;
+    FTC_SBitCache    cache;
+    pthread_mutex_t  lock;        /* the global lock, if `locked' is set */
+    int              locked;
+    FT_Long          num_glyphs;
+    long             lookups;     /* per thread */
+
+  } Test;
+
+
+  typedef struct  Worker_
+  {
+    Test*          test;
+    pthread_t      thread;
+    unsigned long  seed;
+    unsigned long  checksum;
+
+  } Worker;
+
+
+  static FT_Error
+  face_requester( FTC_FaceID  face_id,
+                  FT_Library  library,
+                  FT_Pointer  req_data,
+                  FT_Face*    aface )
+  {
+    (void)req_data;
+
+    return FT_New_Face( library, (const char*)face_id, 0, aface );
+  }
+
+
+  static FT_Pointer
+  mutex_new( FT_Pointer  data )
+  {
+    pthread_mutex_t*  mutex = (pthread_mutex_t*)malloc( sizeof ( *mutex ) );
+
+
+    (void)data;
+
+    if ( mutex )
+      pthread_mutex_init( mutex, NULL );
+
+    return mutex;
+  }
+
+
+  static void
+  mutex_done( FT_Pointer  data,
+              FT_Pointer  lock )
+  {
+    (void)data;
+
+    pthread_mutex_destroy( (pthread_mutex_t*)lock );
+    free( lock );
+  }
+
+
+  static void
+  mutex_lock( FT_Pointer  lock )
+  {
+    pthread_mutex_lock( (pthread_mutex_t*)lock );
+  }
+
+
+  static void
+  mutex_unlock( FT_Pointer  lock )
+  {
+    pthread_mutex_unlock( (pthread_mutex_t*)lock );
+  }
+
+
+  static const char*  font_file;
+
+
+  static void*
+  worker_thread( void*  arg )
+  {
+    Worker*        worker = (Worker*)arg;
+    Test*          test   = worker->test;
+    unsigned long  seed   = worker->seed;
+    unsigned long  sum    = 0;
+    long           n;
+
+
+    for ( n = 0; n < test->lookups; n++ )
+    {
+      FTC_ImageTypeRec  type;
+      FTC_SBit          sbit;
+      FTC_Node          node;
+      FT_UInt           gindex;
+
+
+      /* a skewed distribution: small sizes and low glyph indices */
+      /* are more frequent, as in real text                       */
+      seed   = seed * 1103515245UL + 12345UL;
+      gindex = (FT_UInt)( ( ( seed >> 8 ) % 256 ) *
+                          ( ( seed >> 16 ) % 256 ) / 256 *
+                          (unsigned long)test->num_glyphs / 256 );
+
+      seed = seed * 1103515245UL + 12345UL;
+
+      type.face_id = (FTC_FaceID)font_file;
+      type.width   = 0;
+      type.height  = 8 + ( ( seed >> 8 ) % 16 ) * ( ( seed >> 16 ) % 16 ) / 8;
+      type.flags   = FT_LOAD_DEFAULT | FT_LOAD_RENDER;
+
+      if ( test->locked )
+        pthread_mutex_lock( &test->lock );
+
+      if ( !FTC_SBitCache_Lookup( test->cache, &type, gindex,
+                                  &sbit, &node ) )
+      {
+        int  i, size = sbit->pitch * sbit->height;
+
+
+        sum = sum * 31 + sbit->width * 256 + sbit->height;
+        for ( i = 0; i < size; i++ )
+          sum += sbit->buffer[i];
+
+        FTC_Node_Unref( node, test->manager );
+      }
+
+      if ( test->locked )
+        pthread_mutex_unlock( &test->lock );
+    }
+
+    worker->checksum = sum;
+
+    return NULL;
+  }
+
+
+  static double
+  get_time( void )
+  {
+    struct timespec  ts;
+
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+  }
+
+
+  /* run the lookups in `num_threads' threads; return lookups per second */
+  static double
+  run( Test*           test,
+       int             num_threads,
+       unsigned long*  checksum )
+  {
+    Worker         workers[MAX_THREADS];
+    unsigned long  sum = 0;
+    double         start;
+    int            i;
+
+
+    start = get_time();
+
+    for ( i = 0; i < num_threads; i++ )
+    {
+      workers[i].test = test;
+      workers[i].seed = (unsigned long)i * 7919 + 1;
+      pthread_create( &workers[i].thread, NULL, worker_thread, &workers[i] );
+    }
+
+    for ( i = 0; i < num_threads; i++ )
+    {
+      pthread_join( workers[i].thread, NULL );
+      sum += workers[i].checksum;
+    }
+
+    *checksum = sum;
+    return test->lookups * num_threads / ( get_time() - start );
+  }
+
+
+  int
+  main( int     argc,
+        char**  argv )
+  {
+    FT_Library     library;
+    FT_Face        face;
+    FTC_LockerRec  locker;
+    Test           global, sharded;
+
+    unsigned long  global_sum, sharded_sum;
+    double         global_rate, sharded_rate;
+    unsigned long  max_bytes   = 1024 * 1024;
+    int            max_threads = 8;
+    int            n;
+
+
+    if ( argc < 2 )
+    {
+      fprintf( stderr,
+               "usage: test_cache_mt font-file"
+               " [max-threads [max-kbytes [lookups]]]\n" );
+      return 1;
+    }
+
+    font_file = argv[1];
+
+    memset( &global, 0, sizeof ( global ) );
+    global.lookups = 200000;
+
+    if ( argc > 2 )
+      max_threads = atoi( argv[2] );
+    if ( max_threads > MAX_THREADS )
+      max_threads = MAX_THREADS;
+    if ( argc > 3 )
+      max_bytes = strtoul( argv[3], NULL, 10 ) * 1024;
+    if ( argc > 4 )
+      global.lookups = atol( argv[4] );
+
+    if ( FT_Init_FreeType( &library )                 ||
+         FT_New_Face( library, font_file, 0, &face )  )
+    {
+      fprintf( stderr, "cannot open `%s'\n", font_file );
+      return 1;
+    }
+
+    global.num_glyphs = face->num_glyphs;
+    FT_Done_Face( face );
+
+    sharded = global;
+
+    global.locked = 1;
+    pthread_mutex_init( &global.lock, NULL );
+
+    locker.lock_new  = mutex_new;
+    locker.lock_done = mutex_done;
+    locker.lock      = mutex_lock;
+    locker.unlock    = mutex_unlock;
+    locker.data      = NULL;
+
+    printf( "threads  global lookups/s  sharded lookups/s  speedup\n" );
+
+    for ( n = 1; n <= max_threads; n++ )
+    {
+      if ( FTC_Manager_New( library, 0, 0, max_bytes,
+                            face_requester, NULL, &global.manager )    ||
+           FTC_SBitCache_New( global.manager, &global.cache )          ||
+           FTC_Manager_NewConcurrent( library, 0, 0, max_bytes,
+                                      face_requester, NULL, 0, &locker,
+                                      &sharded.manager )               ||
+           FTC_SBitCache_New( sharded.manager, &sharded.cache )        )
+      {
+        fprintf( stderr, "cannot create cache managers\n" );
+        return 1;
+      }
+
+      global_rate  = run( &global, n, &global_sum );
+      sharded_rate = run( &sharded, n, &sharded_sum );
+
+      printf( "%7d  %17.0f  %17.0f  %7.2f%s\n",
+              n, global_rate, sharded_rate, sharded_rate / global_rate,
+              global_sum == sharded_sum ? "" : "  MISMATCH" );
+
+      FTC_Manager_Done( global.manager );
+      FTC_Manager_Done( sharded.manager );
+    }
+
+    pthread_mutex_destroy( &global.lock );
+    FT_Done_FreeType( library );
+
+    return 0;
+  }
+
+
+/* END */
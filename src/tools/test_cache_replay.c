@@ -0,0 +1,330 @@
+/*
+ * Replay benchmark for the replacement policy of the cache manager.
+ *
+ * Replays a trace of small bitmap lookups through an `FTC_SBitCache' and
+ * reports the hit rate and the number of lookups per second.  A lookup
+ * counts as a miss if it allocates memory, i.e., if a glyph has to be
+ * loaded.
+ *
+ * The trace is read from a file with one lookup per line, giving a glyph
+ * index and a pixel size:
+ *
+ *   36 12
+ *   72 12
+ *   ...
+ *
+ * Without a trace file, a synthetic trace is generated: glyphs are drawn
+ * from a Zipf-like distribution at a few sizes, and the mapping of ranks
+ * to glyph indices changes a few times to simulate switching between
+ * documents.
+ *
+ * To compare policies, run it against libraries compiled with and
+ * without `FTC_CLOCK' defined in `src/cache/ftccache.h'.
+ *
+ * Build with something like
+ *
+ *   cc -O2 -I include test_cache_replay.c libfreetype.a -lz -lm
+ *
+ * and run as
+ *
+ *   test_cache_replay font-file [max-kbytes [trace-file]]
+ */
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_CACHE_H
+#include FT_MODULE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+#define SYNTHETIC_LOOKUPS  2000000L
+#define SYNTHETIC_PHASES   4
+
+
+  typedef struct  Lookup_
+  {
+    FT_UInt  gindex;
+    FT_UInt  ppem;
+
+  } Lookup;
+
+
+  static unsigned long  num_allocs;
+
+
+  static void*
+  count_alloc( FT_Memory  memory,
+               long       size )
+  {
+    (void)memory;
+
+    num_allocs++;
+    return malloc( (size_t)size );
+  }
+
+
+  static void
+  count_free( FT_Memory  memory,
+              void*      block )
+  {
+    (void)memory;
+
+    free( block );
+  }
+
+
+  static void*
+  count_realloc( FT_Memory  memory,
+                 long       cur_size,
+                 long       new_size,
+                 void*      block )
+  {
+    (void)memory;
+    (void)cur_size;
+
+    num_allocs++;
+    return realloc( block, (size_t)new_size );
+  }
+
+
+  static FT_Error
+  face_requester( FTC_FaceID  face_id,
+                  FT_Library  library,
+                  FT_Pointer  req_data,
+                  FT_Face*    aface )
+  {
+    (void)req_data;
+
+    return FT_New_Face( library, (const char*)face_id, 0, aface );
+  }
+
+
+  static double
+  get_time( void )
+  {
+    struct timespec  ts;
+
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+  }
+
+
+  static Lookup*
+  read_trace( const char*  filename,
+              long*        acount )
+  {
+    FILE*    file = fopen( filename, "r" );
+    Lookup*  trace = NULL;
+    long     count = 0, size = 0;
+    FT_UInt  gindex, ppem;
+
+
+    if ( !file )
+      return NULL;
+
+    while ( fscanf( file, "%u %u", &gindex, &ppem ) == 2 )
+    {
+      if ( count == size )
+      {
+        size  = size ? size * 2 : 4096;
+        trace = (Lookup*)realloc( trace, (size_t)size * sizeof ( *trace ) );
+      }
+
+      trace[count].gindex = gindex;
+      trace[count].ppem   = ppem;
+      count++;
+    }
+
+    fclose( file );
+
+    *acount = count;
+    return trace;
+  }
+
+
+  static Lookup*
+  make_trace( FT_Long  num_glyphs,
+              long*    acount )
+  {
+    static const FT_UInt  sizes[] = { 12, 12, 12, 12, 16, 16, 24, 9 };
+
+    Lookup*        trace;
+    double*        cdf;
+    FT_UInt*       map;
+    unsigned long  seed = 1;
+    double         sum  = 0;
+    long           n, count = SYNTHETIC_LOOKUPS;
+    FT_Long        i;
+
+
+    trace = (Lookup*)malloc( (size_t)count * sizeof ( *trace ) );
+    cdf   = (double*)malloc( (size_t)num_glyphs * sizeof ( *cdf ) );
+    map   = (FT_UInt*)malloc( (size_t)num_glyphs * sizeof ( *map ) );
+
+    /* Zipf distribution with exponent 1 */
+    for ( i = 0; i < num_glyphs; i++ )
+    {
+      sum   += 1.0 / ( i + 1 );
+      cdf[i] = sum;
+      map[i] = (FT_UInt)i;
+    }
+
+    for ( n = 0; n < count; n++ )
+    {
+      double   r;
+      FT_Long  lo = 0, hi = num_glyphs - 1;
+
+
+      if ( n % ( count / SYNTHETIC_PHASES ) == 0 )
+      {
+        /* a new document: shuffle the glyph ranks */
+        for ( i = num_glyphs - 1; i > 0; i-- )
+        {
+          FT_Long  j;
+          FT_UInt  tmp;
+
+
+          seed = seed * 1103515245UL + 12345UL;
+          j    = (FT_Long)( ( seed >> 8 ) % (unsigned long)( i + 1 ) );
+
+          tmp    = map[i];
+          map[i] = map[j];
+          map[j] = tmp;
+        }
+      }
+
+      seed = seed * 1103515245UL + 12345UL;
+      r    = ( ( seed >> 8 ) & 0xFFFFFF ) / 16777216.0 * sum;
+
+      while ( lo < hi )
+      {
+        FT_Long  mid = ( lo + hi ) / 2;
+
+
+        if ( cdf[mid] < r )
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+
+      seed = seed * 1103515245UL + 12345UL;
+
+      trace[n].gindex = map[lo];
+      trace[n].ppem   = sizes[( seed >> 8 ) % 8];
+    }
+
+    free( cdf );
+    free( map );
+
+    *acount = count;
+    return trace;
+  }
+
+
+  int
+  main( int     argc,
+        char**  argv )
+  {
+    struct FT_MemoryRec_  memory_rec;
+    FT_Library            library;
+    FT_Face               face;
+    FTC_Manager           manager;
+    FTC_SBitCache         cache;
+    Lookup*               trace;
+
+    const char*    font_file;
+    unsigned long  max_bytes = 512 * 1024;
+    unsigned long  hits      = 0;
+    long           count, n;
+    double         start, elapsed;
+
+
+    if ( argc < 2 )
+    {
+      fprintf( stderr,
+               "usage: test_cache_replay font-file"
+               " [max-kbytes [trace-file]]\n" );
+      return 1;
+    }
+
+    font_file = argv[1];
+    if ( argc > 2 )
+      max_bytes = strtoul( argv[2], NULL, 10 ) * 1024;
+
+    memory_rec.user    = NULL;
+    memory_rec.alloc   = count_alloc;
+    memory_rec.free    = count_free;
+    memory_rec.realloc = count_realloc;
+
+    if ( FT_New_Library( &memory_rec, &library ) )
+      return 1;
+
+    FT_Add_Default_Modules( library );
+    FT_Set_Default_Properties( library );
+
+    if ( FT_New_Face( library, font_file, 0, &face ) )
+    {
+      fprintf( stderr, "cannot open `%s'\n", font_file );
+      return 1;
+    }
+
+    if ( argc > 3 )
+      trace = read_trace( argv[3], &count );
+    else
+      trace = make_trace( face->num_glyphs, &count );
+
+    FT_Done_Face( face );
+
+    if ( !trace || !count )
+    {
+      fprintf( stderr, "cannot read `%s'\n", argv[3] );
+      return 1;
+    }
+
+    if ( FTC_Manager_New( library, 0, 0, max_bytes,
+                          face_requester, NULL, &manager ) ||
+         FTC_SBitCache_New( manager, &cache )              )
+    {
+      fprintf( stderr, "cannot create cache manager\n" );
+      return 1;
+    }
+
+    start = get_time();
+
+    for ( n = 0; n < count; n++ )
+    {
+      FTC_ImageTypeRec  type;
+      FTC_SBit          sbit;
+      unsigned long     allocs = num_allocs;
+
+
+      type.face_id = (FTC_FaceID)font_file;
+      type.width   = 0;
+      type.height  = trace[n].ppem;
+      type.flags   = FT_LOAD_DEFAULT | FT_LOAD_RENDER;
+
+      FTC_SBitCache_Lookup( cache, &type, trace[n].gindex, &sbit, NULL );
+
+      if ( num_allocs == allocs )
+        hits++;
+    }
+
+    elapsed = get_time() - start;
+
+    printf( "%ld lookups, hit rate %.2f%%, %.0f lookups/s\n",
+            count, 100.0 * hits / count, count / elapsed );
+
+    FTC_Manager_Done( manager );
+    FT_Done_Library( library );
+    free( trace );
+
+    return 0;
+  }
+
+
+/* END */
@@ -0,0 +1,235 @@
+/*
+ * Test for the `hinting-cost-limit' and `hinting-cost' properties of the
+ * TrueType driver.
+ *
+ * The program opens a face with a very large limit, loads all glyphs at a
+ * few sizes, and prints the estimated cost of the font program, the cvt
+ * program, and the most expensive glyph program.  It then checks that the
+ * limit works: a face must be rejected if the limit is one less than the
+ * larger of the font and cvt program estimates, and accepted if the limit
+ * equals that estimate.
+ *
+ * If FreeType has been built with TT_CONFIG_OPTION_BYTECODE_PROFILE, the
+ * estimates are also compared with the instructions actually executed.
+ * The estimates are not upper bounds (a glyph's estimate, for example,
+ * doesn't include the programs of its components), but an estimate below
+ * half of the executed instructions means that the verifier lost track
+ * of the functions called.  This happened, for example, when the values
+ * pushed by `PUSHB' and `PUSHW' were taken as unknown; the cvt program of
+ * `DejaVuSans-Bold.ttf' was then estimated to run 434 instructions
+ * instead of 3371.
+ *
+ * Build with something like
+ *
+ *   cc -O2 -I include test_hinting_cost.c libfreetype.a -lz -lm
+ *
+ * and run as
+ *
+ *   test_hinting_cost font-file ...
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_DRIVER_H
+#include FT_MODULE_H
+
+#include <stdio.h>
+
+
+  /* use a static structure; the profile is rather large */
+  static FT_Prop_BytecodeProfile  profile;
+
+
+  /* open a face with the given limit and return its estimates */
+  static int
+  get_cost( FT_Library            library,
+            const char*           filename,
+            FT_ULong              limit,
+            int                   load_glyphs,
+            FT_Prop_HintingCost*  cost,
+            FT_Bool              *ahinter )
+  {
+    FT_Face  face;
+    FT_UInt  ppem;
+    FT_Long  gindex;
+    int      have_profile = 0;
+
+
+    FT_Property_Set( library, "truetype", "hinting-cost-limit", &limit );
+
+    if ( FT_New_Face( library, filename, 0, &face ) )
+      return -1;
+
+    if ( load_glyphs )
+    {
+      profile.face = face;
+      have_profile = !FT_Property_Set( library, "truetype",
+                                       "bytecode-profile", &profile );
+
+      for ( ppem = 9; ppem <= 21; ppem += 6 )
+      {
+        if ( FT_Set_Pixel_Sizes( face, 0, ppem ) )
+          continue;
+
+        for ( gindex = 0; gindex < face->num_glyphs; gindex++ )
+          FT_Load_Glyph( face, (FT_UInt)gindex, FT_LOAD_DEFAULT );
+      }
+
+      if ( have_profile )
+        have_profile = !FT_Property_Get( library, "truetype",
+                                         "bytecode-profile", &profile );
+    }
+
+    cost->face = face;
+    FT_Property_Get( library, "truetype", "hinting-cost", cost );
+    cost->face = NULL;
+
+    *ahinter = FT_BOOL( face->face_flags & FT_FACE_FLAG_HINTER );
+
+    FT_Done_Face( face );
+
+    return have_profile;
+  }
+
+
+  /* compare an estimate with the number of executed instructions */
+  static int
+  check_estimate( const char*  what,
+                  FT_ULong     estimate,
+                  FT_ULong     executed )
+  {
+    printf( "  %-12s estimated %8lu, executed %8lu\n",
+            what, estimate, executed );
+
+    if ( estimate < executed / 2 )
+    {
+      printf( "  %s: estimate too low\n", what );
+      return 0;
+    }
+
+    return 1;
+  }
+
+
+  static int
+  test_font( FT_Library   library,
+             const char*  filename )
+  {
+    FT_Prop_HintingCost  cost, limited;
+    FT_Bool              hinter;
+    FT_ULong             limit;
+    int                  have_profile;
+    int                  ok = 1;
+
+
+    printf( "%s\n", filename );
+
+    have_profile = get_cost( library, filename, 0xFFFFFFFFUL, 1,
+                             &cost, &hinter );
+    if ( have_profile < 0 )
+    {
+      printf( "  cannot open font\n" );
+      return 0;
+    }
+
+    if ( !cost.verified )
+    {
+      printf( "  not verified (not a TrueType font?)\n" );
+      return 1;
+    }
+
+    printf( "  fpgm %lu, prep %lu, max glyph %lu%s\n",
+            cost.font_program, cost.cvt_program, cost.max_glyph,
+            cost.rejected ? ", rejected" : "" );
+
+    if ( have_profile )
+    {
+      FT_ULong  max_glyph = 0;
+      FT_UInt   n;
+
+
+      for ( n = 0; n < profile.num_glyphs; n++ )
+        if ( profile.glyphs[n].instructions > max_glyph )
+          max_glyph = profile.glyphs[n].instructions;
+
+      if ( profile.program_runs[FT_BYTECODE_PROFILE_FONT] )
+        ok &= check_estimate(
+                "fpgm",
+                cost.font_program,
+                profile.program_instructions[FT_BYTECODE_PROFILE_FONT] /
+                  profile.program_runs[FT_BYTECODE_PROFILE_FONT] );
+      if ( profile.program_runs[FT_BYTECODE_PROFILE_CVT] )
+        ok &= check_estimate(
+                "prep",
+                cost.cvt_program,
+                profile.program_instructions[FT_BYTECODE_PROFILE_CVT] /
+                  profile.program_runs[FT_BYTECODE_PROFILE_CVT] );
+      ok &= check_estimate( "max glyph", cost.max_glyph, max_glyph );
+    }
+
+    /* a broken font can be rejected at any limit */
+    if ( cost.rejected )
+      return ok;
+
+    limit = cost.font_program > cost.cvt_program ? cost.font_program
+                                                 : cost.cvt_program;
+    if ( !limit )
+      return ok;
+
+    get_cost( library, filename, limit, 0, &limited, &hinter );
+    if ( limited.rejected || !hinter )
+    {
+      printf( "  rejected with limit %lu\n", limit );
+      ok = 0;
+    }
+
+    if ( limit > 1 )
+    {
+      get_cost( library, filename, limit - 1, 0, &limited, &hinter );
+      if ( !limited.rejected || hinter )
+      {
+        printf( "  accepted with limit %lu\n", limit - 1 );
+        ok = 0;
+      }
+    }
+
+    return ok;
+  }
+
+
+  int
+  main( int     argc,
+        char**  argv )
+  {
+    FT_Library  library;
+    int         failures = 0;
+    int         n;
+
+
+    if ( argc < 2 )
+    {
+      fprintf( stderr, "usage: test_hinting_cost font-file ...\n" );
+      return 2;
+    }
+
+    if ( FT_Init_FreeType( &library ) )
+    {
+      fprintf( stderr, "cannot initialize FreeType\n" );
+      return 2;
+    }
+
+    for ( n = 1; n < argc; n++ )
+      if ( !test_font( library, argv[n] ) )
+        failures++;
+
+    printf( "%d fonts, %d failures\n", argc - 1, failures );
+
+    FT_Done_FreeType( library );
+
+    return failures ? 1 : 0;
+  }
+
+
+/* END */
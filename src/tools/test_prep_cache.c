@@ -0,0 +1,222 @@
+/*
+ * Regression test for the per-face caches of the TrueType driver.
+ *
+ * A TrueType face keeps the results of the CVT program for its most
+ * recently used sizes and rendering modes.  This program loads glyphs
+ * from one face while switching between sizes and rendering modes, and
+ * compares each result with that of a face used for a single rendering
+ * mode only.  Any difference means that a cached result didn't restore
+ * the state of the bytecode interpreter completely.
+ *
+ * The lookups are pseudo-random but reproducible.  Problems found so far
+ * showed up, for example, with `DejaVuSerif-Bold.ttf' and interpreter
+ * version 40 when loading glyph 508 at 16ppem in normal mode, then glyph
+ * 501 in monochrome mode, then glyph 508 in normal mode again; this
+ * sequence is always tested first.
+ *
+ * Build with something like
+ *
+ *   cc -O2 -I include test_prep_cache.c libfreetype.a -lz -lm
+ *
+ * and run as
+ *
+ *   test_prep_cache font-file [interpreter-version [loads]]
+ *
+ * The exit status is 1 if any result differs.
+ */
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_DRIVER_H
+#include FT_MODULE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+#define NUM_MODES  3
+
+
+  static const FT_Int32  load_modes[NUM_MODES] =
+  {
+    FT_LOAD_TARGET_NORMAL,
+    FT_LOAD_TARGET_MONO,
+    FT_LOAD_TARGET_LCD
+  };
+
+  static const char*  mode_names[NUM_MODES] =
+  {
+    "normal",
+    "mono",
+    "lcd"
+  };
+
+
+  typedef struct  Load_
+  {
+    FT_UInt  gindex;
+    FT_UInt  ppem;
+    int      mode;
+
+  } Load;
+
+
+  static const Load  known_loads[] =
+  {
+    { 508, 16, 0 },
+    { 501, 16, 1 },
+    { 508, 16, 0 },
+    { 296, 14, 0 },
+    { 296, 14, 1 },
+    { 296, 14, 0 }
+  };
+
+
+  /* a hash of the loaded glyph's metrics and outline */
+  static unsigned long
+  glyph_hash( FT_Face  face )
+  {
+    FT_GlyphSlot   slot    = face->glyph;
+    FT_Outline*    outline = &slot->outline;
+    unsigned long  hash    = 2166136261UL;
+    short          n;
+
+
+    hash = ( hash ^ (unsigned long)slot->advance.x ) * 16777619UL;
+    hash = ( hash ^ (unsigned long)slot->linearHoriAdvance ) * 16777619UL;
+    hash = ( hash ^ (unsigned long)slot->metrics.horiAdvance ) * 16777619UL;
+    hash = ( hash ^ (unsigned long)slot->metrics.horiBearingX ) *
+             16777619UL;
+
+    for ( n = 0; n < outline->n_points; n++ )
+    {
+      hash = ( hash ^ (unsigned long)outline->points[n].x ) * 16777619UL;
+      hash = ( hash ^ (unsigned long)outline->points[n].y ) * 16777619UL;
+    }
+
+    return hash;
+  }
+
+
+  /* load a glyph in `face'; return FALSE on error */
+  static int
+  load_glyph( FT_Face         face,
+              const Load*     load,
+              unsigned long  *ahash )
+  {
+    if ( FT_Set_Pixel_Sizes( face, 0, load->ppem )                 ||
+         FT_Load_Glyph( face, load->gindex, load_modes[load->mode] ) )
+      return 0;
+
+    *ahash = glyph_hash( face );
+    return 1;
+  }
+
+
+  int
+  main( int     argc,
+        char**  argv )
+  {
+    FT_Library     library;
+    FT_Face        face;
+    FT_Face        mode_faces[NUM_MODES];
+    FT_UInt        version = 40;
+    long           num_loads = 100000;
+    long           n, num_known;
+    long           errors = 0;
+    unsigned long  seed = 1;
+    int            m;
+
+
+    if ( argc < 2 )
+    {
+      fprintf( stderr,
+               "usage: test_prep_cache font-file"
+               " [interpreter-version [loads]]\n" );
+      return 2;
+    }
+
+    if ( argc > 2 )
+      version = (FT_UInt)atoi( argv[2] );
+    if ( argc > 3 )
+      num_loads = atol( argv[3] );
+
+    if ( FT_Init_FreeType( &library ) )
+    {
+      fprintf( stderr, "cannot initialize FreeType\n" );
+      return 2;
+    }
+
+    if ( FT_Property_Set( library, "truetype",
+                          "interpreter-version", &version ) )
+      fprintf( stderr, "interpreter version %u not available\n", version );
+
+    if ( FT_New_Face( library, argv[1], 0, &face ) )
+    {
+      fprintf( stderr, "cannot open `%s'\n", argv[1] );
+      return 2;
+    }
+
+    for ( m = 0; m < NUM_MODES; m++ )
+      if ( FT_New_Face( library, argv[1], 0, &mode_faces[m] ) )
+      {
+        fprintf( stderr, "cannot open `%s'\n", argv[1] );
+        return 2;
+      }
+
+    num_known = (long)( sizeof ( known_loads ) / sizeof ( *known_loads ) );
+
+    for ( n = 0; n < num_known + num_loads; n++ )
+    {
+      Load           load;
+      unsigned long  hash, expected;
+
+
+      if ( n < num_known )
+        load = known_loads[n];
+      else
+      {
+        seed = seed * 1103515245UL + 12345UL;
+
+        load.gindex = (FT_UInt)( ( seed >> 8 ) %
+                                 (unsigned long)face->num_glyphs );
+        load.mode   = (int)( ( seed >> 4 ) % NUM_MODES );
+
+        /* stay at a size for a while, to switch modes more often */
+        if ( n % 50 == 0 )
+          load.ppem = 9 + (FT_UInt)( ( seed >> 20 ) % 32 );
+        else
+          load.ppem = 0;
+      }
+
+      if ( !load.ppem )
+        load.ppem = face->size->metrics.x_ppem;
+
+      if ( load.gindex >= (FT_UInt)face->num_glyphs )
+        continue;
+
+      if ( !load_glyph( face, &load, &hash )                     ||
+           !load_glyph( mode_faces[load.mode], &load, &expected ) )
+        continue;
+
+      if ( hash != expected )
+      {
+        if ( errors < 20 )
+          printf( "load %ld: glyph %u at %uppem, %s mode differs\n",
+                  n, load.gindex, load.ppem, mode_names[load.mode] );
+        errors++;
+      }
+    }
+
+    printf( "%ld loads, %ld differences\n", num_known + num_loads, errors );
+
+    for ( m = 0; m < NUM_MODES; m++ )
+      FT_Done_Face( mode_faces[m] );
+    FT_Done_Face( face );
+    FT_Done_FreeType( library );
+
+    return errors ? 1 : 0;
+  }
+
+
+/* END */
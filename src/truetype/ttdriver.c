@@ -109,6 +109,72 @@
       return error;
     }
 
+    if ( !ft_strcmp( property_name, "glyph-cache-size" ) )
+    {
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s    = (const char*)value;
+        long         size = ft_strtol( s, NULL, 10 );
+
+
+        if ( size < 0 )
+          return FT_THROW( Invalid_Argument );
+
+        driver->glyph_cache_size = (FT_ULong)size;
+      }
+      else
+#endif
+        driver->glyph_cache_size = *(const FT_ULong*)value;
+
+      return error;
+    }
+
+    if ( !ft_strcmp( property_name, "hinting-cost-limit" ) )
+    {
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      if ( value_is_string )
+      {
+        const char*  s     = (const char*)value;
+        long         limit = ft_strtol( s, NULL, 10 );
+
+
+        if ( limit < 0 )
+          return FT_THROW( Invalid_Argument );
+
+        driver->hinting_cost_limit = (FT_ULong)limit;
+      }
+      else
+#endif
+        driver->hinting_cost_limit = *(const FT_ULong*)value;
+
+      return error;
+    }
+
+    if ( !ft_strcmp( property_name, "bytecode-profile" ) )
+    {
+#ifdef TT_CONFIG_OPTION_BYTECODE_PROFILE
+      const FT_Prop_BytecodeProfile*  prop;
+
+
+#ifdef FT_CONFIG_OPTION_ENVIRONMENT_PROPERTIES
+      /* a face can't be given as a string */
+      if ( value_is_string )
+        return FT_THROW( Invalid_Argument );
+#endif
+
+      prop = (const FT_Prop_BytecodeProfile*)value;
+      if ( !prop->face || FT_FACE_DRIVER( prop->face ) != (FT_Driver)module )
+        return FT_THROW( Invalid_Face_Handle );
+
+      TT_Reset_Profile( (TT_Face)prop->face );
+
+      return error;
+#else
+      return FT_THROW( Unimplemented_Feature );
+#endif
+    }
+
     FT_TRACE0(( "tt_property_set: missing property `%s'\n",
                 property_name ));
     return FT_THROW( Missing_Property );
@@ -136,6 +202,75 @@
       return error;
     }
 
+    if ( !ft_strcmp( property_name, "glyph-cache-size" ) )
+    {
+      FT_ULong*  val = (FT_ULong*)value;
+
+
+      *val = driver->glyph_cache_size;
+
+      return error;
+    }
+
+    if ( !ft_strcmp( property_name, "hinting-cost-limit" ) )
+    {
+      FT_ULong*  val = (FT_ULong*)value;
+
+
+      *val = driver->hinting_cost_limit;
+
+      return error;
+    }
+
+    if ( !ft_strcmp( property_name, "hinting-cost" ) )
+    {
+      FT_Prop_HintingCost*  prop = (FT_Prop_HintingCost*)value;
+      FT_Face               face = prop->face;
+
+
+      if ( !face || FT_FACE_DRIVER( face ) != (FT_Driver)module )
+        return FT_THROW( Invalid_Face_Handle );
+
+      FT_ZERO( prop );
+      prop->face = face;
+
+#ifdef TT_USE_BYTECODE_INTERPRETER
+      {
+        TT_Verifier  verifier = (TT_Verifier)( (TT_Face)face )->verifier;
+
+
+        if ( verifier )
+        {
+          prop->verified     = TRUE;
+          prop->rejected     = verifier->rejected;
+          prop->font_program = verifier->font_cost;
+          prop->cvt_program  = verifier->cvt_cost;
+          prop->max_glyph    = verifier->max_glyph_cost;
+          prop->num_rejected = verifier->num_rejected;
+        }
+      }
+#endif
+
+      return error;
+    }
+
+    if ( !ft_strcmp( property_name, "bytecode-profile" ) )
+    {
+#ifdef TT_CONFIG_OPTION_BYTECODE_PROFILE
+      FT_Prop_BytecodeProfile*  prop = (FT_Prop_BytecodeProfile*)value;
+
+
+      if ( !prop->face || FT_FACE_DRIVER( prop->face ) != (FT_Driver)module )
+        return FT_THROW( Invalid_Face_Handle );
+
+      TT_Get_Profile( (TT_Face)prop->face, prop );
+
+      return error;
+#else
+      return FT_THROW( Unimplemented_Feature );
+#endif
+    }
+
     FT_TRACE0(( "tt_property_get: missing property `%s'\n",
                 property_name ));
     return FT_THROW( Missing_Property );
@@ -787,6 +787,53 @@
   }
 
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+
+  /* Give a verdict on the glyph program in `exec->glyphIns', unless */
+  /* the glyph already has one.                                      */
+  static FT_Error
+  tt_loader_verify_glyph( TT_Loader  loader,
+                          FT_Long    n_ins )
+  {
+    TT_Face      face     = loader->face;
+    TT_Verifier  verifier = (TT_Verifier)face->verifier;
+    FT_Byte*     verdict  = verifier->verdicts + loader->glyph_index;
+    FT_Error     error;
+    FT_ULong     cost;
+    FT_UInt      flags;
+
+
+    if ( *verdict != TT_VERDICT_UNKNOWN )
+      return FT_Err_Ok;
+
+    error = TT_Verify_Program( verifier, face->root.memory,
+                               tt_coderange_glyph,
+                               loader->exec->glyphIns, n_ins,
+                               &cost, &flags );
+    if ( error )
+      return error;
+
+    if ( cost > verifier->max_glyph_cost )
+      verifier->max_glyph_cost = cost;
+
+    if ( flags & TT_VERIFY_FATAL || cost > verifier->limit )
+    {
+      FT_TRACE2(( "tt_loader_verify_glyph:"
+                  " not hinting glyph %d (cost %lu, flags 0x%x)\n",
+                  loader->glyph_index, cost, flags ));
+
+      *verdict = TT_VERDICT_REJECTED;
+      verifier->num_rejected++;
+    }
+    else
+      *verdict = TT_VERDICT_ACCEPTED;
+
+    return FT_Err_Ok;
+  }
+
+#endif /* TT_USE_BYTECODE_INTERPRETER */
+
+
   /**************************************************************************
    *
    * @Function:
@@ -818,6 +865,20 @@
 #ifdef TT_USE_BYTECODE_INTERPRETER
     n_ins = loader->glyph->control_len;
 
+    if ( n_ins > 0 && loader->face->verifier )
+    {
+      FT_Error  error = tt_loader_verify_glyph( loader, n_ins );
+
+
+      if ( error )
+        return error;
+
+      /* leave the glyph unhinted if its program has been rejected */
+      if ( ( (TT_Verifier)loader->face->verifier )
+             ->verdicts[loader->glyph_index] == TT_VERDICT_REJECTED )
+        n_ins = 0;
+    }
+
     /* save original point positions in `org' array */
     if ( n_ins > 0 )
       FT_ARRAY_COPY( zone->org, zone->cur, zone->n_points );
@@ -868,6 +929,17 @@
       loader->exec->pts          = *zone;
 
       error = TT_Run_Context( loader->exec );
+
+      /* don't run into the instruction limit again */
+      if ( FT_ERR_EQ( error, Execution_Too_Long ) && loader->face->verifier )
+      {
+        TT_Verifier  verifier = (TT_Verifier)loader->face->verifier;
+
+
+        verifier->verdicts[loader->glyph_index] = TT_VERDICT_REJECTED;
+        verifier->num_rejected++;
+      }
+
       if ( error && loader->exec->pedantic_hinting )
         return error;
 
@@ -2084,6 +2156,9 @@
         loader->stream   = old_stream;
         loader->byte_len = old_byte_len;
 
+        /* loading the components has changed it */
+        loader->glyph_index = glyph_index;
+
         /* process the glyph */
         loader->ins_pos = ins_pos;
         if ( IS_HINTED( loader->load_flags ) &&
@@ -2611,12 +2686,10 @@
 
       if ( reexecute )
       {
-        FT_UInt  i;
-
-
-        for ( i = 0; i < size->cvt_size; i++ )
-          size->cvt[i] = FT_MulFix( face->cvt[i], size->ttmetrics.scale );
-        error = tt_size_run_prep( size, pedantic );
+        /* start from a clean state, exactly as for a new size; */
+        /* this also makes the result cacheable                 */
+        size->cvt_ready = -1;
+        error = tt_size_ready_bytecode( size, pedantic );
         if ( error )
           return error;
       }
@@ -2678,6 +2751,429 @@
   }
 
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+
+  /**************************************************************************
+   *
+   *                       HINTED GLYPH CACHE
+   *
+   * If the `glyph-cache-size' property is set, every face keeps recently
+   * loaded hinted glyphs: the outline before it gets translated to the
+   * origin, and the values `compute_glyph_metrics' needs.  Glyphs are
+   * evicted in least-recently-used order as soon as their total size
+   * exceeds the limit.
+   *
+   * The key consists of the glyph index, the load flags relevant to the
+   * glyph loader, and the key of the `prep' result the size holds (see
+   * `TT_PrepKeyRec'), which covers the scaling, the interpreter version,
+   * and the rendering mode.  It does not cover changes glyph programs make
+   * to the CVT, the storage area, or the twilight zone for later glyphs;
+   * fonts relying on such changes might get hinted differently.
+   */
+
+  typedef struct TT_GlyphNodeRec_*  TT_GlyphNode;
+
+  typedef struct  TT_GlyphNodeRec_
+  {
+    TT_GlyphNode   link;          /* next node in hash bucket  */
+    TT_GlyphNode   prev;          /* LRU list, most recently   */
+    TT_GlyphNode   next;          /* used first                */
+    FT_ULong       hash;
+    FT_ULong       weight;        /* the size of the node      */
+
+    FT_UInt        glyph_index;
+    FT_Int32       load_flags;
+    TT_PrepKeyRec  key;
+
+    FT_Vector      pp1;
+    FT_Vector      pp2;
+    FT_Vector      pp3;
+    FT_Vector      pp4;
+    FT_Int         linear;
+
+    FT_Bool        scan_control;
+    FT_Int         scan_type;
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+    FT_Bool        backward_compatibility;
+#endif
+
+    FT_Outline     outline;       /* arrays follow the node    */
+
+  } TT_GlyphNodeRec;
+
+
+  typedef struct  TT_GlyphCacheRec_
+  {
+    TT_GlyphNode*  buckets;
+    FT_ULong       num_buckets;   /* a power of 2              */
+    FT_ULong       num_nodes;
+    FT_ULong       weight;        /* the size of all nodes     */
+
+    TT_GlyphNode   head;
+    TT_GlyphNode   tail;
+
+  } TT_GlyphCacheRec, *TT_GlyphCache;
+
+
+  /* load flags handled outside of the glyph loader */
+#define TT_GLYPH_CACHE_IGNORED_FLAGS  ( FT_LOAD_RENDER           | \
+                                        FT_LOAD_MONOCHROME       | \
+                                        FT_LOAD_LINEAR_DESIGN    | \
+                                        FT_LOAD_NO_AUTOHINT      | \
+                                        FT_LOAD_IGNORE_TRANSFORM | \
+                                        FT_LOAD_COLOR            | \
+                                        FT_LOAD_COMPUTE_METRICS  )
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_face_done_glyph_cache
+   *
+   * @Description:
+   *   Discard all hinted glyphs of a face.
+   *
+   * @Input:
+   *   face ::
+   *     A handle to the target face object.
+   */
+  FT_LOCAL_DEF( void )
+  tt_face_done_glyph_cache( TT_Face  face )
+  {
+    FT_Memory      memory = face->root.memory;
+    TT_GlyphCache  cache  = (TT_GlyphCache)face->glyph_cache;
+    TT_GlyphNode   node;
+
+
+    if ( !cache )
+      return;
+
+    node = cache->head;
+    while ( node )
+    {
+      TT_GlyphNode  next = node->next;
+
+
+      FT_FREE( node );
+      node = next;
+    }
+
+    FT_FREE( cache->buckets );
+    FT_FREE( face->glyph_cache );
+  }
+
+
+  static void
+  tt_glyph_cache_unlink( TT_GlyphCache  cache,
+                         TT_GlyphNode   node )
+  {
+    if ( node->prev )
+      node->prev->next = node->next;
+    else
+      cache->head = node->next;
+
+    if ( node->next )
+      node->next->prev = node->prev;
+    else
+      cache->tail = node->prev;
+  }
+
+
+  static void
+  tt_glyph_cache_push( TT_GlyphCache  cache,
+                       TT_GlyphNode   node )
+  {
+    node->prev = NULL;
+    node->next = cache->head;
+
+    if ( cache->head )
+      cache->head->prev = node;
+    else
+      cache->tail = node;
+
+    cache->head = node;
+  }
+
+
+  static void
+  tt_glyph_cache_evict( TT_Face        face,
+                        TT_GlyphCache  cache )
+  {
+    FT_Memory      memory = face->root.memory;
+    TT_GlyphNode   node   = cache->tail;
+    TT_GlyphNode*  pnode  = &cache->buckets[node->hash &
+                                            ( cache->num_buckets - 1 )];
+
+
+    while ( *pnode != node )
+      pnode = &(*pnode)->link;
+    *pnode = node->link;
+
+    tt_glyph_cache_unlink( cache, node );
+
+    cache->num_nodes--;
+    cache->weight -= node->weight;
+
+    FT_FREE( node );
+  }
+
+
+  /* Fill in the key of `query'; return FALSE if the glyph */
+  /* can't be cached.                                      */
+  static FT_Bool
+  tt_glyph_cache_query( TT_Loader     loader,
+                        FT_UInt       glyph_index,
+                        FT_Int32      load_flags,
+                        TT_GlyphNode  query )
+  {
+    TT_Face    face   = loader->face;
+    TT_Size    size   = loader->size;
+    TT_Driver  driver = (TT_Driver)FT_FACE_DRIVER( face );
+    FT_Byte*   p;
+    FT_Byte*   limit;
+    FT_ULong   hash;
+
+
+    if ( !driver->glyph_cache_size )
+    {
+      /* release the memory if the cache has been switched off */
+      if ( face->glyph_cache )
+        tt_face_done_glyph_cache( face );
+
+      return FALSE;
+    }
+
+    if ( !loader->exec                            ||
+         !size->shared_fpgm                       ||
+         !IS_HINTED( loader->load_flags )         ||
+         ( load_flags & ( FT_LOAD_NO_SCALE   |
+                          FT_LOAD_NO_RECURSE ) )  )
+      return FALSE;
+
+#ifdef FT_CONFIG_OPTION_INCREMENTAL
+    if ( face->root.internal->incremental_interface )
+      return FALSE;
+#endif
+
+    query->glyph_index = glyph_index;
+    query->load_flags  = load_flags & ~TT_GLYPH_CACHE_IGNORED_FLAGS;
+
+    tt_size_prep_key( size,
+                      FT_BOOL( load_flags & FT_LOAD_PEDANTIC ),
+                      &query->key );
+
+    /* FNV-1a */
+    hash  = 2166136261UL ^ glyph_index;
+    hash  = ( hash * 16777619UL ) ^ (FT_ULong)query->load_flags;
+    p     = (FT_Byte*)&query->key;
+    limit = p + sizeof ( query->key );
+    for ( ; p < limit; p++ )
+      hash = ( hash * 16777619UL ) ^ *p;
+
+    query->hash = hash;
+
+    return TRUE;
+  }
+
+
+  /* Load a glyph from the cache into `loader'. */
+  static FT_Bool
+  tt_glyph_cache_lookup( TT_Loader     loader,
+                         TT_GlyphNode  query )
+  {
+    TT_GlyphCache   cache = (TT_GlyphCache)loader->face->glyph_cache;
+    TT_GlyphNode    node;
+    FT_GlyphLoader  gloader;
+    FT_Outline*     outline;
+
+
+    if ( !cache )
+      return FALSE;
+
+    node = cache->buckets[query->hash & ( cache->num_buckets - 1 )];
+    for ( ; node; node = node->link )
+      if ( node->hash        == query->hash                             &&
+           node->glyph_index == query->glyph_index                      &&
+           node->load_flags  == query->load_flags                       &&
+           !ft_memcmp( &node->key, &query->key, sizeof ( node->key ) ) )
+        break;
+
+    if ( !node )
+      return FALSE;
+
+    gloader = loader->gloader;
+    if ( FT_GlyphLoader_CheckPoints( gloader,
+                                     (FT_UInt)node->outline.n_points,
+                                     (FT_UInt)node->outline.n_contours ) )
+      return FALSE;
+
+    outline = &gloader->current.outline;
+
+    FT_ARRAY_COPY( outline->points, node->outline.points,
+                   node->outline.n_points );
+    FT_ARRAY_COPY( outline->tags, node->outline.tags,
+                   node->outline.n_points );
+    FT_ARRAY_COPY( outline->contours, node->outline.contours,
+                   node->outline.n_contours );
+
+    outline->n_points   = node->outline.n_points;
+    outline->n_contours = node->outline.n_contours;
+
+    FT_GlyphLoader_Add( gloader );
+
+    gloader->base.outline.flags = node->outline.flags;
+
+    loader->pp1    = node->pp1;
+    loader->pp2    = node->pp2;
+    loader->pp3    = node->pp3;
+    loader->pp4    = node->pp4;
+    loader->linear = node->linear;
+
+    loader->exec->GS.scan_control = node->scan_control;
+    loader->exec->GS.scan_type    = node->scan_type;
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+    loader->exec->backward_compatibility = node->backward_compatibility;
+#endif
+
+    /* the glyph's instructions haven't been loaded */
+    loader->glyph->control_len  = 0;
+    loader->glyph->control_data = NULL;
+
+    tt_glyph_cache_unlink( cache, node );
+    tt_glyph_cache_push( cache, node );
+
+    return TRUE;
+  }
+
+
+  /* Add the glyph just loaded by `loader' to the cache. */
+  static void
+  tt_glyph_cache_insert( TT_Loader     loader,
+                         TT_GlyphNode  query )
+  {
+    TT_Face        face    = loader->face;
+    TT_Driver      driver  = (TT_Driver)FT_FACE_DRIVER( face );
+    FT_Memory      memory  = face->root.memory;
+    TT_GlyphCache  cache   = (TT_GlyphCache)face->glyph_cache;
+    FT_Outline*    outline = &loader->gloader->base.outline;
+    TT_GlyphNode   node;
+    TT_GlyphNode*  bucket;
+    FT_ULong       weight;
+    FT_Error       error;
+
+
+    weight = sizeof ( TT_GlyphNodeRec )                            +
+             (FT_ULong)outline->n_points *
+               ( sizeof ( FT_Vector ) + sizeof ( char ) )          +
+             (FT_ULong)outline->n_contours * sizeof ( short );
+
+    /* the cache is optional; give up silently if anything fails */
+    if ( weight > driver->glyph_cache_size )
+      return;
+
+    if ( !cache )
+    {
+      if ( FT_NEW( cache ) )
+        return;
+
+      if ( FT_NEW_ARRAY( cache->buckets, 64 ) )
+      {
+        FT_FREE( cache );
+        return;
+      }
+
+      cache->num_buckets = 64;
+      face->glyph_cache  = cache;
+    }
+
+    /* grow the hash table if it gets crowded */
+    if ( cache->num_nodes >= cache->num_buckets &&
+         cache->num_buckets < 0x10000UL         )
+    {
+      TT_GlyphNode*  buckets;
+      FT_ULong       i;
+
+
+      if ( !FT_NEW_ARRAY( buckets, cache->num_buckets * 2 ) )
+      {
+        for ( i = 0; i < cache->num_buckets; i++ )
+        {
+          TT_GlyphNode  n = cache->buckets[i];
+
+
+          while ( n )
+          {
+            TT_GlyphNode   link = n->link;
+            TT_GlyphNode*  pn   = &buckets[n->hash &
+                                           ( cache->num_buckets * 2 - 1 )];
+
+
+            n->link = *pn;
+            *pn     = n;
+            n       = link;
+          }
+        }
+
+        FT_FREE( cache->buckets );
+        cache->buckets      = buckets;
+        cache->num_buckets *= 2;
+      }
+    }
+
+    while ( cache->tail                                      &&
+            cache->weight + weight > driver->glyph_cache_size )
+      tt_glyph_cache_evict( face, cache );
+
+    if ( FT_ALLOC( node, weight ) )
+      return;
+
+    node->hash        = query->hash;
+    node->weight      = weight;
+    node->glyph_index = query->glyph_index;
+    node->load_flags  = query->load_flags;
+    node->key         = query->key;
+
+    node->pp1    = loader->pp1;
+    node->pp2    = loader->pp2;
+    node->pp3    = loader->pp3;
+    node->pp4    = loader->pp4;
+    node->linear = loader->linear;
+
+    node->scan_control = loader->exec->GS.scan_control;
+    node->scan_type    = loader->exec->GS.scan_type;
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+    node->backward_compatibility = loader->exec->backward_compatibility;
+#endif
+
+    node->outline.n_points   = outline->n_points;
+    node->outline.n_contours = outline->n_contours;
+    node->outline.flags      = outline->flags;
+    node->outline.points     = (FT_Vector*)( node + 1 );
+    node->outline.contours   = (short*)( node->outline.points +
+                                         outline->n_points );
+    node->outline.tags       = (char*)( node->outline.contours +
+                                        outline->n_contours );
+
+    FT_ARRAY_COPY( node->outline.points, outline->points,
+                   outline->n_points );
+    FT_ARRAY_COPY( node->outline.contours, outline->contours,
+                   outline->n_contours );
+    FT_ARRAY_COPY( node->outline.tags, outline->tags,
+                   outline->n_points );
+
+    bucket     = &cache->buckets[node->hash & ( cache->num_buckets - 1 )];
+    node->link = *bucket;
+    *bucket    = node;
+
+    tt_glyph_cache_push( cache, node );
+
+    cache->num_nodes++;
+    cache->weight += weight;
+  }
+
+#endif /* TT_USE_BYTECODE_INTERPRETER */
+
+
   /**************************************************************************
    *
    * @Function:
@@ -2718,6 +3214,11 @@
     FT_Error      error;
     TT_LoaderRec  loader;
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+    TT_GlyphNodeRec  query;
+    FT_Bool          use_cache;
+#endif
+
 #ifdef TT_CONFIG_OPTION_GX_VAR_SUPPORT
 #define IS_DEFAULT_INSTANCE  ( !( FT_IS_NAMED_INSTANCE( glyph->face ) ||  \
                                   FT_IS_VARIATION( glyph->face )      ) )
@@ -2728,6 +3229,17 @@
 
     FT_TRACE1(( "TT_Load_Glyph: glyph index %d\n", glyph_index ));
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+    {
+      TT_Verifier  verifier = (TT_Verifier)( (TT_Face)glyph->face )->verifier;
+
+
+      /* the verifier has rejected the bytecode of the face */
+      if ( verifier && verifier->rejected )
+        load_flags |= FT_LOAD_NO_HINTING;
+    }
+#endif
+
 #ifdef TT_CONFIG_OPTION_EMBEDDED_BITMAPS
 
     /* try to load embedded bitmap (if any) */
@@ -2849,8 +3361,29 @@
     glyph->num_subglyphs = 0;
     glyph->outline.flags = 0;
 
-    /* main loading loop */
-    error = load_truetype_glyph( &loader, glyph_index, 0, FALSE );
+#ifdef TT_USE_BYTECODE_INTERPRETER
+    use_cache = tt_glyph_cache_query( &loader,
+                                      glyph_index,
+                                      load_flags,
+                                      &query );
+    if ( use_cache && tt_glyph_cache_lookup( &loader, &query ) )
+      error = FT_Err_Ok;
+    else
+#endif
+    {
+      /* main loading loop */
+      error = load_truetype_glyph( &loader, glyph_index, 0, FALSE );
+
+#ifdef TT_USE_BYTECODE_INTERPRETER
+      if ( !error && use_cache )
+        tt_glyph_cache_insert( &loader, &query );
+#endif
+    }
+
+#ifdef TT_CONFIG_OPTION_BYTECODE_PROFILE
+    TT_Profile_Glyph( loader.face, glyph_index, size->metrics->y_ppem );
+#endif
+
     if ( !error )
     {
       if ( glyph->format == FT_GLYPH_FORMAT_COMPOSITE )
@@ -53,6 +53,11 @@ FT_BEGIN_HEADER
                  FT_UInt       glyph_index,
                  FT_Int32      load_flags );
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+  FT_LOCAL( void )
+  tt_face_done_glyph_cache( TT_Face  face );
+#endif
+
 
 FT_END_HEADER
 
@@ -50,6 +50,7 @@
 #include FT_LIST_H
 
 #include "ttpload.h"
+#include "ttgload.h"
 #include "ttgxvar.h"
 
 #include "tterrors.h"
@@ -2623,6 +2624,13 @@
 
     face->doblend = TRUE;
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+    /* results of `prep' and hinted glyphs computed for the old */
+    /* coordinates are no longer valid                          */
+    tt_face_clear_prep_cache( face );
+    tt_face_done_glyph_cache( face );
+#endif
+
     if ( face->cvt )
     {
       switch ( manageCvt )
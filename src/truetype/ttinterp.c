@@ -1661,6 +1661,732 @@
   }
 
 
+  /**************************************************************************
+   *
+   * STATIC VERIFIER
+   *
+   * `TT_Verify_Program' walks through a program once, in the order of
+   * its bytes, without running it.  It checks that the instructions fit
+   * into the program, that IF/ELSE/EIF and FDEF/ENDF are balanced, and
+   * that jumps with a constant offset land on an instruction.  On the way
+   * it follows the depth of the stack and the constants pushed onto it,
+   * which gives the function numbers of FDEF, CALL, and LOOPCALL and the
+   * number of LOOPCALL iterations in most fonts.
+   *
+   * The cost of a program estimates the number of instructions a run
+   * executes (as counted by `TT_RunIns' for the
+   * TT_CONFIG_OPTION_MAX_RUNNABLE_OPCODES limit): both branches of an IF
+   * count, a call adds the cost of the function, and loops whose count is
+   * not a constant -- LOOPCALL with a computed count and backward jumps --
+   * are assumed to run TT_VERIFY_LOOP_COUNT times.  A call of an unknown
+   * function costs as much as the most expensive function.
+   */
+
+#define TT_VERIFY_LOOP_COUNT  16
+#define TT_VERIFY_MAX_COST    0xFFFFFFFFUL
+
+  /* the nesting of calls `TT_RunIns' allows (see `callSize') */
+#define TT_VERIFY_MAX_CALLS   32
+
+  /* the number of stack elements whose values are followed */
+#define TT_VERIFY_VALUES      64
+
+#define TT_VERIFY_FUNC_NEW   0
+#define TT_VERIFY_FUNC_BUSY  1
+#define TT_VERIFY_FUNC_DONE  2
+
+
+  /* the state of an IF */
+  typedef struct  TT_VerifyLevelRec_
+  {
+    FT_Long  depth;        /* stack depth after IF      */
+    FT_Bool  known;
+    FT_Bool  has_else;
+    FT_Long  then_depth;   /* stack depth before ELSE   */
+    FT_Bool  then_known;
+
+  } TT_VerifyLevelRec, *TT_VerifyLevel;
+
+
+  typedef struct  TT_VerifyWalkRec_
+  {
+    TT_Verifier  verifier;
+    FT_Memory    memory;
+    FT_Int       call_depth;
+    FT_Bool      top_level;    /* a program, not a function   */
+    FT_Bool      allow_defs;   /* are FDEF and IDEF allowed?  */
+
+    FT_UInt      flags;
+    FT_ULong     cost;
+
+    FT_Bool      known;        /* are `depth' and `low' known? */
+    FT_Long      depth;        /* relative to the start        */
+    FT_Long      low;
+    FT_Long      loop;         /* set by SLOOP; 0 if unknown   */
+
+    /* the topmost stack elements */
+    FT_Int       num_values;
+    FT_Long      values[TT_VERIFY_VALUES];
+    FT_Bool      constant[TT_VERIFY_VALUES];
+
+  } TT_VerifyWalkRec, *TT_VerifyWalk;
+
+
+  static FT_ULong
+  Verify_Add( FT_ULong  a,
+              FT_ULong  b )
+  {
+    return a > TT_VERIFY_MAX_COST - b ? TT_VERIFY_MAX_COST : a + b;
+  }
+
+
+  static FT_ULong
+  Verify_Mul( FT_ULong  a,
+              FT_ULong  n )
+  {
+    return n && a > TT_VERIFY_MAX_COST / n ? TT_VERIFY_MAX_COST : a * n;
+  }
+
+
+  /* the length of the instruction at `ip', which must fit */
+  static FT_Long
+  Verify_Length( FT_Byte*  code,
+                 FT_Long   ip )
+  {
+    FT_Long  length = opcode_length[code[ip]];
+
+
+    if ( length < 0 )
+      length = 2 - length * code[ip + 1];
+
+    return length;
+  }
+
+
+  /* forget the stack depth and the values on the stack */
+  static void
+  Verify_Forget( TT_VerifyWalk  walk )
+  {
+    walk->known      = FALSE;
+    walk->num_values = 0;
+  }
+
+
+  /* get the value `n' elements below the top of the stack if known */
+  static FT_Bool
+  Verify_Value( TT_VerifyWalk  walk,
+                FT_Int         n,
+                FT_Long       *avalue )
+  {
+    FT_Int  i = walk->num_values - 1 - n;
+
+
+    if ( i < 0 || !walk->constant[i] )
+      return FALSE;
+
+    *avalue = walk->values[i];
+    return TRUE;
+  }
+
+
+  static void
+  Verify_Pop( TT_VerifyWalk  walk,
+              FT_Long        count )
+  {
+    if ( count >= walk->num_values )
+      walk->num_values = 0;
+    else
+      walk->num_values -= (FT_Int)count;
+
+    if ( !walk->known )
+      return;
+
+    walk->depth -= count;
+    if ( walk->depth < walk->low )
+    {
+      /* the interpreter pushes zeroes if a program runs out of values */
+      if ( walk->top_level )
+      {
+        walk->flags |= TT_VERIFY_STACK;
+        walk->depth  = 0;
+      }
+      else
+        walk->low = walk->depth;
+    }
+  }
+
+
+  static void
+  Verify_Push( TT_VerifyWalk  walk,
+               FT_Long        value,
+               FT_Bool        constant )
+  {
+    if ( walk->num_values == TT_VERIFY_VALUES )
+    {
+      /* forget the deepest value */
+      FT_ARRAY_MOVE( walk->values, walk->values + 1,
+                     TT_VERIFY_VALUES - 1 );
+      FT_ARRAY_MOVE( walk->constant, walk->constant + 1,
+                     TT_VERIFY_VALUES - 1 );
+      walk->num_values--;
+    }
+
+    walk->values[walk->num_values]   = value;
+    walk->constant[walk->num_values] = constant;
+    walk->num_values++;
+
+    walk->depth++;
+  }
+
+
+  static FT_Error
+  Verify_Range( TT_VerifyWalk  walk,
+                FT_Byte*       code,
+                FT_Long        size );
+
+
+  static FT_Error
+  Verify_Function( TT_VerifyWalk  caller,
+                   TT_VerifyFunc  func )
+  {
+    FT_Error          error;
+    TT_VerifyWalkRec  walk;
+
+
+    FT_ZERO( &walk );
+    walk.verifier   = caller->verifier;
+    walk.memory     = caller->memory;
+    walk.call_depth = caller->call_depth + 1;
+    walk.known      = TRUE;
+    walk.loop       = 1;
+
+    func->state = TT_VERIFY_FUNC_BUSY;
+
+    error = Verify_Range( &walk, func->code, func->size );
+
+    func->state        = TT_VERIFY_FUNC_DONE;
+    func->flags        = walk.flags;
+    func->cost         = Verify_Add( walk.cost, 1 );     /* ENDF */
+    func->effect_known = walk.known;
+    func->effect       = walk.depth;
+    func->low          = walk.low;
+
+    return error;
+  }
+
+
+  /* `number' is -1 for an unknown function, `count' 0 for an */
+  /* unknown number of calls                                   */
+  static FT_Error
+  Verify_Call( TT_VerifyWalk  walk,
+               FT_Long        number,
+               FT_ULong       count )
+  {
+    TT_Verifier    verifier = walk->verifier;
+    TT_VerifyFunc  func;
+    FT_ULong       cost;
+    FT_ULong       n;
+
+
+    if ( number < 0 || (FT_ULong)number >= verifier->num_funcs )
+    {
+      Verify_Forget( walk );
+      cost = verifier->max_func_cost;
+      goto Exit;
+    }
+
+    func = verifier->funcs + number;
+
+    if ( !func->code )
+    {
+      /* the run stops here */
+      walk->flags |= TT_VERIFY_CALL;
+      return FT_Err_Ok;
+    }
+
+    if ( func->state == TT_VERIFY_FUNC_NEW )
+    {
+      if ( walk->call_depth >= TT_VERIFY_MAX_CALLS )
+      {
+        walk->flags |= TT_VERIFY_CALL;
+        return FT_Err_Ok;
+      }
+      else
+      {
+        FT_Error  error = Verify_Function( walk, func );
+
+
+        if ( error )
+          return error;
+      }
+    }
+
+    if ( func->state == TT_VERIFY_FUNC_BUSY )
+    {
+      walk->flags |= TT_VERIFY_RECURSION;
+      Verify_Forget( walk );
+      cost = TT_VERIFY_MAX_COST;
+      goto Exit;
+    }
+
+    walk->flags |= func->flags & ~TT_VERIFY_STACK;
+    cost         = func->cost;
+
+    if ( !count || !func->effect_known )
+      Verify_Forget( walk );
+    else
+    {
+      /* the function replaces the elements above its lowest depth */
+      for ( n = 0; n < count && walk->known; n++ )
+      {
+        Verify_Pop( walk, -func->low );
+        walk->depth += func->effect - func->low;
+      }
+      walk->num_values = 0;
+    }
+
+  Exit:
+    walk->cost = Verify_Add( walk->cost,
+                             Verify_Mul( cost,
+                                         count ? count
+                                               : TT_VERIFY_LOOP_COUNT ) );
+    return FT_Err_Ok;
+  }
+
+
+  /* `marks' holds one plus the cost before each instruction */
+  static void
+  Verify_Jump( TT_VerifyWalk  walk,
+               FT_ULong*      marks,
+               FT_Long        size,
+               FT_Long        ip,
+               FT_Bool        constant,
+               FT_Long        offset )
+  {
+    FT_Long   target = ip + offset;
+    FT_ULong  body;
+
+
+    Verify_Forget( walk );
+
+    if ( !constant )
+      return;
+
+    if ( target < 0 || target > size || ( target < size && !marks[target] ) )
+    {
+      walk->flags |= TT_VERIFY_JUMP;
+      return;
+    }
+
+    if ( offset <= 0 )
+    {
+      /* a loop */
+      body = marks[target] - 1;
+      body = walk->cost > body ? walk->cost - body : 1;
+
+      walk->cost = Verify_Add( walk->cost,
+                               Verify_Mul( body,
+                                           TT_VERIFY_LOOP_COUNT - 1 ) );
+    }
+  }
+
+
+  static FT_Error
+  Verify_Range( TT_VerifyWalk  walk,
+                FT_Byte*       code,
+                FT_Long        size )
+  {
+    FT_Memory       memory = walk->memory;
+    FT_Error        error  = FT_Err_Ok;
+    FT_ULong*       marks  = NULL;
+    TT_VerifyLevel  levels = NULL;
+    FT_Long         num_levels, max_levels;
+    FT_Long         ip, end, length;
+
+
+    if ( size <= 0 )
+      return FT_Err_Ok;
+
+    if ( FT_NEW_ARRAY( marks, size ) )
+      goto Exit;
+
+    /* find the instructions */
+    max_levels = 0;
+    for ( ip = 0; ip < size; ip += length )
+    {
+      length = opcode_length[code[ip]];
+      if ( length < 0 )
+      {
+        if ( ip + 1 >= size )
+          break;
+        length = 2 - length * code[ip + 1];
+      }
+
+      if ( ip + length > size )
+        break;
+
+      marks[ip] = 1;
+      if ( code[ip] == 0x58 )
+        max_levels++;
+    }
+
+    end = ip;
+    if ( end < size )
+      walk->flags |= TT_VERIFY_TRUNCATED;
+
+    if ( FT_QNEW_ARRAY( levels, FT_MAX( max_levels, 1 ) ) )
+      goto Exit;
+
+    num_levels = 0;
+    ip         = 0;
+
+    while ( ip < end )
+    {
+      FT_Byte   opcode   = code[ip];
+      FT_Long   num_pop  = Pop_Push_Count[opcode] >> 4;
+      FT_Long   num_push = Pop_Push_Count[opcode] & 15;
+      FT_Long   value  = 0;
+      FT_Long   value2 = 0;
+      FT_Bool   constant, constant2;
+      FT_Long   n, count;
+
+
+      length = Verify_Length( code, ip );
+
+      walk->cost = Verify_Add( walk->cost, 1 );
+      marks[ip]  = walk->cost;
+
+      constant  = Verify_Value( walk, 0, &value );
+      constant2 = Verify_Value( walk, 1, &value2 );
+
+      switch ( opcode )
+      {
+      case 0x40:  /* NPUSHB */
+        count = code[ip + 1];
+        for ( n = 0; n < count; n++ )
+          Verify_Push( walk, code[ip + 2 + n], TRUE );
+        num_push = 0;
+        break;
+
+      case 0x41:  /* NPUSHW */
+        count = code[ip + 1];
+        for ( n = 0; n < count; n++ )
+          Verify_Push( walk,
+                       (FT_Short)( ( code[ip + 2 + 2 * n] << 8 ) +
+                                   code[ip + 3 + 2 * n]        ),
+                       TRUE );
+        num_push = 0;
+        break;
+
+      case 0x58:  /* IF */
+        Verify_Pop( walk, 1 );
+        levels[num_levels].depth    = walk->depth;
+        levels[num_levels].known    = walk->known;
+        levels[num_levels].has_else = FALSE;
+        num_levels++;
+        num_pop = 0;
+        break;
+
+      case 0x1B:  /* ELSE */
+        if ( !num_levels || levels[num_levels - 1].has_else )
+        {
+          walk->flags |= TT_VERIFY_STRUCTURE;
+          break;
+        }
+        else
+        {
+          TT_VerifyLevel  level = levels + num_levels - 1;
+
+
+          level->has_else   = TRUE;
+          level->then_depth = walk->depth;
+          level->then_known = walk->known;
+
+          walk->depth      = level->depth;
+          walk->known      = level->known;
+          walk->num_values = 0;
+        }
+        break;
+
+      case 0x59:  /* EIF */
+        if ( !num_levels )
+        {
+          walk->flags |= TT_VERIFY_STRUCTURE;
+          break;
+        }
+        else
+        {
+          TT_VerifyLevel  level = levels + --num_levels;
+          FT_Long         depth = level->has_else ? level->then_depth
+                                                  : level->depth;
+          FT_Bool         known = level->has_else ? level->then_known
+                                                  : level->known;
+
+
+          /* both ways through the IF must have the same stack effect */
+          if ( !known || depth != walk->depth )
+            walk->known = FALSE;
+          walk->num_values = 0;
+        }
+        break;
+
+      case 0x2C:  /* FDEF */
+      case 0x89:  /* IDEF */
+        Verify_Pop( walk, 1 );
+        num_pop = 0;
+
+        if ( !walk->allow_defs )
+          walk->flags |= TT_VERIFY_STRUCTURE;
+
+        /* find the end of the definition */
+        for ( n = ip + length; n < end; n += Verify_Length( code, n ) )
+          if ( code[n] == 0x2D || code[n] == 0x2C || code[n] == 0x89 )
+            break;
+
+        if ( n == end || code[n] != 0x2D )
+        {
+          walk->flags |= TT_VERIFY_STRUCTURE;
+          ip = n;
+          continue;
+        }
+
+        if ( opcode == 0x2C                               &&
+             walk->allow_defs                             &&
+             constant                                     &&
+             value >= 0                                   &&
+             (FT_ULong)value < walk->verifier->num_funcs )
+        {
+          TT_VerifyFunc  func = walk->verifier->funcs + value;
+
+
+          func->code  = code + ip + length;
+          func->size  = n - ip - length;
+          func->state = TT_VERIFY_FUNC_NEW;
+        }
+
+        /* the body is not executed here; don't jump into it */
+        FT_ARRAY_ZERO( marks + ip + length, n + 1 - ip - length );
+
+        ip = n + 1;
+        continue;
+
+      case 0x2D:  /* ENDF */
+        walk->flags |= TT_VERIFY_STRUCTURE;
+        break;
+
+      case 0x2B:  /* CALL */
+        Verify_Pop( walk, 1 );
+        num_pop = 0;
+
+        error = Verify_Call( walk, constant ? value : -1, 1 );
+        if ( error )
+          goto Exit;
+        break;
+
+      case 0x2A:  /* LOOPCALL */
+        Verify_Pop( walk, 2 );
+        num_pop = 0;
+
+        if ( constant2 && value2 <= 0 )
+          break;
+
+        error = Verify_Call( walk,
+                             constant ? value : -1,
+                             constant2 ? (FT_ULong)value2 : 0 );
+        if ( error )
+          goto Exit;
+        break;
+
+      case 0x1C:  /* JMPR */
+        Verify_Jump( walk, marks, size, ip, constant, value );
+        break;
+
+      case 0x78:  /* JROT */
+      case 0x79:  /* JROF */
+        Verify_Jump( walk, marks, size, ip, constant2, value2 );
+        break;
+
+      case 0x17:  /* SLOOP */
+        walk->loop = constant && value > 0 ? value : 0;
+        break;
+
+      case 0x22:  /* CLEAR */
+        walk->num_values = 0;
+        if ( walk->top_level )
+          walk->depth = 0;
+        else
+          walk->known = FALSE;
+        break;
+
+      case 0x26:  /* MINDEX */
+        walk->num_values = 0;
+        break;
+
+      case 0x5D:  /* DELTAP1 */
+      case 0x71:  /* DELTAP2 */
+      case 0x72:  /* DELTAP3 */
+      case 0x73:  /* DELTAC1 */
+      case 0x74:  /* DELTAC2 */
+      case 0x75:  /* DELTAC3 */
+        if ( constant && value >= 0 )
+          num_pop += 2 * value;
+        else
+          Verify_Forget( walk );
+        break;
+
+      case 0x32:  /* SHP */
+      case 0x33:
+      case 0x38:  /* SHPIX */
+      case 0x39:  /* IP */
+      case 0x3C:  /* ALIGNRP */
+      case 0x80:  /* FLIPPT */
+        if ( walk->loop )
+          num_pop += walk->loop;
+        else
+          Verify_Forget( walk );
+        walk->loop = 1;
+        break;
+
+      case 0x91:  /* GETVARIATION */
+        /* pushes a value for each axis */
+        Verify_Forget( walk );
+        break;
+
+      default:
+        if ( opcode >= 0xB8 && opcode <= 0xBF )       /* PUSHW */
+        {
+          count = opcode - 0xB8 + 1;
+          for ( n = 0; n < count; n++ )
+            Verify_Push( walk,
+                         (FT_Short)( ( code[ip + 1 + 2 * n] << 8 ) +
+                                     code[ip + 2 + 2 * n]        ),
+                         TRUE );
+          num_push = 0;
+        }
+        else if ( opcode >= 0xB0 && opcode <= 0xB7 )  /* PUSHB */
+        {
+          count = opcode - 0xB0 + 1;
+          for ( n = 0; n < count; n++ )
+            Verify_Push( walk, code[ip + 1 + n], TRUE );
+          num_push = 0;
+        }
+      }
+
+      /* the push instructions have set `num_push' to zero already */
+      Verify_Pop( walk, num_pop );
+      for ( n = 0; n < num_push; n++ )
+        Verify_Push( walk, 0, FALSE );
+
+      ip += length;
+    }
+
+    /* an unterminated IF */
+    if ( num_levels )
+      walk->flags |= TT_VERIFY_STRUCTURE;
+
+  Exit:
+    FT_FREE( levels );
+    FT_FREE( marks );
+
+    return error;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   TT_Verify_Program
+   *
+   * @Description:
+   *   Check a program without running it and estimate its cost (see the
+   *   description of the static verifier above).  Programs must be
+   *   verified in the order they are run: the font program first, then
+   *   the cvt program, then glyph programs.  After the font and cvt
+   *   programs, the functions they define are verified also.
+   *
+   * @Input:
+   *   verifier ::
+   *     The verifier of the face.
+   *
+   *   memory ::
+   *     A handle to the memory object for temporary data.
+   *
+   *   range ::
+   *     The type of the program (`tt_coderange_font', `tt_coderange_cvt',
+   *     or `tt_coderange_glyph').
+   *
+   *   code ::
+   *     The bytecode.
+   *
+   *   size ::
+   *     The size of the bytecode.
+   *
+   * @Output:
+   *   acost ::
+   *     The estimated number of instructions executed by a run.
+   *
+   *   aflags ::
+   *     The TT_VERIFY_XXX findings.
+   *
+   * @Return:
+   *   FreeType error code.  0 means success.
+   */
+  FT_LOCAL_DEF( FT_Error )
+  TT_Verify_Program( TT_Verifier  verifier,
+                     FT_Memory    memory,
+                     FT_Int       range,
+                     FT_Byte*     code,
+                     FT_Long      size,
+                     FT_ULong    *acost,
+                     FT_UInt     *aflags )
+  {
+    FT_Error          error;
+    TT_VerifyWalkRec  walk;
+    FT_UInt           n;
+
+
+    FT_ZERO( &walk );
+    walk.verifier   = verifier;
+    walk.memory     = memory;
+    walk.top_level  = TRUE;
+    walk.allow_defs = FT_BOOL( range != tt_coderange_glyph );
+    walk.known      = TRUE;
+    walk.loop       = 1;
+
+    error = Verify_Range( &walk, code, size );
+    if ( error )
+      goto Exit;
+
+    if ( walk.allow_defs )
+    {
+      for ( n = 0; n < verifier->num_funcs; n++ )
+      {
+        TT_VerifyFunc  func = verifier->funcs + n;
+
+
+        if ( !func->code )
+          continue;
+
+        if ( func->state == TT_VERIFY_FUNC_NEW )
+        {
+          error = Verify_Function( &walk, func );
+          if ( error )
+            goto Exit;
+        }
+
+        if ( func->cost > verifier->max_func_cost )
+          verifier->max_func_cost = func->cost;
+      }
+    }
+
+  Exit:
+    *acost  = walk.cost;
+    *aflags = walk.flags;
+
+    return error;
+  }
+
+
   /**************************************************************************
    *
    * @Function:
@@ -3540,6 +4266,47 @@
    */
 
 
+  /**************************************************************************
+   *
+   * The definitions made by the font program can be shared by all sizes
+   * of a face (see `tt_size_init_bytecode').  Before a size changes them,
+   * it gets its own copy.
+   */
+  static FT_Bool
+  Unshare_Defs( TT_ExecContext  exc )
+  {
+    TT_Size      size   = exc->size;
+    FT_Memory    memory = exc->memory;
+    FT_Error     error;
+    TT_DefArray  fdefs  = NULL;
+    TT_DefArray  idefs  = NULL;
+
+
+    if ( !size || !size->shared_defs )
+      return SUCCESS;
+
+    if ( FT_NEW_ARRAY( fdefs, size->max_function_defs )    ||
+         FT_NEW_ARRAY( idefs, size->max_instruction_defs ) )
+    {
+      FT_FREE( fdefs );
+      exc->error = error;
+      return FAILURE;
+    }
+
+    FT_ARRAY_COPY( fdefs, exc->FDefs, exc->numFDefs );
+    FT_ARRAY_COPY( idefs, exc->IDefs, exc->numIDefs );
+
+    size->function_defs    = fdefs;
+    size->instruction_defs = idefs;
+    size->shared_defs      = FALSE;
+
+    exc->FDefs = fdefs;
+    exc->IDefs = idefs;
+
+    return SUCCESS;
+  }
+
+
   /**************************************************************************
    *
    * FDEF[]:       Function DEFinition
@@ -3662,6 +4429,9 @@
       return;
     }
 
+    if ( Unshare_Defs( exc ) )
+      return;
+
     /* some font programs are broken enough to redefine functions! */
     /* We will then parse the current table.                       */
 
@@ -4095,6 +4865,9 @@
       return;
     }
 
+    if ( Unshare_Defs( exc ) )
+      return;
+
     /*  First of all, look for the same function in our table */
 
     def   = exc->IDefs;
@@ -7697,6 +8470,245 @@
   }
 
 
+#ifdef TT_CONFIG_OPTION_BYTECODE_PROFILE
+
+  /**************************************************************************
+   *
+   * PROFILER
+   *
+   * If `TT_CONFIG_OPTION_BYTECODE_PROFILE' is defined, `TT_RunIns' counts
+   * each instruction it executes in the face's `TT_ProfileRec', which gets
+   * allocated with the first run.  The time spent in an instruction is
+   * estimated with `TT_PROFILE_CLOCK', which may be defined on the
+   * compiler's command line to use a different counter.
+   */
+
+#ifndef TT_PROFILE_CLOCK
+#if defined( __GNUC__ ) && ( defined( __i386__ ) || defined( __x86_64__ ) )
+#define TT_PROFILE_CLOCK()  ( (FT_ULong)__builtin_ia32_rdtsc() )
+#else
+#define TT_PROFILE_CLOCK()  0UL
+#endif
+#endif
+
+
+  static TT_Profile
+  Profile_Start( TT_ExecContext  exc,
+                 FT_Int          program )
+  {
+    TT_Face     face    = exc->face;
+    TT_Profile  profile = (TT_Profile)face->bytecode_profile;
+
+
+    if ( program < 0 || program >= FT_BYTECODE_PROFILE_PROGRAMS )
+      return NULL;
+
+    if ( !profile )
+    {
+      FT_Memory  memory = face->root.memory;
+      FT_Error   error;
+
+
+      /* profiling is simply skipped if we run out of memory */
+      if ( FT_NEW( profile ) )
+        return NULL;
+
+      face->bytecode_profile = profile;
+    }
+
+    profile->program_runs[program]++;
+
+    return profile;
+  }
+
+
+  static void
+  Profile_Instruction( TT_ExecContext  exc,
+                       TT_Profile      profile,
+                       FT_Int          program,
+                       FT_Byte         opcode,
+                       FT_Int          call_top,
+                       FT_ULong        start )
+  {
+    FT_ULong  cycles = TT_PROFILE_CLOCK() - start;
+
+
+    profile->opcode_count[opcode]++;
+    profile->opcode_cycles[opcode] += cycles;
+
+    profile->program_instructions[program]++;
+    profile->program_cycles[program] += cycles;
+
+    if ( program == FT_BYTECODE_PROFILE_GLYPH )
+    {
+      profile->glyph_instructions++;
+      profile->glyph_cycles += cycles;
+    }
+
+    if ( exc->callTop > call_top )
+    {
+      profile->calls++;
+
+      if ( (FT_UInt)exc->callTop > profile->max_call_depth )
+        profile->max_call_depth = (FT_UInt)exc->callTop;
+    }
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   TT_Profile_Glyph
+   *
+   * @Description:
+   *   Charge the glyph programs run since the last call to a glyph.  The
+   *   glyph gets listed in the face's profile if it is one of the most
+   *   expensive ones.
+   *
+   * @Input:
+   *   face ::
+   *     A handle to the face.
+   *
+   *   glyph_index ::
+   *     The index of the glyph just loaded.
+   *
+   *   ppem ::
+   *     The vertical pixel size of the glyph.
+   */
+  FT_LOCAL_DEF( void )
+  TT_Profile_Glyph( TT_Face    face,
+                    FT_UInt    glyph_index,
+                    FT_UShort  ppem )
+  {
+    TT_Profile              profile = (TT_Profile)face->bytecode_profile;
+    FT_Prop_BytecodeGlyph*  glyphs;
+    FT_ULong                instructions;
+    FT_UInt                 n, i;
+
+
+    if ( !profile || !profile->glyph_instructions )
+      return;
+
+    glyphs       = profile->glyphs;
+    instructions = profile->glyph_instructions;
+    n            = profile->num_glyphs;
+
+    for ( i = 0; i < n; i++ )
+      if ( glyphs[i].glyph_index == glyph_index &&
+           glyphs[i].ppem        == ppem        )
+        break;
+
+    if ( i < n )
+    {
+      /* the glyph is already listed; keep the more expensive run */
+      if ( glyphs[i].instructions >= instructions )
+        goto Exit;
+
+      for ( n--; i < n; i++ )
+        glyphs[i] = glyphs[i + 1];
+    }
+    else if ( n == FT_BYTECODE_PROFILE_GLYPHS )
+    {
+      if ( glyphs[n - 1].instructions >= instructions )
+        goto Exit;
+
+      n--;
+    }
+
+    /* insert the glyph, keeping the list sorted */
+    for ( i = n; i > 0 && glyphs[i - 1].instructions < instructions; i-- )
+      glyphs[i] = glyphs[i - 1];
+
+    glyphs[i].glyph_index  = glyph_index;
+    glyphs[i].ppem         = ppem;
+    glyphs[i].instructions = instructions;
+    glyphs[i].cycles       = profile->glyph_cycles;
+
+    profile->num_glyphs = n + 1;
+
+  Exit:
+    profile->glyph_instructions = 0;
+    profile->glyph_cycles       = 0;
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   TT_Get_Profile
+   *
+   * @Description:
+   *   Copy the statistics collected for a face.
+   *
+   * @Input:
+   *   face ::
+   *     A handle to the face.
+   *
+   * @Output:
+   *   profile ::
+   *     The statistics; all zero if no bytecode has been run yet.  The
+   *     `face' field is left unchanged.
+   */
+  FT_LOCAL_DEF( void )
+  TT_Get_Profile( TT_Face                   face,
+                  FT_Prop_BytecodeProfile*  profile )
+  {
+    TT_Profile  stats = (TT_Profile)face->bytecode_profile;
+    FT_Face     root  = profile->face;
+
+
+    FT_ZERO( profile );
+    profile->face = root;
+
+    if ( !stats )
+      return;
+
+    FT_ARRAY_COPY( profile->opcode_count, stats->opcode_count, 256 );
+    FT_ARRAY_COPY( profile->opcode_cycles, stats->opcode_cycles, 256 );
+
+    FT_ARRAY_COPY( profile->program_runs,
+                   stats->program_runs,
+                   FT_BYTECODE_PROFILE_PROGRAMS );
+    FT_ARRAY_COPY( profile->program_instructions,
+                   stats->program_instructions,
+                   FT_BYTECODE_PROFILE_PROGRAMS );
+    FT_ARRAY_COPY( profile->program_cycles,
+                   stats->program_cycles,
+                   FT_BYTECODE_PROFILE_PROGRAMS );
+
+    profile->calls          = stats->calls;
+    profile->max_call_depth = stats->max_call_depth;
+
+    profile->num_glyphs = stats->num_glyphs;
+    FT_ARRAY_COPY( profile->glyphs, stats->glyphs, stats->num_glyphs );
+  }
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   TT_Reset_Profile
+   *
+   * @Description:
+   *   Clear the statistics collected for a face.
+   *
+   * @Input:
+   *   face ::
+   *     A handle to the face.
+   */
+  FT_LOCAL_DEF( void )
+  TT_Reset_Profile( TT_Face  face )
+  {
+    TT_Profile  profile = (TT_Profile)face->bytecode_profile;
+
+
+    if ( profile )
+      FT_ZERO( profile );
+  }
+
+#endif /* TT_CONFIG_OPTION_BYTECODE_PROFILE */
+
+
   /**************************************************************************
    *
    * RUN
@@ -7749,6 +8761,14 @@
     FT_UShort  opcode_size[1]    = { 1 };
 #endif /* TT_SUPPORT_SUBPIXEL_HINTING_INFINALITY */
 
+#ifdef TT_CONFIG_OPTION_BYTECODE_PROFILE
+    TT_Profile  profile;
+    FT_Int      program  = exc->curRange - tt_coderange_font;
+    FT_Byte     opcode   = 0;
+    FT_Int      call_top = 0;
+    FT_ULong    start    = 0;
+#endif
+
 
 #ifdef TT_SUPPORT_SUBPIXEL_HINTING_INFINALITY
     exc->iup_called = FALSE;
@@ -7852,6 +8872,10 @@
     Compute_Funcs( exc );
     Compute_Round( exc, (FT_Byte)exc->GS.round_state );
 
+#ifdef TT_CONFIG_OPTION_BYTECODE_PROFILE
+    profile = Profile_Start( exc, program );
+#endif
+
     do
     {
       exc->opcode = exc->code[exc->IP];
@@ -7877,6 +8901,16 @@
       }
 #endif /* FT_DEBUG_LEVEL_TRACE */
 
+#ifdef TT_CONFIG_OPTION_BYTECODE_PROFILE
+      if ( profile )
+      {
+        /* instructions like `IF' change `exc->opcode' while skipping */
+        opcode   = exc->opcode;
+        call_top = exc->callTop;
+        start    = TT_PROFILE_CLOCK();
+      }
+#endif
+
       if ( ( exc->length = opcode_length[exc->opcode] ) < 0 )
       {
         if ( exc->IP + 1 >= exc->codeSize )
@@ -8577,6 +9611,12 @@
         return FT_THROW( Execution_Too_Long );
 
     LSuiteLabel_:
+#ifdef TT_CONFIG_OPTION_BYTECODE_PROFILE
+      if ( profile )
+        Profile_Instruction( exc, profile, program,
+                             opcode, call_top, start );
+#endif
+
       if ( exc->IP >= exc->codeSize )
       {
         if ( exc->callTop > 0 )
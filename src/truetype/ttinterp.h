@@ -20,6 +20,7 @@
 #define TTINTERP_H_
 
 #include <ft2build.h>
+#include FT_DRIVER_H
 #include "ttobjs.h"
 
 
@@ -438,6 +439,147 @@ FT_BEGIN_HEADER
   extern const TT_GraphicsState  tt_default_graphics_state;
 
 
+#ifdef TT_CONFIG_OPTION_BYTECODE_PROFILE
+
+  /**************************************************************************
+   *
+   * The statistics collected by `TT_RunIns' for a face if
+   * `TT_CONFIG_OPTION_BYTECODE_PROFILE' is defined; the fields are
+   * described with `FT_Prop_BytecodeProfile'.  `glyph_instructions' and
+   * `glyph_cycles' sum up the glyph programs run since the last call to
+   * `TT_Profile_Glyph'.
+   */
+  typedef struct  TT_ProfileRec_
+  {
+    FT_ULong               opcode_count[256];
+    FT_ULong               opcode_cycles[256];
+
+    FT_ULong               program_runs[FT_BYTECODE_PROFILE_PROGRAMS];
+    FT_ULong               program_instructions[FT_BYTECODE_PROFILE_PROGRAMS];
+    FT_ULong               program_cycles[FT_BYTECODE_PROFILE_PROGRAMS];
+
+    FT_ULong               calls;
+    FT_UInt                max_call_depth;
+
+    FT_ULong               glyph_instructions;
+    FT_ULong               glyph_cycles;
+
+    FT_UInt                num_glyphs;
+    FT_Prop_BytecodeGlyph  glyphs[FT_BYTECODE_PROFILE_GLYPHS];
+
+  } TT_ProfileRec, *TT_Profile;
+
+
+  FT_LOCAL( void )
+  TT_Profile_Glyph( TT_Face    face,
+                    FT_UInt    glyph_index,
+                    FT_UShort  ppem );
+
+  FT_LOCAL( void )
+  TT_Get_Profile( TT_Face                   face,
+                  FT_Prop_BytecodeProfile*  profile );
+
+  FT_LOCAL( void )
+  TT_Reset_Profile( TT_Face  face );
+
+#endif /* TT_CONFIG_OPTION_BYTECODE_PROFILE */
+
+
+  /**************************************************************************
+   *
+   * Findings of `TT_Verify_Program'.
+   *
+   * TT_VERIFY_TRUNCATED ::
+   *   An instruction extends past the end of the program.
+   *
+   * TT_VERIFY_STRUCTURE ::
+   *   IF, ELSE, and EIF or FDEF, IDEF, and ENDF don't match, or a function
+   *   gets defined where this isn't allowed.
+   *
+   * TT_VERIFY_JUMP ::
+   *   A jump with a constant offset leaves the program or function, or
+   *   doesn't land on an instruction.
+   *
+   * TT_VERIFY_RECURSION ::
+   *   A function calls itself, directly or indirectly.
+   *
+   * TT_VERIFY_STACK ::
+   *   The program pops more values than it has pushed.
+   *
+   * TT_VERIFY_CALL ::
+   *   An undefined function gets called, or function calls are nested
+   *   too deeply.
+   *
+   * The findings in TT_VERIFY_FATAL make the program fail (or loop) at
+   * run time.
+   */
+#define TT_VERIFY_TRUNCATED  0x01U
+#define TT_VERIFY_STRUCTURE  0x02U
+#define TT_VERIFY_JUMP       0x04U
+#define TT_VERIFY_RECURSION  0x08U
+#define TT_VERIFY_STACK      0x10U
+#define TT_VERIFY_CALL       0x20U
+
+#define TT_VERIFY_FATAL  ( TT_VERIFY_TRUNCATED | \
+                           TT_VERIFY_STRUCTURE | \
+                           TT_VERIFY_JUMP      | \
+                           TT_VERIFY_RECURSION )
+
+
+  /* verdicts on the glyph programs of a face */
+#define TT_VERDICT_UNKNOWN   0
+#define TT_VERDICT_ACCEPTED  1
+#define TT_VERDICT_REJECTED  2
+
+
+  /**************************************************************************
+   *
+   * A function seen by the verifier.  `size' doesn't include the ENDF
+   * instruction.  `effect' is the difference of the stack depth at the
+   * end and the start of the function, `low' the lowest depth relative
+   * to the start; the function doesn't touch the stack elements below.
+   */
+  typedef struct  TT_VerifyFuncRec_
+  {
+    FT_Byte*  code;    /* NULL if not defined */
+    FT_Long   size;
+    FT_Byte   state;   /* 0: new, 1: being analyzed, 2: done */
+
+    FT_UInt   flags;
+    FT_ULong  cost;
+    FT_Bool   effect_known;
+    FT_Long   effect;
+    FT_Long   low;
+
+  } TT_VerifyFuncRec, *TT_VerifyFunc;
+
+
+  /**************************************************************************
+   *
+   * The results of the static verifier for a face, created by
+   * `tt_face_init' if the `hinting-cost-limit' property is set.
+   */
+  typedef struct  TT_VerifierRec_
+  {
+    FT_ULong       limit;          /* `hinting-cost-limit' at face load */
+    FT_Bool        rejected;       /* native hinting is switched off    */
+
+    FT_UInt        num_funcs;      /* indexed by function number */
+    TT_VerifyFunc  funcs;
+    FT_ULong       max_func_cost;  /* used for calls of unknown functions */
+
+    FT_ULong       font_cost;
+    FT_UInt        font_flags;
+    FT_ULong       cvt_cost;
+    FT_UInt        cvt_flags;
+
+    FT_Byte*       verdicts;       /* TT_VERDICT_XXX for each glyph */
+    FT_ULong       max_glyph_cost;
+    FT_UInt        num_rejected;
+
+  } TT_VerifierRec, *TT_Verifier;
+
+
 #ifdef TT_USE_BYTECODE_INTERPRETER
   FT_LOCAL( void )
   TT_Goto_CodeRange( TT_ExecContext  exec,
@@ -454,6 +596,15 @@ FT_BEGIN_HEADER
   TT_Clear_CodeRange( TT_ExecContext  exec,
                       FT_Int          range );
 
+  FT_LOCAL( FT_Error )
+  TT_Verify_Program( TT_Verifier  verifier,
+                     FT_Memory    memory,
+                     FT_Int       range,
+                     FT_Byte*     code,
+                     FT_Long      size,
+                     FT_ULong    *acost,
+                     FT_UInt     *aflags );
+
 
   FT_LOCAL( FT_Error )
   Update_Max( FT_Memory  memory,
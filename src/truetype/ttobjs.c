@@ -141,6 +141,64 @@
 
     return error;
   }
+
+
+  /**************************************************************************
+   *
+   *                    PROGRAM CACHE FUNCTIONS
+   *
+   */
+
+
+  /**************************************************************************
+   *
+   * @Function:
+   *   tt_face_clear_prep_cache
+   *
+   * @Description:
+   *   Discard the cached results of the CVT program, for example, because
+   *   the face's CVT has changed.
+   *
+   * @Input:
+   *   face ::
+   *     A handle to the target face object.
+   */
+  FT_LOCAL_DEF( void )
+  tt_face_clear_prep_cache( TT_Face  face )
+  {
+    FT_Memory        memory = face->root.memory;
+    TT_ProgramCache  cache  = (TT_ProgramCache)face->program_cache;
+
+
+    if ( !cache )
+      return;
+
+    while ( cache->num_preps > 0 )
+    {
+      cache->num_preps--;
+      FT_FREE( cache->preps[cache->num_preps] );
+    }
+  }
+
+
+  static void
+  tt_face_done_program_cache( TT_Face  face )
+  {
+    FT_Memory        memory = face->root.memory;
+    TT_ProgramCache  cache  = (TT_ProgramCache)face->program_cache;
+
+
+    if ( !cache )
+      return;
+
+    tt_face_clear_prep_cache( face );
+
+    FT_FREE( cache->function_defs );
+    FT_FREE( cache->instruction_defs );
+
+    FT_FREE( face->program_cache );
+  }
+
 #endif /* TT_USE_BYTECODE_INTERPRETER */
 
 
@@ -523,6 +581,101 @@
   }
 
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+
+  static void
+  tt_face_done_verifier( TT_Face  face )
+  {
+    FT_Memory    memory   = face->root.memory;
+    TT_Verifier  verifier = (TT_Verifier)face->verifier;
+
+
+    if ( !verifier )
+      return;
+
+    FT_FREE( verifier->funcs );
+    FT_FREE( verifier->verdicts );
+
+    FT_FREE( face->verifier );
+  }
+
+
+  /* If the `hinting-cost-limit' property is set, check the font and cvt */
+  /* programs without running them (see `TT_Verify_Program').  Faces     */
+  /* whose programs are broken or too expensive lose the                 */
+  /* FT_FACE_FLAG_HINTER flag, so that `FT_Load_Glyph' uses the          */
+  /* auto-hinter instead.  Tricky fonts need their bytecode; they are    */
+  /* never checked.                                                      */
+  static FT_Error
+  tt_face_verify_bytecode( TT_Face  face )
+  {
+    TT_Driver    driver   = (TT_Driver)FT_FACE_DRIVER( face );
+    FT_Memory    memory   = face->root.memory;
+    FT_Error     error;
+    TT_Verifier  verifier = NULL;
+
+
+    if ( !driver->hinting_cost_limit || FT_IS_TRICKY( &face->root ) )
+      return FT_Err_Ok;
+
+    if ( FT_NEW( verifier ) )
+      return error;
+
+    face->verifier = verifier;
+
+    if ( FT_NEW_ARRAY( verifier->funcs,
+                       face->max_profile.maxFunctionDefs )    ||
+         FT_NEW_ARRAY( verifier->verdicts, face->root.num_glyphs ) )
+      goto Fail;
+
+    verifier->limit     = driver->hinting_cost_limit;
+    verifier->num_funcs = face->max_profile.maxFunctionDefs;
+
+    error = TT_Verify_Program( verifier, memory,
+                               tt_coderange_font,
+                               face->font_program,
+                               (FT_Long)face->font_program_size,
+                               &verifier->font_cost,
+                               &verifier->font_flags );
+    if ( error )
+      goto Fail;
+
+    error = TT_Verify_Program( verifier, memory,
+                               tt_coderange_cvt,
+                               face->cvt_program,
+                               (FT_Long)face->cvt_program_size,
+                               &verifier->cvt_cost,
+                               &verifier->cvt_flags );
+    if ( error )
+      goto Fail;
+
+    FT_TRACE3(( "tt_face_verify_bytecode:"
+                " fpgm cost %lu (flags 0x%x), prep cost %lu (flags 0x%x)\n",
+                verifier->font_cost, verifier->font_flags,
+                verifier->cvt_cost, verifier->cvt_flags ));
+
+    if ( ( verifier->font_flags | verifier->cvt_flags ) & TT_VERIFY_FATAL ||
+         verifier->font_cost > verifier->limit                          ||
+         verifier->cvt_cost > verifier->limit                           )
+    {
+      FT_TRACE2(( "tt_face_verify_bytecode:"
+                  " switching off native hinting\n" ));
+
+      verifier->rejected      = TRUE;
+      face->root.face_flags &= ~FT_FACE_FLAG_HINTER;
+    }
+
+    return FT_Err_Ok;
+
+  Fail:
+    tt_face_done_verifier( face );
+
+    return error;
+  }
+
+#endif /* TT_USE_BYTECODE_INTERPRETER */
+
+
   /* Check whether `.notdef' is the only glyph in the `loca' table. */
   static FT_Bool
   tt_check_single_notdef( FT_Face  ttface )
@@ -722,6 +875,15 @@
       }
     }
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+    if ( FT_IS_SCALABLE( ttface ) )
+    {
+      error = tt_face_verify_bytecode( face );
+      if ( error )
+        goto Exit;
+    }
+#endif
+
 #ifdef TT_CONFIG_OPTION_GX_VAR_SUPPORT
 
     {
@@ -803,6 +965,16 @@
     face->font_program_size = 0;
     face->cvt_program_size  = 0;
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+    tt_face_done_program_cache( face );
+    tt_face_done_glyph_cache( face );
+    tt_face_done_verifier( face );
+#endif
+
+#ifdef TT_CONFIG_OPTION_BYTECODE_PROFILE
+    FT_FREE( face->bytecode_profile );
+#endif
+
 #ifdef TT_CONFIG_OPTION_GX_VAR_SUPPORT
     tt_done_blend( face );
     face->blend = NULL;
@@ -1005,6 +1177,271 @@
   }
 
 
+  /* collect the parameters the result of `prep' depends on */
+  FT_LOCAL_DEF( void )
+  tt_size_prep_key( TT_Size     size,
+                    FT_Bool     pedantic,
+                    TT_PrepKey  key )
+  {
+    TT_Driver         driver  = (TT_Driver)size->root.face->driver;
+    TT_ExecContext    exec    = size->context;
+    FT_Size_Metrics*  metrics = size->metrics;
+
+
+    FT_ZERO( key );
+
+    key->pedantic            = pedantic;
+    key->interpreter_version = driver->interpreter_version;
+
+    key->point_size = size->point_size;
+    key->x_ppem     = metrics->x_ppem;
+    key->y_ppem     = metrics->y_ppem;
+    key->x_scale    = metrics->x_scale;
+    key->y_scale    = metrics->y_scale;
+    key->scale      = size->ttmetrics.scale;
+    key->ppem       = size->ttmetrics.ppem;
+    key->x_ratio    = size->ttmetrics.x_ratio;
+    key->y_ratio    = size->ttmetrics.y_ratio;
+    key->rotated    = size->ttmetrics.rotated;
+    key->stretched  = size->ttmetrics.stretched;
+
+    key->grayscale = exec->grayscale;
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+    key->subpixel_hinting_lean = exec->subpixel_hinting_lean;
+    key->grayscale_cleartype   = exec->grayscale_cleartype;
+    key->vertical_lcd_lean     = exec->vertical_lcd_lean;
+#endif
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_INFINALITY
+    key->subpixel_hinting      = exec->subpixel_hinting;
+    key->ignore_x_mode         = exec->ignore_x_mode;
+    key->compatible_widths     = exec->compatible_widths;
+    key->symmetrical_smoothing = exec->symmetrical_smoothing;
+    key->bgr                   = exec->bgr;
+    key->vertical_lcd          = exec->vertical_lcd;
+    key->subpixel_positioned   = exec->subpixel_positioned;
+    key->gray_cleartype        = exec->gray_cleartype;
+    key->rasterizer_version    = exec->rasterizer_version;
+    key->sph_tweak_flags       = exec->sph_tweak_flags;
+#endif
+  }
+
+
+  /* Set up `size' from a cached result of `prep' matching `key'. */
+  /* The size must hold the definitions made by `fpgm'; return    */
+  /* FALSE if there is no such result.                            */
+  static FT_Bool
+  tt_size_restore_prep( TT_Size     size,
+                        TT_PrepKey  key )
+  {
+    TT_Face          face   = (TT_Face)size->root.face;
+    FT_Memory        memory = face->root.memory;
+    TT_ProgramCache  cache  = (TT_ProgramCache)face->program_cache;
+    TT_ExecContext   exec   = size->context;
+    TT_PrepEntry     entry;
+    FT_Error         error;
+    FT_UInt          n, n_twilight;
+
+
+    for ( n = 0; n < cache->num_preps; n++ )
+      if ( !ft_memcmp( &cache->preps[n]->key, key, sizeof ( *key ) ) )
+        break;
+
+    if ( n == cache->num_preps )
+      return FALSE;
+
+    entry = cache->preps[n];
+
+    if ( entry->changed_defs )
+    {
+      TT_DefArray  fdefs = NULL;
+      TT_DefArray  idefs = NULL;
+
+
+      if ( FT_NEW_ARRAY( fdefs, size->max_function_defs )    ||
+           FT_NEW_ARRAY( idefs, size->max_instruction_defs ) )
+      {
+        FT_FREE( fdefs );
+        return FALSE;
+      }
+
+      if ( entry->num_function_defs )
+        FT_ARRAY_COPY( fdefs, entry->function_defs,
+                       entry->num_function_defs );
+      if ( entry->num_instruction_defs )
+        FT_ARRAY_COPY( idefs, entry->instruction_defs,
+                       entry->num_instruction_defs );
+
+      size->function_defs        = fdefs;
+      size->instruction_defs     = idefs;
+      size->num_function_defs    = entry->num_function_defs;
+      size->num_instruction_defs = entry->num_instruction_defs;
+      size->max_func             = entry->max_func;
+      size->max_ins              = entry->max_ins;
+      size->shared_defs          = FALSE;
+    }
+
+    n_twilight = (FT_UInt)size->twilight.n_points;
+
+    /* the arrays are NULL if empty */
+    if ( size->cvt_size )
+      FT_ARRAY_COPY( size->cvt, entry->cvt, size->cvt_size );
+    if ( size->storage_size )
+      FT_ARRAY_COPY( size->storage, entry->storage, size->storage_size );
+    if ( n_twilight )
+    {
+      FT_ARRAY_COPY( size->twilight.org, entry->twilight, n_twilight );
+      FT_ARRAY_COPY( size->twilight.cur,
+                     entry->twilight + n_twilight,
+                     n_twilight );
+    }
+
+    size->GS        = entry->GS;
+    size->cvt_ready = entry->error;
+
+    /* set up the code ranges as `tt_size_run_prep' does */
+    error = TT_Load_Context( exec, face, size );
+    if ( error )
+    {
+      size->cvt_ready = -1;
+      return FALSE;
+    }
+
+    exec->period    = entry->period;
+    exec->phase     = entry->phase;
+    exec->threshold = entry->threshold;
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+    /* glyphs without instructions use the value `prep' left */
+    exec->backward_compatibility = entry->backward_compatibility;
+#endif
+
+    TT_Set_CodeRange( exec,
+                      tt_coderange_cvt,
+                      face->cvt_program,
+                      (FT_Long)face->cvt_program_size );
+    TT_Clear_CodeRange( exec, tt_coderange_glyph );
+
+    TT_Save_Context( exec, size );
+
+    /* move entry to the front */
+    if ( n > 0 )
+    {
+      FT_MEM_MOVE( cache->preps + 1,
+                   cache->preps,
+                   n * sizeof ( TT_PrepEntry ) );
+      cache->preps[0] = entry;
+    }
+
+    FT_TRACE4(( "Using cached result of `prep' table.\n" ));
+
+    return TRUE;
+  }
+
+
+  /* Add the result of `prep' held by `size' to the cache. */
+  static void
+  tt_size_store_prep( TT_Size     size,
+                      TT_PrepKey  key )
+  {
+    TT_Face          face   = (TT_Face)size->root.face;
+    FT_Memory        memory = face->root.memory;
+    TT_ProgramCache  cache  = (TT_ProgramCache)face->program_cache;
+    TT_ExecContext   exec   = size->context;
+    TT_PrepEntry     entry;
+    FT_Error         error;
+    FT_UInt          num_fdefs  = 0;
+    FT_UInt          num_idefs  = 0;
+    FT_UInt          n_twilight = (FT_UInt)size->twilight.n_points;
+    FT_Byte*         p;
+
+
+    if ( TT_CONFIG_OPTION_PREP_CACHE_SIZE == 0 )
+      return;
+
+    if ( !size->shared_defs )
+    {
+      num_fdefs = size->num_function_defs;
+      num_idefs = size->num_instruction_defs;
+    }
+
+    /* the cache is optional; simply give up if we are out of memory */
+    if ( FT_ALLOC( entry,
+                   sizeof ( TT_PrepEntryRec )                           +
+                   ( num_fdefs + num_idefs ) * sizeof ( TT_DefRecord )  +
+                   2 * n_twilight * sizeof ( FT_Vector )                +
+                   ( size->cvt_size + size->storage_size ) *
+                     sizeof ( FT_Long )                                 ) )
+      return;
+
+    /* all these types have the same alignment requirements */
+    p = (FT_Byte*)( entry + 1 );
+
+    entry->function_defs    = (TT_DefArray)p;
+    p                      += num_fdefs * sizeof ( TT_DefRecord );
+    entry->instruction_defs = (TT_DefArray)p;
+    p                      += num_idefs * sizeof ( TT_DefRecord );
+    entry->twilight         = (FT_Vector*)p;
+    p                      += 2 * n_twilight * sizeof ( FT_Vector );
+    entry->cvt              = (FT_Long*)p;
+    p                      += size->cvt_size * sizeof ( FT_Long );
+    entry->storage          = (FT_Long*)p;
+
+    entry->key       = *key;
+    entry->error     = size->cvt_ready;
+    entry->GS        = size->GS;
+    entry->period    = exec->period;
+    entry->phase     = exec->phase;
+    entry->threshold = exec->threshold;
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+    entry->backward_compatibility = exec->backward_compatibility;
+#endif
+
+    /* the arrays are NULL if empty */
+    if ( size->cvt_size )
+      FT_ARRAY_COPY( entry->cvt, size->cvt, size->cvt_size );
+    if ( size->storage_size )
+      FT_ARRAY_COPY( entry->storage, size->storage, size->storage_size );
+    if ( n_twilight )
+    {
+      FT_ARRAY_COPY( entry->twilight, size->twilight.org, n_twilight );
+      FT_ARRAY_COPY( entry->twilight + n_twilight,
+                     size->twilight.cur,
+                     n_twilight );
+    }
+
+    if ( !size->shared_defs )
+    {
+      entry->changed_defs         = TRUE;
+      entry->num_function_defs    = num_fdefs;
+      entry->num_instruction_defs = num_idefs;
+      entry->max_func             = size->max_func;
+      entry->max_ins              = size->max_ins;
+
+      if ( num_fdefs )
+        FT_ARRAY_COPY( entry->function_defs,
+                       size->function_defs,
+                       num_fdefs );
+      if ( num_idefs )
+        FT_ARRAY_COPY( entry->instruction_defs,
+                       size->instruction_defs,
+                       num_idefs );
+    }
+
+    /* insert as the most recently used entry, evicting the least */
+    /* recently used one if the cache is full                     */
+    if ( cache->num_preps == TT_CONFIG_OPTION_PREP_CACHE_SIZE )
+    {
+      cache->num_preps--;
+      FT_FREE( cache->preps[cache->num_preps] );
+    }
+
+    FT_MEM_MOVE( cache->preps + 1,
+                 cache->preps,
+                 cache->num_preps * sizeof ( TT_PrepEntry ) );
+    cache->preps[0] = entry;
+    cache->num_preps++;
+  }
+
+
   static void
   tt_size_done_bytecode( FT_Size  ftsize )
   {
@@ -1028,8 +1465,19 @@
     /* twilight zone */
     tt_glyphzone_done( &size->twilight );
 
-    FT_FREE( size->function_defs );
-    FT_FREE( size->instruction_defs );
+    if ( size->shared_defs )
+    {
+      size->function_defs    = NULL;
+      size->instruction_defs = NULL;
+    }
+    else
+    {
+      FT_FREE( size->function_defs );
+      FT_FREE( size->instruction_defs );
+    }
+
+    size->shared_fpgm = FALSE;
+    size->shared_defs = FALSE;
 
     size->num_function_defs    = 0;
     size->max_function_defs    = 0;
@@ -1053,15 +1501,25 @@
     FT_Error   error;
     TT_Size    size = (TT_Size)ftsize;
     TT_Face    face = (TT_Face)ftsize->face;
+    TT_Driver  driver = (TT_Driver)ftsize->face->driver;
     FT_Memory  memory = face->root.memory;
 
-    FT_UShort       n_twilight;
-    TT_MaxProfile*  maxp = &face->max_profile;
+    FT_UShort        n_twilight;
+    TT_MaxProfile*   maxp = &face->max_profile;
+    TT_ProgramCache  cache;
 
 
     /* clean up bytecode related data */
-    FT_FREE( size->function_defs );
-    FT_FREE( size->instruction_defs );
+    if ( !size->shared_defs )
+    {
+      FT_FREE( size->function_defs );
+      FT_FREE( size->instruction_defs );
+    }
+    size->function_defs    = NULL;
+    size->instruction_defs = NULL;
+    size->shared_fpgm      = FALSE;
+    size->shared_defs      = FALSE;
+
     FT_FREE( size->cvt );
     FT_FREE( size->storage );
 
@@ -1101,11 +1559,44 @@
       tt_metrics->compensations[3] = 0;   /* reserved */
     }
 
+    /* set `face->interpreter' according to the debug hook present */
+    {
+      FT_Library  library = face->root.driver->root.library;
+
+
+      face->interpreter = (TT_Interpreter)
+                            library->debug_hooks[FT_DEBUG_HOOK_TRUETYPE];
+      if ( !face->interpreter )
+        face->interpreter = (TT_Interpreter)TT_RunIns;
+    }
+
+    /* The results of `fpgm' are shared by all sizes that run it in the */
+    /* same mode, unless a debugger wants to see the program executed.  */
+    cache = (TT_ProgramCache)face->program_cache;
+    if ( cache                                                      &&
+         cache->pedantic            == pedantic                     &&
+         cache->interpreter_version == driver->interpreter_version  &&
+         face->interpreter          == (TT_Interpreter)TT_RunIns    )
+    {
+      size->function_defs        = cache->function_defs;
+      size->instruction_defs     = cache->instruction_defs;
+      size->num_function_defs    = cache->num_function_defs;
+      size->num_instruction_defs = cache->num_instruction_defs;
+      size->max_func             = cache->max_func;
+      size->max_ins              = cache->max_ins;
+
+      size->shared_fpgm = TRUE;
+      size->shared_defs = TRUE;
+    }
+
     /* allocate function defs, instruction defs, cvt, and storage area */
-    if ( FT_NEW_ARRAY( size->function_defs,    size->max_function_defs    ) ||
-         FT_NEW_ARRAY( size->instruction_defs, size->max_instruction_defs ) ||
-         FT_NEW_ARRAY( size->cvt,              size->cvt_size             ) ||
-         FT_NEW_ARRAY( size->storage,          size->storage_size         ) )
+    if ( ( !size->shared_defs                                          &&
+           ( FT_NEW_ARRAY( size->function_defs,
+                           size->max_function_defs    )              ||
+             FT_NEW_ARRAY( size->instruction_defs,
+                           size->max_instruction_defs )              ) ) ||
+         FT_NEW_ARRAY( size->cvt,     size->cvt_size     )               ||
+         FT_NEW_ARRAY( size->storage, size->storage_size )               )
       goto Exit;
 
     /* reserve twilight zone */
@@ -1122,15 +1613,20 @@
 
     size->GS = tt_default_graphics_state;
 
-    /* set `face->interpreter' according to the debug hook present */
+    if ( size->shared_fpgm )
     {
-      FT_Library  library = face->root.driver->root.library;
+      TT_CodeRange*  range = &size->codeRangeTable[tt_coderange_font - 1];
 
 
-      face->interpreter = (TT_Interpreter)
-                            library->debug_hooks[FT_DEBUG_HOOK_TRUETYPE];
-      if ( !face->interpreter )
-        face->interpreter = (TT_Interpreter)TT_RunIns;
+      /* set up the code ranges as `tt_size_run_fpgm' does */
+      range->base = face->font_program;
+      range->size = (FT_Long)face->font_program_size;
+
+      FT_ZERO( &size->codeRangeTable[tt_coderange_cvt - 1] );
+      FT_ZERO( &size->codeRangeTable[tt_coderange_glyph - 1] );
+
+      size->bytecode_ready = cache->fpgm_error;
+      return cache->fpgm_error;
     }
 
     /* Fine, now run the font program! */
@@ -1142,6 +1638,38 @@
     /* and might even lead to extremely slow behaviour if it is malformed */
     /* (containing an infinite loop, for example).                        */
     error = tt_size_run_fpgm( size, pedantic );
+
+    /* hand the results over to the face if this is the first time */
+    if ( size->bytecode_ready >= 0                      &&
+         !face->program_cache                           &&
+         face->interpreter == (TT_Interpreter)TT_RunIns )
+    {
+      FT_Error  fpgm_error = error;
+
+
+      /* the cache is optional; ignore allocation errors */
+      if ( FT_NEW( cache ) )
+        return fpgm_error;
+
+      cache->pedantic            = pedantic;
+      cache->interpreter_version = driver->interpreter_version;
+      cache->fpgm_error          = size->bytecode_ready;
+
+      cache->function_defs        = size->function_defs;
+      cache->instruction_defs     = size->instruction_defs;
+      cache->num_function_defs    = size->num_function_defs;
+      cache->num_instruction_defs = size->num_instruction_defs;
+      cache->max_func             = size->max_func;
+      cache->max_ins              = size->max_ins;
+
+      face->program_cache = cache;
+
+      size->shared_fpgm = TRUE;
+      size->shared_defs = TRUE;
+
+      error = fpgm_error;
+    }
+
     return error;
 
   Exit:
@@ -1200,7 +1728,48 @@
 
       size->GS = tt_default_graphics_state;
 
-      error = tt_size_run_prep( size, pedantic );
+      if ( size->shared_fpgm )
+      {
+        TT_ProgramCache  cache = (TT_ProgramCache)face->program_cache;
+        TT_ExecContext   exec  = size->context;
+        FT_Memory        memory = face->root.memory;
+        TT_PrepKeyRec    key;
+
+
+        /* `prep' always starts with the definitions made by `fpgm' */
+        /* and the default super-rounding state so that its result  */
+        /* only depends on the key                                  */
+        if ( !size->shared_defs )
+        {
+          FT_FREE( size->function_defs );
+          FT_FREE( size->instruction_defs );
+
+          size->function_defs        = cache->function_defs;
+          size->instruction_defs     = cache->instruction_defs;
+          size->num_function_defs    = cache->num_function_defs;
+          size->num_instruction_defs = cache->num_instruction_defs;
+          size->max_func             = cache->max_func;
+          size->max_ins              = cache->max_ins;
+          size->shared_defs          = TRUE;
+        }
+
+        exec->period    = 64;
+        exec->phase     = 0;
+        exec->threshold = 0;
+
+        tt_size_prep_key( size, pedantic, &key );
+
+        if ( tt_size_restore_prep( size, &key ) )
+          error = size->cvt_ready;
+        else
+        {
+          error = tt_size_run_prep( size, pedantic );
+          if ( size->cvt_ready >= 0 )
+            tt_size_store_prep( size, &key );
+        }
+      }
+      else
+        error = tt_size_run_prep( size, pedantic );
     }
     else
       error = size->cvt_ready;
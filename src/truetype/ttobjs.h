@@ -319,11 +319,132 @@ FT_BEGIN_HEADER
     FT_Error           bytecode_ready;
     FT_Error           cvt_ready;
 
+    /* set if `fpgm' was run for the face's program cache instead of */
+    /* for this size; `shared_defs' is set while `function_defs' and */
+    /* `instruction_defs' are the cache's arrays, i.e., until they   */
+    /* get changed                                                   */
+    FT_Bool            shared_fpgm;
+    FT_Bool            shared_defs;
+
 #endif /* TT_USE_BYTECODE_INTERPRETER */
 
   } TT_SizeRec;
 
 
+#ifdef TT_USE_BYTECODE_INTERPRETER
+
+  /**************************************************************************
+   *
+   * Everything the result of the CVT program depends on, apart from the
+   * face.  The program always starts with the scaled CVT, zeroed storage
+   * area and twilight zone, the default graphics state, and the
+   * definitions made by the font program.  The key is compared with
+   * `ft_memcmp', so it must be cleared before it gets filled.
+   */
+  typedef struct  TT_PrepKeyRec_
+  {
+    FT_Bool    pedantic;
+    FT_UInt    interpreter_version;
+
+    FT_Long    point_size;
+    FT_UShort  x_ppem;
+    FT_UShort  y_ppem;
+    FT_Fixed   x_scale;
+    FT_Fixed   y_scale;
+    FT_Fixed   scale;
+    FT_UShort  ppem;
+    FT_Long    x_ratio;
+    FT_Long    y_ratio;
+    FT_Bool    rotated;
+    FT_Bool    stretched;
+
+    /* the rendering mode flags of the execution context */
+    FT_Bool    grayscale;
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+    FT_Bool    subpixel_hinting_lean;
+    FT_Bool    grayscale_cleartype;
+    FT_Bool    vertical_lcd_lean;
+#endif
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_INFINALITY
+    FT_Bool    subpixel_hinting;
+    FT_Bool    ignore_x_mode;
+    FT_Bool    compatible_widths;
+    FT_Bool    symmetrical_smoothing;
+    FT_Bool    bgr;
+    FT_Bool    vertical_lcd;
+    FT_Bool    subpixel_positioned;
+    FT_Bool    gray_cleartype;
+    FT_Int     rasterizer_version;
+    FT_ULong   sph_tweak_flags;
+#endif
+
+  } TT_PrepKeyRec, *TT_PrepKey;
+
+
+  /**************************************************************************
+   *
+   * A cached result of the CVT program.  The arrays follow the record in
+   * the same memory block.  The definitions are only stored if `prep'
+   * changed the ones made by `fpgm'.
+   */
+  typedef struct  TT_PrepEntryRec_
+  {
+    TT_PrepKeyRec     key;
+    FT_Error          error;
+
+    TT_GraphicsState  GS;
+    FT_F26Dot6        period;     /* super-rounding state of the */
+    FT_F26Dot6        phase;      /* execution context           */
+    FT_F26Dot6        threshold;
+#ifdef TT_SUPPORT_SUBPIXEL_HINTING_MINIMAL
+    FT_Bool           backward_compatibility;
+#endif
+
+    FT_Long*          cvt;
+    FT_Long*          storage;
+    FT_Vector*        twilight;   /* `org', then `cur' */
+
+    FT_Bool           changed_defs;
+    FT_UInt           num_function_defs;
+    TT_DefArray       function_defs;
+    FT_UInt           num_instruction_defs;
+    TT_DefArray       instruction_defs;
+    FT_UInt           max_func;
+    FT_UInt           max_ins;
+
+  } TT_PrepEntryRec, *TT_PrepEntry;
+
+
+  /**************************************************************************
+   *
+   * Bytecode results that a face shares among its sizes: the definitions
+   * made by the font program, which is run once per face, and the most
+   * recent results of the CVT program.  It is created by the first size
+   * that runs `fpgm'.
+   */
+  typedef struct  TT_ProgramCacheRec_
+  {
+    FT_Bool       pedantic;            /* the mode `fpgm' was run in */
+    FT_UInt       interpreter_version;
+    FT_Error      fpgm_error;
+
+    FT_UInt       num_function_defs;
+    TT_DefArray   function_defs;
+    FT_UInt       num_instruction_defs;
+    TT_DefArray   instruction_defs;
+
+    FT_UInt       max_func;
+    FT_UInt       max_ins;
+
+    FT_UInt       num_preps;
+    TT_PrepEntry  preps[TT_CONFIG_OPTION_PREP_CACHE_SIZE + 1];
+                                       /* most recently used first   */
+
+  } TT_ProgramCacheRec, *TT_ProgramCache;
+
+#endif /* TT_USE_BYTECODE_INTERPRETER */
+
+
   /**************************************************************************
    *
    * TrueType driver class.
@@ -335,6 +456,8 @@ FT_BEGIN_HEADER
     TT_GlyphZoneRec  zone;     /* glyph loader points zone */
 
     FT_UInt  interpreter_version;
+    FT_ULong glyph_cache_size;  /* `glyph-cache-size' property */
+    FT_ULong hinting_cost_limit;  /* `hinting-cost-limit' property */
 
   } TT_DriverRec;
 
@@ -387,6 +510,14 @@ FT_BEGIN_HEADER
   tt_size_ready_bytecode( TT_Size  size,
                           FT_Bool  pedantic );
 
+  FT_LOCAL( void )
+  tt_size_prep_key( TT_Size     size,
+                    FT_Bool     pedantic,
+                    TT_PrepKey  key );
+
+  FT_LOCAL( void )
+  tt_face_clear_prep_cache( TT_Face  face );
+
 #endif /* TT_USE_BYTECODE_INTERPRETER */
 
   FT_LOCAL( FT_Error )